@@ -1484,6 +1484,164 @@ QVariantList GetVariants(ResourceFormat rowFormat, uint32_t rowCount, uint32_t r
   return ret;
 }
 
+template <typename T, typename Convert>
+static void DecodeFloatRows(const byte *data, const byte *end, size_t stride,
+                            const uint32_t *rows, size_t numRows, uint32_t compCount, bool bgra,
+                            Convert convert, FloatVector *out)
+{
+  const float nan = (float)qQNaN();
+  const size_t available = size_t(end - data);
+  const size_t elemSize = sizeof(T) * compCount;
+
+  for(size_t i = 0; i < numRows; i++)
+  {
+    float comps[4] = {nan, nan, nan, nan};
+
+    const size_t offset = stride * (rows ? rows[i] : i);
+
+    // an element that runs off the end decodes to nothing, same as GetVariants
+    if(offset < available && elemSize <= available - offset)
+    {
+      const byte *src = data + offset;
+
+      for(uint32_t c = 0; c < compCount; c++)
+      {
+        T val;
+        memcpy(&val, src + c * sizeof(T), sizeof(T));
+        comps[c] = convert(val);
+      }
+
+      if(bgra)
+        std::swap(comps[0], comps[2]);
+    }
+
+    out[i] = FloatVector(comps[0], comps[1], comps[2], comps[3]);
+  }
+}
+
+void DecodeFloatColumn(const ResourceFormat &format, uint32_t rowCount, uint32_t rowByteStride,
+                       const byte *data, const byte *end, size_t stride, const uint32_t *rows,
+                       size_t numRows, FloatVector *out)
+{
+  const uint32_t compCount = qMin(format.compCount, (uint8_t)4);
+  const bool bgra = format.BGRAOrder();
+  const CompType compType = format.compType;
+  const uint8_t width = format.compByteWidth;
+
+  // packed formats and matrices are rare enough that they go through the generic path
+  if(format.type == ResourceFormatType::Regular && rowCount <= 1)
+  {
+    auto asFloat = [](auto v) { return (float)v; };
+
+    if((compType == CompType::Float && width == 8) || compType == CompType::Double)
+    {
+      DecodeFloatRows<double>(data, end, stride, rows, numRows, compCount, bgra, asFloat, out);
+      return;
+    }
+    else if((compType == CompType::Float || compType == CompType::Depth) && width == 4)
+    {
+      DecodeFloatRows<float>(data, end, stride, rows, numRows, compCount, bgra, asFloat, out);
+      return;
+    }
+    else if(compType == CompType::Float && width == 2)
+    {
+      DecodeFloatRows<uint16_t>(data, end, stride, rows, numRows, compCount, bgra,
+                                [](uint16_t v) { return RENDERDOC_HalfToFloat(v); }, out);
+      return;
+    }
+    else if(compType == CompType::Depth && width == 3)
+    {
+      DecodeFloatRows<uint32_t>(data, end, stride, rows, numRows, compCount, bgra,
+                                [](uint32_t v) { return (float)(v & 0x00ffffff) / 16777215.0f; },
+                                out);
+      return;
+    }
+    else if(compType == CompType::Depth && width == 2)
+    {
+      DecodeFloatRows<uint16_t>(data, end, stride, rows, numRows, compCount, bgra,
+                                [](uint16_t v) { return (float)v / 65535.0f; }, out);
+      return;
+    }
+    else if(compType == CompType::SInt || compType == CompType::SScaled)
+    {
+      if(width == 4)
+      {
+        DecodeFloatRows<int32_t>(data, end, stride, rows, numRows, compCount, bgra, asFloat, out);
+        return;
+      }
+      else if(width == 2)
+      {
+        DecodeFloatRows<int16_t>(data, end, stride, rows, numRows, compCount, bgra, asFloat, out);
+        return;
+      }
+      else if(width == 1)
+      {
+        DecodeFloatRows<int8_t>(data, end, stride, rows, numRows, compCount, bgra, asFloat, out);
+        return;
+      }
+    }
+    else if(compType == CompType::UInt || compType == CompType::UScaled)
+    {
+      if(width == 4)
+      {
+        DecodeFloatRows<uint32_t>(data, end, stride, rows, numRows, compCount, bgra, asFloat, out);
+        return;
+      }
+      else if(width == 2)
+      {
+        DecodeFloatRows<uint16_t>(data, end, stride, rows, numRows, compCount, bgra, asFloat, out);
+        return;
+      }
+      else if(width == 1)
+      {
+        DecodeFloatRows<uint8_t>(data, end, stride, rows, numRows, compCount, bgra, asFloat, out);
+        return;
+      }
+    }
+    else if((compType == CompType::UNorm || compType == CompType::UNormSRGB) && width == 1)
+    {
+      DecodeFloatRows<uint8_t>(data, end, stride, rows, numRows, compCount, bgra,
+                               [](uint8_t v) { return (float)v / 255.0f; }, out);
+      return;
+    }
+    else if(compType == CompType::SNorm && width == 1)
+    {
+      DecodeFloatRows<int8_t>(data, end, stride, rows, numRows, compCount, bgra,
+                              [](int8_t v) { return v == -128 ? -1.0f : (float)v / 127.0f; }, out);
+      return;
+    }
+  }
+
+  const float nan = (float)qQNaN();
+
+  for(size_t i = 0; i < numRows; i++)
+  {
+    const byte *bytes = data + stride * (rows ? rows[i] : i);
+
+    QVariantList list = GetVariants(format, rowCount, rowByteStride, bytes, end);
+
+    float comps[4] = {nan, nan, nan, nan};
+
+    for(int c = 0; c < 4 && c < list.count(); c++)
+    {
+      const QVariant &v = list[c];
+
+      QMetaType::Type vt = GetVariantMetatype(v);
+
+      if(vt == QMetaType::Double)
+        comps[c] = (float)v.toDouble();
+      else if(vt == QMetaType::Float)
+        comps[c] = v.toFloat();
+      else if(vt == QMetaType::UInt || vt == QMetaType::UShort || vt == QMetaType::UChar)
+        comps[c] = (float)v.toUInt();
+      else if(vt == QMetaType::Int || vt == QMetaType::Short || vt == QMetaType::SChar)
+        comps[c] = (float)v.toInt();
+    }
+
+    out[i] = FloatVector(comps[0], comps[1], comps[2], comps[3]);
+  }
+}
+
 QString TypeString(const ShaderVariable &v)
 {
   if(!v.members.isEmpty() || v.isStruct)
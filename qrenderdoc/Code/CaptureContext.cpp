@@ -1093,7 +1093,8 @@ void CaptureContext::RecompressCapture()
   float progress = 0.0f;
 
   LambdaThread *th = new LambdaThread([cap, destFilename, &progress]() {
-    cap->Convert(destFilename.toUtf8().data(), "rdc", NULL, [&progress](float p) { progress = p; });
+    cap->Recompress(destFilename.toUtf8().data(), 0, 0, false,
+                    [&progress](float p) { progress = p; });
   });
   th->start();
   // wait a few ms before popping up a progress bar
@@ -0,0 +1,224 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "EventSearchIndex.h"
+#include <QRegularExpression>
+#include <algorithm>
+
+void EventSearchIndex::Build(const rdcarray<DrawcallDescription> &draws, const SDFile &file,
+                             const QMap<ResourceId, QString> &resourceNames,
+                             const QAtomicInt &cancel)
+{
+  m_Text.clear();
+  m_Offsets.clear();
+  m_EventIds.clear();
+
+  m_File = &file;
+  m_ResourceNames = &resourceNames;
+  m_Cancel = &cancel;
+
+  AddDrawcalls(draws);
+
+  m_File = NULL;
+  m_ResourceNames = NULL;
+  m_Cancel = NULL;
+
+  m_Text.squeeze();
+}
+
+bool EventSearchIndex::AddDrawcalls(const rdcarray<DrawcallDescription> &draws)
+{
+  for(const DrawcallDescription &d : draws)
+  {
+    if(m_Cancel->loadAcquire())
+      return false;
+
+    m_Offsets.push_back(m_Text.length());
+    m_EventIds.push_back(d.eventId);
+
+    AppendEntry(m_Text, d, *m_File, *m_ResourceNames);
+
+    m_Text += QLatin1Char('\n');
+
+    if(!AddDrawcalls(d.children))
+      return false;
+  }
+
+  return true;
+}
+
+void EventSearchIndex::AppendEntry(QString &text, const DrawcallDescription &draw,
+                                   const SDFile &file,
+                                   const QMap<ResourceId, QString> &resourceNames)
+{
+  int start = text.length();
+
+  text += QString(draw.name);
+
+  for(const APIEvent &ev : draw.events)
+  {
+    if(ev.chunkIndex >= file.chunks.size())
+      continue;
+
+    const SDChunk *chunk = file.chunks[ev.chunkIndex];
+
+    text += QLatin1Char(' ');
+    text += QString(chunk->name);
+
+    for(const SDObject *obj : chunk->data.children)
+      AppendObject(text, obj, resourceNames);
+  }
+
+  // lowercase in place so searches don't need to fold case, and keep the entry on one line
+  QChar *entry = text.data() + start;
+  for(int i = start; i < text.length(); i++, entry++)
+    *entry = (*entry == QLatin1Char('\n')) ? QLatin1Char(' ') : entry->toLower();
+}
+
+void EventSearchIndex::AppendObject(QString &text, const SDObject *obj,
+                                    const QMap<ResourceId, QString> &resourceNames)
+{
+  if(obj->type.flags & SDTypeFlags::Hidden)
+    return;
+
+  // only values are indexed, member names would make almost every search match everything
+  if(obj->type.basetype == SDBasic::Resource)
+  {
+    ResourceId id;
+    static_assert(sizeof(id) == sizeof(obj->data.basic.u), "ResourceId is no longer uint64_t!");
+    memcpy(&id, &obj->data.basic.u, sizeof(id));
+
+    QString name = resourceNames.value(id);
+    if(!name.isEmpty())
+    {
+      text += QLatin1Char(' ');
+      text += name;
+    }
+    return;
+  }
+  else if(obj->type.flags & SDTypeFlags::NullString)
+  {
+    return;
+  }
+  else if(obj->type.flags & SDTypeFlags::HasCustomString)
+  {
+    text += QLatin1Char(' ');
+    text += QString(obj->data.str);
+    return;
+  }
+
+  switch(obj->type.basetype)
+  {
+    case SDBasic::Chunk:
+    case SDBasic::Struct:
+    case SDBasic::Array:
+      for(const SDObject *child : obj->data.children)
+        AppendObject(text, child, resourceNames);
+      return;
+    case SDBasic::Null:
+    case SDBasic::Buffer:
+    case SDBasic::Resource: return;
+    case SDBasic::String: text += QLatin1Char(' ') + QString(obj->data.str); return;
+    case SDBasic::Enum:
+    case SDBasic::UnsignedInteger:
+      text += QLatin1Char(' ') + QString::number(obj->data.basic.u);
+      return;
+    case SDBasic::SignedInteger:
+      text += QLatin1Char(' ') + QString::number(obj->data.basic.i);
+      return;
+    case SDBasic::Float: text += QLatin1Char(' ') + QString::number(obj->data.basic.d); return;
+    case SDBasic::Boolean: text += obj->data.basic.b ? lit(" true") : lit(" false"); return;
+    case SDBasic::Character:
+      text += QLatin1Char(' ');
+      text += QLatin1Char(obj->data.basic.c);
+      return;
+  }
+}
+
+rdcarray<uint32_t> EventSearchIndex::Find(const QString &filter, bool regex) const
+{
+  rdcarray<uint32_t> ret;
+
+  if(filter.isEmpty() || m_EventIds.isEmpty())
+    return ret;
+
+  if(regex)
+  {
+    QRegularExpression re(filter, QRegularExpression::CaseInsensitiveOption);
+
+    if(!re.isValid())
+      return ret;
+
+    re.optimize();
+
+    for(int i = 0; i < m_Offsets.count(); i++)
+    {
+      int start = m_Offsets[i];
+      int end = (i + 1 < m_Offsets.count() ? m_Offsets[i + 1] : m_Text.length()) - 1;
+
+      if(re.match(m_Text.midRef(start, end - start)).hasMatch())
+        ret.push_back(m_EventIds[i]);
+    }
+  }
+  else
+  {
+    // entries never contain newlines, so nothing can match across them
+    if(filter.contains(QLatin1Char('\n')))
+      return ret;
+
+    QString needle = filter.toLower();
+
+    int pos = m_Text.indexOf(needle);
+    while(pos >= 0)
+    {
+      int entry = int(std::upper_bound(m_Offsets.begin(), m_Offsets.end(), pos) - m_Offsets.begin());
+      entry--;
+
+      ret.push_back(m_EventIds[entry]);
+
+      // skip the rest of this entry, we only need one match per drawcall
+      if(entry + 1 >= m_Offsets.count())
+        break;
+
+      pos = m_Text.indexOf(needle, m_Offsets[entry + 1]);
+    }
+  }
+
+  std::sort(ret.begin(), ret.end());
+
+  return ret;
+}
+
+bool EventSearchIndex::Matches(const DrawcallDescription &draw, const SDFile &file,
+                               const QMap<ResourceId, QString> &resourceNames,
+                               const QString &filter)
+{
+  if(filter.isEmpty() || filter.contains(QLatin1Char('\n')))
+    return false;
+
+  QString text;
+  AppendEntry(text, draw, file, resourceNames);
+
+  return text.contains(filter.toLower());
+}
@@ -0,0 +1,76 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <QAtomicInt>
+#include <QMap>
+#include <QString>
+#include <QVector>
+#include "Code/QRDUtils.h"
+
+// A flat text index over every drawcall in a capture, used to search events without walking the
+// event tree. Each drawcall gets one entry containing its name as well as the chunk name and
+// parameters of every API call that makes it up. The entries are lowercased and concatenated into
+// a single string so a substring search is one linear scan.
+//
+// Building only reads the drawcalls and structured data, so it can be done off the UI thread. Once
+// built the index is immutable and can be searched from any thread.
+class EventSearchIndex
+{
+public:
+  // resource names are passed in rather than fetched from the context, since the context isn't
+  // safe to query from a background thread. If cancel becomes non-zero the build stops early and
+  // the index is left incomplete.
+  void Build(const rdcarray<DrawcallDescription> &draws, const SDFile &file,
+             const QMap<ResourceId, QString> &resourceNames, const QAtomicInt &cancel);
+
+  // returns the event IDs of all drawcalls matching the filter, in ascending order. Matching is
+  // case insensitive, either as a plain substring or as a regular expression.
+  rdcarray<uint32_t> Find(const QString &filter, bool regex) const;
+
+  // checks a single drawcall (not its children) against a plain substring filter, matching the
+  // same text as Find would. Used to search before the index has finished building.
+  static bool Matches(const DrawcallDescription &draw, const SDFile &file,
+                      const QMap<ResourceId, QString> &resourceNames, const QString &filter);
+
+  int count() const { return m_EventIds.count(); }
+private:
+  static void AppendEntry(QString &text, const DrawcallDescription &draw, const SDFile &file,
+                          const QMap<ResourceId, QString> &resourceNames);
+  static void AppendObject(QString &text, const SDObject *obj,
+                           const QMap<ResourceId, QString> &resourceNames);
+
+  bool AddDrawcalls(const rdcarray<DrawcallDescription> &draws);
+
+  const SDFile *m_File = NULL;
+  const QMap<ResourceId, QString> *m_ResourceNames = NULL;
+  const QAtomicInt *m_Cancel = NULL;
+
+  // all entries, each terminated by a newline. Entries never contain newlines themselves
+  QString m_Text;
+  // the offset in m_Text where each entry starts, and the drawcall it belongs to
+  QVector<int> m_Offsets;
+  QVector<uint32_t> m_EventIds;
+};
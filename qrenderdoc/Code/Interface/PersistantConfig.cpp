@@ -700,6 +700,8 @@ ReplayOptions::ReplayOptions(const QVariant &var)
     forceGPUDriverName = map[lit("forceGPUDriverName")].toString();
   if(map.contains(lit("optimisation")))
     optimisation = (ReplayOptimisationLevel)map[lit("optimisation")].toUInt();
+  if(map.contains(lit("checkpointMemoryBudgetMB")))
+    checkpointMemoryBudgetMB = map[lit("checkpointMemoryBudgetMB")].toUInt();
 }
 
 ReplayOptions::operator QVariant() const
@@ -711,6 +713,7 @@ ReplayOptions::operator QVariant() const
   map[lit("forceGPUDeviceID")] = forceGPUDeviceID;
   map[lit("forceGPUDriverName")] = forceGPUDriverName;
   map[lit("optimisation")] = (uint32_t)optimisation;
+  map[lit("checkpointMemoryBudgetMB")] = checkpointMemoryBudgetMB;
 
   return map;
 }
@@ -100,6 +100,7 @@ CaptureSettings::operator QVariant() const
   opts[lit("apiValidation")] = options.apiValidation;
   opts[lit("captureCallstacks")] = options.captureCallstacks;
   opts[lit("captureCallstacksOnlyDraws")] = options.captureCallstacksOnlyDraws;
+  opts[lit("captureCallstacksFastUnwind")] = options.captureCallstacksFastUnwind;
   opts[lit("delayForDebugger")] = options.delayForDebugger;
   opts[lit("verifyBufferAccess")] = options.verifyBufferAccess;
   opts[lit("hookIntoChildren")] = options.hookIntoChildren;
@@ -139,6 +140,7 @@ CaptureSettings::CaptureSettings(const QVariant &v)
   options.apiValidation = opts[lit("apiValidation")].toBool();
   options.captureCallstacks = opts[lit("captureCallstacks")].toBool();
   options.captureCallstacksOnlyDraws = opts[lit("captureCallstacksOnlyDraws")].toBool();
+  options.captureCallstacksFastUnwind = opts[lit("captureCallstacksFastUnwind")].toBool();
   options.delayForDebugger = opts[lit("delayForDebugger")].toUInt();
   // old name for verifyBufferAccess was verifyMapWrites, so use that as a fallback
   if(opts.contains(lit("verifyBufferAccess")))
@@ -196,6 +196,21 @@ struct IEventBrowser
   DOCUMENT("Updates the duration column if the selected time unit changes.");
   virtual void UpdateDurationColumn() = 0;
 
+  DOCUMENT(R"(Search the events in the capture for a string.
+
+Each drawcall is matched against its name, as well as the name and parameters of every API call
+that makes it up. Resource parameters match by the resource's name. Matching is case insensitive.
+
+If the search index is still being built in the background after loading the capture, this will
+wait for it to finish.
+
+:param str filter: The string to search for.
+:param bool regex: ``True`` if the filter is a regular expression, ``False`` for a plain substring.
+:return: The event IDs of the matching drawcalls, in ascending order.
+:rtype: ``list`` of ``int``
+)");
+  virtual rdcarray<uint32_t> FindEvents(const rdcstr &filter, bool regex) = 0;
+
 protected:
   IEventBrowser() = default;
   ~IEventBrowser() = default;
@@ -868,6 +883,44 @@ comes in, we remove any other requests in the queue before it that have the same
 )");
   virtual void AsyncInvoke(InvokeCallback method) = 0;
 
+  DOCUMENT(R"(Make a tagged non-blocking invoke call onto the replay thread, at background priority.
+
+Background invokes are for long-running bulk work such as fetching counters or pixel history. They
+are only started when no other invokes are waiting, so interactive requests queued after them still
+run first. As with :meth:`AsyncInvoke`, any request still waiting in the queue with the same tag is
+removed. An empty tag never replaces anything, but the invoke can't be cancelled either.
+
+:param str tag: The tag to identify this callback, which can be passed to :meth:`CancelInvoke`.
+:param InvokeCallback method: The function to callback on the replay thread.
+)");
+  virtual void BackgroundInvoke(const rdcstr &tag, InvokeCallback method) = 0;
+
+  DOCUMENT(R"(Cancel any invokes with the given tag.
+
+Requests that are still waiting in the queue are removed without being called. If a background
+invoke with this tag is currently running, its next call to :meth:`PreemptionPoint` will return
+``False``.
+
+:param str tag: The tag of the invokes to cancel.
+)");
+  virtual void CancelInvoke(const rdcstr &tag) = 0;
+
+  DOCUMENT(R"(Give waiting interactive invokes a chance to run in the middle of a background invoke.
+
+This should be called periodically from a background invoke's callback. Any non-background invokes
+that are waiting are processed before it returns. Called from anywhere else this does nothing.
+
+If the background work has left the replay in a state the waiting invokes wouldn't expect, e.g. at a
+different event, :paramref:`PreemptionPoint.resume` can put it back. It's only called when there is
+waiting work to process, so nothing is restored when the background work isn't interrupted.
+
+:param InvokeCallback resume: Called once before the first waiting invoke is processed.
+:return: ``False`` if the running background invoke has been cancelled and should return as soon
+  as possible, ``True`` if it should continue.
+:rtype: ``bool``
+)");
+  virtual bool PreemptionPoint(InvokeCallback resume) = 0;
+
   // This is an ugly hack, but we leave BlockInvoke as the last method, so that when the class is
   // extended and the wrapper around BlockInvoke to release the python GIL happens, it picks up the
   // same docstring.
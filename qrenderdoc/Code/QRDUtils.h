@@ -101,6 +101,12 @@ public:
 
 QVariantList GetVariants(ResourceFormat rowFormat, uint32_t rowCount, uint32_t rowByteStride,
                          const byte *&data, const byte *end);
+// decodes the first four components of many elements at once as floats, for bulk processing like
+// bounding boxes. Element i is read at data + stride * rows[i] (or stride * i if rows is NULL).
+// Components that don't exist or can't be represented as a float are NaN.
+void DecodeFloatColumn(const ResourceFormat &format, uint32_t rowCount, uint32_t rowByteStride,
+                       const byte *data, const byte *end, size_t stride, const uint32_t *rows,
+                       size_t numRows, FloatVector *out);
 ResourceFormat GetInterpretedResourceFormat(const ShaderConstant &elem);
 void SetInterpretedResourceFormat(ShaderConstant &elem, ResourceFormatType interpretType,
                                   CompType interpretCompType);
@@ -241,22 +241,7 @@ void ReplayManager::AsyncInvoke(const rdcstr &tag, ReplayManager::InvokeCallback
 {
   QString qtag(tag);
 
-  {
-    QMutexLocker autolock(&m_RenderLock);
-    for(int i = 0; i < m_RenderQueue.count();)
-    {
-      if(m_RenderQueue[i]->tag == qtag)
-      {
-        InvokeHandle *cmd = m_RenderQueue.takeAt(i);
-        if(cmd->selfdelete)
-          delete cmd;
-      }
-      else
-      {
-        i++;
-      }
-    }
-  }
+  RemoveQueuedInvokes(qtag);
 
   InvokeHandle *cmd = new InvokeHandle(m, qtag);
   cmd->selfdelete = true;
@@ -272,6 +257,82 @@ void ReplayManager::AsyncInvoke(ReplayManager::InvokeCallback m)
   PushInvoke(cmd);
 }
 
+void ReplayManager::BackgroundInvoke(const rdcstr &tag, ReplayManager::InvokeCallback m)
+{
+  QString qtag(tag);
+
+  RemoveQueuedInvokes(qtag);
+
+  InvokeHandle *cmd = new InvokeHandle(m, qtag);
+  cmd->selfdelete = true;
+  cmd->background = true;
+
+  PushInvoke(cmd);
+}
+
+void ReplayManager::CancelInvoke(const rdcstr &tag)
+{
+  QString qtag(tag);
+
+  if(qtag.isEmpty())
+    return;
+
+  RemoveQueuedInvokes(qtag);
+
+  QMutexLocker autolock(&m_RenderLock);
+  if(m_RunningBackground && m_RunningTag == qtag)
+    m_RunningCancelled = true;
+}
+
+bool ReplayManager::PreemptionPoint(InvokeCallback resume)
+{
+  // invokes processed here don't get to pre-empt anything themselves
+  if(m_Thread == NULL || !m_Thread->isCurrentThread() || m_Preempting)
+    return true;
+
+  {
+    QMutexLocker autolock(&m_RenderLock);
+    // interactive invokes run to completion, so there's nothing to yield to
+    if(!m_RunningBackground)
+      return true;
+  }
+
+  bool processed = false;
+
+  for(;;)
+  {
+    InvokeHandle *cmd = NULL;
+
+    {
+      QMutexLocker autolock(&m_RenderLock);
+      if(!m_Running || m_RunningCancelled)
+        return false;
+
+      cmd = TakeNextInvoke(true);
+    }
+
+    if(cmd == NULL)
+      break;
+
+    m_Preempting = true;
+    // the background work may have moved the replay, so let it put things back first
+    if(!processed && resume)
+      resume(m_Renderer);
+    ProcessInvoke(cmd);
+    m_Preempting = false;
+    processed = true;
+  }
+
+  // the background invoke is still running, so restart its timer
+  if(processed)
+  {
+    QMutexLocker lock(&m_TimerLock);
+    m_CommandTimer.start();
+  }
+
+  return true;
+}
+
 void ReplayManager::BlockInvoke(ReplayManager::InvokeCallback m)
 {
   InvokeHandle *cmd = new InvokeHandle(m);
@@ -417,6 +478,70 @@ void ReplayManager::PushInvoke(ReplayManager::InvokeHandle *cmd)
   m_RenderCondition.wakeAll();
 }
 
+void ReplayManager::RemoveQueuedInvokes(const QString &tag)
+{
+  // untagged invokes are never removed
+  if(tag.isEmpty())
+    return;
+
+  QMutexLocker autolock(&m_RenderLock);
+  for(int i = 0; i < m_RenderQueue.count();)
+  {
+    if(m_RenderQueue[i]->tag == tag)
+    {
+      InvokeHandle *cmd = m_RenderQueue.takeAt(i);
+      if(cmd->selfdelete)
+        delete cmd;
+      else
+        cmd->processed.release();
+    }
+    else
+    {
+      i++;
+    }
+  }
+}
+
+ReplayManager::InvokeHandle *ReplayManager::TakeNextInvoke(bool interactiveOnly)
+{
+  // must be called with m_RenderLock held. Interactive invokes are taken in order ahead of any
+  // background invokes, which only run when nothing else is waiting
+  for(int i = 0; i < m_RenderQueue.count(); i++)
+  {
+    if(!m_RenderQueue[i]->background)
+      return m_RenderQueue.takeAt(i);
+  }
+
+  if(interactiveOnly || m_RenderQueue.isEmpty())
+    return NULL;
+
+  return m_RenderQueue.dequeue();
+}
+
+void ReplayManager::ProcessInvoke(ReplayManager::InvokeHandle *cmd)
+{
+  if(cmd->method != NULL)
+  {
+    {
+      QMutexLocker lock(&m_TimerLock);
+      m_CommandTimer.start();
+    }
+
+    cmd->method(m_Renderer);
+
+    {
+      QMutexLocker lock(&m_TimerLock);
+      m_CommandTimer.invalidate();
+    }
+  }
+
+  // if it's a throwaway command, delete it
+  if(cmd->selfdelete)
+    delete cmd;
+  else
+    cmd->processed.release();
+}
+
 void ReplayManager::run(int proxyRenderer, const QString &capturefile, const ReplayOptions &opts,
                         RENDERDOC_ProgressCallback progress)
 {
@@ -455,40 +580,33 @@ void ReplayManager::run(int proxyRenderer, const QString &capturefile, const Rep
   {
     InvokeHandle *cmd = NULL;
 
-    // wait for the condition to be woken, grab top of current queue,
+    // wait for the condition to be woken, grab the next invoke from the current queue,
     // unlock again.
     {
       QMutexLocker autolock(&m_RenderLock);
       if(m_RenderQueue.isEmpty())
         m_RenderCondition.wait(&m_RenderLock, 10);
 
-      if(!m_RenderQueue.isEmpty())
-        cmd = m_RenderQueue.dequeue();
+      cmd = TakeNextInvoke(false);
+
+      if(cmd)
+      {
+        m_RunningTag = cmd->tag;
+        m_RunningBackground = cmd->background;
+        m_RunningCancelled = false;
+      }
     }
 
     if(cmd == NULL)
       continue;
 
-    if(cmd->method != NULL)
-    {
-      {
-        QMutexLocker lock(&m_TimerLock);
-        m_CommandTimer.start();
-      }
-
-      cmd->method(m_Renderer);
+    ProcessInvoke(cmd);
 
-      {
-        QMutexLocker lock(&m_TimerLock);
-        m_CommandTimer.invalidate();
-      }
+    {
+      QMutexLocker autolock(&m_RenderLock);
+      m_RunningTag.clear();
+      m_RunningBackground = false;
     }
-
-    // if it's a throwaway command, delete it
-    if(cmd->selfdelete)
-      delete cmd;
-    else
-      cmd->processed.release();
   }
 
   // clean up anything left in the queue
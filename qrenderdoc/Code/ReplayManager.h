@@ -63,6 +63,9 @@ public:
   // comes in, we remove any other requests in the queue before it that have the same tag
   void AsyncInvoke(const rdcstr &tag, InvokeCallback m);
   void AsyncInvoke(InvokeCallback m);
+  void BackgroundInvoke(const rdcstr &tag, InvokeCallback m);
+  void CancelInvoke(const rdcstr &tag);
+  bool PreemptionPoint(InvokeCallback resume);
   void BlockInvoke(InvokeCallback m);
 
   void CancelReplayLoop();
@@ -106,12 +109,14 @@ private:
       tag = t;
       method = m;
       selfdelete = false;
+      background = false;
     }
 
     QString tag;
     InvokeCallback method;
     QSemaphore processed;
     bool selfdelete;
+    bool background;
   };
 
   void run(int proxyRenderer, const QString &capturefile, const ReplayOptions &opts,
@@ -124,10 +129,21 @@ private:
   QQueue<InvokeHandle *> m_RenderQueue;
   QWaitCondition m_RenderCondition;
 
+  // the invoke currently being processed on the replay thread, protected by m_RenderLock. Only a
+  // background invoke can be pre-empted or cancelled while it's running
+  QString m_RunningTag;
+  bool m_RunningBackground = false;
+  bool m_RunningCancelled = false;
+  // only accessed on the replay thread
+  bool m_Preempting = false;
+
   ICaptureFile *m_CaptureFile = NULL;
   IReplayController *m_Renderer = NULL;
 
   void PushInvoke(InvokeHandle *cmd);
+  void RemoveQueuedInvokes(const QString &tag);
+  InvokeHandle *TakeNextInvoke(bool interactiveOnly);
+  void ProcessInvoke(InvokeHandle *cmd);
 
   QMutex m_RemoteLock;
   RemoteHost m_RemoteHost;
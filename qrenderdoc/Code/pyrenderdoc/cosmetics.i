@@ -156,6 +156,8 @@ DEFINE_SAFE_EQUALITY(APIEvent)
 DEFINE_SAFE_EQUALITY(Bindpoint)
 DEFINE_SAFE_EQUALITY(BufferDescription)
 DEFINE_SAFE_EQUALITY(CaptureFileFormat)
+DEFINE_SAFE_EQUALITY(CaptureJobResult)
+DEFINE_SAFE_EQUALITY(ChunkLoadStatistics)
 DEFINE_SAFE_EQUALITY(ConstantBlock)
 DEFINE_SAFE_EQUALITY(DebugMessage)
 DEFINE_SAFE_EQUALITY(EnvironmentModification)
@@ -165,6 +167,7 @@ DEFINE_SAFE_EQUALITY(PixelModification)
 DEFINE_SAFE_EQUALITY(ResourceDescription)
 DEFINE_SAFE_EQUALITY(ResourceId)
 DEFINE_SAFE_EQUALITY(LineColumnInfo)
+DEFINE_SAFE_EQUALITY(LoadPhaseStatistics)
 DEFINE_SAFE_EQUALITY(ShaderCompileFlag)
 DEFINE_SAFE_EQUALITY(ShaderConstant)
 DEFINE_SAFE_EQUALITY(ShaderDebugState)
@@ -100,6 +100,26 @@
 }
 %typemap(freearg) rdcarray<rdcstr> *supportedProtocols { }
 
+// same for RENDERDOC_GetCaptureThumbnails
+%typemap(in, numinputs=0) rdcarray<rdcpair<rdcstr, Thumbnail>> *thumbnails {
+  $1 = new rdcarray<rdcpair<rdcstr, Thumbnail>>;
+}
+%typemap(argout) rdcarray<rdcpair<rdcstr, Thumbnail>> *thumbnails {
+  $result = ConvertToPy(*$1);
+  delete $1;
+}
+%typemap(freearg) rdcarray<rdcpair<rdcstr, Thumbnail>> *thumbnails { }
+
+// same for RENDERDOC_RunCaptureJobs
+%typemap(in, numinputs=0) rdcarray<CaptureJobResult> *results {
+  $1 = new rdcarray<CaptureJobResult>;
+}
+%typemap(argout) rdcarray<CaptureJobResult> *results {
+  $result = ConvertToPy(*$1);
+  delete $1;
+}
+%typemap(freearg) rdcarray<CaptureJobResult> *results { }
+
 // same for RENDERDOC_CreateRemoteServerConnection
 %typemap(in, numinputs=0) IRemoteServer **rend (IRemoteServer *outRenderer) {
   outRenderer = NULL;
@@ -290,6 +310,7 @@ EXTEND_ARRAY_CLASS_METHODS(StructuredBufferList)
 // list of array types. These are the concrete types used in rdcarray that will be bound
 // If you get an error with add_your_use_of_rdcarray_to_swig_interface missing, add your type here
 // or in qrenderdoc.i, depending on which one is appropriate
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, bool)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, int)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, float)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, uint32_t)
@@ -303,6 +324,8 @@ TEMPLATE_ARRAY_INSTANTIATE(rdcarray, APIEvent)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, Bindpoint)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, BufferDescription)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, CaptureFileFormat)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, CaptureJobResult)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ChunkLoadStatistics)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ConstantBlock)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, DebugMessage)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, EnvironmentModification)
@@ -312,6 +335,7 @@ TEMPLATE_ARRAY_INSTANTIATE(rdcarray, PixelModification)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ResourceDescription)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ResourceId)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, LineColumnInfo)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, LoadPhaseStatistics)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderCompileFlag)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderConstant)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderDebugState)
@@ -324,6 +348,7 @@ TEMPLATE_ARRAY_INSTANTIATE(rdcarray, RegisterRange)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, LocalVariableMapping)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, SigParameter)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, TextureDescription)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, TextureSave)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderEntryPoint)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, Viewport)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, Scissor)
@@ -31,6 +31,7 @@
 #include <QMouseEvent>
 #include <QPainter>
 #include <QPen>
+#include <QScrollBar>
 #include <QStack>
 #include <QToolTip>
 #include "Code/Interface/QRDInterface.h"
@@ -86,6 +87,12 @@ public:
   }
 
   void endInsertChild(RDTreeWidgetItem *item) { endInsertRows(); }
+  void beginInsertChildren(RDTreeWidgetItem *item, int first, int last)
+  {
+    beginInsertRows(indexForItem(item, 0), first, last);
+  }
+
+  void endInsertChildren() { endInsertRows(); }
   void beginRemoveChildren(RDTreeWidgetItem *parent, int first, int last)
   {
     beginRemoveRows(indexForItem(parent, 0), first, last);
@@ -150,9 +157,21 @@ public:
     RDTreeWidgetItem *parentItem = itemForIndex(parent);
 
     if(parentItem)
-      return parentItem->childCount() > 0;
+      return parentItem->childCount() > 0 || parentItem->m_lazyChildren;
     return false;
   }
+
+  bool canFetchMore(const QModelIndex &parent) const override
+  {
+    RDTreeWidgetItem *parentItem = itemForIndex(parent);
+
+    return parentItem && parentItem->m_lazyChildren;
+  }
+
+  void fetchMore(const QModelIndex &parent) override
+  {
+    widget->populateLazyItem(itemForIndex(parent));
+  }
   Qt::ItemFlags flags(const QModelIndex &index) const override
   {
     if(!index.isValid())
@@ -592,6 +611,13 @@ RDTreeWidget::RDTreeWidget(QWidget *parent) : RDTreeView(parent)
   QObject::connect(this, &RDTreeWidget::doubleClicked, [this](const QModelIndex &idx) {
     emit itemDoubleClicked(m_model->itemForIndex(idx), idx.column());
   });
+
+  // lazy items only get their first batch of children when expanded, fetch the rest as the last
+  // one becomes visible
+  QObject::connect(verticalScrollBar(), &QScrollBar::valueChanged,
+                   [this](int) { populateVisibleLazyItems(); });
+  QObject::connect(this, &RDTreeWidget::expanded,
+                   [this](const QModelIndex &) { populateVisibleLazyItems(); });
 }
 
 RDTreeWidget::~RDTreeWidget()
@@ -718,6 +744,9 @@ void RDTreeWidget::expandAllItems(RDTreeWidgetItem *item)
 {
   expandItem(item);
 
+  while(item->m_lazyChildren)
+    populateLazyItem(item);
+
   for(int c = 0; c < item->childCount(); c++)
   {
     RDTreeWidgetItem *child = item->child(c);
@@ -746,6 +775,61 @@ void RDTreeWidget::scrollToItem(RDTreeWidgetItem *node)
   scrollTo(m_model->indexForItem(node, 0));
 }
 
+void RDTreeWidget::populateLazyItem(RDTreeWidgetItem *item)
+{
+  if(!item || !item->m_lazyChildren || !m_lazyPopulate)
+    return;
+
+  item->m_lazyChildren = false;
+
+  // detach the item while the callback runs so that adding children doesn't send a model update
+  // for each one, then insert the whole batch at once.
+  int first = item->childCount();
+
+  item->m_widget = NULL;
+  m_lazyPopulate(item);
+  item->m_widget = this;
+
+  int last = item->childCount() - 1;
+
+  if(last < first)
+    return;
+
+  QVector<RDTreeWidgetItem *> added = item->m_children.mid(first);
+  item->m_children.resize(first);
+
+  m_model->beginInsertChildren(item, first, last);
+
+  for(RDTreeWidgetItem *child : added)
+  {
+    child->setWidget(this);
+    item->m_children.push_back(child);
+  }
+
+  m_model->endInsertChildren();
+}
+
+void RDTreeWidget::populateVisibleLazyItems()
+{
+  if(!m_lazyPopulate)
+    return;
+
+  int bottom = viewport()->height();
+
+  // check the visible rows for any that are the last loaded child of a lazy item
+  for(QModelIndex idx = indexAt(QPoint(0, 0)); idx.isValid(); idx = indexBelow(idx))
+  {
+    if(visualRect(idx).top() > bottom)
+      break;
+
+    RDTreeWidgetItem *item = m_model->itemForIndex(idx);
+    RDTreeWidgetItem *parent = item->m_parent;
+
+    if(parent && parent->m_lazyChildren && parent->m_children.back() == item)
+      populateLazyItem(parent);
+  }
+}
+
 void RDTreeWidget::clear()
 {
   m_clearing = true;
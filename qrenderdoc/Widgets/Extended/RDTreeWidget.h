@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <functional>
 #include "RDTreeView.h"
 
 class RDTreeWidget;
@@ -66,6 +67,10 @@ public:
   void clear();
   inline int dataCount() const { return m_text.count(); }
   inline int childCount() const { return m_children.count(); }
+  // items with lazy children are shown as expandable, and their children are only created through
+  // the tree's lazy populate callback when they're needed. See RDTreeWidget::setLazyPopulate
+  inline void setLazyChildren(bool lazy) { m_lazyChildren = lazy; }
+  inline bool hasLazyChildren() const { return m_lazyChildren; }
   inline RDTreeWidgetItem *parent() const { return m_parent; }
   inline RDTreeWidget *treeWidget() const { return m_widget; }
   inline void setBold(bool bold)
@@ -167,6 +172,7 @@ private:
   QBrush m_back;
   QBrush m_fore;
   QVariant m_tag;
+  bool m_lazyChildren = false;
 };
 
 class RDTreeWidgetItemIterator
@@ -254,6 +260,16 @@ public:
   void collapseAllItems(RDTreeWidgetItem *item);
   void scrollToItem(RDTreeWidgetItem *node);
 
+  // the callback is called to add children to an item marked with setLazyChildren(), when it's
+  // first expanded or when its last child scrolls into view. It can add as many children as it
+  // likes and should mark the item as lazy again if there are still more to come.
+  void setLazyPopulate(std::function<void(RDTreeWidgetItem *)> callback)
+  {
+    m_lazyPopulate = callback;
+  }
+  // add the next batch of children to an item with lazy children, if it has any.
+  void populateLazyItem(RDTreeWidgetItem *item);
+
   void copySelection();
 
   void clear();
@@ -285,6 +301,7 @@ private:
   void itemDataChanged(RDTreeWidgetItem *item, int column, int role);
   void beginInsertChild(RDTreeWidgetItem *item, int index);
   void endInsertChild(RDTreeWidgetItem *item, int index);
+  void populateVisibleLazyItems();
 
   friend class RDTreeWidgetModel;
   friend class RDTreeWidgetItem;
@@ -320,4 +337,6 @@ private:
   bool m_hoverHandCursor = false;
   bool m_clearSelectionOnFocusLoss = false;
   bool m_activateOnClick = false;
+
+  std::function<void(RDTreeWidgetItem *)> m_lazyPopulate;
 };
@@ -31,12 +31,17 @@
 #include <QMouseEvent>
 #include <QMutexLocker>
 #include <QScrollBar>
+#include <QSet>
 #include <QTimer>
 #include <QtMath>
 #include "Code/QRDUtils.h"
 #include "Code/Resources.h"
 #include "ui_BufferViewer.h"
 
+#if defined(__x86_64__) || defined(_M_X64)
+#include <xmmintrin.h>
+#endif
+
 namespace NativeScanCode
 {
 enum
@@ -455,8 +460,98 @@ struct BufferData
 
   const byte *data() const { return storage.begin(); };
   const byte *end() const { return storage.end(); }
-  bool hasData() const { return !storage.empty(); }
-  size_t size() const { return storage.size(); }
+  bool hasData() const { return !storage.empty() || paged(); }
+  size_t size() const { return paged() ? (size_t)pagedLength : storage.size(); }
+
+  // raw buffers larger than this aren't fetched in one go. Instead pages of rows are fetched as
+  // they're displayed, and only the most recently used pages are kept in memory.
+  static const uint64_t PagingThreshold = 16 * 1024 * 1024;
+  static const uint64_t PageSize = 256 * 1024;
+  static const int MaxCachedPages = 64;
+  // when every row of a paged buffer is needed at once, e.g. for bounds or exporting, it's fetched
+  // in transient blocks of this size without going through the page cache.
+  static const uint64_t StreamBlockSize = 16 * 1024 * 1024;
+
+  ResourceId pagedResource;
+  uint64_t pagedOffset = 0;
+  uint64_t pagedLength = 0;
+
+  bool paged() const { return pagedLength > 0; }
+  uint64_t rowStride() const { return qMax((uint64_t)1, (uint64_t)stride); }
+  uint32_t rowsPerPage() const { return uint32_t(qMax((uint64_t)1, PageSize / rowStride())); }
+  uint64_t pageByteSize() const { return rowsPerPage() * rowStride(); }
+  uint32_t pageForRow(uint32_t row) const { return row / rowsPerPage(); }
+  uint32_t numPages() const
+  {
+    return uint32_t((pagedLength + pageByteSize() - 1) / pageByteSize());
+  }
+
+  // copies a row into rowData if its page is loaded, otherwise returns false
+  bool readRow(uint32_t row, bytebuf &rowData)
+  {
+    QMutexLocker lock(&pageLock);
+
+    uint32_t page = pageForRow(row);
+
+    auto it = pages.find(page);
+    if(it == pages.end())
+      return false;
+
+    recentPages.removeOne(page);
+    recentPages.push_front(page);
+
+    size_t offs = (row % rowsPerPage()) * stride;
+    if(offs < it->size())
+      rowData.assign(it->data() + offs, qMin(stride, it->size() - offs));
+    else
+      rowData.clear();
+
+    return true;
+  }
+
+  bool hasPage(uint32_t page)
+  {
+    QMutexLocker lock(&pageLock);
+    return pages.contains(page);
+  }
+
+  // marks a page as pending, returns false if it's out of range, already loaded, or already pending
+  bool requestPage(uint32_t page)
+  {
+    QMutexLocker lock(&pageLock);
+
+    if(page >= numPages() || pages.contains(page) || pendingPages.contains(page))
+      return false;
+
+    pendingPages.insert(page);
+    return true;
+  }
+
+  // clears a page's pending state without loading it, if its fetch was skipped
+  void cancelPage(uint32_t page)
+  {
+    QMutexLocker lock(&pageLock);
+    pendingPages.remove(page);
+  }
+
+  void insertPage(uint32_t page, const bytebuf &contents)
+  {
+    QMutexLocker lock(&pageLock);
+
+    pendingPages.remove(page);
+    pages[page] = contents;
+
+    recentPages.removeOne(page);
+    recentPages.push_front(page);
+
+    while(recentPages.count() > MaxCachedPages)
+      pages.remove(recentPages.takeLast());
+  }
+
+  QMutex pageLock;
+  QMap<uint32_t, bytebuf> pages;
+  QList<uint32_t> recentPages;
+  QSet<uint32_t> pendingPages;
 };
 
 struct BufferElementProperties
@@ -859,12 +954,12 @@ public:
           const ShaderConstant &el = elementForColumn(col);
           const BufferElementProperties &prop = propForColumn(col);
 
-          if(el.type.descriptor.displayAsRGB && prop.buffer < config.buffers.size())
-          {
-            const byte *data = config.buffers[prop.buffer]->data();
-            const byte *end = config.buffers[prop.buffer]->end();
+          const byte *data = NULL, *end = NULL;
+          bytebuf rowStorage;
 
-            data += config.buffers[prop.buffer]->stride * row;
+          if(el.type.descriptor.displayAsRGB && prop.buffer < config.buffers.size() &&
+             rowData(config.buffers[prop.buffer], row, rowStorage, data, end))
+          {
             data += el.byteOffset;
 
             // only slightly wasteful, we need to fetch all variants together
@@ -973,13 +1068,12 @@ public:
 
           if(prop.buffer < config.buffers.size())
           {
-            const byte *data = config.buffers[prop.buffer]->data();
-            const byte *end = config.buffers[prop.buffer]->end();
+            const byte *data = NULL, *end = NULL;
+            bytebuf rowStorage;
 
-            if(!prop.perinstance)
-              data += config.buffers[prop.buffer]->stride * idx;
-            else
-              data += config.buffers[prop.buffer]->stride * instIdx;
+            if(!rowData(config.buffers[prop.buffer], prop.perinstance ? instIdx : idx, rowStorage,
+                        data, end))
+              return lit("...");
 
             data += el.byteOffset;
 
@@ -1121,7 +1215,58 @@ public:
   }
 
   const BufferConfiguration &getConfig() { return config; }
+  // called when a page of a paged buffer has been fetched, to refresh the rows it contains
+  void pageLoaded(BufferData *buf, uint32_t firstRow, uint32_t numRows)
+  {
+    if(!config.buffers.contains(buf) || firstRow >= config.numRows)
+      return;
+
+    uint32_t lastRow = qMin(config.numRows, firstRow + numRows) - 1;
+
+    emit dataChanged(index(firstRow, 0), index(lastRow, columnCount() - 1));
+  }
+
+  // called to fetch a page of a paged buffer, which must call pageLoaded() once it's available
+  std::function<void(BufferData *buf, uint32_t page)> fetchPage;
+
 private:
+  // number of pages either side of a displayed page to fetch, so that scrolling is smooth
+  static const uint32_t PrefetchPages = 2;
+
+  // finds a row's data in a buffer. Paged buffers only have some rows loaded, so the row may be
+  // copied into rowStorage, or if it's not loaded this returns false and requests its page.
+  bool rowData(BufferData *buf, uint32_t row, bytebuf &rowStorage, const byte *&data,
+               const byte *&end) const
+  {
+    if(!buf->paged())
+    {
+      data = buf->data() + buf->stride * row;
+      end = buf->end();
+      return true;
+    }
+
+    if(buf->readRow(row, rowStorage))
+    {
+      data = rowStorage.data();
+      end = rowStorage.end();
+      return true;
+    }
+
+    if(fetchPage)
+    {
+      uint32_t page = buf->pageForRow(row);
+      uint32_t first = page > PrefetchPages ? page - PrefetchPages : 0;
+
+      for(uint32_t p = first; p <= page + PrefetchPages; p++)
+      {
+        if(buf->requestPage(p))
+          fetchPage(buf, p);
+      }
+    }
+
+    return false;
+  }
+
   // constant data over the item model's lifetime
   // The view that this model is for
   RDTableView *view = NULL;
@@ -1305,6 +1450,9 @@ struct CachedElData
   const byte *data = NULL;
   const byte *end = NULL;
 
+  // if the data comes from a paged buffer, data is NULL and rows must be read from here instead
+  BufferData *paged = NULL;
+
   size_t stride;
   int byteSize;
   uint32_t instIdx = 0;
@@ -1360,7 +1508,12 @@ void CacheDataForIteration(QVector<CachedElData> &cache, const rdcarray<ShaderCo
     if(prop.instancerate > 0)
       d.instIdx = inst / prop.instancerate;
 
-    if(prop.buffer < buffers.size())
+    if(prop.buffer < buffers.size() && buffers[prop.buffer]->paged())
+    {
+      d.paged = buffers[prop.buffer];
+      d.stride = d.paged->stride;
+    }
+    else if(prop.buffer < buffers.size())
     {
       d.data = buffers[prop.buffer]->data();
       d.end = buffers[prop.buffer]->end();
@@ -1693,8 +1846,21 @@ static void RT_FetchMeshData(IReplayController *r, ICaptureContext &ctx, Populat
     BufferData *buf = new BufferData;
     if(used)
     {
-      buf->storage = r->GetBufferData(vb.resourceId, vb.byteOffset + offset * vb.byteStride,
-                                      qMax(maxIdx, maxIdx + 1) * vb.byteStride + maxAttrOffset);
+      uint64_t vbOffset = vb.byteOffset + uint64_t(offset) * vb.byteStride;
+      uint64_t vbLength = uint64_t(qMax(maxIdx, maxIdx + 1)) * vb.byteStride + maxAttrOffset;
+
+      // large vertex buffers are paged like raw buffers. The bounding box is calculated by
+      // streaming through them instead
+      if(vb.byteStride > 0 && vbLength > BufferData::PagingThreshold)
+      {
+        buf->pagedResource = vb.resourceId;
+        buf->pagedOffset = vbOffset;
+        buf->pagedLength = vbLength;
+      }
+      else
+      {
+        buf->storage = r->GetBufferData(vb.resourceId, vbOffset, vbLength);
+      }
 
       buf->stride = vb.byteStride;
     }
@@ -1853,6 +2019,9 @@ BufferViewer::BufferViewer(ICaptureContext &ctx, bool meshview, QWidget *parent)
   m_ModelVSOut = new BufferItemModel(ui->vsoutData, false, meshview, this);
   m_ModelGSOut = new BufferItemModel(ui->gsoutData, false, meshview, this);
 
+  // only raw buffers are paged, which are always displayed in the VS In view
+  m_ModelVSIn->fetchPage = [this](BufferData *buf, uint32_t page) { FetchBufferPage(buf, page); };
+
   m_MeshView = meshview;
 
   ui->formatSpecifier->setContext(&m_Ctx);
@@ -2289,6 +2458,59 @@ void BufferViewer::OnCaptureClosed()
     ToolWindowManager::closeToolWindow(this);
 }
 
+void BufferViewer::FetchBufferPage(BufferData *buf, uint32_t page)
+{
+  uint64_t offs = page * buf->pageByteSize();
+  uint64_t length = qMin(buf->pageByteSize(), buf->pagedLength - offs);
+  uint32_t firstRow = page * buf->rowsPerPage();
+  uint32_t numRows = buf->rowsPerPage();
+
+  // keep the buffer alive until the page has been fetched, even if the view is reset meanwhile
+  buf->ref();
+
+  QPointer<BufferViewer> me(this);
+
+  m_Ctx.Replay().AsyncInvoke([this, me, buf, page, offs, length, firstRow,
+                              numRows](IReplayController *r) {
+    // if we hold the only reference, the buffer is no longer displayed so don't bother fetching.
+    // The page is no longer pending either way, so it can be requested again if it's needed.
+    if(me && buf->refcount.load() > 1)
+      buf->insertPage(page, r->GetBufferData(buf->pagedResource, buf->pagedOffset + offs, length));
+    else
+      buf->cancelPage(page);
+
+    buf->deref();
+
+    if(!me)
+      return;
+
+    GUIInvoke::call(this, [this, buf, firstRow, numRows]() {
+      m_ModelVSIn->pageLoaded(buf, firstRow, numRows);
+    });
+  });
+}
+
+bytebuf BufferViewer::FetchPagedRange(BufferData *buf, uint64_t offset, uint64_t length)
+{
+  bytebuf ret;
+
+  m_Ctx.Replay().BlockInvoke([buf, offset, length, &ret](IReplayController *r) {
+    ret = r->GetBufferData(buf->pagedResource, buf->pagedOffset + offset, length);
+  });
+
+  return ret;
+}
+
+void BufferViewer::LoadBufferPage(BufferData *buf, uint32_t page)
+{
+  if(page >= buf->numPages() || buf->hasPage(page))
+    return;
+
+  uint64_t offs = page * buf->pageByteSize();
+  uint64_t length = qMin(buf->pageByteSize(), buf->pagedLength - offs);
+  buf->insertPage(page, FetchPagedRange(buf, offs, length));
+}
+
 void BufferViewer::OnEventChanged(uint32_t eventId)
 {
   PopulateBufferData *bufdata = new PopulateBufferData;
@@ -2422,7 +2644,23 @@ void BufferViewer::OnEventChanged(uint32_t eventId)
         if(len == UINT64_MAX)
           len = 0;
 
-        buf->storage = r->GetBufferData(m_BufferID, m_ByteOffset, len);
+        uint64_t available = 0;
+        if(m_ObjectByteSize != UINT64_MAX && m_ObjectByteSize > m_ByteOffset)
+          available = m_ObjectByteSize - m_ByteOffset;
+        if(len > 0)
+          available = qMin(len, available);
+
+        // large buffers are fetched a page at a time as rows are displayed
+        if(available > BufferData::PagingThreshold)
+        {
+          buf->pagedResource = m_BufferID;
+          buf->pagedOffset = m_ByteOffset;
+          buf->pagedLength = available;
+        }
+        else
+        {
+          buf->storage = r->GetBufferData(m_BufferID, m_ByteOffset, len);
+        }
       }
       else
       {
@@ -2582,6 +2820,51 @@ void BufferViewer::setPersistData(const QVariant &persistData)
   ui->dockarea->restoreState(state);
 }
 
+static void AccumulateBounds(const FloatVector *values, size_t count, FloatVector &minOut,
+                             FloatVector &maxOut)
+{
+#if defined(__x86_64__) || defined(_M_X64)
+  __m128 mn = _mm_set_ps(minOut.w, minOut.z, minOut.y, minOut.x);
+  __m128 mx = _mm_set_ps(maxOut.w, maxOut.z, maxOut.y, maxOut.x);
+  const __m128 zero = _mm_setzero_ps();
+
+  for(size_t i = 0; i < count; i++)
+  {
+    __m128 v = _mm_loadu_ps(&values[i].x);
+
+    // v - v is 0 for finite values and NaN for infinities or NaNs, so this masks off the lanes
+    // that should be skipped and keeps the current bound there instead.
+    __m128 finite = _mm_cmpeq_ps(_mm_sub_ps(v, v), zero);
+
+    mn = _mm_min_ps(mn, _mm_or_ps(_mm_and_ps(finite, v), _mm_andnot_ps(finite, mn)));
+    mx = _mm_max_ps(mx, _mm_or_ps(_mm_and_ps(finite, v), _mm_andnot_ps(finite, mx)));
+  }
+
+  float out[4];
+  _mm_storeu_ps(out, mn);
+  minOut = FloatVector(out[0], out[1], out[2], out[3]);
+  _mm_storeu_ps(out, mx);
+  maxOut = FloatVector(out[0], out[1], out[2], out[3]);
+#else
+  float *minComps = &minOut.x;
+  float *maxComps = &maxOut.x;
+
+  for(size_t i = 0; i < count; i++)
+  {
+    const float *v = &values[i].x;
+
+    for(int comp = 0; comp < 4; comp++)
+    {
+      if(qIsFinite(v[comp]))
+      {
+        minComps[comp] = qMin(minComps[comp], v[comp]);
+        maxComps[comp] = qMax(maxComps[comp], v[comp]);
+      }
+    }
+  }
+#endif
+}
+
 void BufferViewer::calcBoundingData(CalcBoundingBoxData &bbox)
 {
   for(size_t stage = 0; stage < ARRAY_COUNT(bbox.input); stage++)
@@ -2613,65 +2896,134 @@ void BufferViewer::calcBoundingData(CalcBoundingBoxData &bbox)
 
     CacheDataForIteration(cache, s.columns, s.props, s.buffers, bbox.input[0].curInstance);
 
-    // possible optimisation here if this shows up as a hot spot - sort and unique the indices and
-    // iterate in ascending order, to be more cache friendly
+    // gather the rows to visit once up front, then decode and accumulate each column in bulk
+    // rather than going element by element through QVariants
+    QVector<uint32_t> rowIndices;
+    size_t numRows = s.numRows;
 
-    for(uint32_t row = 0; row < s.numRows; row++)
+    if(s.indices && s.indices->hasData())
     {
-      uint32_t idx = row;
+      rowIndices.reserve((int)s.numRows);
 
-      if(s.indices && s.indices->hasData())
+      for(uint32_t row = 0; row < s.numRows; row++)
       {
-        idx = CalcIndex(s.indices, row, s.baseVertex, s.primRestart);
+        uint32_t idx = CalcIndex(s.indices, row, s.baseVertex, s.primRestart);
 
         if(idx == ~0U || (s.primRestart && idx == s.primRestart))
           continue;
+
+        rowIndices.push_back(idx);
       }
 
-      for(int col = 0; col < s.columns.count(); col++)
+      numRows = (size_t)rowIndices.count();
+    }
+
+    QVector<FloatVector> decoded;
+
+    for(int col = 0; col < s.columns.count(); col++)
+    {
+      const CachedElData &d = cache[col];
+
+      if(!d.data || numRows == 0)
+        continue;
+
+      // per-instance data is the same in every row, so only needs decoding once
+      const uint32_t *rows = rowIndices.isEmpty() ? NULL : rowIndices.data();
+      size_t count = numRows;
+
+      if(d.prop->perinstance)
       {
-        const CachedElData &d = cache[col];
-        const ShaderConstant *el = d.el;
-        const BufferElementProperties *prop = d.prop;
+        rows = NULL;
+        count = 1;
+      }
 
-        float *minOut = (float *)&minOutputList[col];
-        float *maxOut = (float *)&maxOutputList[col];
+      decoded.resize((int)count);
 
-        if(d.data)
+      DecodeFloatColumn(d.prop->format, d.el->type.descriptor.rows,
+                        d.el->type.descriptor.matrixByteStride, d.data, d.end, d.stride, rows,
+                        count, decoded.data());
+
+      AccumulateBounds(decoded.data(), count, minOutputList[col], maxOutputList[col]);
+    }
+
+    // paged buffers aren't held in memory, so stream through each one in large blocks and decode
+    // all of its columns for the rows in each block.
+    QVector<BufferData *> pagedBuffers;
+    for(const CachedElData &d : cache)
+    {
+      if(d.paged && !pagedBuffers.contains(d.paged))
+        pagedBuffers.push_back(d.paged);
+    }
+
+    for(BufferData *buf : pagedBuffers)
+    {
+      // visit the rows in ascending order so that each block is only fetched once, the bounds don't
+      // depend on the order.
+      QVector<uint32_t> rows;
+
+      for(const CachedElData &d : cache)
+      {
+        if(d.paged == buf && d.prop->perinstance)
         {
-          const byte *bytes = d.data;
+          rows.push_back(d.instIdx);
+          break;
+        }
+      }
 
-          if(!prop->perinstance)
-            bytes += d.stride * idx;
+      if(rows.isEmpty() && !rowIndices.isEmpty())
+      {
+        rows = rowIndices;
+        std::sort(rows.begin(), rows.end());
+      }
+      else if(rows.isEmpty())
+      {
+        rows.resize((int)numRows);
+        for(int i = 0; i < rows.count(); i++)
+          rows[i] = (uint32_t)i;
+      }
 
-          QVariantList list = GetVariants(prop->format, el->type.descriptor.rows,
-                                          el->type.descriptor.matrixByteStride, bytes, d.end);
+      const uint32_t blockRows =
+          uint32_t(qMax((uint64_t)1, BufferData::StreamBlockSize / buf->rowStride()));
 
-          for(int comp = 0; comp < 4 && comp < list.count(); comp++)
-          {
-            const QVariant &v = list[comp];
+      QVector<uint32_t> blockIndices;
 
-            QMetaType::Type vt = GetVariantMetatype(v);
+      for(int first = 0, last = 0; first < rows.count(); first = last)
+      {
+        uint32_t blockStart = rows[first];
 
-            float fval = 0.0f;
+        for(last = first; last < rows.count() && rows[last] - blockStart < blockRows; last++)
+          ;
 
-            if(vt == QMetaType::Double)
-              fval = (float)v.toDouble();
-            else if(vt == QMetaType::Float)
-              fval = v.toFloat();
-            else if(vt == QMetaType::UInt || vt == QMetaType::UShort || vt == QMetaType::UChar)
-              fval = (float)v.toUInt();
-            else if(vt == QMetaType::Int || vt == QMetaType::Short || vt == QMetaType::SChar)
-              fval = (float)v.toInt();
-            else
-              continue;
+        uint64_t offs = uint64_t(blockStart) * buf->rowStride();
+        if(offs >= buf->pagedLength)
+          break;
 
-            if(qIsFinite(fval))
-            {
-              minOut[comp] = qMin(minOut[comp], fval);
-              maxOut[comp] = qMax(maxOut[comp], fval);
-            }
-          }
+        bytebuf block = FetchPagedRange(
+            buf, offs, qMin(uint64_t(blockRows) * buf->rowStride(), buf->pagedLength - offs));
+
+        if(block.isEmpty())
+          continue;
+
+        blockIndices.resize(last - first);
+        for(int i = first; i < last; i++)
+          blockIndices[i - first] = rows[i] - blockStart;
+
+        decoded.resize(blockIndices.count());
+
+        for(int col = 0; col < s.columns.count(); col++)
+        {
+          const CachedElData &d = cache[col];
+
+          if(d.paged != buf)
+            continue;
+
+          DecodeFloatColumn(d.prop->format, d.el->type.descriptor.rows,
+                            d.el->type.descriptor.matrixByteStride, block.data() + d.el->byteOffset,
+                            block.end(), d.stride, blockIndices.data(), blockIndices.count(),
+                            decoded.data());
+
+          AccumulateBounds(decoded.data(), blockIndices.count(), minOutputList[col],
+                           maxOutputList[col]);
         }
       }
     }
@@ -3678,7 +4030,24 @@ void BufferViewer::exportData(const BufferExport &params)
       {
         // this is the simplest possible case, we just dump the contents of the first buffer, as
         // it's tightly packed
-        f->write((const char *)config.buffers[0]->data(), int(config.buffers[0]->size()));
+        BufferData *buf = config.buffers[0];
+
+        if(buf->paged())
+        {
+          // paged buffers aren't held in memory, so fetch and write them out in large blocks
+          const uint64_t blockSize = BufferData::StreamBlockSize;
+
+          for(uint64_t offs = 0; offs < buf->pagedLength; offs += blockSize)
+          {
+            bytebuf block = FetchPagedRange(buf, offs, qMin(blockSize, buf->pagedLength - offs));
+
+            f->write((const char *)block.data(), int(block.size()));
+          }
+        }
+        else
+        {
+          f->write((const char *)buf->data(), int(buf->size()));
+        }
       }
       else
       {
@@ -3724,6 +4093,20 @@ void BufferViewer::exportData(const BufferExport &params)
                 continue;
               }
             }
+            else if(d.paged)
+            {
+              uint32_t row = prop->perinstance ? d.instIdx : idx;
+
+              LoadBufferPage(d.paged, d.paged->pageForRow(row));
+
+              bytebuf rowStorage;
+              if(d.paged->readRow(row, rowStorage) &&
+                 el->byteOffset + d.byteSize <= rowStorage.size())
+              {
+                f->write((const char *)rowStorage.data() + el->byteOffset, d.byteSize);
+                continue;
+              }
+            }
 
             // if we didn't continue above, something was wrong, so write nulls
             f->write(d.nulls);
@@ -3748,8 +4131,30 @@ void BufferViewer::exportData(const BufferExport &params)
 
       s << "\n";
 
+      const BufferConfiguration &config = model->getConfig();
+
       for(int row = 0; row < model->rowCount(); row++)
       {
+        // paged buffers need each page to be fetched before its rows can be exported. Mesh rows
+        // are looked up through the index buffer, and per-instance data by the current instance
+        uint32_t idx = row;
+        if(config.indices && config.indices->hasData())
+          idx = CalcIndex(config.indices, row, config.baseVertex, config.primRestart);
+
+        for(const BufferElementProperties &prop : config.props)
+        {
+          if(prop.buffer >= config.buffers.size() || !config.buffers[prop.buffer]->paged())
+            continue;
+
+          BufferData *buf = config.buffers[prop.buffer];
+
+          uint32_t bufRow = idx;
+          if(prop.perinstance)
+            bufRow = prop.instancerate > 0 ? config.curInstance / prop.instancerate : 0;
+
+          LoadBufferPage(buf, buf->pageForRow(bufRow));
+        }
+
         for(int col = 0; col < model->columnCount(); col++)
         {
           s << model->data(model->index(row, col), Qt::DisplayRole).toString();
@@ -233,6 +233,10 @@ private:
 
   void ClearModels();
 
+  void FetchBufferPage(BufferData *buf, uint32_t page);
+  void LoadBufferPage(BufferData *buf, uint32_t page);
+  bytebuf FetchPagedRange(BufferData *buf, uint64_t offset, uint64_t length);
+
   void UI_CalculateMeshFormats();
 
   void UpdateCurrentMeshConfig();
@@ -271,11 +271,14 @@ void CaptureDialog::on_CaptureCallstacks_toggled(bool checked)
   if(ui->CaptureCallstacks->isChecked())
   {
     ui->CaptureCallstacksOnlyDraws->setEnabled(true);
+    ui->CaptureCallstacksFastUnwind->setEnabled(true);
   }
   else
   {
     ui->CaptureCallstacksOnlyDraws->setChecked(false);
     ui->CaptureCallstacksOnlyDraws->setEnabled(false);
+    ui->CaptureCallstacksFastUnwind->setChecked(false);
+    ui->CaptureCallstacksFastUnwind->setEnabled(false);
   }
 }
 
@@ -969,6 +972,7 @@ void CaptureDialog::SetSettings(CaptureSettings settings)
   ui->HookIntoChildren->setChecked(settings.options.hookIntoChildren);
   ui->CaptureCallstacks->setChecked(settings.options.captureCallstacks);
   ui->CaptureCallstacksOnlyDraws->setChecked(settings.options.captureCallstacksOnlyDraws);
+  ui->CaptureCallstacksFastUnwind->setChecked(settings.options.captureCallstacksFastUnwind);
   ui->APIValidation->setChecked(settings.options.apiValidation);
   ui->RefAllResources->setChecked(settings.options.refAllResources);
   ui->CaptureAllCmdLists->setChecked(settings.options.captureAllCmdLists);
@@ -1017,6 +1021,7 @@ CaptureSettings CaptureDialog::Settings()
   ret.options.hookIntoChildren = ui->HookIntoChildren->isChecked();
   ret.options.captureCallstacks = ui->CaptureCallstacks->isChecked();
   ret.options.captureCallstacksOnlyDraws = ui->CaptureCallstacksOnlyDraws->isChecked();
+  ret.options.captureCallstacksFastUnwind = ui->CaptureCallstacksFastUnwind->isChecked();
   ret.options.apiValidation = ui->APIValidation->isChecked();
   ret.options.refAllResources = ui->RefAllResources->isChecked();
   ret.options.captureAllCmdLists = ui->CaptureAllCmdLists->isChecked();
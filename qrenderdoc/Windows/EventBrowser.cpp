@@ -34,6 +34,7 @@
 #include <QTimer>
 #include "3rdparty/flowlayout/FlowLayout.h"
 #include "3rdparty/scintilla/include/qt/ScintillaEdit.h"
+#include "Code/EventSearchIndex.h"
 #include "Code/QRDUtils.h"
 #include "Code/Resources.h"
 #include "Widgets/Extended/RDHeaderView.h"
@@ -51,6 +52,10 @@ struct EventItemTag
   bool current = false;
   bool find = false;
   bool bookmark = false;
+  // the drawcalls that this node's children are created from when it's populated, and the index
+  // of the next one to add
+  const rdcarray<DrawcallDescription> *children = NULL;
+  int nextChild = 0;
 };
 
 Q_DECLARE_METATYPE(EventItemTag);
@@ -64,6 +69,9 @@ enum
   COL_COUNT,
 };
 
+// how many child nodes are created at once when populating the tree
+static const int EventBatchSize = 1000;
+
 static bool textEditControl(QWidget *sender)
 {
   if(qobject_cast<QLineEdit *>(sender) || qobject_cast<QTextEdit *>(sender) ||
@@ -114,6 +122,8 @@ EventBrowser::EventBrowser(ICaptureContext &ctx, QWidget *parent)
   ui->events->setItemVerticalMargin(0);
   ui->events->setIgnoreIconSize(true);
 
+  ui->events->setLazyPopulate([this](RDTreeWidgetItem *item) { AddDrawcalls(item); });
+
   // set up default section layout. This will be overridden in restoreState()
   ui->events->header()->resizeSection(COL_EID, 80);
   ui->events->header()->resizeSection(COL_DRAW, 60);
@@ -211,6 +221,10 @@ EventBrowser::EventBrowser(ICaptureContext &ctx, QWidget *parent)
 
 EventBrowser::~EventBrowser()
 {
+  // abandon any timing fetch, so a batch that's still being measured isn't delivered to us
+  m_TimingRequest->ref();
+  m_Ctx.Replay().CancelInvoke(lit("EventBrowserTimes"));
+
   // unregister any shortcuts we registered
   Qt::Key keys[] = {
       Qt::Key_1, Qt::Key_2, Qt::Key_3, Qt::Key_4, Qt::Key_5,
@@ -231,6 +245,8 @@ EventBrowser::~EventBrowser()
   m_Ctx.GetMainWindow()->UnregisterShortcut(QString(), ui->findStrip);
   m_Ctx.GetMainWindow()->UnregisterShortcut(QString(), ui->jumpStrip);
 
+  CancelSearchIndex();
+
   m_Ctx.BuiltinWindowClosed(this);
   m_Ctx.RemoveCaptureViewer(this);
   delete ui;
@@ -251,8 +267,14 @@ void EventBrowser::OnCaptureLoaded()
 
   frame->addChild(framestart);
 
-  QPair<uint32_t, uint32_t> lastEIDDraw = AddDrawcalls(frame, m_Ctx.CurDrawcalls());
-  frame->setTag(QVariant::fromValue(EventItemTag(0, lastEIDDraw.first)));
+  // only create the first batch of top-level nodes now, everything else is populated as it's
+  // expanded or scrolled into view
+  EventItemTag frameTag(0, GetLastEvent(m_Ctx.CurDrawcalls()).first);
+  frameTag.children = &m_Ctx.CurDrawcalls();
+  frame->setTag(QVariant::fromValue(frameTag));
+  frame->setLazyChildren(true);
+
+  AddDrawcalls(frame);
 
   ui->events->addTopLevelItem(frame);
 
@@ -268,14 +290,29 @@ void EventBrowser::OnCaptureLoaded()
   ui->exportDraws->setEnabled(true);
   ui->stepPrev->setEnabled(true);
   ui->stepNext->setEnabled(true);
+
+  BuildSearchIndex();
 }
 
 void EventBrowser::OnCaptureClosed()
 {
+  CancelSearchIndex();
+
   clearBookmarks();
 
   on_HideFindJump();
 
+  m_TimingRequest->ref();
+  m_Ctx.Replay().CancelInvoke(lit("EventBrowserTimes"));
+
+  m_EventNodes.clear();
+  m_FindNodes.clear();
+  m_FindResults.clear();
+
+  m_Times.clear();
+  m_DrawTimes.clear();
+  m_FrameTime = -1.0;
+
   ui->events->clear();
 
   ui->find->setEnabled(false);
@@ -289,6 +326,8 @@ void EventBrowser::OnCaptureClosed()
 
 void EventBrowser::OnEventChanged(uint32_t eventId)
 {
+  m_TimingEvent->storeRelease((int)eventId);
+
   SelectEvent(eventId);
   repopulateBookmarks();
   highlightBookmarks();
@@ -345,12 +384,56 @@ bool EventBrowser::ShouldHide(const DrawcallDescription &drawcall)
   return false;
 }
 
-QPair<uint32_t, uint32_t> EventBrowser::AddDrawcalls(RDTreeWidgetItem *parent,
-                                                     const rdcarray<DrawcallDescription> &draws)
+bool EventBrowser::HasVisibleChildren(const DrawcallDescription &drawcall)
+{
+  for(const DrawcallDescription &child : drawcall.children)
+  {
+    if(!ShouldHide(child))
+      return true;
+  }
+
+  return false;
+}
+
+QPair<uint32_t, uint32_t> EventBrowser::GetLastEvent(const rdcarray<DrawcallDescription> &draws)
+{
+  // the range of a node ends with the range of its last visible child, so only the last drawcall at
+  // each level needs to be looked at rather than the whole subtree
+  for(int32_t i = draws.count() - 1; i >= 0; i--)
+  {
+    const DrawcallDescription &d = draws[i];
+
+    if(ShouldHide(d))
+      continue;
+
+    QPair<uint32_t, uint32_t> last = GetLastEvent(d.children);
+
+    if(last.first == 0)
+    {
+      last = qMakePair(d.eventId, d.drawcallId);
+
+      if((d.flags & DrawFlags::SetMarker) && i + 1 < draws.count())
+        last.first = draws[i + 1].eventId;
+    }
+
+    return last;
+  }
+
+  return qMakePair(0U, 0U);
+}
+
+void EventBrowser::AddDrawcalls(RDTreeWidgetItem *parent)
 {
-  uint lastEID = 0, lastDraw = 0;
+  EventItemTag parentTag = parent->tag().value<EventItemTag>();
+
+  if(!parentTag.children)
+    return;
+
+  const rdcarray<DrawcallDescription> &draws = *parentTag.children;
 
-  for(int32_t i = 0; i < draws.count(); i++)
+  int32_t i = parentTag.nextChild;
+
+  for(int added = 0; i < draws.count() && added < EventBatchSize; i++)
   {
     const DrawcallDescription &d = draws[i];
 
@@ -364,9 +447,8 @@ QPair<uint32_t, uint32_t> EventBrowser::AddDrawcalls(RDTreeWidgetItem *parent,
     RDTreeWidgetItem *child = new RDTreeWidgetItem(
         {name, QString::number(d.eventId), QString::number(d.drawcallId), lit("---")});
 
-    QPair<uint32_t, uint32_t> last = AddDrawcalls(child, d.children);
-    lastEID = last.first;
-    lastDraw = last.second;
+    QPair<uint32_t, uint32_t> last = GetLastEvent(d.children);
+    uint32_t lastEID = last.first, lastDraw = last.second;
 
     if(lastEID > d.eventId)
     {
@@ -383,7 +465,25 @@ QPair<uint32_t, uint32_t> EventBrowser::AddDrawcalls(RDTreeWidgetItem *parent,
         lastEID = draws[i + 1].eventId;
     }
 
-    child->setTag(QVariant::fromValue(EventItemTag(draws[i].eventId, lastEID)));
+    EventItemTag tag(draws[i].eventId, lastEID);
+
+    if(HasVisibleChildren(d))
+    {
+      tag.children = &d.children;
+      child->setLazyChildren(true);
+    }
+
+    // nodes created after a search was run still need to be flagged as results
+    if(m_FindResults.contains(d.eventId))
+    {
+      tag.find = true;
+      m_FindNodes.push_back(child);
+      RefreshIcon(child, tag);
+    }
+
+    child->setTag(QVariant::fromValue(tag));
+
+    m_EventNodes[draws[i].eventId] = child;
 
     if(m_Ctx.Config().EventBrowser_ApplyColors)
     {
@@ -405,59 +505,75 @@ QPair<uint32_t, uint32_t> EventBrowser::AddDrawcalls(RDTreeWidgetItem *parent,
       }
     }
 
+    if(!m_Times.empty())
+      SetDrawcallTime(child);
+
     parent->addChild(child);
+
+    added++;
   }
 
-  return qMakePair(lastEID, lastDraw);
+  // skip past any hidden drawcalls so we don't leave the parent expandable with nothing to add
+  while(i < draws.count() && ShouldHide(draws[i]))
+    i++;
+
+  parentTag.nextChild = i;
+  parent->setTag(QVariant::fromValue(parentTag));
+  parent->setLazyChildren(i < draws.count());
 }
 
-void EventBrowser::SetDrawcallTimes(RDTreeWidgetItem *node, const rdcarray<CounterResult> &results)
+double EventBrowser::CalcDrawcallTimes(const rdcarray<DrawcallDescription> &draws,
+                                       const QHash<uint32_t, double> &results)
 {
-  if(node == NULL)
-    return;
-
   // parent nodes take the value of the sum of their children
   double duration = 0.0;
 
-  // look up leaf nodes in the dictionary
-  if(node->childCount() == 0)
+  for(const DrawcallDescription &d : draws)
   {
-    uint32_t eid = node->tag().value<EventItemTag>().EID;
+    if(ShouldHide(d))
+      continue;
 
-    duration = -1.0;
+    double nd = -1.0;
 
-    for(const CounterResult &r : results)
-    {
-      if(r.eventId == eid)
-        duration = r.value.d;
-    }
+    if(HasVisibleChildren(d))
+      nd = CalcDrawcallTimes(d.children, results);
+    else
+      nd = results.value(d.eventId, -1.0);
 
-    double secs = duration;
+    m_DrawTimes[d.eventId] = nd;
 
-    if(m_TimeUnit == TimeUnit::Milliseconds)
-      secs *= 1000.0;
-    else if(m_TimeUnit == TimeUnit::Microseconds)
-      secs *= 1000000.0;
-    else if(m_TimeUnit == TimeUnit::Nanoseconds)
-      secs *= 1000000000.0;
+    if(nd > 0.0)
+      duration += nd;
+  }
 
-    node->setText(COL_DURATION, duration < 0.0f ? QString() : Formatter::Format(secs));
-    EventItemTag tag = node->tag().value<EventItemTag>();
-    tag.duration = duration;
-    node->setTag(QVariant::fromValue(tag));
+  return duration;
+}
 
-    return;
-  }
+void EventBrowser::CalcDrawcallTimes()
+{
+  QHash<uint32_t, double> results;
+  for(const CounterResult &r : m_Times)
+    results[r.eventId] = r.value.d;
 
-  for(int i = 0; i < node->childCount(); i++)
-  {
-    SetDrawcallTimes(node->child(i), results);
+  m_DrawTimes.clear();
 
-    double nd = node->child(i)->tag().value<EventItemTag>().duration;
+  // the capture start node is event 0, and is included in the frame's total like any other child
+  double start = results.value(0, -1.0);
+  m_DrawTimes[0] = start;
 
-    if(nd > 0.0)
-      duration += nd;
-  }
+  m_FrameTime = CalcDrawcallTimes(m_Ctx.CurDrawcalls(), results) + qMax(start, 0.0);
+}
+
+void EventBrowser::SetDrawcallTime(RDTreeWidgetItem *node)
+{
+  EventItemTag tag = node->tag().value<EventItemTag>();
+
+  double duration = -1.0;
+
+  if(node == ui->events->topLevelItem(0))
+    duration = m_FrameTime;
+  else
+    duration = m_DrawTimes.value(tag.EID, -1.0);
 
   double secs = duration;
 
@@ -469,11 +585,22 @@ void EventBrowser::SetDrawcallTimes(RDTreeWidgetItem *node, const rdcarray<Count
     secs *= 1000000000.0;
 
   node->setText(COL_DURATION, duration < 0.0f ? QString() : Formatter::Format(secs));
-  EventItemTag tag = node->tag().value<EventItemTag>();
   tag.duration = duration;
   node->setTag(QVariant::fromValue(tag));
 }
 
+void EventBrowser::SetDrawcallTimes(RDTreeWidgetItem *node)
+{
+  if(node == NULL)
+    return;
+
+  // only nodes that have been created need updating, any others pick up their time when populated
+  SetDrawcallTime(node);
+
+  for(int i = 0; i < node->childCount(); i++)
+    SetDrawcallTimes(node->child(i));
+}
+
 void EventBrowser::on_find_clicked()
 {
   ui->jumpStrip->hide();
@@ -502,17 +629,45 @@ void EventBrowser::on_timeDraws_clicked()
 
   ui->events->header()->showSection(COL_DURATION);
 
-  m_Ctx.Replay().AsyncInvoke([this](IReplayController *r) {
+  // any fetch still running is abandoned, its remaining batches are skipped or ignored
+  QSharedPointer<QAtomicInt> request = m_TimingRequest;
+  int timing = request->fetchAndAddOrdered(1) + 1;
 
-    m_Times = r->FetchCounters({GPUCounter::EventGPUDuration});
+  m_Times.clear();
 
-    GUIInvoke::call(this, [this]() {
-      if(ui->events->topLevelItemCount() == 0)
-        return;
+  QPointer<EventBrowser> me(this);
+  QSharedPointer<QAtomicInt> eventId = m_TimingEvent;
+  eventId->storeRelease((int)m_Ctx.CurEvent());
+  IReplayManager *replay = &m_Ctx.Replay();
 
-      SetDrawcallTimes(ui->events->topLevelItem(0), m_Times);
-      ui->events->update();
-    });
+  replay->CancelInvoke(lit("EventBrowserTimes"));
+  replay->BackgroundInvoke(lit("EventBrowserTimes"), [this, me, request, timing, eventId,
+                                                      replay](IReplayController *r) {
+    auto batchCallback = [this, me, request, timing, eventId,
+                          replay](const rdcarray<CounterResult> &batch) {
+      if(!me || request->loadAcquire() != timing)
+        return false;
+
+      // fill in the times progressively as each batch of events is measured
+      GUIInvoke::call(this, [this, request, timing, batch]() {
+        if(request->loadAcquire() != timing || ui->events->topLevelItemCount() == 0)
+          return;
+
+        m_Times.append(batch);
+
+        CalcDrawcallTimes();
+        SetDrawcallTimes(ui->events->topLevelItem(0));
+        ui->events->update();
+      });
+
+      // let any interactive work that's waiting run before the next batch. Measuring moves the
+      // replay away from the current event, so return to it first if anything does run
+      return replay->PreemptionPoint([eventId](IReplayController *r) {
+        r->SetFrameEvent((uint32_t)eventId->loadAcquire(), true);
+      });
+    };
+
+    r->FetchCountersStreamed({GPUCounter::EventGPUDuration}, batchCallback);
   });
 }
 
@@ -1011,7 +1166,7 @@ void EventBrowser::events_contextMenu(const QPoint &pos)
   collapseAll.setIcon(Icons::arrow_in());
   selectCols.setIcon(Icons::timeline_marker());
 
-  expandAll.setEnabled(item && item->childCount() > 0);
+  expandAll.setEnabled(item && (item->childCount() > 0 || item->hasLazyChildren()));
   collapseAll.setEnabled(item && item->childCount() > 0);
 
   QObject::connect(&expandAll, &QAction::triggered,
@@ -1174,30 +1329,64 @@ void EventBrowser::RefreshIcon(RDTreeWidgetItem *item, EventItemTag tag)
 
 bool EventBrowser::FindEventNode(RDTreeWidgetItem *&found, RDTreeWidgetItem *parent, uint32_t eventId)
 {
-  // do a reverse search to find the last match (in case of 'set' markers that
-  // inherit the event of the next real draw).
-  for(int i = parent->childCount() - 1; i >= 0; i--)
+  if(parent == NULL)
+    return false;
+
+  // siblings are in ascending order, so the closest match at this level is the first child whose
+  // range ends at or after the event. Only that node's children need to be searched, so only the
+  // path down to the event is populated.
+  int i = 0;
+  for(;; i++)
   {
-    RDTreeWidgetItem *n = parent->child(i);
+    while(i >= parent->childCount() && parent->hasLazyChildren())
+      ui->events->populateLazyItem(parent);
 
-    uint nEID = n->tag().value<EventItemTag>().lastEID;
-    uint fEID = found ? found->tag().value<EventItemTag>().lastEID : 0;
+    if(i >= parent->childCount())
+      return false;
 
-    if(nEID >= eventId && (found == NULL || nEID <= fEID))
-      found = n;
+    if(parent->child(i)->tag().value<EventItemTag>().lastEID >= eventId)
+      break;
+  }
 
-    if(nEID == eventId && n->childCount() == 0)
-      return true;
+  uint nEID = parent->child(i)->tag().value<EventItemTag>().lastEID;
 
-    if(n->childCount() > 0)
-    {
-      bool exact = FindEventNode(found, n, eventId);
-      if(exact)
-        return true;
-    }
+  // take the last of any siblings ending at the same event (in case of 'set' markers that inherit
+  // the event of the next real draw).
+  for(;;)
+  {
+    if(i + 1 >= parent->childCount() && parent->hasLazyChildren())
+      ui->events->populateLazyItem(parent);
+
+    if(i + 1 < parent->childCount() &&
+       parent->child(i + 1)->tag().value<EventItemTag>().lastEID == nEID)
+      i++;
+    else
+      break;
   }
 
-  return false;
+  RDTreeWidgetItem *n = parent->child(i);
+
+  found = n;
+
+  if(n->childCount() == 0 && !n->hasLazyChildren())
+    return nEID == eventId;
+
+  return FindEventNode(found, n, eventId);
+}
+
+RDTreeWidgetItem *EventBrowser::GetEventNode(uint32_t eventId)
+{
+  RDTreeWidgetItem *n = m_EventNodes.value(eventId);
+
+  if(n)
+    return n;
+
+  // searching for the event populates the path down to it, which will create the node if it's
+  // visible at all
+  RDTreeWidgetItem *found = NULL;
+  FindEventNode(found, ui->events->topLevelItem(0), eventId);
+
+  return m_EventNodes.value(eventId);
 }
 
 void EventBrowser::ExpandNode(RDTreeWidgetItem *node)
@@ -1232,124 +1421,184 @@ bool EventBrowser::SelectEvent(uint32_t eventId)
   return false;
 }
 
-void EventBrowser::ClearFindIcons(RDTreeWidgetItem *parent)
+void EventBrowser::ClearFindIcons()
 {
-  for(int i = 0; i < parent->childCount(); i++)
+  for(RDTreeWidgetItem *n : m_FindNodes)
   {
-    RDTreeWidgetItem *n = parent->child(i);
-
     EventItemTag tag = n->tag().value<EventItemTag>();
     tag.find = false;
     n->setTag(QVariant::fromValue(tag));
     RefreshIcon(n, tag);
-
-    if(n->childCount() > 0)
-      ClearFindIcons(n);
   }
-}
 
-void EventBrowser::ClearFindIcons()
-{
-  if(m_Ctx.IsCaptureLoaded() && ui->events->topLevelItemCount() > 0)
-    ClearFindIcons(ui->events->topLevelItem(0));
+  m_FindNodes.clear();
+  m_FindResults.clear();
 }
 
-int EventBrowser::SetFindIcons(RDTreeWidgetItem *parent, QString filter)
+int EventBrowser::SetFindIcons(QString filter)
 {
+  if(filter.isEmpty() || !m_Ctx.IsCaptureLoaded())
+    return 0;
+
   int results = 0;
 
-  for(int i = 0; i < parent->childCount(); i++)
+  for(uint32_t eid : FindMatches(filter))
   {
-    RDTreeWidgetItem *n = parent->child(i);
+    // hidden drawcalls are in the index but not the tree
+    const DrawcallDescription *draw = m_Ctx.GetDrawcall(eid);
+    if(draw && ShouldHide(*draw))
+      continue;
 
-    if(n->text(COL_NAME).contains(filter, Qt::CaseInsensitive))
-    {
-      EventItemTag tag = n->tag().value<EventItemTag>();
-      tag.find = true;
-      n->setTag(QVariant::fromValue(tag));
-      RefreshIcon(n, tag);
-      results++;
-    }
+    results++;
 
-    if(n->childCount() > 0)
-    {
-      results += SetFindIcons(n, filter);
-    }
+    // nodes that haven't been created yet are flagged when they're populated
+    m_FindResults.insert(eid);
+
+    RDTreeWidgetItem *n = m_EventNodes.value(eid);
+
+    if(!n)
+      continue;
+
+    EventItemTag tag = n->tag().value<EventItemTag>();
+    tag.find = true;
+    n->setTag(QVariant::fromValue(tag));
+    RefreshIcon(n, tag);
+    m_FindNodes.push_back(n);
   }
 
   return results;
 }
 
-int EventBrowser::SetFindIcons(QString filter)
+int EventBrowser::FindEvent(QString filter, uint32_t after, bool forward)
 {
-  if(filter.isEmpty() || !m_Ctx.IsCaptureLoaded())
+  if(!m_Ctx.IsCaptureLoaded())
     return 0;
 
-  return SetFindIcons(ui->events->topLevelItem(0), filter);
-}
+  rdcarray<uint32_t> results = FindMatches(filter);
 
-RDTreeWidgetItem *EventBrowser::FindNode(RDTreeWidgetItem *parent, QString filter, uint32_t after)
-{
-  for(int i = 0; i < parent->childCount(); i++)
+  // results are in eventId order, which matches the tree order since parents come before their
+  // children. A node's range starts at its eventId so going forward the first result after the
+  // current event is the match. Going backward the range end has to be checked, which needs the
+  // node - but only nodes up to the match get populated.
+  for(int i = forward ? 0 : results.count() - 1; i >= 0 && i < results.count();
+      i += forward ? 1 : -1)
   {
-    RDTreeWidgetItem *n = parent->child(i);
+    if(results[i] <= after && forward)
+      continue;
 
-    uint eid = n->tag().value<EventItemTag>().lastEID;
+    if(results[i] >= after && !forward)
+      continue;
 
-    if(eid > after && n->text(COL_NAME).contains(filter, Qt::CaseInsensitive))
-      return n;
+    RDTreeWidgetItem *n = GetEventNode(results[i]);
 
-    if(n->childCount() > 0)
-    {
-      RDTreeWidgetItem *found = FindNode(n, filter, after);
+    if(!n)
+      continue;
 
-      if(found != NULL)
-        return found;
-    }
+    uint eid = n->tag().value<EventItemTag>().lastEID;
+
+    if((forward && eid > after) || (!forward && eid < after))
+      return (int)eid;
   }
 
-  return NULL;
+  return -1;
 }
 
-int EventBrowser::FindEvent(RDTreeWidgetItem *parent, QString filter, uint32_t after, bool forward)
+rdcarray<uint32_t> EventBrowser::FindMatches(const QString &filter)
 {
-  if(parent == NULL)
-    return -1;
+  const EventSearchIndex *index = ReadySearchIndex();
 
-  for(int i = forward ? 0 : parent->childCount() - 1; i >= 0 && i < parent->childCount();
-      i += forward ? 1 : -1)
+  if(index)
+    return index->Find(filter, false);
+
+  // until the index is built, check each drawcall against the same text the index would hold so
+  // results don't change once it's ready
+  rdcarray<uint32_t> ret;
+  FindMatches(m_Ctx.CurDrawcalls(), filter, ret);
+  return ret;
+}
+
+void EventBrowser::FindMatches(const rdcarray<DrawcallDescription> &draws, const QString &filter,
+                               rdcarray<uint32_t> &results)
+{
+  for(const DrawcallDescription &d : draws)
   {
-    auto n = parent->child(i);
+    if(EventSearchIndex::Matches(d, m_Ctx.GetStructuredFile(), m_SearchResourceNames, filter))
+      results.push_back(d.eventId);
 
-    uint eid = n->tag().value<EventItemTag>().lastEID;
+    FindMatches(d.children, filter, results);
+  }
+}
 
-    bool matchesAfter = (forward && eid > after) || (!forward && eid < after);
+rdcarray<uint32_t> EventBrowser::FindEvents(const rdcstr &filter, bool regex)
+{
+  if(!m_Ctx.IsCaptureLoaded() || !m_SearchIndex)
+    return {};
 
-    if(matchesAfter)
-    {
-      QString name = n->text(COL_NAME);
-      if(name.contains(filter, Qt::CaseInsensitive))
-        return (int)eid;
-    }
+  // regex searches need the index, so block until it's finished rather than checking each
+  // drawcall in turn
+  if(m_SearchIndexThread)
+    m_SearchIndexThread->wait();
 
-    if(n->childCount() > 0)
-    {
-      int found = FindEvent(n, filter, after, forward);
+  return m_SearchIndex->Find(filter, regex);
+}
 
-      if(found > 0)
-        return found;
-    }
-  }
+void EventBrowser::BuildSearchIndex()
+{
+  CancelSearchIndex();
 
-  return -1;
+  // resource names come from the context which can only be used here, so snapshot them first.
+  // The snapshot is kept for searching before the index is ready
+  m_SearchResourceNames.clear();
+  for(const ResourceDescription &res : m_Ctx.GetResources())
+    m_SearchResourceNames[res.resourceId] = m_Ctx.GetResourceName(res.resourceId);
+
+  QMap<ResourceId, QString> resourceNames = m_SearchResourceNames;
+
+  const rdcarray<DrawcallDescription> *draws = &m_Ctx.CurDrawcalls();
+  const SDFile *file = &m_Ctx.GetStructuredFile();
+
+  QSharedPointer<EventSearchIndex> index(new EventSearchIndex());
+
+  m_SearchIndex = index;
+  m_SearchIndexReady = false;
+  m_SearchIndexCancel = 0;
+
+  m_SearchIndexThread = new LambdaThread([this, index, draws, file, resourceNames]() {
+    index->Build(*draws, *file, resourceNames, m_SearchIndexCancel);
+
+    GUIInvoke::call(this, [this, index]() {
+      // ignore this if the capture was closed or reloaded in the meantime
+      if(index != m_SearchIndex)
+        return;
+
+      m_SearchIndexReady = true;
+
+      // refresh any highlights that were found with the slower per-drawcall search
+      if(!ui->findEvent->text().isEmpty() && ui->findStrip->isVisible())
+        findHighlight_timeout();
+    });
+  });
+  m_SearchIndexThread->start(QThread::LowPriority);
 }
 
-int EventBrowser::FindEvent(QString filter, uint32_t after, bool forward)
+void EventBrowser::CancelSearchIndex()
 {
-  if(!m_Ctx.IsCaptureLoaded())
-    return 0;
+  if(m_SearchIndexThread)
+  {
+    m_SearchIndexCancel = 1;
+    m_SearchIndexThread->wait();
+    m_SearchIndexThread->deleteLater();
+    m_SearchIndexThread = NULL;
+  }
 
-  return FindEvent(ui->events->topLevelItem(0), filter, after, forward);
+  m_SearchIndex.reset();
+  m_SearchIndexReady = false;
+  m_SearchResourceNames.clear();
+}
+
+const EventSearchIndex *EventBrowser::ReadySearchIndex() const
+{
+  return m_SearchIndexReady ? m_SearchIndex.data() : NULL;
 }
 
 void EventBrowser::Find(bool forward)
@@ -1394,5 +1643,5 @@ void EventBrowser::UpdateDurationColumn()
   ui->events->setHeaderText(COL_DURATION, tr("Duration (%1)").arg(UnitSuffix(m_TimeUnit)));
 
   if(!m_Times.empty())
-    SetDrawcallTimes(ui->events->topLevelItem(0), m_Times);
+    SetDrawcallTimes(ui->events->topLevelItem(0));
 }
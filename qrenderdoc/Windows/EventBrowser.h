@@ -24,8 +24,13 @@
 
 #pragma once
 
+#include <QAtomicInt>
 #include <QFrame>
+#include <QHash>
 #include <QIcon>
+#include <QMap>
+#include <QSet>
+#include <QSharedPointer>
 #include "Code/Interface/QRDInterface.h"
 
 namespace Ui
@@ -39,6 +44,8 @@ class RDTreeWidgetItem;
 class QTimer;
 class QTextStream;
 class FlowLayout;
+class LambdaThread;
+class EventSearchIndex;
 struct EventItemTag;
 
 class EventBrowser : public QFrame, public IEventBrowser, public ICaptureViewer
@@ -55,6 +62,7 @@ public:
   // IEventBrowser
   QWidget *Widget() override { return this; }
   void UpdateDurationColumn() override;
+  rdcarray<uint32_t> FindEvents(const rdcstr &filter, bool regex) override;
   // ICaptureViewer
   void OnCaptureLoaded() override;
   void OnCaptureClosed() override;
@@ -96,30 +104,39 @@ public slots:
 
 private:
   bool ShouldHide(const DrawcallDescription &drawcall);
-  QPair<uint32_t, uint32_t> AddDrawcalls(RDTreeWidgetItem *parent,
-                                         const rdcarray<DrawcallDescription> &draws);
-  void SetDrawcallTimes(RDTreeWidgetItem *node, const rdcarray<CounterResult> &results);
+  bool HasVisibleChildren(const DrawcallDescription &drawcall);
+  QPair<uint32_t, uint32_t> GetLastEvent(const rdcarray<DrawcallDescription> &draws);
+  void AddDrawcalls(RDTreeWidgetItem *parent);
+  double CalcDrawcallTimes(const rdcarray<DrawcallDescription> &draws,
+                           const QHash<uint32_t, double> &results);
+  void CalcDrawcallTimes();
+  void SetDrawcallTime(RDTreeWidgetItem *node);
+  void SetDrawcallTimes(RDTreeWidgetItem *node);
 
   void ExpandNode(RDTreeWidgetItem *node);
 
   bool FindEventNode(RDTreeWidgetItem *&found, RDTreeWidgetItem *parent, uint32_t eventId);
+  RDTreeWidgetItem *GetEventNode(uint32_t eventId);
   bool SelectEvent(uint32_t eventId);
 
-  void ClearFindIcons(RDTreeWidgetItem *parent);
   void ClearFindIcons();
 
-  int SetFindIcons(RDTreeWidgetItem *parent, QString filter);
   int SetFindIcons(QString filter);
 
   void repopulateBookmarks();
   void highlightBookmarks();
   bool hasBookmark(RDTreeWidgetItem *node);
 
-  RDTreeWidgetItem *FindNode(RDTreeWidgetItem *parent, QString filter, uint32_t after);
-  int FindEvent(RDTreeWidgetItem *parent, QString filter, uint32_t after, bool forward);
+  rdcarray<uint32_t> FindMatches(const QString &filter);
+  void FindMatches(const rdcarray<DrawcallDescription> &draws, const QString &filter,
+                   rdcarray<uint32_t> &results);
   int FindEvent(QString filter, uint32_t after, bool forward);
   void Find(bool forward);
 
+  void BuildSearchIndex();
+  void CancelSearchIndex();
+  const EventSearchIndex *ReadySearchIndex() const;
+
   QString GetExportDrawcallString(int indent, bool firstchild, const DrawcallDescription &drawcall);
   double GetDrawTime(const DrawcallDescription &drawcall);
   void GetMaxNameLength(int &maxNameLength, int indent, bool firstchild,
@@ -132,9 +149,33 @@ private:
   TimeUnit m_TimeUnit = TimeUnit::Count;
 
   rdcarray<CounterResult> m_Times;
+  // incremented for each timing fetch so batches from an abandoned fetch can be dropped. It's
+  // shared with the fetch on the replay thread, which can outlive this window
+  QSharedPointer<QAtomicInt> m_TimingRequest = QSharedPointer<QAtomicInt>(new QAtomicInt(0));
+  // the current event, mirrored for the timing fetch to return the replay to in between batches
+  QSharedPointer<QAtomicInt> m_TimingEvent = QSharedPointer<QAtomicInt>(new QAtomicInt(0));
+  // durations calculated from m_Times for each drawcall by eventId, and for the whole frame
+  QHash<uint32_t, double> m_DrawTimes;
+  double m_FrameTime = -1.0;
 
   QTimer *m_FindHighlight;
 
+  // drawcall nodes in the tree by their eventId, and the nodes currently flagged as find results.
+  // Nodes are created lazily, so m_FindResults holds the eventIds of all results including any
+  // that don't have a node yet
+  QHash<uint32_t, RDTreeWidgetItem *> m_EventNodes;
+  QList<RDTreeWidgetItem *> m_FindNodes;
+  QSet<uint32_t> m_FindResults;
+
+  // search index over the capture's events. It's built on a background thread after the capture
+  // is loaded, and until it's ready searches check each drawcall directly against the same text,
+  // using the resource names snapshotted for the build.
+  QSharedPointer<EventSearchIndex> m_SearchIndex;
+  LambdaThread *m_SearchIndexThread = NULL;
+  QAtomicInt m_SearchIndexCancel;
+  bool m_SearchIndexReady = false;
+  QMap<ResourceId, QString> m_SearchResourceNames;
+
   FlowLayout *m_BookmarkStripLayout;
   QSpacerItem *m_BookmarkSpacer;
   QMap<uint32_t, QToolButton *> m_BookmarkButtons;
@@ -3817,10 +3817,11 @@ void TextureViewer::on_pixelHistory_clicked()
   QPointer<QWidget> histWidget = hist->Widget();
 
   // add a short delay so that controls repainting after a new panel appears can get at the
-  // render thread before we insert the long blocking pixel history task
+  // render thread before we insert the long blocking pixel history task. Any requests made while
+  // it's waiting will still go first since it runs at background priority
   LambdaThread *thread = new LambdaThread([this, texptr, x, y, hist, histWidget]() {
     QThread::msleep(150);
-    m_Ctx.Replay().AsyncInvoke([this, texptr, x, y, hist, histWidget](IReplayController *r) {
+    auto fetchHistory = [this, texptr, x, y, hist, histWidget](IReplayController *r) {
       rdcarray<PixelModification> history =
           r->PixelHistory(texptr->resourceId, (uint32_t)x, (int32_t)y, m_TexDisplay.subresource,
                           m_TexDisplay.typeCast);
@@ -3829,7 +3830,9 @@ void TextureViewer::on_pixelHistory_clicked()
         if(histWidget)
           hist->SetHistory(history);
       });
-    });
+    };
+
+    m_Ctx.Replay().BackgroundInvoke(rdcstr(), fetchHistory);
   });
   thread->selfDelete(true);
   thread->start();
@@ -171,6 +171,7 @@ SOURCES += Code/qrenderdoc.cpp \
     Code/BufferFormatter.cpp \
     Code/Resources.cpp \
     Code/RGPInterop.cpp \
+    Code/EventSearchIndex.cpp \
     Code/pyrenderdoc/PythonContext.cpp \
     Code/Interface/QRDInterface.cpp \
     Code/Interface/Analytics.cpp \
@@ -247,6 +248,7 @@ HEADERS += Code/CaptureContext.h \
     Code/QRDUtils.h \
     Code/Resources.h \
     Code/RGPInterop.h \
+    Code/EventSearchIndex.h \
     Code/pyrenderdoc/PythonContext.h \
     Code/pyrenderdoc/pyconversion.h \
     Code/pyrenderdoc/interface_check.h \
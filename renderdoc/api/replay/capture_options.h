@@ -127,6 +127,20 @@ Default - disabled
 )");
   bool captureCallstacksOnlyDraws;
 
+  DOCUMENT(R"(When capturing CPU callstacks, use a faster cached unwinder instead of the platform's
+default stack walk. This reduces the overhead of capturing callstacks for every event, but on
+frames without standard unwind information the callstack may be truncated.
+This option does nothing if :data:`captureCallstacks` is not enabled, or on platforms which don't
+support the faster unwinder.
+
+Default - disabled
+
+``True`` - Callstacks are collected with the fast cached unwinder where supported.
+
+``False`` - Callstacks are collected with the platform's default stack walk.
+)");
+  bool captureCallstacksFastUnwind;
+
   DOCUMENT(R"(Specify a delay in seconds to wait for a debugger to attach, after
 creating or injecting into a process, before continuing to allow it to run.
 
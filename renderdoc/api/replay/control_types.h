@@ -784,6 +784,20 @@ The default is :data:`ReplayOptimisationLevel.Balanced`.
 )");
   ReplayOptimisationLevel optimisation = ReplayOptimisationLevel::Balanced;
 
+  DOCUMENT(R"(The amount of GPU memory in megabytes that may be spent on replay checkpoints.
+
+Checkpoints snapshot the resources modified by the frame at a few points during replay, so that
+selecting an event later in the frame can resume from the nearest checkpoint instead of replaying
+everything from the start of the frame.
+
+When set to 0, no checkpoints are created and every replay begins at the start of the frame.
+
+The default is 0.
+
+.. note:: Checkpoints are currently only implemented on Vulkan, other APIs ignore this option.
+)");
+  uint32_t checkpointMemoryBudgetMB = 0;
+
 // helpers for Qt, define constructor and cast. These will be defined in Qt code
 #if defined(RENDERDOC_QT_COMPAT)
   ReplayOptions(const QVariant &var);
@@ -919,9 +933,54 @@ went wrong.
 
 DECLARE_REFLECTION_STRUCT(ExecuteResult);
 
+DOCUMENT("The result of running one job from :func:`RunCaptureJobs` against a capture.");
+struct CaptureJobResult
+{
+  DOCUMENT("");
+  CaptureJobResult() = default;
+  CaptureJobResult(const CaptureJobResult &) = default;
+  CaptureJobResult &operator=(const CaptureJobResult &) = default;
+
+  bool operator==(const CaptureJobResult &o) const
+  {
+    return capture == o.capture && launched == o.launched && exitCode == o.exitCode &&
+           output == o.output && errors == o.errors;
+  }
+  bool operator<(const CaptureJobResult &o) const
+  {
+    if(!(capture == o.capture))
+      return capture < o.capture;
+    if(!(launched == o.launched))
+      return launched < o.launched;
+    if(!(exitCode == o.exitCode))
+      return exitCode < o.exitCode;
+    if(!(output == o.output))
+      return output < o.output;
+    if(!(errors == o.errors))
+      return errors < o.errors;
+    return false;
+  }
+
+  DOCUMENT("The path of the capture this job was run against.");
+  rdcstr capture;
+  DOCUMENT("``True`` if the worker process was launched successfully.");
+  bool launched = false;
+  DOCUMENT(R"(The exit code of the worker process, or ``-1`` if it couldn't be launched or didn't
+exit normally.
+)");
+  int32_t exitCode = -1;
+  DOCUMENT("Everything the worker process wrote to stdout.");
+  rdcstr output;
+  DOCUMENT("Everything the worker process wrote to stderr.");
+  rdcstr errors;
+};
+
+DECLARE_REFLECTION_STRUCT(CaptureJobResult);
+
 // there's not a good way to document a callback, so for lack of a better place we declare these
 // here and document them in the main IReplayController. They can be linked to from anywhere by
 // name.
 typedef std::function<bool()> RENDERDOC_KillCallback;
 typedef std::function<void(float)> RENDERDOC_ProgressCallback;
+typedef std::function<bool(const rdcarray<CounterResult> &)> RENDERDOC_CounterBatchCallback;
 typedef std::function<WindowingData(bool, const rdcarray<WindowingSystem> &)> RENDERDOC_PreviewWindowCallback;
@@ -1159,6 +1159,96 @@ struct FrameStatistics
 
 DECLARE_REFLECTION_STRUCT(FrameStatistics);
 
+DOCUMENT("Timing and size statistics for one type of chunk, gathered while loading a capture.");
+struct ChunkLoadStatistics
+{
+  DOCUMENT("");
+  ChunkLoadStatistics() = default;
+  ChunkLoadStatistics(const ChunkLoadStatistics &) = default;
+  ChunkLoadStatistics &operator=(const ChunkLoadStatistics &) = default;
+
+  bool operator==(const ChunkLoadStatistics &o) const
+  {
+    return chunkID == o.chunkID && name == o.name && count == o.count && byteSize == o.byteSize &&
+           durationMS == o.durationMS;
+  }
+  bool operator<(const ChunkLoadStatistics &o) const
+  {
+    if(!(chunkID == o.chunkID))
+      return chunkID < o.chunkID;
+    if(!(name == o.name))
+      return name < o.name;
+    if(!(count == o.count))
+      return count < o.count;
+    if(!(byteSize == o.byteSize))
+      return byteSize < o.byteSize;
+    if(!(durationMS == o.durationMS))
+      return durationMS < o.durationMS;
+    return false;
+  }
+
+  DOCUMENT("The name of this type of chunk.");
+  rdcstr name;
+
+  DOCUMENT("The API-specific ID of this type of chunk.");
+  uint32_t chunkID = 0;
+
+  DOCUMENT("How many chunks of this type were read.");
+  uint32_t count = 0;
+
+  DOCUMENT("The total uncompressed size in bytes of all chunks of this type.");
+  uint64_t byteSize = 0;
+
+  DOCUMENT(R"(The total time in milliseconds spent reading and processing chunks of this type.
+
+This includes decompressing their data as well as creating any resources or parsing any shaders
+they contain. The chunk that begins the frame also includes the time for the initial read through
+the frame's commands.
+)");
+  double durationMS = 0.0;
+};
+
+DECLARE_REFLECTION_STRUCT(ChunkLoadStatistics);
+
+DOCUMENT("Timing and memory statistics for one phase of loading a capture for replay.");
+struct LoadPhaseStatistics
+{
+  DOCUMENT("");
+  LoadPhaseStatistics() = default;
+  LoadPhaseStatistics(const LoadPhaseStatistics &) = default;
+  LoadPhaseStatistics &operator=(const LoadPhaseStatistics &) = default;
+
+  bool operator==(const LoadPhaseStatistics &o) const
+  {
+    return name == o.name && durationMS == o.durationMS && memoryUsage == o.memoryUsage;
+  }
+  bool operator<(const LoadPhaseStatistics &o) const
+  {
+    if(!(name == o.name))
+      return name < o.name;
+    if(!(durationMS == o.durationMS))
+      return durationMS < o.durationMS;
+    if(!(memoryUsage == o.memoryUsage))
+      return memoryUsage < o.memoryUsage;
+    return false;
+  }
+
+  DOCUMENT("A short human-readable name of this phase.");
+  rdcstr name;
+
+  DOCUMENT("The time in milliseconds this phase took.");
+  double durationMS = 0.0;
+
+  DOCUMENT(R"(The memory in bytes used by the replaying process at the end of this phase, or 0 if it
+couldn't be determined.
+
+.. note:: When replaying remotely this is the memory used by the local process, not the remote one.
+)");
+  uint64_t memoryUsage = 0;
+};
+
+DECLARE_REFLECTION_STRUCT(LoadPhaseStatistics);
+
 DOCUMENT(R"(Contains frame-level global information
 
 .. data:: NoFrameNumber
@@ -1218,6 +1308,11 @@ this counts the frame number when the capture was made.
   DOCUMENT("A list of debug messages that are not associated with any particular event.");
   rdcarray<DebugMessage> debugMessages;
 
+  DOCUMENT(R"(Statistics for each type of chunk that was read while loading the capture, as a list
+of :class:`ChunkLoadStatistics` sorted by chunk ID.
+)");
+  rdcarray<ChunkLoadStatistics> chunkLoadStatistics;
+
   static const uint32_t NoFrameNumber = ~0U;
 };
 
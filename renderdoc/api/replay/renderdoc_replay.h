@@ -379,6 +379,16 @@ well as control the replay and analysis functionality available.
 
   :param float progress: The latest progress amount.
 
+.. function:: CounterBatchCallback()
+
+  Not an actual member function - the signature for any ``CounterBatchCallback`` callbacks.
+
+  Called by :meth:`FetchCountersStreamed` each time a batch of counter results has been measured.
+
+  :param list results: The list of :class:`CounterResult` in this batch.
+  :return: ``True`` to continue fetching, ``False`` to stop without measuring any more batches.
+  :rtype: ``bool``
+
 .. function:: PreviewWindowCallback()
 
   Not an actual member function - the signature for any ``PreviewWindowCallback`` callbacks.
@@ -645,6 +655,16 @@ See :meth:`BuildTargetShader`.
 )");
   virtual FrameDescription GetFrameInfo() = 0;
 
+  DOCUMENT(R"(Retrieve timing and memory statistics for each phase of loading the capture.
+
+Statistics for each type of chunk read while loading are available in
+:data:`FrameDescription.chunkLoadStatistics`.
+
+:return: The statistics for each phase, in the order they happened.
+:rtype: ``list`` of :class:`LoadPhaseStatistics`
+)");
+  virtual rdcarray<LoadPhaseStatistics> GetLoadPhaseStatistics() = 0;
+
   DOCUMENT(R"(Fetch the structured data representation of the capture loaded.
 
 :return: The structured file.
@@ -672,6 +692,27 @@ textures are bound as outputs.
 )");
   virtual rdcarray<CounterResult> FetchCounters(const rdcarray<GPUCounter> &counters) = 0;
 
+  DOCUMENT(R"(Retrieve the values of a specified set of counters, delivering them in batches as they
+are measured.
+
+The frame is measured in consecutive ranges of events, starting with a small range near the start
+of the frame so that the first results are available quickly. Each batch contains the results for
+one range, in event order. Counters that can't be measured over a range are delivered together in a
+final batch.
+
+While the callback runs the replay is left wherever the last batch was measured. If the callback
+makes other calls on the controller in between batches it should call :meth:`SetFrameEvent` with
+``force`` set first. The replay is returned to the current event once the fetch finishes.
+
+:param list counters: The list of :class:`GPUCounter` to fetch results for.
+:param CounterBatchCallback callback: A callback that will be called with each batch of results. If
+  it returns ``False`` no further batches are measured.
+:return: ``True`` if every batch was delivered, ``False`` if the callback stopped the fetch early.
+:rtype: ``bool``
+)");
+  virtual bool FetchCountersStreamed(const rdcarray<GPUCounter> &counters,
+                                     RENDERDOC_CounterBatchCallback callback) = 0;
+
   DOCUMENT(R"(Retrieve a list of which counters are available in the current capture analysis
 implementation.
 
@@ -917,6 +958,22 @@ texture to something compatible with the target file format.
 )");
   virtual bool SaveTexture(const TextureSave &saveData, const char *path) = 0;
 
+  DOCUMENT(R"(Save a list of textures to files on disk, each in the same way as :meth:`SaveTexture`.
+
+This is much faster than calling :meth:`SaveTexture` for each texture in turn when saving many
+textures, as converting and encoding the files is done in parallel and overlapped with fetching the
+next textures' data.
+
+:param list saveData: The configuration settings of which textures to save, and how, as a list of
+  :class:`TextureSave`.
+:param list paths: The paths to save to on disk, one for each entry in ``saveData``.
+:return: A list with ``True`` for each texture that saved successfully, ``False`` otherwise. If
+  the lists are different lengths, nothing is saved.
+:rtype: ``list`` of ``bool``
+)");
+  virtual rdcarray<bool> SaveTextures(const rdcarray<TextureSave> &saveData,
+                                      const rdcarray<rdcstr> &paths) = 0;
+
   DOCUMENT(R"(Retrieve the generated data from one of the geometry processing shader stages.
 
 :param int instance: The index of the instance to retrieve data for, or 0 for non-instanced draws.
@@ -927,6 +984,18 @@ texture to something compatible with the target file format.
 )");
   virtual MeshFormat GetPostVSData(uint32_t instance, uint32_t view, MeshDataStage stage) = 0;
 
+  DOCUMENT(R"(Fetch the generated data from the geometry processing shader stages for a list of
+drawcalls in as few replays as possible.
+
+The data is cached, so that a later :meth:`GetPostVSData` for any of these drawcalls won't need to
+replay the frame again. This is much faster than selecting each drawcall in turn when the data for
+many drawcalls is needed.
+
+:param list eventIds: The EIDs of the drawcalls to fetch data for. Any events that aren't drawcalls
+  are ignored.
+)");
+  virtual void FetchPostVSData(const rdcarray<uint32_t> &eventIds) = 0;
+
   DOCUMENT(R"(Retrieve the contents of a range of a buffer as a ``bytes``.
 
 :param ResourceId buff: The id of the buffer to retrieve data from.
@@ -1405,6 +1474,28 @@ representation back to native RDC.
   virtual ReplayStatus Convert(const char *filename, const char *filetype, const SDFile *file,
                                RENDERDOC_ProgressCallback progress) = 0;
 
+  DOCUMENT(R"(Writes the currently loaded capture to a new native RDC file with the frame capture
+data compressed with zstd.
+
+Each block of the capture is compressed independently, so blocks are compressed in parallel across
+the given number of threads. The resulting file is identical whatever the number of threads.
+
+:param str filename: The filename to save to.
+:param int compressionLevel: The zstd compression level to use, up to 22. Higher levels give smaller
+  files but take longer. If 0 then the default level used when saving captures is used.
+:param int numThreads: The number of threads to compress with. If 0 then all available cores are
+  used.
+:param bool useDictionary: If ``True`` a compression dictionary is built from the frame capture data
+  and stored in the capture, which makes the many small repeated structures in a capture compress
+  better. Captures written with a dictionary can't be opened by older versions of RenderDoc.
+:param ProgressCallback progress: A callback that will be repeatedly called with an updated progress
+  value for the recompression. Can be ``None`` if no progress is desired.
+:return: The status of the operation, whether it succeeded or failed (and how it failed).
+:rtype: ReplayStatus
+)");
+  virtual ReplayStatus Recompress(const char *filename, int compressionLevel, uint32_t numThreads,
+                                  bool useDictionary, RENDERDOC_ProgressCallback progress) = 0;
+
   DOCUMENT(R"(Returns the human-readable error string for the last error received.
 
 The error string is not reset by calling this function so it's safe to call multiple times. However
@@ -1676,6 +1767,24 @@ can only be shut-down, it is not re-usable.
 )");
 extern "C" RENDERDOC_API ICaptureFile *RENDERDOC_CC RENDERDOC_OpenCaptureFile();
 
+DOCUMENT(R"(Extract the embedded thumbnails from every capture in a directory.
+
+Only the header of each capture is read, and the captures are processed concurrently, so this is
+much faster than opening each capture with :func:`OpenCaptureFile` and calling
+:meth:`CaptureFile.GetThumbnail` when indexing a large number of captures.
+
+:param str path: The directory to search for ``.rdc`` captures. Subdirectories are not searched.
+:param FileType type: The image format to return the thumbnails in. See
+  :meth:`CaptureFile.GetThumbnail` for the supported formats.
+:param int maxsize: The largest width or height allowed. If a thumbnail is larger, it's resized.
+:return: The full path of each capture found, sorted by filename, paired with its thumbnail.
+  Captures that can't be read or have no thumbnail return an empty thumbnail.
+:rtype: ``list`` of ``tuple`` of (``str``, Thumbnail)
+)");
+extern "C" RENDERDOC_API void RENDERDOC_CC
+RENDERDOC_GetCaptureThumbnails(const rdcstr &path, FileType type, uint32_t maxsize,
+                               rdcarray<rdcpair<rdcstr, Thumbnail>> *thumbnails);
+
 //////////////////////////////////////////////////////////////////////////
 // Target Control
 //////////////////////////////////////////////////////////////////////////
@@ -1839,6 +1948,29 @@ extern "C" RENDERDOC_API ExecuteResult RENDERDOC_CC
 RENDERDOC_InjectIntoProcess(uint32_t pid, const rdcarray<EnvironmentModification> &env,
                             const char *capturefile, const CaptureOptions &opts, bool waitForExit);
 
+DOCUMENT(R"(Run the same job against many captures, using a pool of worker processes.
+
+One worker process is launched per capture, and up to ``maxWorkers`` of them run at once. Each
+worker is expected to open the capture it is given, e.g. with a python script that calls
+:func:`OpenCaptureFile`, and report its results on stdout. Since every capture is replayed in its
+own process, this scales across cores and a crash while analysing one capture doesn't affect the
+others.
+
+:param str app: The path to the worker application to run.
+:param str workingDir: The working directory to use when running the worker. If blank, the directory
+  containing the application is used.
+:param str cmdLine: The command line to pass to each worker. Every occurrence of ``{capture}`` is
+  replaced with the quoted path of the capture for that worker.
+:param list captures: The paths of the captures to run the job against.
+:param int maxWorkers: The maximum number of workers to run at once, or ``0`` to run one per CPU
+  core.
+:return: The :class:`CaptureJobResult` of each job, in the same order as ``captures``.
+:rtype: ``list`` of CaptureJobResult
+)");
+extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_RunCaptureJobs(
+    const rdcstr &app, const rdcstr &workingDir, const rdcstr &cmdLine,
+    const rdcarray<rdcstr> &captures, uint32_t maxWorkers, rdcarray<CaptureJobResult> *results);
+
 DOCUMENT(R"(When debugging RenderDoc it can be useful to capture itself by doing a side-build with a
 temporary name. This function wraps up the use of the in-application API to start a capture.
 
@@ -962,6 +962,9 @@ rdcstr DoStringise(const SectionType &el)
     STRINGISE_ENUM_CLASS_NAMED(ResourceRenames, "renderdoc/ui/resrenames");
     STRINGISE_ENUM_CLASS_NAMED(AMDRGPProfile, "amd/rgp/profile");
     STRINGISE_ENUM_CLASS_NAMED(ExtendedThumbnail, "renderdoc/internal/exthumb");
+    STRINGISE_ENUM_CLASS_NAMED(CallstackTable, "renderdoc/internal/callstacks");
+    STRINGISE_ENUM_CLASS_NAMED(ZstdDictionary, "renderdoc/internal/zstddict");
+    STRINGISE_ENUM_CLASS_NAMED(BlobStore, "renderdoc/internal/blobs");
   }
   END_ENUM_STRINGISE();
 }
@@ -1020,6 +1023,7 @@ rdcstr DoStringise(const SectionFlags &el)
     STRINGISE_BITFIELD_CLASS_BIT_NAMED(ASCIIStored, "Stored as ASCII");
     STRINGISE_BITFIELD_CLASS_BIT_NAMED(LZ4Compressed, "Compressed with LZ4");
     STRINGISE_BITFIELD_CLASS_BIT_NAMED(ZstdCompressed, "Compressed with Zstd");
+    STRINGISE_BITFIELD_CLASS_BIT_NAMED(ZstdDictionary, "Compressed with a Zstd dictionary");
   }
   END_BITFIELD_STRINGISE();
 }
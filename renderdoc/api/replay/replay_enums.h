@@ -86,6 +86,26 @@ version of RenderDoc that addes a new section type. They should be considered eq
   lossless.
 
   The name for this section will be "renderdoc/internal/exthumb".
+
+.. data:: CallstackTable
+
+  This section contains the table of unique callstacks that chunks in the frame capture reference.
+
+  The name for this section will be "renderdoc/internal/callstacks".
+
+.. data:: ZstdDictionary
+
+  This section contains the dictionary used by any sections compressed with Zstd that have the
+  :data:`SectionFlags.ZstdDictionary` flag.
+
+  The name for this section will be "renderdoc/internal/zstddict".
+
+.. data:: BlobStore
+
+  This section contains large blobs of data such as resource initial contents, stored once each and
+  referenced by hash from chunks in the frame capture.
+
+  The name for this section will be "renderdoc/internal/blobs".
 )");
 enum class SectionType : uint32_t
 {
@@ -98,6 +118,9 @@ enum class SectionType : uint32_t
   ResourceRenames,
   AMDRGPProfile,
   ExtendedThumbnail,
+  CallstackTable,
+  ZstdDictionary,
+  BlobStore,
   Count,
 };
 
@@ -3649,6 +3672,12 @@ DOCUMENT(R"(A set of flags describing the properties of a section in a renderdoc
 .. data:: ZstdCompressed
 
   This section is compressed with Zstd on disk.
+
+.. data:: ZstdDictionary
+
+  This section is compressed with Zstd on disk using the dictionary stored in the
+  :data:`SectionType.ZstdDictionary` section. This flag is only valid together with
+  :data:`ZstdCompressed`.
 )");
 enum class SectionFlags : uint32_t
 {
@@ -3656,6 +3685,7 @@ enum class SectionFlags : uint32_t
   ASCIIStored = 0x1,
   LZ4Compressed = 0x2,
   ZstdCompressed = 0x4,
+  ZstdDictionary = 0x8,
 };
 
 BITMASK_OPERATORS(SectionFlags);
@@ -251,6 +251,14 @@ uint64_t Log2Floor(uint64_t value)
 static rdcstr logfile;
 static FileIO::LogFileHandle *logfileHandle = NULL;
 
+// every write to the log outputs happens under this lock, whether it's a single line written
+// synchronously or a batch written out of the asynchronous ring.
+static Threading::CriticalSection &rdclog_outputlock()
+{
+  static Threading::CriticalSection *lock = new Threading::CriticalSection();
+  return *lock;
+}
+
 const char *rdclog_getfilename()
 {
   return logfile.c_str();
@@ -258,6 +266,11 @@ const char *rdclog_getfilename()
 
 void rdclog_filename(const char *filename)
 {
+  // anything queued so far belongs in the current file
+  rdclog_flush();
+
+  SCOPED_LOCK(rdclog_outputlock());
+
   rdcstr previous = logfile;
 
   logfile = "";
@@ -292,46 +305,277 @@ void rdclog_enableoutput()
   log_output_enabled = true;
 }
 
-void rdclog_closelog(const char *filename)
-{
-  log_output_enabled = false;
-  FileIO::logfile_close(logfileHandle, filename);
-}
-
-void rdclog_flush()
-{
-}
-
-void rdclogprint_int(LogType type, const char *fullMsg, const char *msg)
+static void rdclog_output(const char *fullMsg, size_t fullLength, const char *consoleMsg)
 {
-  static Threading::CriticalSection *lock = new Threading::CriticalSection();
-
-  SCOPED_LOCK(*lock);
-
 #if ENABLED(OUTPUT_LOG_TO_DEBUG_OUT)
   OSUtility::WriteOutput(OSUtility::Output_DebugMon, fullMsg);
 #endif
 #if ENABLED(OUTPUT_LOG_TO_STDOUT)
-  // don't output debug messages to stdout/stderr
-  if(type != LogType::Debug && log_output_enabled)
-    OSUtility::WriteOutput(OSUtility::Output_StdOut, msg);
+  if(consoleMsg[0] && log_output_enabled)
+    OSUtility::WriteOutput(OSUtility::Output_StdOut, consoleMsg);
 #endif
 #if ENABLED(OUTPUT_LOG_TO_STDERR)
-  // don't output debug messages to stdout/stderr
-  if(type != LogType::Debug && log_output_enabled)
-    OSUtility::WriteOutput(OSUtility::Output_StdErr, msg);
+  if(consoleMsg[0] && log_output_enabled)
+    OSUtility::WriteOutput(OSUtility::Output_StdErr, consoleMsg);
 #endif
 #if ENABLED(OUTPUT_LOG_TO_DISK)
   if(logfileHandle)
   {
-    // strlen used as byte length - str is UTF-8 so this is NOT number of characters
-    FileIO::logfile_append(logfileHandle, fullMsg, strlen(fullMsg));
+    // byte length - str is UTF-8 so this is NOT number of characters
+    FileIO::logfile_append(logfileHandle, fullMsg, fullLength);
+  }
+#endif
+}
+
+// Asynchronous logging. Lines are formatted on the calling thread as normal, then copied into a
+// fixed ring of slots that a background thread writes out in batches. Producers claim a slot with
+// an atomic ticket and publish it by bumping the slot's sequence number, so no lock is taken unless
+// the ring is full - in which case the producer drains it itself rather than waiting.
+//
+// A slot with sequence number == ticket is free for that ticket, ticket+1 is filled and ready to
+// be written out, and once written it's bumped to ticket+logRingSlots for the next lap.
+static const int64_t logRingSlots = 1024;
+static const uint32_t logSlotTextSize = 496;
+
+struct LogSlot
+{
+  volatile int64_t seq;
+  LogType type;
+  // the message without the prefix (used for stdout/stderr) is always a suffix of the full text
+  uint16_t msgOffset;
+  uint16_t textLength;
+  char text[logSlotTextSize];
+};
+
+static LogSlot *logRing = NULL;
+static volatile int64_t logRingHead = 0;
+// only read or written with the output lock held
+static int64_t logRingTail = 0;
+
+// text gathered from the ring to be written out in one go. Like the ring this is allocated once and
+// never freed, since on windows the writer thread isn't joined and could still be draining during
+// static destruction.
+struct LogBatch
+{
+  rdcstr full, console;
+};
+
+static LogBatch *logBatch = NULL;
+
+static volatile int32_t logAsyncEnabled = 0;
+static uint32_t logWriterPID = 0;
+static volatile int32_t logWriterShutdown = 0;
+static volatile int32_t logWriterRunning = 0;
+static Threading::ThreadHandle logWriterThread = 0;
+
+// writes out every line in the ring that's ready, in order. Must be called with the output lock
+// held
+static void rdclog_drain()
+{
+  if(logRing == NULL)
+    return;
+
+  for(;;)
+  {
+    LogSlot &slot = logRing[logRingTail % logRingSlots];
+
+    // stop at the first line that hasn't been published yet, even if later ones are ready
+    if(Atomic::ExchAdd64(&slot.seq, 0) != logRingTail + 1)
+      break;
+
+    logBatch->full.append(slot.text, slot.textLength);
+    if(slot.type != LogType::Debug)
+      logBatch->console.append(slot.text + slot.msgOffset, slot.textLength - slot.msgOffset);
+
+    Atomic::ExchAdd64(&slot.seq, logRingSlots - 1);
+    logRingTail++;
+  }
+
+  if(!logBatch->full.empty())
+  {
+    rdclog_output(logBatch->full.c_str(), logBatch->full.size(), logBatch->console.c_str());
+    logBatch->full.clear();
+    logBatch->console.clear();
+  }
+}
+
+static bool rdclog_enqueue(LogType type, const char *fullMsg, const char *msg)
+{
+  size_t fullLength = strlen(fullMsg);
+  size_t msgLength = strlen(msg);
+
+  // very long lines, or a message that isn't the tail of the full text, are written synchronously
+  if(fullLength > logSlotTextSize || msgLength > fullLength ||
+     memcmp(fullMsg + fullLength - msgLength, msg, msgLength) != 0)
+    return false;
+
+  int64_t ticket = Atomic::Inc64(&logRingHead) - 1;
+  LogSlot &slot = logRing[ticket % logRingSlots];
+
+  // if the ring is full, help write it out instead of spinning
+  while(Atomic::ExchAdd64(&slot.seq, 0) != ticket)
+  {
+    if(rdclog_outputlock().Trylock())
+    {
+      rdclog_drain();
+      rdclog_outputlock().Unlock();
+    }
+    else
+    {
+      Threading::Sleep(0);
+    }
+  }
+
+  slot.type = type;
+  slot.msgOffset = uint16_t(fullLength - msgLength);
+  slot.textLength = uint16_t(fullLength);
+  memcpy(slot.text, fullMsg, fullLength);
+
+  Atomic::ExchAdd64(&slot.seq, 1);
+
+  return true;
+}
+
+static void rdclog_writerthread()
+{
+  uint32_t waitMS = 1;
+
+  while(logWriterShutdown == 0)
+  {
+    Threading::Sleep(waitMS);
+
+    bool wrote = false;
+
+    {
+      SCOPED_LOCK(rdclog_outputlock());
+      int64_t prevTail = logRingTail;
+      rdclog_drain();
+      wrote = (logRingTail != prevTail);
+    }
+
+    // poll quickly while lines are arriving, and back off while idle
+    waitMS = wrote ? 1 : RDCMIN(waitMS * 2, 16U);
+  }
+
+  Atomic::CmpExch32(&logWriterRunning, 1, 0);
+}
+
+void rdclog_flush()
+{
+  if(logRing == NULL)
+    return;
+
+  // everything claimed up to now must be written out. A producer might still be copying its line
+  // in, so wait a little while for it, but never forever since we could be flushing on a crash.
+  int64_t head = Atomic::ExchAdd64(&logRingHead, 0);
+
+  for(int attempt = 0; attempt < 1000; attempt++)
+  {
+    {
+      SCOPED_LOCK(rdclog_outputlock());
+      rdclog_drain();
+      if(logRingTail >= head)
+        return;
+    }
+
+    Threading::Sleep(attempt < 100 ? 0 : 1);
+  }
+}
+
+void rdclog_async(bool enable)
+{
+  if(enable)
+  {
+    if(logWriterThread)
+      return;
+
+    if(logRing == NULL)
+    {
+      LogSlot *ring = new LogSlot[logRingSlots];
+      for(int64_t i = 0; i < logRingSlots; i++)
+        ring[i].seq = logRingHead + i;
+      logRingTail = logRingHead;
+      logBatch = new LogBatch;
+      logRing = ring;
+    }
+
+    logWriterShutdown = 0;
+    logWriterRunning = 1;
+    logWriterPID = Process::GetCurrentPID();
+    logWriterThread = Threading::CreateThread(&rdclog_writerthread);
+
+    Atomic::CmpExch32(&logAsyncEnabled, 0, 1);
   }
+  else
+  {
+    if(!logWriterThread)
+      return;
+
+    Atomic::CmpExch32(&logAsyncEnabled, 1, 0);
+    Atomic::CmpExch32(&logWriterShutdown, 0, 1);
+
+#if ENABLED(RDOC_WIN32)
+    // on windows we can't join the thread here as this may be happening during module unload, where
+    // the thread can't exit until the loader lock is released. Give it a moment to leave the loop
+    // and then write out anything remaining ourselves.
+    for(int i = 0; i < 100 && logWriterRunning; i++)
+      Threading::Sleep(1);
+
+    Threading::CloseThread(logWriterThread);
+#else
+    Threading::JoinThread(logWriterThread);
+    Threading::CloseThread(logWriterThread);
 #endif
+    logWriterThread = 0;
+
+    rdclog_flush();
+  }
+}
+
+void rdclog_closelog(const char *filename)
+{
+  log_output_enabled = false;
+
+  rdclog_async(false);
+
+  SCOPED_LOCK(rdclog_outputlock());
+  FileIO::logfile_close(logfileHandle, filename);
+}
+
+void rdclogprint_int(LogType type, const char *fullMsg, const char *msg)
+{
+  if(logAsyncEnabled)
+  {
+    if(logWriterPID == Process::GetCurrentPID())
+    {
+      // errors are written synchronously below, flushing anything queued before them, so the lines
+      // leading up to a fatal error or crash are on disk before we go any further.
+      if(type < LogType::Error && rdclog_enqueue(type, fullMsg, msg))
+        return;
+    }
+    else
+    {
+      // we're in a child process that was forked without the writer thread. Anything still in the
+      // ring was the parent's to write, so drop it and log synchronously from now on.
+      SCOPED_LOCK(rdclog_outputlock());
+      logAsyncEnabled = 0;
+      logWriterThread = 0;
+      for(int64_t i = 0; i < logRingSlots; i++)
+        logRing[(logRingHead + i) % logRingSlots].seq = logRingHead + i;
+      logRingTail = logRingHead;
+    }
+  }
+
+  SCOPED_LOCK(rdclog_outputlock());
+
+  // anything already queued has to be written first to keep lines in order
+  rdclog_drain();
+
+  // don't output debug messages to stdout/stderr
+  rdclog_output(fullMsg, strlen(fullMsg), type != LogType::Debug ? msg : "");
 }
 
 const int rdclog_outBufSize = 4 * 1024;
-static char rdclog_outputBuffer[rdclog_outBufSize + 3];
 
 static void write_newline(char *output)
 {
@@ -376,13 +620,11 @@ void rdclog_direct(time_t utcTime, uint32_t pid, LogType type, const char *proje
       "Debug  ", "Log    ", "Warning", "Error  ", "Fatal  ",
   };
 
-  static Threading::CriticalSection *lock = new Threading::CriticalSection();
-
-  SCOPED_LOCK(*lock);
-
-  rdclog_outputBuffer[rdclog_outBufSize] = rdclog_outputBuffer[0] = 0;
+  // format on the calling thread's stack so that threads only contend when writing the output
+  char outputBuffer[rdclog_outBufSize + 3];
+  outputBuffer[rdclog_outBufSize] = outputBuffer[0] = 0;
 
-  char *output = rdclog_outputBuffer;
+  char *output = outputBuffer;
   size_t available = rdclog_outBufSize;
 
   char *base = output;
@@ -501,3 +743,132 @@ void rdclog_direct(time_t utcTime, uint32_t pid, LogType type, const char *proje
 
   SAFE_DELETE_ARRAY(oversizedBuffer);
 }
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "3rdparty/catch/catch.hpp"
+#include "common/formatting.h"
+
+// logs numLines from each of numThreads threads, then returns how many lines each thread got into
+// the log file, or -1 for a thread if its lines were out of order.
+static rdcarray<int> LogFromThreads(const rdcstr &logPath, uint32_t numThreads, uint32_t numLines,
+                                    const char *marker)
+{
+  Threading::ParallelFor(numThreads, numThreads, [numLines, marker](uint32_t thread) {
+    for(uint32_t line = 0; line < numLines; line++)
+      RDCLOG("%s %u %u", marker, thread, line);
+  });
+
+  rdclog_flush();
+
+  rdcstr contents;
+  FileIO::ReadAll(logPath.c_str(), contents);
+
+  rdcarray<int> counts;
+  counts.resize(numThreads);
+
+  const char *cur = contents.c_str();
+  size_t markerLen = strlen(marker);
+  while((cur = strstr(cur, marker)) != NULL)
+  {
+    cur += markerLen;
+
+    uint32_t thread = 0, line = 0;
+    if(sscanf(cur, " %u %u", &thread, &line) != 2 || thread >= numThreads)
+      continue;
+
+    if(counts[thread] >= 0 && (uint32_t)counts[thread] == line)
+      counts[thread]++;
+    else
+      counts[thread] = -1;
+  }
+
+  return counts;
+}
+
+TEST_CASE("Test asynchronous logging", "[log]")
+{
+  rdcstr previousLog = rdclog_getfilename();
+  rdcstr logPath = FileIO::GetTempFolderFilename() + "/renderdoc_log_test.log";
+
+  // detach from the current log first, so its contents aren't moved into the test log
+  rdclog_filename(NULL);
+  FileIO::Delete(logPath.c_str());
+  rdclog_filename(logPath.c_str());
+
+  const uint32_t numThreads = 8, numLines = 500;
+
+  SECTION("Lines from every thread are written in order")
+  {
+    for(bool async : {false, true})
+    {
+      rdclog_async(async);
+
+      rdcarray<int> counts =
+          LogFromThreads(logPath, numThreads, numLines, async ? "async-log-test" : "sync-log-test");
+
+      for(int c : counts)
+        CHECK(c == (int)numLines);
+    }
+  };
+
+  SECTION("Long and multi-line messages are kept in order with queued lines")
+  {
+    rdclog_async(true);
+
+    rdcstr longText;
+    longText.resize(2000);
+    for(size_t i = 0; i < longText.size(); i++)
+      longText[i] = 'a' + (i % 26);
+
+    RDCLOG("async-order-test 0");
+    RDCLOG("async-order-test 1 %s", longText.c_str());
+    RDCLOG("async-order-test 2\nasync-order-test 3");
+    RDCLOG("async-order-test 4");
+
+    rdclog_async(false);
+
+    rdcstr contents;
+    FileIO::ReadAll(logPath.c_str(), contents);
+
+    int32_t prevOffset = -1;
+    for(int i = 0; i < 5; i++)
+    {
+      int32_t offset = contents.find(StringFormat::Fmt("async-order-test %d", i));
+      CHECK(offset > prevOffset);
+      prevOffset = offset;
+    }
+
+    CHECK(contents.contains(longText));
+  };
+
+  SECTION("Errors write out queued lines without a flush")
+  {
+    rdclog_async(true);
+
+    RDCLOG("async-error-test queued");
+    // not RDCERR, which can break into the debugger
+    rdclog(LogType::Error, "async-error-test error");
+
+    rdcstr contents;
+    FileIO::ReadAll(logPath.c_str(), contents);
+
+    int32_t queuedOffset = contents.find("async-error-test queued");
+    CHECK(queuedOffset >= 0);
+    CHECK(contents.find("async-error-test error") > queuedOffset);
+
+    rdclog_async(false);
+  };
+
+#if ENABLED(ASYNC_LOGGING)
+  rdclog_async(true);
+#else
+  rdclog_async(false);
+#endif
+
+  rdclog_filename(NULL);
+  FileIO::Delete(logPath.c_str());
+  rdclog_filename(previousLog.c_str());
+};
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -258,6 +258,10 @@ inline size_t Log2Floor(size_t value)
   do                   \
   {                    \
   } while((void)0, 0)
+#define RDCLOGASYNC(enable) \
+  do                        \
+  {                         \
+  } while((void)0, 0)
 #define RDCLOGDELETE() \
   do                   \
   {                    \
@@ -346,12 +350,16 @@ void rdclog_direct(time_t utcTime, uint32_t pid, LogType type, const char *proje
 const char *rdclog_getfilename();
 void rdclog_filename(const char *filename);
 void rdclog_enableoutput();
+// switch to writing log lines from a background thread in batches. Disabling waits for everything
+// queued to be written out.
+void rdclog_async(bool enable);
 void rdclog_closelog(const char *filename);
 
 #define RDCLOGFILE(fn) rdclog_filename(fn)
 #define RDCGETLOGFILE() rdclog_getfilename()
 
 #define RDCLOGOUTPUT() rdclog_enableoutput()
+#define RDCLOGASYNC(enable) rdclog_async(enable)
 #define RDCSTOPLOGGING(filename) rdclog_closelog(filename)
 
 #if(ENABLED(RDOC_DEVEL) || ENABLED(FORCE_DEBUG_LOGS)) && DISABLED(STRIP_DEBUG_LOGS)
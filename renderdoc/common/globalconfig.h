@@ -203,6 +203,15 @@ enum
 // logs go to disk
 #define OUTPUT_LOG_TO_DISK OPTION_ON
 
+// log lines are written out in batches from a background thread, so logging threads don't block on
+// file I/O. Errors are always written synchronously and flush anything queued, but a hard crash can
+// lose the last few milliseconds of output, so this is opt-in.
+#define ASYNC_LOGGING OPTION_OFF
+
+// compile in SCOPED_INSTRUMENT timing scopes. These cost one branch each until recording is
+// started, see common/instrumentation.h
+#define ENABLE_INSTRUMENTATION OPTION_ON
+
 // normally only in a debug build do we
 // include debug logs. This prints them all the time
 #define FORCE_DEBUG_LOGS OPTION_OFF
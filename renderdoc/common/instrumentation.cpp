@@ -0,0 +1,278 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "instrumentation.h"
+#include "common/threading.h"
+#include "serialise/codecs/chrome_json_codec.h"
+
+namespace Instrumentation
+{
+volatile int32_t recording = 0;
+
+struct Event
+{
+  const char *name;
+  uint64_t start;
+  uint64_t end;
+};
+
+// each thread's events. Only the owning thread writes to it, so its lock is only contended when a
+// trace is written or a new recording starts.
+struct ThreadEvents
+{
+  static const int64_t capacity = 32 * 1024;
+
+  uint32_t threadIndex = 0;
+  int32_t generation = -1;
+  int64_t count = 0;
+  // held by the owning thread while it records, and by anyone else reading or freeing the ring
+  Threading::SpinLock lock;
+  // allocated on the first event of each recording, see Start()
+  Event *events = NULL;
+};
+
+static Threading::CriticalSection threadsLock;
+static rdcarray<ThreadEvents *> threads;
+static uint64_t tlsSlot = 0;
+
+// bumped by every Start() so that threads discard their old events lazily on the next Record()
+static volatile int32_t generation = 0;
+static uint64_t startTick = 0;
+
+void Start()
+{
+  {
+    SCOPED_LOCK(threadsLock);
+
+    if(tlsSlot == 0)
+      tlsSlot = Threading::AllocateTLSSlot();
+
+    // the previous recording's events are discarded, so free every thread's ring. We aren't told
+    // when a thread exits, so this is what stops exited threads holding on to theirs - threads that
+    // are still alive allocate a new one the next time they record.
+    for(ThreadEvents *thread : threads)
+    {
+      Threading::ScopedSpinLock lock(thread->lock);
+      delete[] thread->events;
+      thread->events = NULL;
+      thread->count = 0;
+    }
+
+    startTick = Timing::GetTick();
+  }
+
+  Atomic::Inc32(&generation);
+  Atomic::CmpExch32(&recording, 0, 1);
+}
+
+void Stop()
+{
+  Atomic::CmpExch32(&recording, 1, 0);
+}
+
+void Record(const char *name, uint64_t start, uint64_t end)
+{
+  // recording could have been started between a scope beginning and ending
+  if(tlsSlot == 0)
+    return;
+
+  ThreadEvents *thread = (ThreadEvents *)Threading::GetTLSValue(tlsSlot);
+
+  if(thread == NULL)
+  {
+    thread = new ThreadEvents;
+
+    {
+      SCOPED_LOCK(threadsLock);
+      thread->threadIndex = (uint32_t)threads.size() + 1;
+      threads.push_back(thread);
+    }
+
+    Threading::SetTLSValue(tlsSlot, thread);
+  }
+
+  Threading::ScopedSpinLock lock(thread->lock);
+
+  int32_t curGeneration = generation;
+  if(thread->generation != curGeneration)
+  {
+    thread->generation = curGeneration;
+    thread->count = 0;
+  }
+
+  if(thread->events == NULL)
+    thread->events = new Event[ThreadEvents::capacity];
+
+  Event &ev = thread->events[thread->count % ThreadEvents::capacity];
+  ev.name = name;
+  ev.start = start;
+  ev.end = end;
+
+  thread->count++;
+}
+
+bool WriteChromeTrace(const char *filename)
+{
+  rdcarray<ChromeTraceEvent> events;
+
+  {
+    SCOPED_LOCK(threadsLock);
+
+    const double ticksPerMicro = Timing::GetTickFrequency() / 1000.0;
+    const int32_t curGeneration = generation;
+
+    for(ThreadEvents *thread : threads)
+    {
+      Threading::ScopedSpinLock lock(thread->lock);
+
+      if(thread->generation != curGeneration || thread->events == NULL)
+        continue;
+
+      int64_t count = thread->count;
+      int64_t first = RDCMAX(int64_t(0), count - ThreadEvents::capacity);
+
+      for(int64_t i = first; i < count; i++)
+      {
+        const Event &src = thread->events[i % ThreadEvents::capacity];
+
+        // events from before the start tick were begun before recording started
+        if(src.start < startTick)
+          continue;
+
+        ChromeTraceEvent ev;
+        ev.name = src.name;
+        ev.category = "RenderDoc";
+        ev.timestampMicro = uint64_t(double(src.start - startTick) / ticksPerMicro);
+        // never write zero-length scopes as they'd be shown as instant events
+        ev.durationMicro =
+            RDCMAX(int64_t(1), int64_t(double(src.end - src.start) / ticksPerMicro));
+        ev.threadID = thread->threadIndex;
+        events.push_back(ev);
+      }
+    }
+  }
+
+  RDCLOG("Writing %zu instrumentation events to %s", events.size(), filename);
+
+  return ::WriteChromeTrace(filename, events, true, RENDERDOC_ProgressCallback()) ==
+         ReplayStatus::Succeeded;
+}
+};
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "3rdparty/catch/catch.hpp"
+
+TEST_CASE("Test instrumentation recording", "[instrumentation]")
+{
+  rdcstr path = FileIO::GetTempFolderFilename() + "/renderdoc_instrumentation_test.json";
+
+  SECTION("Nothing is recorded unless started")
+  {
+    Instrumentation::Stop();
+
+    {
+      SCOPED_INSTRUMENT("not recorded");
+    }
+
+    Instrumentation::Start();
+    Instrumentation::Stop();
+
+    REQUIRE(Instrumentation::WriteChromeTrace(path.c_str()));
+
+    rdcstr contents;
+    FileIO::ReadAll(path.c_str(), contents);
+
+    CHECK(contents.contains("traceEvents"));
+    CHECK(!contents.contains("not recorded"));
+  };
+
+  SECTION("Scopes from several threads are written")
+  {
+    Instrumentation::Start();
+
+    Threading::ParallelFor(4, 4, [](uint32_t) {
+      SCOPED_INSTRUMENT("outer scope");
+      for(int i = 0; i < 10; i++)
+      {
+        SCOPED_INSTRUMENT("inner scope");
+        Threading::Sleep(0);
+      }
+    });
+
+    Instrumentation::Stop();
+
+    {
+      SCOPED_INSTRUMENT("after stop");
+    }
+
+    REQUIRE(Instrumentation::WriteChromeTrace(path.c_str()));
+
+    rdcstr contents;
+    FileIO::ReadAll(path.c_str(), contents);
+
+    int outer = 0, inner = 0;
+    for(int32_t offs = contents.find("outer scope"); offs >= 0;
+        offs = contents.find("outer scope", offs + 1))
+      outer++;
+    for(int32_t offs = contents.find("inner scope"); offs >= 0;
+        offs = contents.find("inner scope", offs + 1))
+      inner++;
+
+    // the worker threads have exited by now, their events are kept until the next Start()
+    CHECK(outer == 4);
+    CHECK(inner == 40);
+    CHECK(contents.contains("\"ph\": \"X\""));
+    CHECK(!contents.contains("after stop"));
+  };
+
+  SECTION("Threads record again after their ring is freed")
+  {
+    Instrumentation::Start();
+
+    {
+      SCOPED_INSTRUMENT("first recording");
+    }
+
+    Instrumentation::Start();
+
+    {
+      SCOPED_INSTRUMENT("second recording");
+    }
+
+    Instrumentation::Stop();
+
+    REQUIRE(Instrumentation::WriteChromeTrace(path.c_str()));
+
+    rdcstr contents;
+    FileIO::ReadAll(path.c_str(), contents);
+
+    CHECK(!contents.contains("first recording"));
+    CHECK(contents.contains("second recording"));
+  };
+
+  FileIO::Delete(path.c_str());
+};
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
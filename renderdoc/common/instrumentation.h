@@ -0,0 +1,87 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include "common/common.h"
+#include "os/os_specific.h"
+
+// Lightweight scoped timing of internal work, for finding out where capture, load and replay time
+// goes. Scopes cost a single branch unless recording has been started, and when recording each
+// thread appends to its own fixed-size ring of events so threads never contend. If a thread's ring
+// fills up, its oldest events are overwritten.
+//
+// Recording can be started from code, or for any process by setting RENDERDOC_INSTRUMENTATION_TRACE
+// to a filename. The trace is then written there (with the PID appended) when RenderDoc shuts down.
+namespace Instrumentation
+{
+extern volatile int32_t recording;
+
+inline bool IsRecording()
+{
+  return recording != 0;
+}
+
+// starts recording on all threads, discarding any previously recorded events.
+void Start();
+
+// stops recording. Events recorded so far are kept until the next Start().
+void Stop();
+
+// records a completed scope on the calling thread. name must be a string literal or otherwise live
+// until the trace is written.
+void Record(const char *name, uint64_t startTick, uint64_t endTick);
+
+// writes every event recorded since the last Start() as a chrome://tracing JSON file. This should
+// be called once instrumented work has finished, as threads still recording may overwrite events
+// while they're being read.
+bool WriteChromeTrace(const char *filename);
+};
+
+class InstrumentedScope
+{
+public:
+  InstrumentedScope(const char *name)
+  {
+    m_Name = Instrumentation::IsRecording() ? name : NULL;
+    if(m_Name)
+      m_Start = Timing::GetTick();
+  }
+
+  ~InstrumentedScope()
+  {
+    if(m_Name)
+      Instrumentation::Record(m_Name, m_Start, Timing::GetTick());
+  }
+
+private:
+  const char *m_Name;
+  uint64_t m_Start = 0;
+};
+
+#if ENABLED(ENABLE_INSTRUMENTATION)
+#define SCOPED_INSTRUMENT(name) InstrumentedScope CONCAT(instrumentscope, __LINE__)(name);
+#else
+#define SCOPED_INSTRUMENT(name)
+#endif
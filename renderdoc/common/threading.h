@@ -110,6 +110,47 @@ public:
 private:
   SpinLock *m_Spin = NULL;
 };
+
+// calls func(i) for every i in [0, count), spread over up to maxThreads threads including the
+// calling thread, and returns once every call has completed. Indices are handed out in order one
+// at a time, so each call should do a reasonable amount of work (e.g. a block of rows rather than
+// a single pixel).
+inline void ParallelFor(uint32_t count, uint32_t maxThreads, std::function<void(uint32_t)> func)
+{
+  uint32_t numThreads = RDCMIN(RDCMAX(maxThreads, 1U), count);
+
+  if(numThreads <= 1)
+  {
+    for(uint32_t i = 0; i < count; i++)
+      func(i);
+    return;
+  }
+
+  int32_t next = -1;
+
+  auto worker = [count, &func, &next]() {
+    for(;;)
+    {
+      int32_t idx = Atomic::Inc32(&next);
+      if(idx >= (int32_t)count)
+        break;
+
+      func((uint32_t)idx);
+    }
+  };
+
+  rdcarray<ThreadHandle> threads;
+  for(uint32_t i = 1; i < numThreads; i++)
+    threads.push_back(CreateThread(worker));
+
+  worker();
+
+  for(ThreadHandle t : threads)
+  {
+    JoinThread(t);
+    CloseThread(t);
+  }
+}
 };
 
 #define SCOPED_LOCK(cs) Threading::ScopedLock CONCAT(scopedlock, __LINE__)(&cs);
@@ -71,4 +71,28 @@ TEST_CASE("Test spin lock", "[threading]")
   CHECK(finalValue == value);
 }
 
+TEST_CASE("Test parallel for", "[threading]")
+{
+  rdcarray<int32_t> hits;
+  hits.resize(1000);
+
+  for(uint32_t maxThreads : {0U, 1U, 4U, 64U})
+  {
+    for(int32_t &h : hits)
+      h = 0;
+
+    Threading::ParallelFor((uint32_t)hits.size(), maxThreads,
+                           [&hits](uint32_t i) { Atomic::Inc32(&hits[i]); });
+
+    // every index must be visited exactly once
+    for(int32_t h : hits)
+      CHECK(h == 1);
+  }
+
+  // an empty range never calls the function
+  bool called = false;
+  Threading::ParallelFor(0, 4, [&called](uint32_t) { called = true; });
+  CHECK(!called);
+}
+
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -28,10 +28,13 @@
 #include <algorithm>
 #include "api/replay/version.h"
 #include "common/common.h"
+#include "common/instrumentation.h"
 #include "common/threading.h"
 #include "hooks/hooks.h"
 #include "maths/formatpacking.h"
 #include "replay/replay_driver.h"
+#include "serialise/blob_store.h"
+#include "serialise/callstack_table.h"
 #include "serialise/rdcfile.h"
 #include "serialise/serialiser.h"
 #include "stb/stb_image_write.h"
@@ -61,6 +64,9 @@ void LogReplayOptions(const ReplayOptions &opts)
   }
 
   RDCLOG("Replay optimisation level: %s", ToStr(opts.optimisation).c_str());
+
+  if(opts.checkpointMemoryBudgetMB > 0)
+    RDCLOG("Replay checkpoints enabled with a budget of %u MB", opts.checkpointMemoryBudgetMB);
 }
 
 // these one is done by hand as we format it
@@ -321,6 +327,8 @@ RenderDoc::RenderDoc()
 
   m_ExHandler = NULL;
 
+  m_CallstackTable = new CallstackTable();
+
   m_Overlay = eRENDERDOC_Overlay_Default;
 
   m_VulkanCheck = NULL;
@@ -391,7 +399,27 @@ void RenderDoc::Initialise()
       SetCaptureFileTemplate(capture_filename.c_str());
 
     RDCLOGFILE(m_LoggingFilename.c_str());
+
+#if ENABLED(ASYNC_LOGGING)
+    RDCLOGASYNC(true);
+#endif
+  }
+
+#if ENABLED(ENABLE_INSTRUMENTATION)
+  const char *instrumentTrace = Process::GetEnvVariable("RENDERDOC_INSTRUMENTATION_TRACE");
+  if(instrumentTrace && instrumentTrace[0])
+  {
+    m_InstrumentationTrace =
+        StringFormat::Fmt("%s.%u.json", instrumentTrace, Process::GetCurrentPID());
+    Instrumentation::Start();
   }
+#endif
+
+  // storing initial contents once each in a shared section changes how captures are written and
+  // costs memory and hashing time while capturing, so it's opt-in.
+  const char *dedupInitialContents =
+      Process::GetEnvVariable("RENDERDOC_DEDUPLICATE_INITIAL_CONTENTS");
+  m_DeduplicateInitialContents = dedupInitialContents && dedupInitialContents[0] == '1';
 
   const char *platform =
 #if ENABLED(RDOC_WIN32)
@@ -472,6 +500,12 @@ RenderDoc::~RenderDoc()
     }
   }
 
+  if(!m_InstrumentationTrace.empty())
+  {
+    Instrumentation::Stop();
+    Instrumentation::WriteChromeTrace(m_InstrumentationTrace.c_str());
+  }
+
   RDCSTOPLOGGING(m_LoggingFilename.c_str());
 
   if(m_RemoteThread)
@@ -486,6 +520,8 @@ RenderDoc::~RenderDoc()
     m_RemoteThread = 0;
   }
 
+  SAFE_DELETE(m_CallstackTable);
+
   Process::Shutdown();
 
   Network::Shutdown();
@@ -742,6 +778,8 @@ void RenderDoc::SetActiveWindow(void *dev, void *wnd)
 
 bool RenderDoc::EndFrameCapture(void *dev, void *wnd)
 {
+  SCOPED_INSTRUMENT("RenderDoc::EndFrameCapture");
+
   IFrameCapturer *frameCap = MatchFrameCapturer(dev, wnd);
   if(frameCap)
   {
@@ -1140,6 +1178,9 @@ RDCFile *RenderDoc::CreateRDC(RDCDriver driver, uint32_t frameNum, const FramePi
 
   ret->Create(m_CurrentLogFile.c_str());
 
+  if(m_DeduplicateInitialContents)
+    ret->EnableBlobStore();
+
   if(ret->ErrorCode() != ContainerError::NoError)
   {
     RDCERR("Error creating RDC at '%s'", m_CurrentLogFile.c_str());
@@ -1576,6 +1617,8 @@ void RenderDoc::SetCaptureFileTemplate(const char *pathtemplate)
 
 void RenderDoc::FinishCaptureWriting(RDCFile *rdc, uint32_t frameNumber)
 {
+  SCOPED_INSTRUMENT("RenderDoc::FinishCaptureWriting");
+
   RenderDoc::Inst().SetProgress(CaptureProgress::FileWriting, 0.0f);
 
   if(rdc)
@@ -1601,6 +1644,40 @@ void RenderDoc::FinishCaptureWriting(RDCFile *rdc, uint32_t frameNumber)
       delete w;
     }
 
+    // add the table of unique callstacks that chunks reference, if there are any
+    if(m_CallstackTable->NumNodes() > 0)
+    {
+      SectionProperties props = {};
+      props.type = SectionType::CallstackTable;
+      props.version = 1;
+      StreamWriter *w = rdc->WriteSection(props);
+
+      m_CallstackTable->Write(w);
+
+      w->Finish();
+
+      delete w;
+    }
+
+    // add the deduplicated blobs that chunks reference, if there are any
+    BlobStore *blobs = rdc->GetBlobStore();
+    if(blobs && blobs->NumBlobs() > 0)
+    {
+      RDCLOG("Writing %llu unique blobs, %llu bytes deduplicated", (uint64_t)blobs->NumBlobs(),
+             blobs->DeduplicatedBytes());
+
+      SectionProperties props = {};
+      props.type = SectionType::BlobStore;
+      props.version = 1;
+      StreamWriter *w = rdc->WriteSection(props);
+
+      blobs->Write(w);
+
+      w->Finish();
+
+      delete w;
+    }
+
     const RDCThumb &thumb = rdc->GetThumbnail();
     if(thumb.format != FileType::JPG && thumb.width > 0 && thumb.height > 0)
     {
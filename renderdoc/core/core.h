@@ -50,6 +50,7 @@ class IReplayDriver;
 
 class StreamReader;
 class RDCFile;
+class CallstackTable;
 struct SDFile;
 enum class VulkanLayerFlags : uint32_t;
 
@@ -430,6 +431,7 @@ public:
 
   void SetCaptureOptions(const CaptureOptions &opts);
   const CaptureOptions &GetCaptureOptions() const { return m_Options; }
+  CallstackTable &GetCallstackTable() { return *m_CallstackTable; }
   void RecreateCrashHandler();
   void UnloadCrashHandler();
   ICrashHandler *GetCrashHandler() const { return m_ExHandler; }
@@ -590,11 +592,16 @@ private:
   FrameTimer m_FrameTimer;
 
   rdcstr m_LoggingFilename;
+  rdcstr m_InstrumentationTrace;
+  bool m_DeduplicateInitialContents = false;
 
   rdcstr m_Target;
   rdcstr m_CaptureFileTemplate;
   rdcstr m_CurrentLogFile;
   CaptureOptions m_Options;
+
+  // unique callstacks collected while capturing, shared between all captures
+  CallstackTable *m_CallstackTable = NULL;
   uint32_t m_Overlay;
 
   rdcarray<uint32_t> m_QueuedFrameCaptures;
@@ -221,7 +221,11 @@ public:
     desc.counter = counterID;
     return desc;
   }
-  rdcarray<CounterResult> FetchCounters(const rdcarray<GPUCounter> &counters) { return {}; }
+  rdcarray<CounterResult> FetchCounters(const rdcarray<GPUCounter> &counters, uint32_t firstEvent,
+                                        uint32_t lastEvent)
+  {
+    return {};
+  }
   void FillCBufferVariables(ResourceId pipeline, ResourceId shader, rdcstr entryPoint,
                             uint32_t cbufSlot, rdcarray<ShaderVariable> &outvars, const bytebuf &data)
   {
@@ -643,12 +643,11 @@ static void ActiveRemoteClientThread(ClientThread *threadData,
 
       if(resolver)
       {
-        StackFrames.reserve(StackAddresses.size());
-        for(uint64_t frame : StackAddresses)
-        {
-          Callstack::AddressDetails info = resolver->GetAddr(frame);
+        rdcarray<Callstack::AddressDetails> details = resolver->GetAddrs(StackAddresses);
+
+        StackFrames.reserve(details.size());
+        for(Callstack::AddressDetails &info : details)
           StackFrames.push_back(info.formattedString());
-        }
       }
       else
       {
@@ -674,7 +674,8 @@ ResourceId ReplayProxy::GetLiveID(ResourceId id)
 template <typename ParamSerialiser, typename ReturnSerialiser>
 rdcarray<CounterResult> ReplayProxy::Proxied_FetchCounters(ParamSerialiser &paramser,
                                                            ReturnSerialiser &retser,
-                                                           const rdcarray<GPUCounter> &counters)
+                                                           const rdcarray<GPUCounter> &counters,
+                                                           uint32_t firstEvent, uint32_t lastEvent)
 {
   const ReplayProxyPacket expectedPacket = eReplayProxy_FetchCounters;
   ReplayProxyPacket packet = eReplayProxy_FetchCounters;
@@ -683,13 +684,15 @@ rdcarray<CounterResult> ReplayProxy::Proxied_FetchCounters(ParamSerialiser &para
   {
     BEGIN_PARAMS();
     SERIALISE_ELEMENT(counters);
+    SERIALISE_ELEMENT(firstEvent);
+    SERIALISE_ELEMENT(lastEvent);
     END_PARAMS();
   }
 
   {
     REMOTE_EXECUTION();
     if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
-      ret = m_Remote->FetchCounters(counters);
+      ret = m_Remote->FetchCounters(counters, firstEvent, lastEvent);
   }
 
   SERIALISE_RETURN(ret);
@@ -697,9 +700,10 @@ rdcarray<CounterResult> ReplayProxy::Proxied_FetchCounters(ParamSerialiser &para
   return ret;
 }
 
-rdcarray<CounterResult> ReplayProxy::FetchCounters(const rdcarray<GPUCounter> &counters)
+rdcarray<CounterResult> ReplayProxy::FetchCounters(const rdcarray<GPUCounter> &counters,
+                                                   uint32_t firstEvent, uint32_t lastEvent)
 {
-  PROXY_FUNCTION(FetchCounters, counters);
+  PROXY_FUNCTION(FetchCounters, counters, firstEvent, lastEvent);
 }
 
 template <typename ParamSerialiser, typename ReturnSerialiser>
@@ -2696,7 +2700,7 @@ bool ReplayProxy::Tick(int type)
     case eReplayProxy_FetchCounters:
     {
       rdcarray<GPUCounter> counters;
-      FetchCounters(counters);
+      FetchCounters(counters, 0, 0);
       break;
     }
     case eReplayProxy_EnumerateCounters: EnumerateCounters(); break;
@@ -487,7 +487,8 @@ public:
   IMPLEMENT_FUNCTION_PROXIED(rdcarray<GPUCounter>, EnumerateCounters);
   IMPLEMENT_FUNCTION_PROXIED(CounterDescription, DescribeCounter, GPUCounter counterID);
   IMPLEMENT_FUNCTION_PROXIED(rdcarray<CounterResult>, FetchCounters,
-                             const rdcarray<GPUCounter> &counterID);
+                             const rdcarray<GPUCounter> &counterID, uint32_t firstEvent,
+                             uint32_t lastEvent);
 
   IMPLEMENT_FUNCTION_PROXIED(void, FillCBufferVariables, ResourceId pipeline, ResourceId shader,
                              rdcstr entryPoint, uint32_t cbufSlot,
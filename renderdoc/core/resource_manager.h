@@ -28,9 +28,11 @@
 #include <map>
 #include <set>
 #include "api/replay/resourceid.h"
+#include "common/instrumentation.h"
 #include "common/threading.h"
 #include "core/core.h"
 #include "os/os_specific.h"
+#include "serialise/blob_store.h"
 #include "serialise/serialiser.h"
 
 // In what way (read, write, etc) was a resource referenced in a frame -
@@ -604,6 +606,7 @@ public:
   // when asked for a given id, return the resource for a replacement id
   void ReplaceResource(ResourceId from, ResourceId to);
   bool HasReplacement(ResourceId from);
+  bool HasAnyReplacement();
   void RemoveReplacement(ResourceId id);
 
   // fetch original ID for a real ID or vice-versa.
@@ -1123,6 +1126,8 @@ void ResourceManager<Configuration>::MarkUnwrittenResources()
 template <typename Configuration>
 void ResourceManager<Configuration>::InsertReferencedChunks(WriteSerialiser &ser)
 {
+  SCOPED_INSTRUMENT("ResourceManager::InsertReferencedChunks");
+
   std::map<int32_t, Chunk *> sortedChunks;
 
   SCOPED_LOCK(m_Lock);
@@ -1173,6 +1178,8 @@ void ResourceManager<Configuration>::InsertReferencedChunks(WriteSerialiser &ser
 template <typename Configuration>
 void ResourceManager<Configuration>::PrepareInitialContents()
 {
+  SCOPED_INSTRUMENT("ResourceManager::PrepareInitialContents");
+
   SCOPED_LOCK(m_Lock);
 
   RDCDEBUG("Preparing up to %u potentially dirty resources", (uint32_t)m_DirtyResources.size());
@@ -1224,6 +1231,8 @@ void ResourceManager<Configuration>::PrepareInitialContents()
 template <typename Configuration>
 void ResourceManager<Configuration>::InsertInitialContentsChunks(WriteSerialiser &ser)
 {
+  SCOPED_INSTRUMENT("ResourceManager::InsertInitialContentsChunks");
+
   SCOPED_LOCK(m_Lock);
 
   uint32_t dirty = 0;
@@ -1293,9 +1302,35 @@ void ResourceManager<Configuration>::InsertInitialContentsChunks(WriteSerialiser
     {
       uint64_t size = GetSize_InitialState(id, it->second.data);
 
-      SCOPED_SERIALISE_CHUNK(SystemChunk::InitialContents, size);
+      // chunks too small to contain a blob are written straight out as normal
+      if(ser.GetBlobStore() && size >= BlobStore::MinimumSize && size < 0xffffffff)
+      {
+        // contents stored in the blob store only leave a reference in the chunk, so the estimated
+        // size would be almost all padding. Serialise to memory first to get the real length.
+        WriteSerialiser scratch(new StreamWriter(StreamWriter::DefaultScratchSize),
+                                Ownership::Stream);
+        scratch.SetChunkMetadataRecording(ser.GetChunkMetadataRecording());
+        scratch.SetUserData(ser.GetUserData());
+        scratch.SetBlobStore(ser.GetBlobStore());
 
-      Serialise_InitialState(ser, id, record, &it->second.data);
+        Chunk *chunk = NULL;
+        {
+          ScopedChunk scope(scratch, SystemChunk::InitialContents);
+
+          Serialise_InitialState(scratch, id, record, &it->second.data);
+
+          chunk = scope.Get();
+        }
+
+        chunk->Write(ser);
+        delete chunk;
+      }
+      else
+      {
+        SCOPED_SERIALISE_CHUNK(SystemChunk::InitialContents, size);
+
+        Serialise_InitialState(ser, id, record, &it->second.data);
+      }
     }
 
     // Reset back to empty contents, unloading the actual resource.
@@ -1367,6 +1402,14 @@ bool ResourceManager<Configuration>::HasReplacement(ResourceId from)
   return m_Replacements.find(from) != m_Replacements.end();
 }
 
+template <typename Configuration>
+bool ResourceManager<Configuration>::HasAnyReplacement()
+{
+  SCOPED_LOCK(m_Lock);
+
+  return !m_Replacements.empty();
+}
+
 template <typename Configuration>
 void ResourceManager<Configuration>::RemoveReplacement(ResourceId id)
 {
@@ -467,6 +467,11 @@ bool D3D11InitParams::IsSupportedVersion(uint64_t ver)
   if(ver == 0x10)
     return true;
 
+  // 0x11 -> 0x12 - large initial contents can be stored once in the blob store section, with only
+  // a reference to them in the frame capture
+  if(ver == 0x11)
+    return true;
+
   return false;
 }
 
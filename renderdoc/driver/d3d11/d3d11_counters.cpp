@@ -229,6 +229,8 @@ struct GPUTimer
 struct D3D11CounterContext
 {
   uint32_t eventStart;
+  uint32_t firstEvent;
+  uint32_t lastEvent;
   rdcarray<GPUTimer> timers;
 };
 
@@ -246,7 +248,7 @@ void D3D11Replay::FillTimers(D3D11CounterContext &ctx, const DrawcallDescription
     const DrawcallDescription &d = drawnode.children[i];
     FillTimers(ctx, drawnode.children[i]);
 
-    if(d.events.empty())
+    if(d.events.empty() || d.eventId < ctx.firstEvent || d.eventId > ctx.lastEvent)
       continue;
 
     GPUTimer *timer = NULL;
@@ -559,7 +561,8 @@ rdcarray<CounterResult> D3D11Replay::FetchCountersIntel(const rdcarray<GPUCounte
   return m_pIntelCounters->GetCounterData(eventIDs, counters);
 }
 
-rdcarray<CounterResult> D3D11Replay::FetchCounters(const rdcarray<GPUCounter> &counters)
+rdcarray<CounterResult> D3D11Replay::FetchCounters(const rdcarray<GPUCounter> &counters,
+                                                   uint32_t firstEvent, uint32_t lastEvent)
 {
   rdcarray<CounterResult> ret;
 
@@ -649,6 +652,8 @@ rdcarray<CounterResult> D3D11Replay::FetchCounters(const rdcarray<GPUCounter> &c
       m_pImmediateContext->End(start);
 
       ctx.eventStart = 0;
+      ctx.firstEvent = firstEvent;
+      ctx.lastEvent = lastEvent;
       FillTimers(ctx, m_pImmediateContext->GetRootDraw());
 
       m_pImmediateContext->End(disjoint);
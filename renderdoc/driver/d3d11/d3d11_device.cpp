@@ -24,6 +24,7 @@
  ******************************************************************************/
 
 #include "d3d11_device.h"
+#include "common/instrumentation.h"
 #include "core/core.h"
 #include "driver/dxgi/dxgi_wrapped.h"
 #include "jpeg-compressor/jpge.h"
@@ -1218,6 +1219,8 @@ bool WrappedID3D11Device::Serialise_CaptureScope(SerialiserType &ser)
 
 ReplayStatus WrappedID3D11Device::ReadLogInitialisation(RDCFile *rdc, bool storeStructuredBuffers)
 {
+  SCOPED_INSTRUMENT("WrappedID3D11Device::ReadLogInitialisation");
+
   int sectionIdx = rdc->SectionIndex(SectionType::FrameCapture);
 
   if(sectionIdx < 0)
@@ -1235,6 +1238,10 @@ ReplayStatus WrappedID3D11Device::ReadLogInitialisation(RDCFile *rdc, bool store
 
   ser.SetStringDatabase(&m_StringDB);
   ser.SetUserData(GetResourceManager());
+  m_CallstackTable = rdc->GetCallstackTable();
+  ser.SetCallstackTable(m_CallstackTable);
+  ser.SetBlobStore(rdc->GetBlobStore());
+  ser.SetBlobReferences(m_SectionVersion >= 0x12);
 
   ser.ConfigureStructuredExport(&GetChunkName, storeStructuredBuffers);
 
@@ -1384,6 +1391,24 @@ ReplayStatus WrappedID3D11Device::ReadLogInitialisation(RDCFile *rdc, bool store
   GetReplay()->WriteFrameRecord().frameInfo.initDataSize =
       chunkInfos[(D3D11Chunk)SystemChunk::InitialContents].totalsize;
 
+  rdcarray<ChunkLoadStatistics> &chunkStats =
+      GetReplay()->WriteFrameRecord().frameInfo.chunkLoadStatistics;
+  chunkStats.clear();
+
+  for(auto it = chunkInfos.begin(); it != chunkInfos.end(); ++it)
+  {
+    if(it->second.count == 0)
+      continue;
+
+    ChunkLoadStatistics stats;
+    stats.name = GetChunkName((uint32_t)it->first);
+    stats.chunkID = (uint32_t)it->first;
+    stats.count = (uint32_t)it->second.count;
+    stats.byteSize = it->second.totalsize;
+    stats.durationMS = it->second.total;
+    chunkStats.push_back(stats);
+  }
+
   RDCDEBUG("Allocating %llu persistant bytes of memory for the log.",
            GetReplay()->WriteFrameRecord().frameInfo.persistentSize);
 
@@ -1393,6 +1418,8 @@ ReplayStatus WrappedID3D11Device::ReadLogInitialisation(RDCFile *rdc, bool store
 void WrappedID3D11Device::ReplayLog(uint32_t startEventID, uint32_t endEventID,
                                     ReplayLogType replayType)
 {
+  SCOPED_INSTRUMENT("WrappedID3D11Device::ReplayLog");
+
   bool partial = true;
 
   if(startEventID == 0 && (replayType == eReplay_WithoutDraw || replayType == eReplay_Full))
@@ -1728,6 +1755,8 @@ bool WrappedID3D11Device::EndFrameCapture(void *dev, void *wnd)
   if(!IsActiveCapturing(m_State))
     return true;
 
+  SCOPED_INSTRUMENT("WrappedID3D11Device::EndFrameCapture");
+
   CaptureFailReason reason;
 
   IDXGISwapper *swapper = NULL;
@@ -1923,6 +1952,7 @@ bool WrappedID3D11Device::EndFrameCapture(void *dev, void *wnd)
       ser.SetChunkMetadataRecording(m_ScratchSerialiser.GetChunkMetadataRecording());
 
       ser.SetUserData(GetResourceManager());
+      ser.SetBlobStore(rdc ? rdc->GetBlobStore() : NULL);
 
       {
         // remember to update this estimated chunk length if you add more parameters
@@ -63,7 +63,7 @@ struct D3D11InitParams
   DXGI_ADAPTER_DESC AdapterDesc = {};
 
   // check if a frame capture section version is supported
-  static const uint64_t CurrentVersion = 0x11;
+  static const uint64_t CurrentVersion = 0x12;
   static bool IsSupportedVersion(uint64_t ver);
 };
 
@@ -318,6 +318,8 @@ private:
 
   D3D11InitParams m_InitParams;
   uint64_t m_SectionVersion;
+  // owned by the capture file, so only valid during ReadLogInitialisation
+  CallstackTable *m_CallstackTable = NULL;
   ReplayOptions m_ReplayOptions;
 
   ResourceId m_BBID;
@@ -402,6 +404,7 @@ public:
   }
   const ReplayOptions &GetReplayOptions() { return m_ReplayOptions; }
   uint64_t GetLogVersion() { return m_SectionVersion; }
+  CallstackTable *GetCallstackTable() { return m_CallstackTable; }
   virtual ~WrappedID3D11Device();
 
   ////////////////////////////////////////////////////////////////
@@ -545,7 +545,7 @@ bool WrappedID3D11Device::Serialise_InitialState(SerialiserType &ser, ResourceId
           SubresourceContents = mapped.pData;
       }
 
-      SERIALISE_ELEMENT_ARRAY(SubresourceContents, ContentsLength);
+      SERIALISE_ELEMENT_ARRAY_DEDUPLICATED(SubresourceContents, ContentsLength);
       SERIALISE_ELEMENT(ContentsLength);
 
       if(ser.IsWriting() && SUCCEEDED(hr))
@@ -701,7 +701,7 @@ bool WrappedID3D11Device::Serialise_InitialState(SerialiserType &ser, ResourceId
         }
 
         SERIALISE_ELEMENT(RowPitch);
-        SERIALISE_ELEMENT_ARRAY(SubresourceContents, ContentsLength);
+        SERIALISE_ELEMENT_ARRAY_DEDUPLICATED(SubresourceContents, ContentsLength);
 
         if(ser.IsWriting() && SUCCEEDED(hr))
           m_pImmediateContext->GetReal()->Unmap(prepared, sub);
@@ -876,7 +876,7 @@ bool WrappedID3D11Device::Serialise_InitialState(SerialiserType &ser, ResourceId
 
       SERIALISE_ELEMENT(RowPitch);
       SERIALISE_ELEMENT(DepthPitch);
-      SERIALISE_ELEMENT_ARRAY(SubresourceContents, ContentsLength);
+      SERIALISE_ELEMENT_ARRAY_DEDUPLICATED(SubresourceContents, ContentsLength);
       SERIALISE_ELEMENT(ContentsLength);
 
       if(ser.IsWriting() && SUCCEEDED(hr))
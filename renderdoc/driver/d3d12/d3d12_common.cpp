@@ -215,6 +215,11 @@ bool D3D12InitParams::IsSupportedVersion(uint64_t ver)
   if(ver == 0x7)
     return true;
 
+  // 0x8 -> 0x9 - large initial contents can be stored once in the blob store section, with only
+  // a reference to them in the frame capture
+  if(ver == 0x8)
+    return true;
+
   return false;
 }
 
@@ -439,7 +439,8 @@ struct D3D12GPUTimerCallback : public D3D12DrawcallCallback
   rdcarray<rdcpair<uint32_t, uint32_t> > m_AliasEvents;
 };
 
-rdcarray<CounterResult> D3D12Replay::FetchCounters(const rdcarray<GPUCounter> &counters)
+rdcarray<CounterResult> D3D12Replay::FetchCounters(const rdcarray<GPUCounter> &counters,
+                                                   uint32_t firstEvent, uint32_t lastEvent)
 {
   uint32_t maxEID = m_pDevice->GetQueue()->GetMaxEID();
 
@@ -553,8 +554,9 @@ rdcarray<CounterResult> D3D12Replay::FetchCounters(const rdcarray<GPUCounter> &c
 
   D3D12GPUTimerCallback cb(m_pDevice, this, timerQueryHeap, pipestatsQueryHeap, occlusionQueryHeap);
 
-  // replay the events to perform all the queries
-  m_pDevice->ReplayLog(0, maxEID, eReplay_Full);
+  // replay the events to perform all the queries. Events before firstEvent still have to be
+  // replayed, and are timed along with the rest so that resubmitted command lists can alias.
+  m_pDevice->ReplayLog(0, RDCMIN(maxEID, lastEvent), eReplay_Full);
 
 #if ENABLED(SINGLE_FLUSH_VALIDATE)
   m_pDevice->ExecuteLists();
@@ -24,6 +24,7 @@
 
 #include "d3d12_device.h"
 #include <algorithm>
+#include "common/instrumentation.h"
 #include "core/core.h"
 #include "driver/dxgi/dxgi_common.h"
 #include "driver/dxgi/dxgi_wrapped.h"
@@ -1826,6 +1827,8 @@ bool WrappedID3D12Device::EndFrameCapture(void *dev, void *wnd)
   if(!IsActiveCapturing(m_State))
     return true;
 
+  SCOPED_INSTRUMENT("WrappedID3D12Device::EndFrameCapture");
+
   IDXGISwapper *swapper = NULL;
   SwapPresentInfo swapInfo = {};
 
@@ -2036,6 +2039,7 @@ bool WrappedID3D12Device::EndFrameCapture(void *dev, void *wnd)
     ser.SetChunkMetadataRecording(GetThreadSerialiser().GetChunkMetadataRecording());
 
     ser.SetUserData(GetResourceManager());
+    ser.SetBlobStore(rdc ? rdc->GetBlobStore() : NULL);
 
     {
       SCOPED_SERIALISE_CHUNK(SystemChunk::DriverInit, sizeof(D3D12InitParams));
@@ -3157,6 +3161,8 @@ void WrappedID3D12Device::AddResourceCurChunk(ResourceId id)
 
 ReplayStatus WrappedID3D12Device::ReadLogInitialisation(RDCFile *rdc, bool storeStructuredBuffers)
 {
+  SCOPED_INSTRUMENT("WrappedID3D12Device::ReadLogInitialisation");
+
   int sectionIdx = rdc->SectionIndex(SectionType::FrameCapture);
 
   if(sectionIdx < 0)
@@ -3174,6 +3180,10 @@ ReplayStatus WrappedID3D12Device::ReadLogInitialisation(RDCFile *rdc, bool store
 
   ser.SetStringDatabase(&m_StringDB);
   ser.SetUserData(GetResourceManager());
+  m_CallstackTable = rdc->GetCallstackTable();
+  ser.SetCallstackTable(m_CallstackTable);
+  ser.SetBlobStore(rdc->GetBlobStore());
+  ser.SetBlobReferences(m_SectionVersion >= 0x9);
 
   ser.ConfigureStructuredExport(&GetChunkName, storeStructuredBuffers);
 
@@ -3321,6 +3331,24 @@ ReplayStatus WrappedID3D12Device::ReadLogInitialisation(RDCFile *rdc, bool store
   GetReplay()->WriteFrameRecord().frameInfo.initDataSize =
       chunkInfos[(D3D12Chunk)SystemChunk::InitialContents].totalsize;
 
+  rdcarray<ChunkLoadStatistics> &chunkStats =
+      GetReplay()->WriteFrameRecord().frameInfo.chunkLoadStatistics;
+  chunkStats.clear();
+
+  for(auto it = chunkInfos.begin(); it != chunkInfos.end(); ++it)
+  {
+    if(it->second.count == 0)
+      continue;
+
+    ChunkLoadStatistics stats;
+    stats.name = GetChunkName((uint32_t)it->first);
+    stats.chunkID = (uint32_t)it->first;
+    stats.count = (uint32_t)it->second.count;
+    stats.byteSize = it->second.totalsize;
+    stats.durationMS = it->second.total;
+    chunkStats.push_back(stats);
+  }
+
   RDCDEBUG("Allocating %llu persistant bytes of memory for the log.",
            GetReplay()->WriteFrameRecord().frameInfo.persistentSize);
 
@@ -3330,6 +3358,8 @@ ReplayStatus WrappedID3D12Device::ReadLogInitialisation(RDCFile *rdc, bool store
 void WrappedID3D12Device::ReplayLog(uint32_t startEventID, uint32_t endEventID,
                                     ReplayLogType replayType)
 {
+  SCOPED_INSTRUMENT("WrappedID3D12Device::ReplayLog");
+
   bool partial = true;
 
   if(startEventID == 0 && (replayType == eReplay_WithoutDraw || replayType == eReplay_Full))
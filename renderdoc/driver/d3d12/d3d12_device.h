@@ -44,7 +44,7 @@ struct D3D12InitParams
   DXGI_ADAPTER_DESC AdapterDesc = {};
 
   // check if a frame capture section version is supported
-  static const uint64_t CurrentVersion = 0x8;
+  static const uint64_t CurrentVersion = 0x9;
 
   static bool IsSupportedVersion(uint64_t ver);
 };
@@ -447,6 +447,8 @@ private:
 
   D3D12InitParams m_InitParams;
   uint64_t m_SectionVersion;
+  // owned by the capture file, so only valid during ReadLogInitialisation
+  CallstackTable *m_CallstackTable = NULL;
   ReplayOptions m_ReplayOptions;
   ID3D12InfoQueue *m_pInfoQueue;
 
@@ -581,6 +583,7 @@ public:
   }
   const ReplayOptions &GetReplayOptions() { return m_ReplayOptions; }
   uint64_t GetLogVersion() { return m_SectionVersion; }
+  CallstackTable *GetCallstackTable() { return m_CallstackTable; }
   CaptureState GetState() { return m_State; }
   D3D12Replay *GetReplay() { return m_Replay; }
   WrappedID3D12CommandQueue *GetQueue() { return m_Queue; }
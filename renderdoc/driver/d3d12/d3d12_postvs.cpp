@@ -1339,17 +1339,35 @@ struct D3D12InitPostVSCallback : public D3D12DrawcallCallback
 
 void D3D12Replay::InitPostVSBuffers(const rdcarray<uint32_t> &events)
 {
-  // first we must replay up to the first event without replaying it. This ensures any
-  // non-command buffer calls like memory unmaps etc all happen correctly before this
-  // command buffer
-  m_pDevice->ReplayLog(0, events.front(), eReplay_WithoutDraw);
+  // skip any events that are already fetched, if everything is then we don't need to replay at all
+  rdcarray<const DrawcallDescription *> draws;
+  for(uint32_t eid : events)
+  {
+    auto alias = m_PostVSAlias.find(eid);
+    uint32_t dataEID = alias == m_PostVSAlias.end() ? eid : alias->second;
+    if(m_PostVSData.find(dataEID) != m_PostVSData.end())
+      continue;
+
+    draws.push_back(m_pDevice->GetDrawcall(eid));
+  }
 
-  D3D12InitPostVSCallback cb(m_pDevice, this, events);
+  // the events could come from a whole frame, so split them up into runs that each lie within one
+  // command list. Each run can then be fetched with a single replay.
+  rdcarray<rdcarray<uint32_t>> runs = SplitEventsByPass(draws);
 
-  // now we replay the events, which are guaranteed (because we generated them in
-  // GetPassEvents above) to come from the same command buffer, so the event IDs are
-  // still locally continuous, even if we jump into replaying.
-  m_pDevice->ReplayLog(events.front(), events.back(), eReplay_Full);
+  for(const rdcarray<uint32_t> &run : runs)
+  {
+    // first we must replay up to the first event without replaying it. This ensures any
+    // non-command buffer calls like memory unmaps etc all happen correctly before this
+    // command buffer
+    m_pDevice->ReplayLog(0, run.front(), eReplay_WithoutDraw);
+
+    D3D12InitPostVSCallback cb(m_pDevice, this, run);
+
+    // now we replay the events, which are guaranteed to come from the same command list, so the
+    // event IDs are still locally continuous, even if we jump into replaying.
+    m_pDevice->ReplayLog(run.front(), run.back(), eReplay_Full);
+  }
 }
 
 MeshFormat D3D12Replay::GetPostVSBuffers(uint32_t eventId, uint32_t instID, uint32_t viewID,
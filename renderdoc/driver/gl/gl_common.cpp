@@ -1178,6 +1178,11 @@ bool GLInitParams::IsSupportedVersion(uint64_t ver)
   if(ver == 0x20)
     return true;
 
+  // 0x21 -> 0x22 - large initial contents can be stored once in the blob store section, with only
+  // a reference to them in the frame capture
+  if(ver == 0x21)
+    return true;
+
   return false;
 }
 
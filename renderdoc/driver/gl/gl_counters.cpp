@@ -219,6 +219,8 @@ struct GPUQueries
 struct GLCounterContext
 {
   uint32_t eventStart;
+  uint32_t firstEvent;
+  uint32_t lastEvent;
   rdcarray<GPUQueries> queries;
 };
 
@@ -250,7 +252,7 @@ void GLReplay::FillTimers(GLCounterContext &ctx, const DrawcallDescription &draw
     const DrawcallDescription &d = drawnode.children[i];
     FillTimers(ctx, drawnode.children[i], counters);
 
-    if(d.events.empty())
+    if(d.events.empty() || d.eventId < ctx.firstEvent || d.eventId > ctx.lastEvent)
       continue;
 
     GPUQueries *queries = NULL;
@@ -461,7 +463,8 @@ rdcarray<CounterResult> GLReplay::FetchCountersIntel(const rdcarray<GPUCounter>
   return ret;
 }
 
-rdcarray<CounterResult> GLReplay::FetchCounters(const rdcarray<GPUCounter> &allCounters)
+rdcarray<CounterResult> GLReplay::FetchCounters(const rdcarray<GPUCounter> &allCounters,
+                                                uint32_t firstEvent, uint32_t lastEvent)
 {
   rdcarray<CounterResult> ret;
 
@@ -510,6 +513,8 @@ rdcarray<CounterResult> GLReplay::FetchCounters(const rdcarray<GPUCounter> &allC
 
   GLCounterContext ctx;
   ctx.eventStart = 0;
+  ctx.firstEvent = firstEvent;
+  ctx.lastEvent = lastEvent;
 
   m_pDriver->ReplayMarkers(false);
 
@@ -26,6 +26,7 @@
 #include "gl_driver.h"
 #include <algorithm>
 #include "common/common.h"
+#include "common/instrumentation.h"
 #include "driver/shaders/spirv/spirv_compile.h"
 #include "jpeg-compressor/jpge.h"
 #include "serialise/rdcfile.h"
@@ -2182,6 +2183,8 @@ bool WrappedOpenGL::EndFrameCapture(void *dev, void *wnd)
   if(!IsActiveCapturing(m_State))
     return true;
 
+  SCOPED_INSTRUMENT("WrappedOpenGL::EndFrameCapture");
+
   SCOPED_LOCK(glLock);
 
   CaptureFailReason reason = CaptureSucceeded;
@@ -2254,6 +2257,7 @@ bool WrappedOpenGL::EndFrameCapture(void *dev, void *wnd)
       ser.SetChunkMetadataRecording(m_ScratchSerialiser.GetChunkMetadataRecording());
 
       ser.SetUserData(GetResourceManager());
+      ser.SetBlobStore(rdc ? rdc->GetBlobStore() : NULL);
 
       {
         // we no longer use this one, but for ease of compatibility we still serialise it here. This
@@ -3186,6 +3190,8 @@ bool WrappedOpenGL::HasNonDebugMarkers()
 
 ReplayStatus WrappedOpenGL::ReadLogInitialisation(RDCFile *rdc, bool storeStructuredBuffers)
 {
+  SCOPED_INSTRUMENT("WrappedOpenGL::ReadLogInitialisation");
+
   int sectionIdx = rdc->SectionIndex(SectionType::FrameCapture);
 
   if(sectionIdx < 0)
@@ -3203,6 +3209,10 @@ ReplayStatus WrappedOpenGL::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
 
   ser.SetStringDatabase(&m_StringDB);
   ser.SetUserData(GetResourceManager());
+  m_CallstackTable = rdc->GetCallstackTable();
+  ser.SetCallstackTable(m_CallstackTable);
+  ser.SetBlobStore(rdc->GetBlobStore());
+  ser.SetBlobReferences(m_SectionVersion >= 0x22);
 
   ser.ConfigureStructuredExport(&GetChunkName, storeStructuredBuffers);
 
@@ -3320,6 +3330,24 @@ ReplayStatus WrappedOpenGL::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
   GetReplay()->WriteFrameRecord().frameInfo.initDataSize =
       chunkInfos[(GLChunk)SystemChunk::InitialContents].totalsize;
 
+  rdcarray<ChunkLoadStatistics> &chunkStats =
+      GetReplay()->WriteFrameRecord().frameInfo.chunkLoadStatistics;
+  chunkStats.clear();
+
+  for(auto it = chunkInfos.begin(); it != chunkInfos.end(); ++it)
+  {
+    if(it->second.count == 0)
+      continue;
+
+    ChunkLoadStatistics stats;
+    stats.name = GetChunkName((uint32_t)it->first);
+    stats.chunkID = (uint32_t)it->first;
+    stats.count = (uint32_t)it->second.count;
+    stats.byteSize = it->second.totalsize;
+    stats.durationMS = it->second.total;
+    chunkStats.push_back(stats);
+  }
+
   RDCDEBUG("Allocating %llu persistant bytes of memory for the log.",
            GetReplay()->WriteFrameRecord().frameInfo.persistentSize);
 
@@ -4930,6 +4958,8 @@ bool WrappedOpenGL::ProcessChunk(ReadSerialiser &ser, GLChunk chunk)
 ReplayStatus WrappedOpenGL::ContextReplayLog(CaptureState readType, uint32_t startEventID,
                                              uint32_t endEventID, bool partial)
 {
+  SCOPED_INSTRUMENT("WrappedOpenGL::ContextReplayLog");
+
   m_FrameReader->SetOffset(0);
 
   ReadSerialiser ser(m_FrameReader, Ownership::Nothing);
@@ -4942,6 +4972,7 @@ ReplayStatus WrappedOpenGL::ContextReplayLog(CaptureState readType, uint32_t sta
 
   if(IsLoading(m_State) || IsStructuredExporting(m_State))
   {
+    ser.SetCallstackTable(m_CallstackTable);
     ser.ConfigureStructuredExport(&GetChunkName, IsStructuredExporting(m_State));
 
     ser.GetStructuredFile().Swap(*m_StructuredFile);
@@ -5492,6 +5523,8 @@ const DrawcallDescription *WrappedOpenGL::GetDrawcall(uint32_t eventId)
 
 void WrappedOpenGL::ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType)
 {
+  SCOPED_INSTRUMENT("WrappedOpenGL::ReplayLog");
+
   bool partial = true;
 
   if(startEventID == 0 && (replayType == eReplay_WithoutDraw || replayType == eReplay_Full))
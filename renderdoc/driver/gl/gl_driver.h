@@ -59,7 +59,7 @@ struct GLInitParams
   rdcstr renderer, version;
 
   // check if a frame capture section version is supported
-  static const uint64_t CurrentVersion = 0x21;
+  static const uint64_t CurrentVersion = 0x22;
   static bool IsSupportedVersion(uint64_t ver);
 };
 
@@ -143,6 +143,8 @@ private:
                                GLint arraySize, GLint samples, GLenum intFormat);
 
   uint64_t m_SectionVersion;
+  // owned by the capture file, so only valid during ReadLogInitialisation
+  CallstackTable *m_CallstackTable = NULL;
   GLInitParams m_GlobalInitParams;
   ReplayOptions m_ReplayOptions;
 
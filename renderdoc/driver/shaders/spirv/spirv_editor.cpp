@@ -108,25 +108,39 @@ void Editor::Prepare()
 
 Editor::~Editor()
 {
-  for(size_t i = FirstRealWord; i < m_SPIRV.size();)
+  // strip out all nops in a single pass. Any removed operations and any reserved space at the end
+  // of sections is left as nops, so there can be a lot of them - erasing them one at a time would
+  // be quadratic.
+  size_t write = FirstRealWord;
+  for(size_t read = FirstRealWord; read < m_SPIRV.size();)
   {
-    while(m_SPIRV[i] == OpNopWord)
+    if(m_SPIRV[read] == OpNopWord)
     {
-      m_SPIRV.erase(i);
-      addWords(i, -1);
+      read++;
+      continue;
     }
 
-    uint32_t len = m_SPIRV[i] >> WordCountShift;
+    size_t len = m_SPIRV[read] >> WordCountShift;
 
     if(len == 0)
     {
       RDCERR("Malformed SPIR-V");
-      break;
+
+      // leave the remainder untouched
+      len = m_SPIRV.size() - read;
     }
 
-    i += len;
+    len = RDCMIN(len, m_SPIRV.size() - read);
+
+    if(write != read)
+      memmove(&m_SPIRV[write], &m_SPIRV[read], len * sizeof(uint32_t));
+
+    write += len;
+    read += len;
   }
 
+  m_SPIRV.resize(write);
+
   m_ExternalSPIRV.swap(m_SPIRV);
 }
 
@@ -164,10 +178,7 @@ void Editor::SetName(Id id, const char *name)
 
 void Editor::AddDecoration(const Operation &op)
 {
-  size_t offset = m_Sections[Section::Annotations].endOffset;
-  op.insertInto(m_SPIRV, offset);
-  RegisterOp(Iter(m_SPIRV, offset));
-  addWords(offset, op.size());
+  InsertAtSectionEnd(Section::Annotations, op);
 }
 
 void Editor::AddCapability(Capability cap)
@@ -209,11 +220,7 @@ void Editor::AddExtension(const rdcstr &extension)
 
 void Editor::AddExecutionMode(const Operation &mode)
 {
-  size_t offset = m_Sections[Section::ExecutionMode].endOffset;
-
-  mode.insertInto(m_SPIRV, offset);
-  RegisterOp(Iter(m_SPIRV, offset));
-  addWords(offset, mode.size());
+  InsertAtSectionEnd(Section::ExecutionMode, mode);
 }
 
 Id Editor::ImportExtInst(const char *setname)
@@ -252,34 +259,22 @@ Id Editor::ImportExtInst(const char *setname)
 
 Id Editor::AddType(const Operation &op)
 {
-  size_t offset = m_Sections[Section::Types].endOffset;
-
   Id id = Id::fromWord(op[1]);
-  op.insertInto(m_SPIRV, offset);
-  RegisterOp(Iter(m_SPIRV, offset));
-  addWords(offset, op.size());
+  InsertAtSectionEnd(Section::Types, op);
   return id;
 }
 
 Id Editor::AddVariable(const Operation &op)
 {
-  size_t offset = m_Sections[Section::Variables].endOffset;
-
   Id id = Id::fromWord(op[2]);
-  op.insertInto(m_SPIRV, offset);
-  RegisterOp(Iter(m_SPIRV, offset));
-  addWords(offset, op.size());
+  InsertAtSectionEnd(Section::Variables, op);
   return id;
 }
 
 Id Editor::AddConstant(const Operation &op)
 {
-  size_t offset = m_Sections[Section::Constants].endOffset;
-
   Id id = Id::fromWord(op[2]);
-  op.insertInto(m_SPIRV, offset);
-  RegisterOp(Iter(m_SPIRV, offset));
-  addWords(offset, op.size());
+  InsertAtSectionEnd(Section::Constants, op);
   return id;
 }
 
@@ -339,6 +334,60 @@ void Editor::AddOperation(Iter iter, const Operation &op)
   addWords(iter.offs(), op.size());
 }
 
+void Editor::InsertAtSectionEnd(Section::Type section, const Operation &op)
+{
+  size_t &gap = m_SectionGap[section];
+
+  // the reserved nops are the last words in the section, so new operations go in front of them
+  const size_t offset = m_Sections[section].endOffset - gap;
+  const size_t size = op.size();
+
+  // paranoid check that the reserved space is still intact
+  for(size_t i = 0; i < gap && i < size; i++)
+  {
+    if(m_SPIRV[offset + i] != OpNopWord)
+    {
+      RDCERR("Reserved space at the end of section %u has been overwritten", section);
+      gap = 0;
+      return InsertAtSectionEnd(section, op);
+    }
+  }
+
+  if(gap >= size)
+  {
+    // fast path, overwrite the nops in place. Nothing moves, not even the section boundaries.
+    memcpy(&m_SPIRV[offset], &op[0], size * sizeof(uint32_t));
+    gap -= size;
+
+    RegisterOp(Iter(m_SPIRV, offset));
+    return;
+  }
+
+  // otherwise we have to insert. Reserve more space than we need at the same time, growing
+  // geometrically so that the number of inserts is logarithmic in the number of words appended.
+  size_t &growth = m_SectionGrowth[section];
+  if(growth == 0)
+    growth = 64;
+  else
+    growth *= 2;
+
+  const size_t reserve = RDCMAX(growth, size);
+
+  rdcarray<uint32_t> words;
+  words.resize(size + reserve);
+  memcpy(&words[0], &op[0], size * sizeof(uint32_t));
+  for(size_t i = size; i < words.size(); i++)
+    words[i] = OpNopWord;
+
+  // the new words go in front of any remaining old gap, which the new reserved nops then join
+  m_SPIRV.insert(offset, words);
+  addWords(offset, words.size());
+  gap += reserve;
+
+  // register after shifting offsets, so the new operation's own offset isn't shifted
+  RegisterOp(Iter(m_SPIRV, offset));
+}
+
 void Editor::RegisterOp(Iter it)
 {
   Processor::RegisterOp(it);
@@ -461,6 +510,15 @@ void Editor::UnregisterOp(Iter it)
 
 void Editor::addWords(size_t offs, int32_t num)
 {
+  // anything inserted right at the end of a section lands after its reserved nops. Later appends
+  // must come after it too, so the gap can't be used any more and is left to be stripped.
+  for(uint32_t s = 0; s < Section::Count; s++)
+  {
+    if(m_SectionGap[s] > 0 && offs > m_Sections[s].endOffset - m_SectionGap[s] &&
+       offs <= m_Sections[s].endOffset)
+      m_SectionGap[s] = 0;
+  }
+
   // look through every section, any that are >= this point, adjust the offsets
   // note that if we're removing words then any offsets pointing directly to the removed words
   // will go backwards - but they no longer have anywhere valid to point.
@@ -500,6 +558,61 @@ void Editor::addWords(size_t offs, int32_t num)
       o += num;
 }
 
+static inline size_t HashCombine(size_t seed, size_t v)
+{
+  return seed ^ (v + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+size_t TypeHash::operator()(const Scalar &s) const
+{
+  return HashCombine(HashCombine(size_t(s.type), s.width), s.signedness ? 1 : 0);
+}
+
+size_t TypeHash::operator()(const Vector &v) const
+{
+  return HashCombine(operator()(v.scalar), v.count);
+}
+
+size_t TypeHash::operator()(const Matrix &m) const
+{
+  return HashCombine(operator()(m.vector), m.count);
+}
+
+size_t TypeHash::operator()(const Pointer &p) const
+{
+  return HashCombine(p.baseId.value(), size_t(p.storage));
+}
+
+size_t TypeHash::operator()(const Image &i) const
+{
+  size_t ret = operator()(i.retType);
+  ret = HashCombine(ret, size_t(i.dim));
+  ret = HashCombine(ret, i.depth);
+  ret = HashCombine(ret, i.arrayed);
+  ret = HashCombine(ret, i.ms);
+  ret = HashCombine(ret, i.sampled);
+  ret = HashCombine(ret, size_t(i.format));
+  return ret;
+}
+
+size_t TypeHash::operator()(const Sampler &s) const
+{
+  return 0;
+}
+
+size_t TypeHash::operator()(const SampledImage &s) const
+{
+  return s.baseId.value();
+}
+
+size_t TypeHash::operator()(const FunctionType &f) const
+{
+  size_t ret = f.returnId.value();
+  for(const Id &arg : f.argumentIds)
+    ret = HashCombine(ret, arg.value());
+  return ret;
+}
+
 Operation Editor::MakeDeclaration(const Scalar &s)
 {
   if(s.type == Op::TypeVoid)
@@ -550,16 +663,16 @@ Operation Editor::MakeDeclaration(const FunctionType &f)
   return OpTypeFunction(Id(), f.returnId, f.argumentIds);
 }
 
-#define TYPETABLE(StructType, variable)                                \
-  template <>                                                          \
-  std::map<StructType, Id> &Editor::GetTable<StructType>()             \
-  {                                                                    \
-    return variable;                                                   \
-  }                                                                    \
-  template <>                                                          \
-  const std::map<StructType, Id> &Editor::GetTable<StructType>() const \
-  {                                                                    \
-    return variable;                                                   \
+#define TYPETABLE(StructType, variable)                             \
+  template <>                                                       \
+  TypeTable<StructType> &Editor::GetTable<StructType>()             \
+  {                                                                 \
+    return variable;                                                \
+  }                                                                 \
+  template <>                                                       \
+  const TypeTable<StructType> &Editor::GetTable<StructType>() const \
+  {                                                                 \
+    return variable;                                                \
   }
 
 TYPETABLE(Scalar, scalarTypeToId);
@@ -754,4 +867,130 @@ void main() {
   }
 }
 
+static rdcarray<uint32_t> CompileLargeShader(uint32_t numStatements)
+{
+  rdcspv::CompilationSettings settings;
+  settings.entryPoint = "main";
+  settings.lang = rdcspv::InputLanguage::VulkanGLSL;
+  settings.stage = rdcspv::ShaderStage::Fragment;
+
+  rdcstr source = R"(#version 450 core
+
+layout(binding = 0) uniform block {
+	vec4 val;
+};
+
+layout(location = 0) out vec4 col;
+
+void main() {
+  col = vec4(0, 0, 0, 0);
+)";
+
+  for(uint32_t i = 0; i < numStatements; i++)
+    source += StringFormat::Fmt("  col += val * sin(gl_FragCoord.x * %u.0);\n", i + 1);
+
+  source += "}\n";
+
+  rdcarray<uint32_t> spirv;
+  rdcstr errors = rdcspv::Compile(settings, {source}, spirv);
+
+  INFO("SPIR-V compilation - " << errors);
+
+  // ensure that compilation succeeded
+  REQUIRE(spirv.size() > 0);
+
+  return spirv;
+}
+
+static void PatchLargeShader(rdcspv::Editor &ed, uint32_t numPatches, rdcarray<rdcspv::Id> &added)
+{
+  rdcspv::Id uintType = ed.DeclareType(rdcspv::scalar<uint32_t>());
+  rdcspv::Id uintPtrType = ed.DeclareType(rdcspv::Pointer(uintType, rdcspv::StorageClass::Private));
+
+  for(uint32_t i = 0; i < numPatches; i++)
+  {
+    // constant values are unique so they don't alias
+    rdcspv::Id constant = ed.AddConstantImmediate<uint32_t>(0x10000000U + i);
+    ed.AddDecoration(rdcspv::OpDecorate(constant, rdcspv::Decoration::RelaxedPrecision));
+
+    rdcspv::Id var = ed.AddVariable(
+        rdcspv::OpVariable(uintPtrType, ed.MakeId(), rdcspv::StorageClass::Private, constant));
+
+    // existing types should be looked up, not redeclared
+    CHECK(ed.DeclareType(rdcspv::Pointer(uintType, rdcspv::StorageClass::Private)) == uintPtrType);
+
+    added.push_back(constant);
+    added.push_back(var);
+  }
+}
+
+TEST_CASE("Test SPIR-V editor bulk patching", "[spirv]")
+{
+  rdcspv::Init();
+  RenderDoc::Inst().RegisterShutdownFunction(&rdcspv::Shutdown);
+
+  rdcarray<uint32_t> spirv = CompileLargeShader(50);
+
+  rdcarray<rdcspv::Id> added;
+
+  {
+    rdcspv::Editor ed(spirv);
+
+    ed.Prepare();
+
+    PatchLargeShader(ed, 500, added);
+
+    // every id we added should be locatable while the editor is still live
+    for(size_t i = 0; i < added.size(); i += 2)
+    {
+      INFO("Constant " << i / 2);
+      rdcspv::Iter it = ed.GetID(added[i]);
+      REQUIRE((bool)it);
+      CHECK(it.opcode() == rdcspv::Op::Constant);
+      CHECK(it.word(2) == added[i].value());
+      CHECK(it.word(3) == 0x10000000U + i / 2);
+
+      it = ed.GetID(added[i + 1]);
+      REQUIRE((bool)it);
+      CHECK(it.opcode() == rdcspv::Op::Variable);
+      CHECK(it.word(2) == added[i + 1].value());
+    }
+
+    // the sections should still be contiguous
+    for(uint32_t s = rdcspv::Section::First; s + 1 < rdcspv::Section::Count; s++)
+      CHECK(ed.End((rdcspv::Section::Type)s).offs() ==
+            ed.Begin((rdcspv::Section::Type)(s + 1)).offs());
+
+    // and the entry point should still be in the functions section
+    REQUIRE(ed.GetEntries().size() == 1);
+    rdcspv::Iter entry = ed.GetID(ed.GetEntries()[0].id);
+    CHECK(entry.opcode() == rdcspv::Op::Function);
+    CHECK(ed.Begin(rdcspv::Section::Functions).offs() == entry.offs());
+  }
+
+  // once the editor is done there should be no nops left in the SPIR-V
+  for(size_t i = rdcspv::FirstRealWord; i < spirv.size();)
+  {
+    REQUIRE(spirv[i] != rdcspv::OpNopWord);
+
+    size_t len = spirv[i] >> rdcspv::WordCountShift;
+    REQUIRE(len > 0);
+    i += len;
+  }
+
+  // and all of the added ids should still be present when reading it back
+  rdcspv::Editor ed(spirv);
+
+  ed.Prepare();
+
+  for(size_t i = 0; i < added.size(); i += 2)
+  {
+    INFO("Constant " << i / 2);
+    rdcspv::Iter it = ed.GetID(added[i]);
+    REQUIRE((bool)it);
+    CHECK(it.opcode() == rdcspv::Op::Constant);
+    CHECK(it.word(3) == 0x10000000U + i / 2);
+  }
+}
+
 #endif
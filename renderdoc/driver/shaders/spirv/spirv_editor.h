@@ -25,7 +25,9 @@
 #pragma once
 
 #include <stdint.h>
+#include <algorithm>
 #include <map>
+#include <unordered_map>
 #include "api/replay/rdcarray.h"
 #include "spirv_common.h"
 #include "spirv_processor.h"
@@ -58,6 +60,23 @@ using TypeToId = std::pair<SPIRVType, Id>;
 template <typename SPIRVType>
 using TypeToIds = rdcarray<TypeToId<SPIRVType>>;
 
+// hashing for the type lookup tables. These are hit on every DeclareType and every type op that's
+// registered, so we don't want the log(n) compare-heavy lookups of a std::map
+struct TypeHash
+{
+  size_t operator()(const Scalar &s) const;
+  size_t operator()(const Vector &v) const;
+  size_t operator()(const Matrix &m) const;
+  size_t operator()(const Pointer &p) const;
+  size_t operator()(const Image &i) const;
+  size_t operator()(const Sampler &s) const;
+  size_t operator()(const SampledImage &s) const;
+  size_t operator()(const FunctionType &f) const;
+};
+
+template <typename SPIRVType>
+using TypeTable = std::unordered_map<SPIRVType, Id, TypeHash>;
+
 class Editor : public Processor
 {
 public:
@@ -106,10 +125,10 @@ public:
   template <typename SPIRVType>
   Id DeclareType(const SPIRVType &t)
   {
-    std::map<SPIRVType, Id> &table = GetTable<SPIRVType>();
+    TypeTable<SPIRVType> &table = GetTable<SPIRVType>();
 
-    auto it = table.lower_bound(t);
-    if(it != table.end() && it->first == t)
+    auto it = table.find(t);
+    if(it != table.end())
       return it->second;
 
     Operation decl = MakeDeclaration(t);
@@ -117,7 +136,7 @@ public:
     decl[1] = id.value();
     AddType(decl);
 
-    table.insert(it, std::pair<SPIRVType, Id>(t, id));
+    table.insert(std::pair<SPIRVType, Id>(t, id));
 
     return id;
   }
@@ -125,7 +144,7 @@ public:
   template <typename SPIRVType>
   Id GetType(const SPIRVType &t)
   {
-    std::map<SPIRVType, Id> &table = GetTable<SPIRVType>();
+    TypeTable<SPIRVType> &table = GetTable<SPIRVType>();
 
     auto it = table.find(t);
     if(it != table.end())
@@ -137,18 +156,21 @@ public:
   template <typename SPIRVType>
   TypeToIds<SPIRVType> GetTypes()
   {
-    std::map<SPIRVType, Id> &table = GetTable<SPIRVType>();
+    TypeTable<SPIRVType> &table = GetTable<SPIRVType>();
 
     TypeToIds<SPIRVType> ret;
 
     for(auto it = table.begin(); it != table.end(); ++it)
       ret.push_back(*it);
 
+    // the table is unordered, sort so that callers see a stable order
+    std::sort(ret.begin(), ret.end());
+
     return ret;
   }
 
   template <typename SPIRVType>
-  const std::map<SPIRVType, Id> &GetTypeInfo() const
+  const TypeTable<SPIRVType> &GetTypeInfo() const
   {
     return GetTable<SPIRVType>();
   }
@@ -196,20 +218,33 @@ private:
 
   std::map<Id, Binding> bindings;
 
-  std::map<Scalar, Id> scalarTypeToId;
-  std::map<Vector, Id> vectorTypeToId;
-  std::map<Matrix, Id> matrixTypeToId;
-  std::map<Pointer, Id> pointerTypeToId;
-  std::map<Image, Id> imageTypeToId;
-  std::map<Sampler, Id> samplerTypeToId;
-  std::map<SampledImage, Id> sampledImageTypeToId;
-  std::map<FunctionType, Id> functionTypeToId;
+  TypeTable<Scalar> scalarTypeToId;
+  TypeTable<Vector> vectorTypeToId;
+  TypeTable<Matrix> matrixTypeToId;
+  TypeTable<Pointer> pointerTypeToId;
+  TypeTable<Image> imageTypeToId;
+  TypeTable<Sampler> samplerTypeToId;
+  TypeTable<SampledImage> sampledImageTypeToId;
+  TypeTable<FunctionType> functionTypeToId;
 
   template <typename SPIRVType>
-  std::map<SPIRVType, Id> &GetTable();
+  TypeTable<SPIRVType> &GetTable();
 
   template <typename SPIRVType>
-  const std::map<SPIRVType, Id> &GetTable() const;
+  const TypeTable<SPIRVType> &GetTable() const;
+
+  // inserting at the end of a section normally means shifting every word after it, as well as
+  // every id offset. Since we mostly append at the end of the same few sections (types, constants,
+  // variables, decorations) we instead reserve a run of nops at the end of the section when we have
+  // to grow it, and subsequent appends overwrite those nops in place without moving anything else.
+  // This is effectively a gap buffer for each section. Iterating skips the nops, and they're
+  // stripped when the editor is destroyed.
+  void InsertAtSectionEnd(Section::Type section, const Operation &op);
+
+  // the number of reserved nop words at the end of each section
+  size_t m_SectionGap[Section::Count] = {};
+  // how many words to reserve the next time each section has to grow
+  size_t m_SectionGrowth[Section::Count] = {};
 
   rdcarray<uint32_t> &m_ExternalSPIRV;
 };
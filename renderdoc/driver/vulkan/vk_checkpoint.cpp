@@ -0,0 +1,887 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "vk_core.h"
+#include "vk_debug.h"
+
+// checkpoints are spread evenly through the frame, so this bounds how many we'll ever make
+static const uint32_t MaxReplayCheckpoints = 16;
+
+static uint32_t RangeEnd(uint32_t base, uint32_t count)
+{
+  if(count == VK_REMAINING_MIP_LEVELS || count == VK_REMAINING_ARRAY_LAYERS)
+    return ~0U;
+
+  return base + RDCMAX(count, 1U);
+}
+
+static bool IntersectRanges(const VkImageSubresourceRange &a, const VkImageSubresourceRange &b,
+                            VkImageSubresourceRange &out)
+{
+  out.aspectMask = a.aspectMask & b.aspectMask;
+
+  uint32_t mipEnd = RDCMIN(RangeEnd(a.baseMipLevel, a.levelCount),
+                           RangeEnd(b.baseMipLevel, b.levelCount));
+  uint32_t layerEnd = RDCMIN(RangeEnd(a.baseArrayLayer, a.layerCount),
+                             RangeEnd(b.baseArrayLayer, b.layerCount));
+
+  out.baseMipLevel = RDCMAX(a.baseMipLevel, b.baseMipLevel);
+  out.baseArrayLayer = RDCMAX(a.baseArrayLayer, b.baseArrayLayer);
+
+  if(out.aspectMask == 0 || out.baseMipLevel >= mipEnd || out.baseArrayLayer >= layerEnd)
+    return false;
+
+  out.levelCount = mipEnd == ~0U ? VK_REMAINING_MIP_LEVELS : mipEnd - out.baseMipLevel;
+  out.layerCount = layerEnd == ~0U ? VK_REMAINING_ARRAY_LAYERS : layerEnd - out.baseArrayLayer;
+
+  return true;
+}
+
+// transition every subresource of the image between its tracked layout and 'layout', in the
+// direction given by toLayout.
+static void AddTransitions(rdcarray<VkImageMemoryBarrier> &barriers, VkImage image,
+                           const ImageLayouts &layouts, VkImageLayout layout, bool toLayout)
+{
+  for(const ImageRegionState &state : layouts.subresourceStates)
+  {
+    VkImageMemoryBarrier barrier = {
+        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        NULL,
+        VK_ACCESS_ALL_WRITE_BITS,
+        VK_ACCESS_ALL_READ_BITS | VK_ACCESS_ALL_WRITE_BITS,
+        state.newLayout,
+        layout,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        image,
+        state.subresourceRange,
+    };
+
+    if(barrier.oldLayout == UNKNOWN_PREV_IMG_LAYOUT)
+      barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    if(toLayout)
+    {
+      SanitiseOldImageLayout(barrier.oldLayout);
+    }
+    else
+    {
+      std::swap(barrier.oldLayout, barrier.newLayout);
+      SanitiseNewImageLayout(barrier.newLayout);
+    }
+
+    barriers.push_back(barrier);
+  }
+}
+
+// transition every subresource of the image from its current layout to the one it had in target.
+// The tracked states can be split differently, so we transition each overlapping pair.
+static void AddLayoutRestore(rdcarray<VkImageMemoryBarrier> &barriers, VkImage image,
+                             const ImageLayouts &current, const ImageLayouts &target)
+{
+  for(const ImageRegionState &dst : target.subresourceStates)
+  {
+    if(dst.newLayout == UNKNOWN_PREV_IMG_LAYOUT)
+      continue;
+
+    for(const ImageRegionState &src : current.subresourceStates)
+    {
+      VkImageMemoryBarrier barrier = {
+          VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+          NULL,
+          VK_ACCESS_ALL_WRITE_BITS,
+          VK_ACCESS_ALL_READ_BITS | VK_ACCESS_ALL_WRITE_BITS,
+          src.newLayout,
+          dst.newLayout,
+          VK_QUEUE_FAMILY_IGNORED,
+          VK_QUEUE_FAMILY_IGNORED,
+          image,
+      };
+
+      if(!IntersectRanges(src.subresourceRange, dst.subresourceRange, barrier.subresourceRange))
+        continue;
+
+      if(barrier.oldLayout == UNKNOWN_PREV_IMG_LAYOUT)
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+      SanitiseOldImageLayout(barrier.oldLayout);
+      SanitiseNewImageLayout(barrier.newLayout);
+
+      if(barrier.oldLayout != barrier.newLayout)
+        barriers.push_back(barrier);
+    }
+  }
+}
+
+bool WrappedVulkan::ChunkUsesQueries(VulkanChunk chunk)
+{
+  switch(chunk)
+  {
+    case VulkanChunk::vkCmdBeginQuery:
+    case VulkanChunk::vkCmdEndQuery:
+    case VulkanChunk::vkCmdBeginQueryIndexedEXT:
+    case VulkanChunk::vkCmdEndQueryIndexedEXT:
+    case VulkanChunk::vkCmdWriteTimestamp:
+    case VulkanChunk::vkCmdResetQueryPool:
+    case VulkanChunk::vkResetQueryPoolEXT:
+    case VulkanChunk::vkCmdCopyQueryPoolResults: return true;
+    default: break;
+  }
+
+  return false;
+}
+
+const WrappedVulkan::ReplayCheckpoint *WrappedVulkan::FindReplayCheckpoint(uint32_t lastEventID)
+{
+  // callbacks expect to see every drawcall from the start of the frame
+  if(m_DrawcallCallback)
+    return NULL;
+
+  const ReplayCheckpoint *ret = NULL;
+
+  // a checkpoint at lastEventID + 1 is exactly the state we want, with nothing left to replay
+  for(const ReplayCheckpoint *checkpoint : m_ReplayCheckpoints)
+  {
+    if(checkpoint->eventId > lastEventID + 1)
+      break;
+
+    ret = checkpoint;
+  }
+
+  return ret;
+}
+
+bool WrappedVulkan::CanResumeReplayAt(uint32_t eventId, uint64_t chunkOffset)
+{
+  // command buffers are only re-recorded when their recording chunks are replayed. If one recorded
+  // before the resume point is submitted at or after it, resuming would skip its recording.
+  for(int p = 0; p < ePartialNum; p++)
+  {
+    for(auto it = m_Partial[p].cmdBufferSubmits.begin(); it != m_Partial[p].cmdBufferSubmits.end();
+        ++it)
+    {
+      auto info = m_BakedCmdBufferInfo.find(it->first);
+
+      if(info != m_BakedCmdBufferInfo.end() && info->second.beginOffset >= chunkOffset)
+        continue;
+
+      // the partial re-record has been used for every submission so far, so they may be incomplete
+      if(it->first == m_Partial[p].partialParent)
+        return false;
+
+      for(const Submission &submit : it->second)
+      {
+        if(submit.baseEvent >= eventId)
+          return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+void WrappedVulkan::CreateReplayCheckpoint(uint32_t eventId, uint64_t chunkOffset)
+{
+  const uint64_t budget = uint64_t(m_ReplayOptions.checkpointMemoryBudgetMB) * 1024 * 1024;
+
+  if(budget == 0 || m_ReplayCheckpointsUnsupported || m_DrawcallCallback)
+    return;
+
+  // the submission must have been replayed completely, otherwise this isn't a state the frame
+  // ever reaches
+  if(eventId == 0 || eventId - 1 > m_LastEventID)
+    return;
+
+  const uint32_t spacing = RDCMAX(1U, GetMaxEID() / MaxReplayCheckpoints);
+
+  for(const ReplayCheckpoint *checkpoint : m_ReplayCheckpoints)
+  {
+    uint32_t dist = checkpoint->eventId > eventId ? checkpoint->eventId - eventId
+                                                  : eventId - checkpoint->eventId;
+    if(dist < spacing)
+      return;
+  }
+
+  // a query reset before the checkpoint and begun after it would be begun without a reset
+  if(chunkOffset > m_FirstQueryChunkOffset)
+    return;
+
+  if(!CanResumeReplayAt(eventId, chunkOffset))
+    return;
+
+  VulkanResourceManager *rm = GetResourceManager();
+
+  ReplayCheckpoint *checkpoint = new ReplayCheckpoint;
+  checkpoint->eventId = eventId;
+  checkpoint->chunkOffset = chunkOffset;
+
+  // first gather everything that needs to be saved, so we can check the budget before allocating
+
+  // memory is saved only in the ranges that the frame writes
+  for(auto it = m_CreationInfo.m_Memory.begin(); it != m_CreationInfo.m_Memory.end(); ++it)
+  {
+    if(it->second.wholeMemBuf == VK_NULL_HANDLE)
+      continue;
+
+    const VkDeviceSize memSize = it->second.size;
+    ResourceId orig = rm->GetOriginalID(it->first);
+    MemRefs *memRefs = rm->FindMemRefs(orig);
+
+    ReplayCheckpoint::MemoryContents contents;
+    contents.memory = it->first;
+
+    VkDeviceSize bufSize = 0;
+
+    if(memRefs)
+    {
+      for(auto ref = memRefs->rangeRefs.begin(); ref != memRefs->rangeRefs.end(); ref++)
+      {
+        if(!IncludesWrite(ref->value()) || ref->start() >= memSize)
+          continue;
+
+        VkDeviceSize size = RDCMIN(ref->finish(), memSize) - ref->start();
+        contents.regions.push_back({ref->start(), bufSize, size});
+        bufSize += size;
+      }
+    }
+    else if(rm->GetInitialContents(orig).type == eResDeviceMemory)
+    {
+      // with no reference information the whole memory is reset every replay, so save all of it
+      contents.regions.push_back({0, 0, memSize});
+      bufSize = memSize;
+    }
+
+    if(contents.regions.empty())
+      continue;
+
+    checkpoint->byteSize += bufSize;
+    checkpoint->memory.push_back(contents);
+  }
+
+  // images are saved whole if any subresource is written
+  for(auto it = m_ImageLayouts.begin(); it != m_ImageLayouts.end(); ++it)
+  {
+    if(!it->second.isMemoryBound)
+      continue;
+
+    ImgRefs *imgRefs = rm->FindImgRefs(rm->GetOriginalID(it->first));
+
+    if(!imgRefs)
+      continue;
+
+    bool written = false;
+    for(FrameRefType ref : imgRefs->rangeRefs)
+      written |= IncludesWrite(ref);
+
+    if(!written)
+      continue;
+
+    auto imit = m_CreationInfo.m_Image.find(it->first);
+    if(imit == m_CreationInfo.m_Image.end())
+      continue;
+
+    const VulkanCreationInfo::Image &imInfo = imit->second;
+
+    uint32_t srcQueueFamily = it->second.queueFamilyIndex, dstQueueFamily = srcQueueFamily;
+    RemapQueueFamilyIndices(srcQueueFamily, dstQueueFamily);
+
+    // multi-planar images would need per-plane copies, and images owned by another queue family
+    // would need ownership transfers. Neither is worth the complexity here.
+    if(GetYUVPlaneCount(imInfo.format) > 1 ||
+       (dstQueueFamily != m_QueueFamilyIdx && dstQueueFamily != VK_QUEUE_FAMILY_IGNORED))
+    {
+      RDCLOG("Disabling replay checkpoints, %s can't be saved",
+             ToStr(rm->GetOriginalID(it->first)).c_str());
+      m_ReplayCheckpointsUnsupported = true;
+      delete checkpoint;
+      return;
+    }
+
+    ReplayCheckpoint::ImageContents contents;
+    contents.image = it->first;
+
+    for(int m = 0; m < imInfo.mipLevels; m++)
+    {
+      VkImageCopy region = {};
+      region.srcSubresource.aspectMask = FormatImageAspects(imInfo.format);
+      region.srcSubresource.mipLevel = (uint32_t)m;
+      region.srcSubresource.layerCount = (uint32_t)imInfo.arrayLayers;
+      region.dstSubresource = region.srcSubresource;
+      region.extent.width = RDCMAX(1U, imInfo.extent.width >> m);
+      region.extent.height = RDCMAX(1U, imInfo.extent.height >> m);
+      region.extent.depth = RDCMAX(1U, imInfo.extent.depth >> m);
+
+      contents.regions.push_back(region);
+
+      checkpoint->byteSize += uint64_t(GetByteSize(imInfo.extent.width, imInfo.extent.height,
+                                                   imInfo.extent.depth, imInfo.format, m)) *
+                              imInfo.arrayLayers * imInfo.samples;
+    }
+
+    checkpoint->images.push_back(contents);
+  }
+
+  if(m_ReplayCheckpointBytes + checkpoint->byteSize > budget)
+  {
+    RDCDEBUG("Replay checkpoint at %u needs %llu bytes, over budget", eventId,
+             checkpoint->byteSize);
+    delete checkpoint;
+    return;
+  }
+
+  // descriptor sets that can change in the frame are the ones with initial contents
+  for(auto it = m_DescriptorSetState.begin(); it != m_DescriptorSetState.end(); ++it)
+  {
+    if(it->second.push ||
+       rm->GetInitialContents(rm->GetOriginalID(it->first)).type != eResDescriptorSet)
+      continue;
+
+    const DescSetLayout &layout = m_CreationInfo.m_DescSetLayout[it->second.layout];
+
+    ReplayCheckpoint::DescSetContents contents;
+    contents.set = it->first;
+
+    for(size_t b = 0; b < layout.bindings.size() && b < it->second.currentBindings.size(); b++)
+      contents.slots.append(it->second.currentBindings[b], layout.bindings[b].descriptorCount);
+
+    checkpoint->descSets.push_back(contents);
+  }
+
+  checkpoint->imageLayouts = m_ImageLayouts;
+
+  VkDevice dev = GetDev();
+  VkResult vkr = VK_SUCCESS;
+
+  for(ReplayCheckpoint::MemoryContents &contents : checkpoint->memory)
+  {
+    VkBufferCreateInfo bufInfo = {
+        VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        NULL,
+        0,
+        contents.regions.back().dstOffset + contents.regions.back().size,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+    };
+
+    vkr = ObjDisp(dev)->CreateBuffer(Unwrap(dev), &bufInfo, NULL, &contents.buf);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    rm->WrapResource(Unwrap(dev), contents.buf);
+
+    MemoryAllocation alloc = AllocateMemoryForResource(contents.buf, MemoryScope::ReplayCheckpoint,
+                                                       MemoryType::GPULocal);
+
+    vkr = ObjDisp(dev)->BindBufferMemory(Unwrap(dev), Unwrap(contents.buf), Unwrap(alloc.mem),
+                                         alloc.offs);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  }
+
+  for(ReplayCheckpoint::ImageContents &contents : checkpoint->images)
+  {
+    const VulkanCreationInfo::Image &imInfo = m_CreationInfo.m_Image[contents.image];
+
+    VkImageCreateInfo imageInfo = {
+        VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        NULL,
+        0,
+        imInfo.type,
+        imInfo.format,
+        imInfo.extent,
+        (uint32_t)imInfo.mipLevels,
+        (uint32_t)imInfo.arrayLayers,
+        imInfo.samples,
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        VK_SHARING_MODE_EXCLUSIVE,
+        0,
+        NULL,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+
+    // multisampled images must be usable as an attachment
+    if(imInfo.samples != VK_SAMPLE_COUNT_1_BIT)
+      imageInfo.usage |= IsDepthOrStencilFormat(imInfo.format)
+                             ? VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT
+                             : VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+    vkr = ObjDisp(dev)->CreateImage(Unwrap(dev), &imageInfo, NULL, &contents.copy);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    rm->WrapResource(Unwrap(dev), contents.copy);
+
+    MemoryAllocation alloc = AllocateMemoryForResource(contents.copy, MemoryScope::ReplayCheckpoint,
+                                                       MemoryType::GPULocal);
+
+    vkr = ObjDisp(dev)->BindImageMemory(Unwrap(dev), Unwrap(contents.copy), Unwrap(alloc.mem),
+                                        alloc.offs);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  }
+
+  // the frame's own submissions went to its queues, so wait for everything before copying
+  ObjDisp(dev)->DeviceWaitIdle(Unwrap(dev));
+
+  for(ResourceId id : m_ReplayCheckpointEvents)
+  {
+    if(rm->HasCurrentResource(id))
+      checkpoint->events[id] =
+          ObjDisp(dev)->GetEventStatus(Unwrap(dev), Unwrap(rm->GetCurrentHandle<VkEvent>(id))) ==
+          VK_EVENT_SET;
+  }
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  VkCommandBuffer cmd = GetNextCmd();
+
+  vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  for(const ReplayCheckpoint::MemoryContents &contents : checkpoint->memory)
+  {
+    ObjDisp(cmd)->CmdCopyBuffer(
+        Unwrap(cmd), Unwrap(m_CreationInfo.m_Memory[contents.memory].wholeMemBuf),
+        Unwrap(contents.buf), (uint32_t)contents.regions.size(), contents.regions.data());
+  }
+
+  rdcarray<VkImageMemoryBarrier> barriers;
+
+  for(const ReplayCheckpoint::ImageContents &contents : checkpoint->images)
+  {
+    VkImage live = Unwrap(rm->GetCurrentHandle<VkImage>(contents.image));
+    const ImageLayouts &layouts = m_ImageLayouts[contents.image];
+
+    VkImageMemoryBarrier copyBarrier = {
+        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        NULL,
+        0,
+        VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        Unwrap(contents.copy),
+        {FormatImageAspects(m_CreationInfo.m_Image[contents.image].format), 0,
+         VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS},
+    };
+
+    barriers.clear();
+    AddTransitions(barriers, live, layouts, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, true);
+    barriers.push_back(copyBarrier);
+    DoPipelineBarrier(cmd, (uint32_t)barriers.size(), barriers.data());
+
+    ObjDisp(cmd)->CmdCopyImage(Unwrap(cmd), live, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                               Unwrap(contents.copy), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               (uint32_t)contents.regions.size(), contents.regions.data());
+
+    // the copy lives in TRANSFER_SRC_OPTIMAL from now on
+    copyBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    copyBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    copyBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    copyBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+    barriers.clear();
+    AddTransitions(barriers, live, layouts, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, false);
+    barriers.push_back(copyBarrier);
+    DoPipelineBarrier(cmd, (uint32_t)barriers.size(), barriers.data());
+  }
+
+  vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  SubmitCmds();
+  FlushQ();
+
+  RDCDEBUG("Created replay checkpoint at %u: %llu bytes, %zu memories, %zu images, %zu sets",
+           eventId, checkpoint->byteSize, checkpoint->memory.size(), checkpoint->images.size(),
+           checkpoint->descSets.size());
+
+  m_ReplayCheckpointBytes += checkpoint->byteSize;
+
+  size_t idx = 0;
+  while(idx < m_ReplayCheckpoints.size() && m_ReplayCheckpoints[idx]->eventId < eventId)
+    idx++;
+
+  m_ReplayCheckpoints.insert(idx, checkpoint);
+}
+
+void WrappedVulkan::ApplyReplayCheckpoint(const ReplayCheckpoint &checkpoint)
+{
+  VulkanResourceManager *rm = GetResourceManager();
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  VkDevice dev = GetDev();
+
+  for(auto it = checkpoint.events.begin(); it != checkpoint.events.end(); ++it)
+  {
+    if(!rm->HasCurrentResource(it->first))
+      continue;
+
+    VkEvent ev = Unwrap(rm->GetCurrentHandle<VkEvent>(it->first));
+
+    if(it->second)
+      ObjDisp(dev)->SetEvent(Unwrap(dev), ev);
+    else
+      ObjDisp(dev)->ResetEvent(Unwrap(dev), ev);
+  }
+
+  VkCommandBuffer cmd = GetNextCmd();
+
+  VkResult vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  // put every image back in the layout it had at the checkpoint. Like the transitions at the start
+  // of the frame this preserves contents, and any image the frame writes is overwritten below.
+  rdcarray<VkImageMemoryBarrier> barriers;
+
+  for(auto it = checkpoint.imageLayouts.begin(); it != checkpoint.imageLayouts.end(); ++it)
+  {
+    auto cur = m_ImageLayouts.find(it->first);
+
+    if(cur == m_ImageLayouts.end())
+      continue;
+
+    if(it->second.isMemoryBound && rm->HasCurrentResource(it->first))
+      AddLayoutRestore(barriers, Unwrap(rm->GetCurrentHandle<VkImage>(it->first)), cur->second,
+                       it->second);
+
+    cur->second = it->second;
+  }
+
+  if(!barriers.empty())
+    DoPipelineBarrier(cmd, (uint32_t)barriers.size(), barriers.data());
+
+  // restore memory before images, so that images aliasing written memory end up with their own
+  // contents
+  for(const ReplayCheckpoint::MemoryContents &contents : checkpoint.memory)
+  {
+    rdcarray<VkBufferCopy> regions = contents.regions;
+    for(VkBufferCopy &region : regions)
+      std::swap(region.srcOffset, region.dstOffset);
+
+    ObjDisp(cmd)->CmdCopyBuffer(Unwrap(cmd), Unwrap(contents.buf),
+                                Unwrap(m_CreationInfo.m_Memory[contents.memory].wholeMemBuf),
+                                (uint32_t)regions.size(), regions.data());
+  }
+
+  VkMemoryBarrier memBarrier = {
+      VK_STRUCTURE_TYPE_MEMORY_BARRIER, NULL, VK_ACCESS_TRANSFER_WRITE_BIT,
+      VK_ACCESS_ALL_READ_BITS | VK_ACCESS_ALL_WRITE_BITS,
+  };
+
+  DoPipelineBarrier(cmd, 1, &memBarrier);
+
+  for(const ReplayCheckpoint::ImageContents &contents : checkpoint.images)
+  {
+    VkImage live = Unwrap(rm->GetCurrentHandle<VkImage>(contents.image));
+    const ImageLayouts &layouts = m_ImageLayouts[contents.image];
+
+    barriers.clear();
+    AddTransitions(barriers, live, layouts, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true);
+    DoPipelineBarrier(cmd, (uint32_t)barriers.size(), barriers.data());
+
+    ObjDisp(cmd)->CmdCopyImage(Unwrap(cmd), Unwrap(contents.copy),
+                               VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, live,
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               (uint32_t)contents.regions.size(), contents.regions.data());
+
+    barriers.clear();
+    AddTransitions(barriers, live, layouts, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, false);
+    DoPipelineBarrier(cmd, (uint32_t)barriers.size(), barriers.data());
+  }
+
+  vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  // descriptor sets are only rewritten where a binding differs from the checkpoint
+  rdcarray<VkWriteDescriptorSet> writes;
+  rdcarray<VkDescriptorImageInfo> imageInfos;
+  rdcarray<VkDescriptorBufferInfo> bufferInfos;
+  rdcarray<VkBufferView> texelBufferViews;
+
+  for(const ReplayCheckpoint::DescSetContents &contents : checkpoint.descSets)
+  {
+    auto setit = m_DescriptorSetState.find(contents.set);
+
+    if(setit == m_DescriptorSetState.end())
+      continue;
+
+    rdcarray<DescriptorSetSlot *> &bindings = setit->second.currentBindings;
+    const DescSetLayout &layout = m_CreationInfo.m_DescSetLayout[setit->second.layout];
+
+    VkDescriptorSet set = rm->GetCurrentHandle<VkDescriptorSet>(contents.set);
+
+    const DescriptorSetSlot *src = contents.slots.data();
+
+    for(size_t b = 0; b < layout.bindings.size() && b < bindings.size(); b++)
+    {
+      const DescSetLayout::Binding &bind = layout.bindings[b];
+      const uint32_t count = bind.descriptorCount;
+
+      DescriptorSetSlot *dst = bindings[b];
+
+      if(count == 0 || memcmp(dst, src, sizeof(DescriptorSetSlot) * count) == 0)
+      {
+        src += count;
+        continue;
+      }
+
+      writes.clear();
+      imageInfos.resize(count);
+      bufferInfos.resize(count);
+      texelBufferViews.resize(count);
+
+      for(uint32_t d = 0; d < count; d++)
+      {
+        VkWriteDescriptorSet write = {
+            VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, set, (uint32_t)b, d, 1,
+            bind.descriptorType,
+        };
+
+        const DescriptorSetSlot &slot = src[d];
+
+        bool valid = false;
+
+        switch(bind.descriptorType)
+        {
+          case VK_DESCRIPTOR_TYPE_SAMPLER:
+          case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+          case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+          case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+          case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+          {
+            const bool hasSampler =
+                bind.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER ||
+                bind.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            const bool hasView = bind.descriptorType != VK_DESCRIPTOR_TYPE_SAMPLER;
+
+            VkDescriptorImageInfo &info = imageInfos[d];
+            info.sampler = VK_NULL_HANDLE;
+            info.imageView = VK_NULL_HANDLE;
+            info.imageLayout = slot.imageInfo.imageLayout;
+
+            valid = true;
+
+            if(bind.immutableSampler)
+            {
+              // nothing to write for an immutable sampler on its own
+              if(!hasView)
+                valid = false;
+              else
+                info.sampler = rm->GetCurrentHandle<VkSampler>(bind.immutableSampler[d]);
+            }
+            else if(hasSampler)
+            {
+              valid &= rm->HasCurrentResource(slot.imageInfo.sampler);
+              if(valid)
+                info.sampler = rm->GetCurrentHandle<VkSampler>(slot.imageInfo.sampler);
+            }
+
+            if(hasView)
+            {
+              valid &= rm->HasCurrentResource(slot.imageInfo.imageView);
+              if(valid)
+                info.imageView = rm->GetCurrentHandle<VkImageView>(slot.imageInfo.imageView);
+            }
+
+            write.pImageInfo = &info;
+            break;
+          }
+          case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+          case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+          {
+            valid = rm->HasCurrentResource(slot.texelBufferView);
+            if(valid)
+              texelBufferViews[d] = rm->GetCurrentHandle<VkBufferView>(slot.texelBufferView);
+
+            write.pTexelBufferView = &texelBufferViews[d];
+            break;
+          }
+          case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+          case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+          case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+          case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+          {
+            valid = rm->HasCurrentResource(slot.bufferInfo.buffer);
+            if(valid)
+            {
+              bufferInfos[d].buffer = rm->GetCurrentHandle<VkBuffer>(slot.bufferInfo.buffer);
+              bufferInfos[d].offset = slot.bufferInfo.offset;
+              bufferInfos[d].range = slot.bufferInfo.range;
+            }
+
+            write.pBufferInfo = &bufferInfos[d];
+            break;
+          }
+          default: RDCERR("Unexpected descriptor type %d", bind.descriptorType); break;
+        }
+
+        // descriptors that were never written or refer to destroyed objects are left alone
+        if(valid)
+          writes.push_back(write);
+      }
+
+      // deliberately go through our wrapper implementation, to unwrap the writes
+      if(!writes.empty())
+        vkUpdateDescriptorSets(GetDev(), (uint32_t)writes.size(), writes.data(), 0, NULL);
+
+      memcpy(dst, src, sizeof(DescriptorSetSlot) * count);
+
+      src += count;
+    }
+  }
+}
+
+void WrappedVulkan::FreeReplayCheckpoints()
+{
+  if(m_ReplayCheckpoints.empty())
+    return;
+
+  VkDevice dev = GetDev();
+
+  // make sure nothing is still reading from them
+  FlushQ();
+
+  for(ReplayCheckpoint *checkpoint : m_ReplayCheckpoints)
+  {
+    for(ReplayCheckpoint::MemoryContents &contents : checkpoint->memory)
+    {
+      ObjDisp(dev)->DestroyBuffer(Unwrap(dev), Unwrap(contents.buf), NULL);
+      GetResourceManager()->ReleaseWrappedResource(contents.buf);
+    }
+
+    for(ReplayCheckpoint::ImageContents &contents : checkpoint->images)
+    {
+      ObjDisp(dev)->DestroyImage(Unwrap(dev), Unwrap(contents.copy), NULL);
+      GetResourceManager()->ReleaseWrappedResource(contents.copy);
+    }
+
+    delete checkpoint;
+  }
+
+  m_ReplayCheckpoints.clear();
+  m_ReplayCheckpointBytes = 0;
+
+  FreeAllMemory(MemoryScope::ReplayCheckpoint);
+}
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "3rdparty/catch/catch.hpp"
+
+TEST_CASE("Test replay checkpoint helpers", "[vulkan][checkpoint]")
+{
+  SECTION("RangeEnd")
+  {
+    CHECK(RangeEnd(2, 3) == 5);
+    // a zero count is treated as a single subresource
+    CHECK(RangeEnd(4, 0) == 5);
+    CHECK(RangeEnd(1, VK_REMAINING_MIP_LEVELS) == ~0U);
+    CHECK(RangeEnd(1, VK_REMAINING_ARRAY_LAYERS) == ~0U);
+  };
+
+  SECTION("IntersectRanges")
+  {
+    VkImageSubresourceRange out = {};
+
+    VkImageSubresourceRange a = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 4, 0, 6};
+    VkImageSubresourceRange b = {VK_IMAGE_ASPECT_COLOR_BIT, 2, 4, 3, 1};
+
+    REQUIRE(IntersectRanges(a, b, out));
+    CHECK(out.aspectMask == VK_IMAGE_ASPECT_COLOR_BIT);
+    CHECK(out.baseMipLevel == 2);
+    CHECK(out.levelCount == 2);
+    CHECK(out.baseArrayLayer == 3);
+    CHECK(out.layerCount == 1);
+
+    // remaining counts stay remaining when both ranges are unbounded
+    a = {VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT, 1, VK_REMAINING_MIP_LEVELS, 0,
+         VK_REMAINING_ARRAY_LAYERS};
+    b = {VK_IMAGE_ASPECT_STENCIL_BIT, 0, VK_REMAINING_MIP_LEVELS, 2, VK_REMAINING_ARRAY_LAYERS};
+
+    REQUIRE(IntersectRanges(a, b, out));
+    CHECK(out.aspectMask == VK_IMAGE_ASPECT_STENCIL_BIT);
+    CHECK(out.baseMipLevel == 1);
+    CHECK(out.levelCount == VK_REMAINING_MIP_LEVELS);
+    CHECK(out.baseArrayLayer == 2);
+    CHECK(out.layerCount == VK_REMAINING_ARRAY_LAYERS);
+
+    // disjoint mips, layers or aspects don't intersect
+    a = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 2, 0, 1};
+    b = {VK_IMAGE_ASPECT_COLOR_BIT, 2, 1, 0, 1};
+    CHECK_FALSE(IntersectRanges(a, b, out));
+
+    b = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 1, 1};
+    CHECK_FALSE(IntersectRanges(a, b, out));
+
+    b = {VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1};
+    CHECK_FALSE(IntersectRanges(a, b, out));
+  };
+
+  SECTION("AddLayoutRestore")
+  {
+    ImageLayouts current, target;
+    current.subresourceStates.push_back(
+        {VK_QUEUE_FAMILY_IGNORED,
+         {VK_IMAGE_ASPECT_COLOR_BIT, 0, 2, 0, 1},
+         UNKNOWN_PREV_IMG_LAYOUT,
+         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+    target.subresourceStates.push_back(
+        {VK_QUEUE_FAMILY_IGNORED,
+         {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+         UNKNOWN_PREV_IMG_LAYOUT,
+         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+    target.subresourceStates.push_back(
+        {VK_QUEUE_FAMILY_IGNORED,
+         {VK_IMAGE_ASPECT_COLOR_BIT, 1, 1, 0, 1},
+         UNKNOWN_PREV_IMG_LAYOUT,
+         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+
+    rdcarray<VkImageMemoryBarrier> barriers;
+    AddLayoutRestore(barriers, VK_NULL_HANDLE, current, target);
+
+    // only the first mip changes layout
+    REQUIRE(barriers.size() == 1);
+    CHECK(barriers[0].oldLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    CHECK(barriers[0].newLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    CHECK(barriers[0].subresourceRange.baseMipLevel == 0);
+    CHECK(barriers[0].subresourceRange.levelCount == 1);
+  };
+
+  SECTION("Query chunks disable later checkpoints")
+  {
+    CHECK(WrappedVulkan::ChunkUsesQueries(VulkanChunk::vkCmdBeginQuery));
+    CHECK(WrappedVulkan::ChunkUsesQueries(VulkanChunk::vkCmdWriteTimestamp));
+    CHECK(WrappedVulkan::ChunkUsesQueries(VulkanChunk::vkCmdResetQueryPool));
+    CHECK(WrappedVulkan::ChunkUsesQueries(VulkanChunk::vkResetQueryPoolEXT));
+    CHECK(WrappedVulkan::ChunkUsesQueries(VulkanChunk::vkCmdCopyQueryPoolResults));
+    CHECK(WrappedVulkan::ChunkUsesQueries(VulkanChunk::vkCmdBeginQueryIndexedEXT));
+
+    CHECK_FALSE(WrappedVulkan::ChunkUsesQueries(VulkanChunk::vkCmdDraw));
+    CHECK_FALSE(WrappedVulkan::ChunkUsesQueries(VulkanChunk::vkCmdSetEvent));
+    CHECK_FALSE(WrappedVulkan::ChunkUsesQueries(VulkanChunk::vkQueueSubmit));
+  };
+}
+
+#endif
@@ -312,6 +312,11 @@ bool VkInitParams::IsSupportedVersion(uint64_t ver)
   if(ver == CurrentVersion)
     return true;
 
+  // 0x10 -> 0x11 - large initial contents can be stored once in the blob store section, with only
+  // a reference to them in the frame capture
+  if(ver == 0x10)
+    return true;
+
   // 0xF -> 0x10 - added serialisation of VkPhysicalDeviceDriverPropertiesKHR into enumerated
   // physical devices
   if(ver == 0xF)
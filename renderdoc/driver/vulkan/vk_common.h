@@ -348,6 +348,7 @@ enum class MemoryScope : uint8_t
   InitialContents,
   First = InitialContents,
   IndirectReadback,
+  ReplayCheckpoint,
   Count,
 };
 
@@ -25,6 +25,7 @@
 #include "vk_core.h"
 #include <ctype.h>
 #include <algorithm>
+#include "common/instrumentation.h"
 #include "driver/ihv/amd/amd_rgp.h"
 #include "driver/shaders/spirv/spirv_compile.h"
 #include "jpeg-compressor/jpge.h"
@@ -1598,6 +1599,8 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
   if(!IsActiveCapturing(m_State))
     return true;
 
+  SCOPED_INSTRUMENT("WrappedVulkan::EndFrameCapture");
+
   VkSwapchainKHR swap = VK_NULL_HANDLE;
 
   if(wnd)
@@ -1686,6 +1689,8 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
 
   if(swaprecord != NULL)
   {
+    SCOPED_INSTRUMENT("Vulkan backbuffer readback");
+
     VkDevice device = GetDev();
     VkCommandBuffer cmd = GetNextCmd();
 
@@ -1900,6 +1905,7 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
     ser.SetChunkMetadataRecording(GetThreadSerialiser().GetChunkMetadataRecording());
 
     ser.SetUserData(GetResourceManager());
+    ser.SetBlobStore(rdc ? rdc->GetBlobStore() : NULL);
 
     {
       SCOPED_SERIALISE_CHUNK(SystemChunk::DriverInit, m_InitParams.GetSerialiseSize());
@@ -1932,6 +1938,8 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
     // pushed to the vector
 
     {
+      SCOPED_INSTRUMENT("Vulkan frame chunks write");
+
       RDCDEBUG("Flushing %u command buffer records to file serialiser",
                (uint32_t)m_CmdBufferRecords.size());
 
@@ -2106,6 +2114,8 @@ void WrappedVulkan::AddResourceCurChunk(ResourceId id)
 
 ReplayStatus WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStructuredBuffers)
 {
+  SCOPED_INSTRUMENT("WrappedVulkan::ReadLogInitialisation");
+
   int sectionIdx = rdc->SectionIndex(SectionType::FrameCapture);
 
   GetResourceManager()->SetState(m_State);
@@ -2125,6 +2135,10 @@ ReplayStatus WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
 
   ser.SetStringDatabase(&m_StringDB);
   ser.SetUserData(GetResourceManager());
+  m_CallstackTable = rdc->GetCallstackTable();
+  ser.SetCallstackTable(m_CallstackTable);
+  ser.SetBlobStore(rdc->GetBlobStore());
+  ser.SetBlobReferences(m_SectionVersion >= 0x11);
 
   ser.ConfigureStructuredExport(&GetChunkName, storeStructuredBuffers);
 
@@ -2202,6 +2216,8 @@ ReplayStatus WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
 
       if(status != ReplayStatus::Succeeded)
         return status;
+
+      CalculateInitialContentsFirstWrites();
     }
 
     chunkInfos[context].total += timer.GetMilliseconds();
@@ -2242,6 +2258,24 @@ ReplayStatus WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
   GetReplay()->WriteFrameRecord().frameInfo.initDataSize =
       chunkInfos[(VulkanChunk)SystemChunk::InitialContents].totalsize;
 
+  rdcarray<ChunkLoadStatistics> &chunkStats =
+      GetReplay()->WriteFrameRecord().frameInfo.chunkLoadStatistics;
+  chunkStats.clear();
+
+  for(auto it = chunkInfos.begin(); it != chunkInfos.end(); ++it)
+  {
+    if(it->second.count == 0)
+      continue;
+
+    ChunkLoadStatistics stats;
+    stats.name = GetChunkName((uint32_t)it->first);
+    stats.chunkID = (uint32_t)it->first;
+    stats.count = (uint32_t)it->second.count;
+    stats.byteSize = it->second.totalsize;
+    stats.durationMS = it->second.total;
+    chunkStats.push_back(stats);
+  }
+
   RDCDEBUG("Allocating %llu persistant bytes of memory for the log.",
            GetReplay()->WriteFrameRecord().frameInfo.persistentSize);
 
@@ -2271,6 +2305,8 @@ ReplayStatus WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
 ReplayStatus WrappedVulkan::ContextReplayLog(CaptureState readType, uint32_t startEventID,
                                              uint32_t endEventID, bool partial)
 {
+  SCOPED_INSTRUMENT("WrappedVulkan::ContextReplayLog");
+
   m_FrameReader->SetOffset(0);
 
   ReadSerialiser ser(m_FrameReader, Ownership::Nothing);
@@ -2283,6 +2319,7 @@ ReplayStatus WrappedVulkan::ContextReplayLog(CaptureState readType, uint32_t sta
 
   if(IsLoading(m_State) || IsStructuredExporting(m_State))
   {
+    ser.SetCallstackTable(m_CallstackTable);
     ser.ConfigureStructuredExport(&GetChunkName, IsStructuredExporting(m_State));
 
     ser.GetStructuredFile().Swap(*m_StructuredFile);
@@ -2293,7 +2330,8 @@ ReplayStatus WrappedVulkan::ContextReplayLog(CaptureState readType, uint32_t sta
   SystemChunk header = ser.ReadChunk<SystemChunk>();
   RDCASSERTEQUAL(header, SystemChunk::CaptureBegin);
 
-  if(partial)
+  // when resuming from a checkpoint the image layouts have already been restored to that point
+  if(partial || m_ResumeCheckpoint)
     ser.SkipCurrentChunk();
   else
     Serialise_BeginCaptureFrame(ser);
@@ -2330,7 +2368,16 @@ ReplayStatus WrappedVulkan::ContextReplayLog(CaptureState readType, uint32_t sta
     // past the command buffer records, so can't
     // skip to the file offset of the first event
     if(partial)
+    {
       ser.GetReader()->SetOffset(ev.fileOffset);
+    }
+    else if(m_ResumeCheckpoint)
+    {
+      // everything before the checkpoint has been restored, including the effects of any command
+      // buffer records, so we can skip straight to it.
+      m_RootEventID = m_ResumeCheckpoint->eventId;
+      ser.GetReader()->SetOffset(m_ResumeCheckpoint->chunkOffset);
+    }
 
     m_FirstEventID = startEventID;
     m_LastEventID = endEventID;
@@ -2418,6 +2465,17 @@ ReplayStatus WrappedVulkan::ContextReplayLog(CaptureState readType, uint32_t sta
          chunktype != VulkanChunk::vkEndCommandBuffer)
         m_BakedCmdBufferInfo[m_LastCmdBufferID].curEventID++;
     }
+
+    // we can't snapshot sparse page tables, so disable checkpoints if the frame rebinds them
+    if(IsLoading(m_State) && chunktype == VulkanChunk::vkQueueBindSparse)
+      m_ReplayCheckpointsUnsupported = true;
+
+    if(IsLoading(m_State) && ChunkUsesQueries(chunktype))
+      m_FirstQueryChunkOffset = RDCMIN(m_FirstQueryChunkOffset, m_CurChunkOffset);
+
+    // after a submission on a full replay, the next root event is a possible checkpoint
+    if(IsActiveReplaying(m_State) && !partial && chunktype == VulkanChunk::vkQueueSubmit)
+      CreateReplayCheckpoint(m_RootEventID, ser.GetReader()->GetOffset());
   }
 
   if(!partial && !IsStructuredExporting(m_State))
@@ -2481,6 +2539,8 @@ ReplayStatus WrappedVulkan::ContextReplayLog(CaptureState readType, uint32_t sta
 
 void WrappedVulkan::ApplyInitialContents()
 {
+  SCOPED_INSTRUMENT("WrappedVulkan::ApplyInitialContents");
+
   VkMarkerRegion region("ApplyInitialContents");
 
   // check that we have all external queues necessary
@@ -2531,6 +2591,8 @@ void WrappedVulkan::ApplyInitialContents()
   // actually apply the initial contents here
   GetResourceManager()->ApplyInitialContents();
 
+  m_InitialContentsDirtyEventID = 0;
+
   // likewise again to make sure the initial states are all applied
   cmd = GetNextCmd();
 
@@ -3024,6 +3086,8 @@ void WrappedVulkan::AddFrameTerminator(uint64_t queueMarkerTag)
 
 void WrappedVulkan::ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType)
 {
+  SCOPED_INSTRUMENT("WrappedVulkan::ReplayLog");
+
   bool partial = true;
 
   if(startEventID == 0 && (replayType == eReplay_WithoutDraw || replayType == eReplay_Full))
@@ -3032,11 +3096,26 @@ void WrappedVulkan::ReplayLog(uint32_t startEventID, uint32_t endEventID, Replay
     partial = false;
   }
 
+  const ReplayCheckpoint *checkpoint = NULL;
+
   if(!partial)
   {
-    VkMarkerRegion::Begin("!!!!RenderDoc Internal: ApplyInitialContents");
-    ApplyInitialContents();
-    VkMarkerRegion::End();
+    checkpoint = FindReplayCheckpoint(replayType == eReplay_Full ? endEventID
+                                                                 : RDCMAX(1U, endEventID) - 1);
+
+    if(checkpoint)
+    {
+      VkMarkerRegion::Begin(StringFormat::Fmt(
+          "!!!!RenderDoc Internal: ApplyReplayCheckpoint %u", checkpoint->eventId));
+      ApplyReplayCheckpoint(*checkpoint);
+      VkMarkerRegion::End();
+    }
+    else
+    {
+      VkMarkerRegion::Begin("!!!!RenderDoc Internal: ApplyInitialContents");
+      ApplyInitialContents();
+      VkMarkerRegion::End();
+    }
 
     SubmitCmds();
     FlushQ();
@@ -3119,6 +3198,8 @@ void WrappedVulkan::ReplayLog(uint32_t startEventID, uint32_t endEventID, Replay
 
     ReplayStatus status = ReplayStatus::Succeeded;
 
+    m_ResumeCheckpoint = checkpoint;
+
     if(replayType == eReplay_Full)
       status = ContextReplayLog(m_State, startEventID, endEventID, partial);
     else if(replayType == eReplay_WithoutDraw)
@@ -3128,6 +3209,15 @@ void WrappedVulkan::ReplayLog(uint32_t startEventID, uint32_t endEventID, Replay
     else
       RDCFATAL("Unexpected replay type");
 
+    m_ResumeCheckpoint = NULL;
+
+    // callbacks and replaced shaders can write to resources we don't know about, otherwise track
+    // how far we've replayed so the next full replay only re-applies what could have been modified
+    if(m_DrawcallCallback || GetResourceManager()->HasAnyReplacement())
+      m_InitialContentsDirtyEventID = ~0U;
+    else
+      m_InitialContentsDirtyEventID = RDCMAX(m_InitialContentsDirtyEventID, endEventID);
+
     RDCASSERTEQUAL(status, ReplayStatus::Succeeded);
 
     if(m_OutsideCmdBuffer != VK_NULL_HANDLE)
@@ -3647,6 +3737,7 @@ void WrappedVulkan::AddDrawcall(const DrawcallDescription &d, bool hasEvents)
     VulkanDrawcallTreeNode node(draw);
 
     node.resourceUsage.swap(m_BakedCmdBufferInfo[m_LastCmdBufferID].resourceUsage);
+    node.contentWrites.swap(m_BakedCmdBufferInfo[m_LastCmdBufferID].contentWrites);
 
     if(m_LastCmdBufferID != ResourceId())
       AddUsage(node, m_BakedCmdBufferInfo[m_LastCmdBufferID].debugMessages);
@@ -3959,6 +4050,26 @@ const DrawcallDescription *WrappedVulkan::GetDrawcall(uint32_t eventId)
   return m_Drawcalls[eventId];
 }
 
+uint32_t WrappedVulkan::GetSubmissionBaseEvent(uint32_t eventId)
+{
+  for(auto it = m_Partial[Primary].cmdBufferSubmits.begin();
+      it != m_Partial[Primary].cmdBufferSubmits.end(); ++it)
+  {
+    auto info = m_BakedCmdBufferInfo.find(it->first);
+
+    if(info == m_BakedCmdBufferInfo.end())
+      continue;
+
+    for(const Submission &submit : it->second)
+    {
+      if(submit.baseEvent <= eventId && eventId < submit.baseEvent + info->second.eventCount)
+        return submit.baseEvent;
+    }
+  }
+
+  return 0;
+}
+
 #if ENABLED(ENABLE_UNIT_TESTS)
 
 #undef None
@@ -53,7 +53,7 @@ struct VkInitParams
   uint64_t GetSerialiseSize();
 
   // check if a frame capture section version is supported
-  static const uint64_t CurrentVersion = 0x10;
+  static const uint64_t CurrentVersion = 0x11;
   static bool IsSupportedVersion(uint64_t ver);
 };
 
@@ -126,6 +126,10 @@ struct VulkanDrawcallTreeNode
 
   rdcarray<rdcpair<ResourceId, EventUsage>> resourceUsage;
 
+  // writes that aren't shown as resource usage, only used to find the first event that can modify
+  // each resource's contents
+  rdcarray<rdcpair<ResourceId, uint32_t>> contentWrites;
+
   rdcarray<ResourceId> executedCmds;
 
   VulkanDrawcallTreeNode &operator=(const DrawcallDescription &d)
@@ -144,6 +148,13 @@ struct VulkanDrawcallTreeNode
       resourceUsage.back().second.eventId += baseEventID;
     }
 
+    contentWrites.reserve(child.contentWrites.size());
+    for(size_t i = 0; i < child.contentWrites.size(); i++)
+    {
+      contentWrites.push_back(child.contentWrites[i]);
+      contentWrites.back().second += baseEventID;
+    }
+
     children.reserve(child.children.size());
     for(size_t i = 0; i < child.children.size(); i++)
     {
@@ -163,6 +174,9 @@ struct VulkanDrawcallTreeNode
     for(size_t i = 0; i < resourceUsage.size(); i++)
       resourceUsage[i].second.eventId += baseEventID;
 
+    for(size_t i = 0; i < contentWrites.size(); i++)
+      contentWrites[i].second += baseEventID;
+
     for(size_t i = 0; i < children.size(); i++)
       children[i].UpdateIDs(baseEventID, baseDrawID);
   }
@@ -303,6 +317,8 @@ private:
 
   VkInitParams m_InitParams;
   uint64_t m_SectionVersion;
+  // owned by the capture file, so only valid during ReadLogInitialisation
+  CallstackTable *m_CallstackTable = NULL;
 
   StreamReader *m_FrameReader = NULL;
 
@@ -539,6 +555,9 @@ private:
     uint32_t beginChunk = 0;
     uint32_t endChunk = 0;
 
+    // file offset of the vkBeginCommandBuffer chunk, 0 if not recorded in the frame
+    uint64_t beginOffset = 0;
+
     VkCommandBufferLevel level;
     VkCommandBufferUsageFlags beginFlags;
 
@@ -547,6 +566,7 @@ private:
     int markerCount;
 
     rdcarray<rdcpair<ResourceId, EventUsage>> resourceUsage;
+    rdcarray<rdcpair<ResourceId, uint32_t>> contentWrites;
 
     struct CmdBufferState
     {
@@ -687,6 +707,71 @@ private:
   bool ShouldUpdateRenderState(ResourceId cmdid, bool forcePrimary = false);
   VkCommandBuffer RerecordCmdBuf(ResourceId cmdid, PartialReplayIndex partialType = ePartialNum);
 
+  // a snapshot of everything the frame can modify, taken at a root event boundary just after a
+  // queue submit during a full replay. A later full replay to any event after it can restore the
+  // snapshot and continue from eventId instead of replaying from the start of the frame.
+  // All IDs are live IDs.
+  struct ReplayCheckpoint
+  {
+    // the first root event to replay after restoring, and the file offset of its chunk
+    uint32_t eventId = 0;
+    uint64_t chunkOffset = 0;
+
+    // GPU memory used by the snapshot, counted against the replay options' budget
+    uint64_t byteSize = 0;
+
+    std::map<ResourceId, ImageLayouts> imageLayouts;
+
+    // the ranges of each memory object written in the frame, copied into buf
+    struct MemoryContents
+    {
+      ResourceId memory;
+      VkBuffer buf = VK_NULL_HANDLE;
+      // srcOffset is in the memory, dstOffset in buf
+      rdcarray<VkBufferCopy> regions;
+    };
+    rdcarray<MemoryContents> memory;
+
+    // a copy of each image written in the frame, kept in TRANSFER_SRC_OPTIMAL
+    struct ImageContents
+    {
+      ResourceId image;
+      VkImage copy = VK_NULL_HANDLE;
+      rdcarray<VkImageCopy> regions;
+    };
+    rdcarray<ImageContents> images;
+
+    // the bindings of each descriptor set with initial contents, flattened across bindings
+    struct DescSetContents
+    {
+      ResourceId set;
+      rdcarray<DescriptorSetSlot> slots;
+    };
+    rdcarray<DescSetContents> descSets;
+
+    // whether each event in m_ReplayCheckpointEvents was set
+    std::map<ResourceId, bool> events;
+  };
+
+  // sorted by eventId
+  rdcarray<ReplayCheckpoint *> m_ReplayCheckpoints;
+  uint64_t m_ReplayCheckpointBytes = 0;
+  // set when something in the frame can't be snapshotted, such as sparse binding
+  bool m_ReplayCheckpointsUnsupported = false;
+  // query results can't be snapshotted either, so no checkpoint is made after the first chunk in
+  // the frame that begins, ends, writes or resets a query
+  uint64_t m_FirstQueryChunkOffset = ~0ULL;
+  // the events the frame sets with vkCmdSetEvent. These are the only event operations replayed.
+  std::set<ResourceId> m_ReplayCheckpointEvents;
+
+  // the checkpoint the current ContextReplayLog is resuming from, if any
+  const ReplayCheckpoint *m_ResumeCheckpoint = NULL;
+
+  const ReplayCheckpoint *FindReplayCheckpoint(uint32_t lastEventID);
+  bool CanResumeReplayAt(uint32_t eventId, uint64_t chunkOffset);
+  void CreateReplayCheckpoint(uint32_t eventId, uint64_t chunkOffset);
+  void ApplyReplayCheckpoint(const ReplayCheckpoint &checkpoint);
+
   // this info is stored in the record on capture, but we
   // need it on replay too
   struct DescriptorSetInfo
@@ -816,6 +901,7 @@ private:
                                VkDeviceSize memoryOffset, VkMemoryRequirements mrq);
 
   void AddImplicitResolveResourceUsage(uint32_t subpass = 0);
+  void AddImplicitLoadStoreContentWrites();
   rdcarray<VkImageMemoryBarrier> GetImplicitRenderPassBarriers(uint32_t subpass = 0);
   rdcstr MakeRenderPassOpString(bool store);
 
@@ -852,6 +938,17 @@ private:
 
   void ApplyInitialContents();
 
+  // the first event at which the frame can modify each resource with initial contents, by live ID.
+  // Resources that aren't listed are only modified if the capture has no reference information.
+  std::map<ResourceId, uint32_t> m_InitialContentsFirstWrite;
+  // the highest event replayed since initial contents were last applied. 0 if nothing has been
+  // replayed since, ~0U if anything could have been modified.
+  uint32_t m_InitialContentsDirtyEventID = ~0U;
+
+  void MarkInitialContentsWrite(ResourceId id, uint32_t eventId);
+  void MarkCmdContentWrite(ResourceId id);
+  void CalculateInitialContentsFirstWrites();
+
   rdcarray<APIEvent> m_RootEvents, m_Events;
   bool m_AddedDrawcall;
 
@@ -933,6 +1030,7 @@ public:
   APIProperties APIProps;
 
   static rdcstr GetChunkName(uint32_t idx);
+  static bool ChunkUsesQueries(VulkanChunk chunk);
   VulkanResourceManager *GetResourceManager() { return m_ResourceManager; }
   VulkanDebugManager *GetDebugManager() { return m_DebugManager; }
   VulkanShaderCache *GetShaderCache() { return m_ShaderCache; }
@@ -947,6 +1045,7 @@ public:
                               const VkInitialContents *initial);
   void Create_InitialState(ResourceId id, WrappedVkRes *live, bool hasData);
   void Apply_InitialState(WrappedVkRes *live, const VkInitialContents &initial);
+  bool IsInitialContentsDirty(ResourceId id, const VkInitialContents &initial);
 
   void RemapQueueFamilyIndices(uint32_t &srcQueueFamily, uint32_t &dstQueueFamily);
   uint32_t GetQueueFamilyIndex() { return m_QueueFamilyIdx; }
@@ -961,12 +1060,15 @@ public:
   }
   void Shutdown();
   void ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType);
+  void FreeReplayCheckpoints();
   ReplayStatus ReadLogInitialisation(RDCFile *rdc, bool storeStructuredBuffers);
 
   SDFile &GetStructuredFile() { return *m_StructuredFile; }
   const APIEvent &GetEvent(uint32_t eventId);
   uint32_t GetMaxEID() { return m_Events.back().eventId; }
   const DrawcallDescription *GetDrawcall(uint32_t eventId);
+  // the first event of the primary command buffer submission that eventId is in, or 0
+  uint32_t GetSubmissionBaseEvent(uint32_t eventId);
 
   ResourceId GetDescLayoutForDescSet(ResourceId descSet)
   {
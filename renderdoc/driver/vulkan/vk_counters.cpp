@@ -768,7 +768,8 @@ struct VulkanGPUTimerCallback : public VulkanDrawcallCallback
   rdcarray<rdcpair<uint32_t, uint32_t> > m_AliasEvents;
 };
 
-rdcarray<CounterResult> VulkanReplay::FetchCounters(const rdcarray<GPUCounter> &counters)
+rdcarray<CounterResult> VulkanReplay::FetchCounters(const rdcarray<GPUCounter> &counters,
+                                                    uint32_t firstEvent, uint32_t lastEvent)
 {
   uint32_t maxEID = m_pDriver->GetMaxEID();
 
@@ -891,8 +892,9 @@ rdcarray<CounterResult> VulkanReplay::FetchCounters(const rdcarray<GPUCounter> &
 
   VulkanGPUTimerCallback cb(m_pDriver, this, timeStampPool, occlusionPool, pipeStatsPool);
 
-  // replay the events to perform all the queries
-  m_pDriver->ReplayLog(0, maxEID, eReplay_Full);
+  // replay the events to perform all the queries. Events before firstEvent still have to be
+  // replayed, and are timed along with the rest so that resubmitted command buffers can alias.
+  m_pDriver->ReplayLog(0, RDCMIN(maxEID, lastEvent), eReplay_Full);
 
   rdcarray<uint64_t> m_TimeStampData;
   m_TimeStampData.resize(cb.m_Results.size() * 2);
@@ -2695,6 +2695,32 @@ void VulkanReplay::PostVS::Destroy(WrappedVulkan *driver)
 {
   if(XFBQueryPool != VK_NULL_HANDLE)
     driver->vkDestroyQueryPool(driver->GetDev(), XFBQueryPool, NULL);
+
+  if(XFBFramebuffer != VK_NULL_HANDLE)
+    driver->vkDestroyFramebuffer(driver->GetDev(), XFBFramebuffer, NULL);
+
+  if(XFBRenderPass != VK_NULL_HANDLE)
+    driver->vkDestroyRenderPass(driver->GetDev(), XFBRenderPass, NULL);
+
+  for(std::map<ShaderKey, PatchedShader> *shaders : {&MeshOutputShaders, &XFBShaders})
+  {
+    for(auto it = shaders->begin(); it != shaders->end(); ++it)
+    {
+      for(auto pipeIt = it->second.pipes.begin(); pipeIt != it->second.pipes.end(); ++pipeIt)
+      {
+        driver->vkDestroyPipeline(driver->GetDev(), pipeIt->second.pipe, NULL);
+        driver->vkDestroyPipelineLayout(driver->GetDev(), pipeIt->second.layout, NULL);
+        for(VkDescriptorSetLayout layout : pipeIt->second.setLayouts)
+          driver->vkDestroyDescriptorSetLayout(driver->GetDev(), layout, NULL);
+      }
+
+      driver->vkDestroyShaderModule(driver->GetDev(), it->second.module, NULL);
+    }
+
+    shaders->clear();
+  }
+
+  DrawParamsUBO.Destroy();
 }
 
 void VulkanReplay::Feedback::Destroy(WrappedVulkan *driver)
@@ -1053,7 +1053,7 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id,
 
     // not using SERIALISE_ELEMENT_ARRAY so we can deliberately avoid allocation - we serialise
     // directly into upload memory
-    ser.Serialise("Contents"_lit, Contents, ContentsSize, SerialiserFlags::NoFlags);
+    ser.Serialise("Contents"_lit, Contents, ContentsSize, SerialiserFlags::Deduplicate);
 
     // unmap the resource we mapped before - we need to do this on read and on write.
     if(!IsStructuredExporting(m_State) && mappedMem.mem != VK_NULL_HANDLE)
@@ -2290,3 +2290,273 @@ void WrappedVulkan::Apply_InitialState(WrappedVkRes *live, const VkInitialConten
     RDCERR("Unhandled resource type %d", type);
   }
 }
+
+// whether a resource usage can modify the resource's contents. Barriers only count for images,
+// since layout transitions can discard contents.
+static bool IsModifyingUsage(ResourceUsage usage, bool image)
+{
+  switch(usage)
+  {
+    case ResourceUsage::VertexBuffer:
+    case ResourceUsage::IndexBuffer:
+    case ResourceUsage::VS_Constants:
+    case ResourceUsage::HS_Constants:
+    case ResourceUsage::DS_Constants:
+    case ResourceUsage::GS_Constants:
+    case ResourceUsage::PS_Constants:
+    case ResourceUsage::CS_Constants:
+    case ResourceUsage::All_Constants:
+    case ResourceUsage::VS_Resource:
+    case ResourceUsage::HS_Resource:
+    case ResourceUsage::DS_Resource:
+    case ResourceUsage::GS_Resource:
+    case ResourceUsage::PS_Resource:
+    case ResourceUsage::CS_Resource:
+    case ResourceUsage::All_Resource:
+    case ResourceUsage::InputTarget:
+    case ResourceUsage::CopySrc:
+    case ResourceUsage::ResolveSrc:
+    case ResourceUsage::Indirect: return false;
+    case ResourceUsage::Barrier: return image;
+    default: break;
+  }
+
+  return true;
+}
+
+static void MarkFirstWrite(std::map<ResourceId, uint32_t> &firstWrites, ResourceId id,
+                           uint32_t eventId)
+{
+  if(id == ResourceId())
+    return;
+
+  auto it = firstWrites.insert({id, eventId});
+  if(!it.second)
+    it.first->second = RDCMIN(it.first->second, eventId);
+}
+
+typedef rdcarray<rdcpair<ResourceId, ResourceId>> MemoryBindings;
+
+// a write to a buffer or image modifies the memory it's bound to, and in turn any image aliasing
+// that memory. Bindings are pairs of {resource, memory}.
+static void PropagateBoundMemoryWrites(std::map<ResourceId, uint32_t> &firstWrites,
+                                       const MemoryBindings &bufferMemory,
+                                       const MemoryBindings &imageMemory)
+{
+  std::map<ResourceId, uint32_t> resourceWrites = firstWrites;
+
+  for(const MemoryBindings *bindings : {&bufferMemory, &imageMemory})
+  {
+    for(const rdcpair<ResourceId, ResourceId> &bind : *bindings)
+    {
+      auto it = resourceWrites.find(bind.first);
+      if(it != resourceWrites.end())
+        MarkFirstWrite(firstWrites, bind.second, it->second);
+    }
+  }
+
+  for(const rdcpair<ResourceId, ResourceId> &bind : imageMemory)
+  {
+    auto it = firstWrites.find(bind.second);
+    if(it != firstWrites.end())
+      MarkFirstWrite(firstWrites, bind.first, it->second);
+  }
+}
+
+static uint32_t GetFirstWrite(const std::map<ResourceId, uint32_t> &firstWrites, ResourceId id)
+{
+  auto it = firstWrites.find(id);
+  return it == firstWrites.end() ? ~0U : it->second;
+}
+
+void WrappedVulkan::MarkInitialContentsWrite(ResourceId id, uint32_t eventId)
+{
+  MarkFirstWrite(m_InitialContentsFirstWrite, id, eventId);
+}
+
+void WrappedVulkan::MarkCmdContentWrite(ResourceId id)
+{
+  m_BakedCmdBufferInfo[m_LastCmdBufferID].contentWrites.push_back(
+      make_rdcpair(id, m_BakedCmdBufferInfo[m_LastCmdBufferID].curEventID));
+}
+
+void WrappedVulkan::CalculateInitialContentsFirstWrites()
+{
+  VulkanResourceManager *rm = GetResourceManager();
+
+  // root-level writes like memory flushes and descriptor updates, and command writes that aren't
+  // resource usage, were marked while loading. Add everything else written by commands.
+  for(auto it = m_ResourceUses.begin(); it != m_ResourceUses.end(); ++it)
+  {
+    const bool image = m_CreationInfo.m_Image.find(it->first) != m_CreationInfo.m_Image.end();
+
+    for(const EventUsage &usage : it->second)
+    {
+      if(IsModifyingUsage(usage.usage, image))
+        MarkInitialContentsWrite(it->first, usage.eventId);
+    }
+  }
+
+  MemoryBindings bufferMemory, imageMemory;
+
+  for(auto it = m_InitialContentsFirstWrite.begin(); it != m_InitialContentsFirstWrite.end(); ++it)
+  {
+    if(m_CreationInfo.m_Buffer.find(it->first) == m_CreationInfo.m_Buffer.end())
+      continue;
+
+    for(ResourceId mem : GetResourceDesc(rm->GetOriginalID(it->first)).parentResources)
+      bufferMemory.push_back(make_rdcpair(it->first, rm->GetLiveID(mem)));
+  }
+
+  for(auto it = m_ImageLayouts.begin(); it != m_ImageLayouts.end(); ++it)
+    imageMemory.push_back(make_rdcpair(it->first, it->second.boundMemory));
+
+  PropagateBoundMemoryWrites(m_InitialContentsFirstWrite, bufferMemory, imageMemory);
+
+  // the load replayed the whole frame
+  m_InitialContentsDirtyEventID = ~0U;
+}
+
+bool WrappedVulkan::IsInitialContentsDirty(ResourceId id, const VkInitialContents &initial)
+{
+  if(m_InitialContentsDirtyEventID == ~0U)
+    return true;
+
+  VulkanResourceManager *rm = GetResourceManager();
+  ResourceId live = rm->GetLiveID(id);
+
+  uint32_t firstWrite = GetFirstWrite(m_InitialContentsFirstWrite, live);
+
+  // anything written that we didn't see written, such as through a buffer device address, is
+  // assumed to be written at the start of the frame. Likewise if the capture has no reference
+  // information for the memory - in which case it's reset in full every time.
+  auto untrackedMemoryWrite = [this, rm](ResourceId mem) {
+    if(mem == ResourceId())
+      return false;
+
+    MemRefs *memRefs = rm->FindMemRefs(rm->GetOriginalID(mem));
+
+    if(!memRefs)
+      return true;
+
+    if(m_InitialContentsFirstWrite.find(mem) != m_InitialContentsFirstWrite.end())
+      return false;
+
+    for(auto ref = memRefs->rangeRefs.begin(); ref != memRefs->rangeRefs.end(); ref++)
+      if(IncludesWrite(ref->value()))
+        return true;
+
+    return false;
+  };
+
+  if(initial.type == eResImage && initial.tag != VkInitialContents::Sparse)
+  {
+    ImgRefs *imgRefs = rm->FindImgRefs(id);
+
+    if(!imgRefs)
+    {
+      firstWrite = 1;
+    }
+    else if(firstWrite == ~0U)
+    {
+      for(FrameRefType ref : imgRefs->rangeRefs)
+        if(IncludesWrite(ref))
+          firstWrite = 1;
+    }
+
+    auto layouts = m_ImageLayouts.find(live);
+    if(layouts != m_ImageLayouts.end() && untrackedMemoryWrite(layouts->second.boundMemory))
+      firstWrite = 1;
+  }
+  else if(initial.type == eResDeviceMemory)
+  {
+    if(untrackedMemoryWrite(live))
+      firstWrite = 1;
+  }
+  else if(initial.type != eResDescriptorSet)
+  {
+    // sparse resources have their page tables restored unconditionally
+    firstWrite = 1;
+  }
+
+  return firstWrite <= m_InitialContentsDirtyEventID;
+}
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "3rdparty/catch/catch.hpp"
+
+TEST_CASE("Test initial contents first writes", "[vulkan][initstate]")
+{
+  ResourceId mem = ResourceIDGen::GetNewUniqueID();
+  ResourceId otherMem = ResourceIDGen::GetNewUniqueID();
+  ResourceId buf = ResourceIDGen::GetNewUniqueID();
+  ResourceId img = ResourceIDGen::GetNewUniqueID();
+  ResourceId aliasImg = ResourceIDGen::GetNewUniqueID();
+  ResourceId otherImg = ResourceIDGen::GetNewUniqueID();
+  ResourceId set = ResourceIDGen::GetNewUniqueID();
+
+  MemoryBindings bufferMemory = {make_rdcpair(buf, mem)};
+  MemoryBindings imageMemory = {
+      make_rdcpair(img, mem), make_rdcpair(aliasImg, mem), make_rdcpair(otherImg, otherMem),
+  };
+
+  std::map<ResourceId, uint32_t> firstWrites;
+
+  // restores are needed if the resource's first write is at or before the last replayed event
+  auto restored = [&firstWrites](ResourceId id, uint32_t replayedEventID) {
+    return GetFirstWrite(firstWrites, id) <= replayedEventID;
+  };
+
+  SECTION("Earliest write is kept")
+  {
+    MarkFirstWrite(firstWrites, set, 20);
+    MarkFirstWrite(firstWrites, set, 8);
+    MarkFirstWrite(firstWrites, set, 12);
+    MarkFirstWrite(firstWrites, ResourceId(), 1);
+
+    CHECK(GetFirstWrite(firstWrites, set) == 8);
+    CHECK(firstWrites.size() == 1);
+
+    CHECK_FALSE(restored(set, 0));
+    CHECK_FALSE(restored(set, 7));
+    CHECK(restored(set, 8));
+    CHECK(restored(set, ~0U));
+  };
+
+  SECTION("Buffer writes mark memory and aliasing images")
+  {
+    MarkFirstWrite(firstWrites, buf, 10);
+
+    PropagateBoundMemoryWrites(firstWrites, bufferMemory, imageMemory);
+
+    CHECK(GetFirstWrite(firstWrites, mem) == 10);
+    CHECK(GetFirstWrite(firstWrites, img) == 10);
+    CHECK(GetFirstWrite(firstWrites, aliasImg) == 10);
+
+    // resources bound elsewhere are never written, so they're skipped however far we replay
+    CHECK(GetFirstWrite(firstWrites, otherMem) == ~0U);
+    CHECK(GetFirstWrite(firstWrites, otherImg) == ~0U);
+    CHECK_FALSE(restored(otherMem, ~0U - 1));
+    CHECK_FALSE(restored(otherImg, ~0U - 1));
+
+    CHECK_FALSE(restored(mem, 9));
+    CHECK(restored(mem, 10));
+    CHECK(restored(aliasImg, 15));
+  };
+
+  SECTION("Image writes mark aliases at the earliest write")
+  {
+    MarkFirstWrite(firstWrites, img, 30);
+    MarkFirstWrite(firstWrites, aliasImg, 5);
+
+    PropagateBoundMemoryWrites(firstWrites, bufferMemory, imageMemory);
+
+    CHECK(GetFirstWrite(firstWrites, mem) == 5);
+    CHECK(GetFirstWrite(firstWrites, img) == 5);
+    CHECK(GetFirstWrite(firstWrites, aliasImg) == 5);
+    CHECK(GetFirstWrite(firstWrites, buf) == ~0U);
+  };
+}
+
+#endif
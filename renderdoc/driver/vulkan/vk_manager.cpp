@@ -932,6 +932,10 @@ rdcarray<ResourceId> VulkanResourceManager::InitialContentResources()
 {
   rdcarray<ResourceId> resources =
       ResourceManager<VulkanResourceManagerConfiguration>::InitialContentResources();
+  // skip anything the replay can't have modified since initial contents were last applied
+  resources.removeIf([this](const ResourceId &id) {
+    return !m_Core->IsInitialContentsDirty(id, m_InitialContents[id].data);
+  });
   std::sort(resources.begin(), resources.end(), [this](ResourceId a, ResourceId b) {
     return m_InitialContents[a].data.type < m_InitialContents[b].data.type;
   });
@@ -31,6 +31,7 @@
 #include "vk_debug.h"
 #include "vk_replay.h"
 #include "vk_shader_cache.h"
+#include "zstd/xxhash.h"
 
 #undef None
 
@@ -49,12 +50,29 @@ static const uint32_t MeshOutputTBufferArraySize = 16;
 // 2 = float vbuffers
 // 3 = uint vbuffers
 // 4 = sint vbuffers
-static const uint32_t MeshOutputReservedBindings = 5;
+// 5 = draw parameters
+static const uint32_t MeshOutputReservedBindings = 6;
+
+// minimum size of each buffer that mesh output is sub-allocated from
+static const VkDeviceSize MeshOutputArenaSize = 16 * 1024 * 1024;
+
+// the draw parameters are read by the patched shader from a uniform buffer rather than being baked
+// in, so the patched shader and its pipeline only depend on the shader and vertex input layout and
+// can be cached and shared between draws. This matches the layout declared in the shader.
+struct MeshOutputDrawParams
+{
+  uint32_t numVerts;
+  uint32_t numInsts;
+  uint32_t numViews;
+  uint32_t vertexOffset;
+  int32_t baseVertex;
+  uint32_t instanceOffset;
+  uint32_t drawIndex;
+};
 
 static void ConvertToMeshOutputCompute(const ShaderReflection &refl, const SPIRVPatchData &patchData,
                                        const char *entryName, rdcarray<uint32_t> instDivisor,
-                                       const DrawcallDescription *draw, uint32_t numVerts,
-                                       uint32_t numViews, rdcarray<uint32_t> &modSpirv,
+                                       bool indexed, rdcarray<uint32_t> &modSpirv,
                                        uint32_t &bufStride)
 {
   rdcspv::Editor editor(modSpirv);
@@ -542,7 +560,7 @@ static void ConvertToMeshOutputCompute(const ShaderReflection &refl, const SPIRV
   rdcspv::Id idxImagePtr;
   rdcspv::Id idxSampledTypeID;
 
-  if(draw->flags & DrawFlags::Indexed)
+  if(indexed)
   {
     uint32Vec4ID = editor.DeclareType(rdcspv::Vector(rdcspv::scalar<uint32_t>(), 4));
 
@@ -571,13 +589,69 @@ static void ConvertToMeshOutputCompute(const ShaderReflection &refl, const SPIRV
   }
 
   rdcspv::Id outBufferVarID;
-  rdcspv::Id numVertsConstID = editor.AddConstantImmediate<uint32_t>(numVerts);
-  rdcspv::Id numInstConstID = editor.AddConstantImmediate<uint32_t>(draw->numInstances);
-  rdcspv::Id numViewsConstID = editor.AddConstantImmediate<uint32_t>(numViews);
 
-  editor.SetName(numVertsConstID, "numVerts");
-  editor.SetName(numInstConstID, "numInsts");
-  editor.SetName(numViewsConstID, "numViews");
+  // declare the draw parameters buffer. Each member is loaded once at the start of the wrapper
+  // function below, into these IDs
+  rdcspv::Id drawParamsVarID;
+  rdcspv::Id drawParamIDs[7];
+  rdcspv::Id drawParamTypes[7];
+  RDCCOMPILE_ASSERT(sizeof(MeshOutputDrawParams) == sizeof(uint32_t) * ARRAY_COUNT(drawParamIDs),
+                    "Draw parameters struct doesn't match shader declaration");
+  {
+    rdcspv::Id uintID = editor.DeclareType(rdcspv::scalar<uint32_t>());
+    rdcspv::Id sintID = editor.DeclareType(rdcspv::scalar<int32_t>());
+
+    for(uint32_t i = 0; i < ARRAY_COUNT(drawParamIDs); i++)
+    {
+      drawParamIDs[i] = editor.MakeId();
+      drawParamTypes[i] = uintID;
+    }
+
+    drawParamTypes[offsetof(MeshOutputDrawParams, baseVertex) / sizeof(uint32_t)] = sintID;
+
+    // struct drawParams { uint numVerts; ... };
+    rdcspv::Id drawParamsStructID =
+        editor.DeclareStructType(rdcarray<rdcspv::Id>(drawParamTypes, ARRAY_COUNT(drawParamTypes)));
+    editor.SetName(drawParamsStructID, "drawParams_struct");
+
+    for(uint32_t i = 0; i < ARRAY_COUNT(drawParamIDs); i++)
+      editor.AddDecoration(rdcspv::OpMemberDecorate(
+          drawParamsStructID, i,
+          rdcspv::DecorationParam<rdcspv::Decoration::Offset>(i * (uint32_t)sizeof(uint32_t))));
+
+    editor.AddDecoration(rdcspv::OpDecorate(drawParamsStructID, rdcspv::Decoration::Block));
+
+    rdcspv::Id drawParamsPtrID =
+        editor.DeclareType(rdcspv::Pointer(drawParamsStructID, rdcspv::StorageClass::Uniform));
+
+    // drawParams *drawParams;
+    drawParamsVarID = editor.AddVariable(
+        rdcspv::OpVariable(drawParamsPtrID, editor.MakeId(), rdcspv::StorageClass::Uniform));
+    editor.SetName(drawParamsVarID, "drawParams");
+
+    editor.AddDecoration(rdcspv::OpDecorate(
+        drawParamsVarID, rdcspv::DecorationParam<rdcspv::Decoration::DescriptorSet>(0)));
+    editor.AddDecoration(rdcspv::OpDecorate(
+        drawParamsVarID, rdcspv::DecorationParam<rdcspv::Decoration::Binding>(5)));
+  }
+
+  auto drawParam = [&drawParamIDs](size_t offs) { return drawParamIDs[offs / sizeof(uint32_t)]; };
+
+  rdcspv::Id numVertsID = drawParam(offsetof(MeshOutputDrawParams, numVerts));
+  rdcspv::Id numInstID = drawParam(offsetof(MeshOutputDrawParams, numInsts));
+  rdcspv::Id numViewsID = drawParam(offsetof(MeshOutputDrawParams, numViews));
+  rdcspv::Id vertexOffsetID = drawParam(offsetof(MeshOutputDrawParams, vertexOffset));
+  rdcspv::Id baseVertexID = drawParam(offsetof(MeshOutputDrawParams, baseVertex));
+  rdcspv::Id instOffsetID = drawParam(offsetof(MeshOutputDrawParams, instanceOffset));
+  rdcspv::Id drawIndexID = drawParam(offsetof(MeshOutputDrawParams, drawIndex));
+
+  editor.SetName(numVertsID, "numVerts");
+  editor.SetName(numInstID, "numInsts");
+  editor.SetName(numViewsID, "numViews");
+  editor.SetName(vertexOffsetID, "vertexOffset");
+  editor.SetName(baseVertexID, "baseVertex");
+  editor.SetName(instOffsetID, "instanceOffset");
+  editor.SetName(drawIndexID, "drawIndex");
 
   // declare the output buffer and its type
   {
@@ -751,6 +825,16 @@ static void ConvertToMeshOutputCompute(const ShaderReflection &refl, const SPIRV
 
     ops.push_back(rdcspv::OpLabel(editor.MakeId()));
     {
+      // uint numVerts = drawParams.numVerts; etc
+      for(uint32_t i = 0; i < ARRAY_COUNT(drawParamIDs); i++)
+      {
+        rdcspv::Id ptrID = editor.MakeId();
+        ops.push_back(rdcspv::OpAccessChain(
+            editor.DeclareType(rdcspv::Pointer(drawParamTypes[i], rdcspv::StorageClass::Uniform)),
+            ptrID, drawParamsVarID, {editor.AddConstantImmediate<uint32_t>(i)}));
+        ops.push_back(rdcspv::OpLoad(drawParamTypes[i], drawParamIDs[i], ptrID));
+      }
+
       // uint3 invocationVec = gl_GlobalInvocationID;
       rdcspv::Id invocationVector = editor.MakeId();
       ops.push_back(rdcspv::OpLoad(uint32Vec3ID, invocationVector, invocationId));
@@ -766,24 +850,24 @@ static void ConvertToMeshOutputCompute(const ShaderReflection &refl, const SPIRV
 
       // uint viewinst = uintInvocationID / numVerts
       rdcspv::Id viewinstID = editor.MakeId();
-      ops.push_back(rdcspv::OpUDiv(uint32ID, viewinstID, uintInvocationID, numVertsConstID));
+      ops.push_back(rdcspv::OpUDiv(uint32ID, viewinstID, uintInvocationID, numVertsID));
 
       editor.SetName(viewinstID, "viewInstance");
 
       rdcspv::Id instID = editor.MakeId();
-      ops.push_back(rdcspv::OpUMod(uint32ID, instID, viewinstID, numInstConstID));
+      ops.push_back(rdcspv::OpUMod(uint32ID, instID, viewinstID, numInstID));
 
       editor.SetName(instID, "instanceID");
 
       rdcspv::Id viewID = editor.MakeId();
-      ops.push_back(rdcspv::OpUDiv(uint32ID, viewID, viewinstID, numInstConstID));
+      ops.push_back(rdcspv::OpUDiv(uint32ID, viewID, viewinstID, numInstID));
 
       editor.SetName(viewID, "viewID");
 
       // bool inBounds = viewID < numViews;
       rdcspv::Id inBounds = editor.MakeId();
       ops.push_back(rdcspv::OpULessThan(editor.DeclareType(rdcspv::scalar<bool>()), inBounds,
-                                        viewID, numViewsConstID));
+                                        viewID, numViewsID));
 
       // if(inBounds) goto continueLabel; else goto killLabel;
       rdcspv::Id killLabel = editor.MakeId();
@@ -796,7 +880,7 @@ static void ConvertToMeshOutputCompute(const ShaderReflection &refl, const SPIRV
 
       // uint vtx = uintInvocationID % numVerts
       rdcspv::Id vtxID = editor.MakeId();
-      ops.push_back(rdcspv::OpUMod(uint32ID, vtxID, uintInvocationID, numVertsConstID));
+      ops.push_back(rdcspv::OpUMod(uint32ID, vtxID, uintInvocationID, numVertsID));
 
       editor.SetName(vtxID, "vertexID");
 
@@ -804,7 +888,7 @@ static void ConvertToMeshOutputCompute(const ShaderReflection &refl, const SPIRV
 
       // if we're indexing, look up the index buffer. We don't have to apply vertexOffset - it was
       // already applied when we read back and uniq-ified the index buffer.
-      if(draw->flags & DrawFlags::Indexed)
+      if(indexed)
       {
         // sampledimage idximg = *idximgPtr;
         rdcspv::Id loaded = editor.MakeId();
@@ -830,20 +914,18 @@ static void ConvertToMeshOutputCompute(const ShaderReflection &refl, const SPIRV
       rdcspv::Id vertexLookupID = vertexIndexID;
       rdcspv::Id instanceLookupID = instID;
 
-      if(!(draw->flags & DrawFlags::Indexed))
+      if(!indexed)
       {
         // for non-indexed draws, we manually apply the vertex offset, but here after we used the
         // 0-based one to calculate the array slot
         vertexIndexID = editor.MakeId();
-        ops.push_back(rdcspv::OpIAdd(uint32ID, vertexIndexID, vtxID,
-                                     editor.AddConstantImmediate<uint32_t>(draw->vertexOffset)));
+        ops.push_back(rdcspv::OpIAdd(uint32ID, vertexIndexID, vtxID, vertexOffsetID));
       }
       editor.SetName(vertexIndexID, "vertexIndex");
 
       // instIndex = inst + instOffset
       rdcspv::Id instIndexID = editor.MakeId();
-      ops.push_back(rdcspv::OpIAdd(uint32ID, instIndexID, instID,
-                                   editor.AddConstantImmediate<uint32_t>(draw->instanceOffset)));
+      ops.push_back(rdcspv::OpIAdd(uint32ID, instIndexID, instID, instOffsetID));
       editor.SetName(instIndexID, "instanceIndex");
 
       rdcspv::Id idxs[64] = {};
@@ -870,23 +952,23 @@ static void ConvertToMeshOutputCompute(const ShaderReflection &refl, const SPIRV
           }
           else if(builtin == ShaderBuiltin::BaseVertex)
           {
-            if(draw->flags & DrawFlags::Indexed)
+            if(indexed)
             {
-              valueID = editor.AddConstantImmediate<uint32_t>(draw->vertexOffset);
+              valueID = vertexOffsetID;
             }
             else
             {
-              valueID = editor.AddConstantImmediate<int32_t>(draw->baseVertex);
+              valueID = baseVertexID;
               compType = CompType::SInt;
             }
           }
           else if(builtin == ShaderBuiltin::BaseInstance)
           {
-            valueID = editor.AddConstantImmediate<uint32_t>(draw->instanceOffset);
+            valueID = instOffsetID;
           }
           else if(builtin == ShaderBuiltin::DrawIndex)
           {
-            valueID = editor.AddConstantImmediate<uint32_t>(draw->drawIndex);
+            valueID = drawIndexID;
           }
 
           if(valueID)
@@ -1155,10 +1237,64 @@ static void ConvertToMeshOutputCompute(const ShaderReflection &refl, const SPIRV
   }
 }
 
+bool VulkanReplay::PostVS::ShaderKey::operator<(const ShaderKey &o) const
+{
+  if(shaderHash != o.shaderHash)
+    return shaderHash < o.shaderHash;
+  if(vertexLayoutHash != o.vertexLayoutHash)
+    return vertexLayoutHash < o.vertexLayoutHash;
+  return indexed < o.indexed;
+}
+
+static uint64_t HashShader(const VulkanCreationInfo::Pipeline::Shader &shader)
+{
+  // the reflection and patch data that the patched shader is generated from are derived from the
+  // module, entry point and specialisation, so those identify it. Modules are immutable so their ID
+  // stands in for the code, which would be expensive to hash on every fetch
+  uint64_t hash = XXH64(&shader.module, sizeof(shader.module), 0);
+  hash = XXH64(shader.entryPoint.c_str(), shader.entryPoint.size(), hash);
+
+  for(const SpecConstant &spec : shader.specialization)
+  {
+    uint64_t specKey[] = {spec.specID, spec.value, spec.dataSize};
+    hash = XXH64(specKey, sizeof(specKey), hash);
+  }
+
+  return hash;
+}
+
+static uint64_t HashVertexLayout(const VulkanCreationInfo::Pipeline &pipeInfo,
+                                 const VkPipelineVertexInputStateCreateInfo *vi)
+{
+  uint64_t hash = XXH64(&vi->vertexAttributeDescriptionCount,
+                        sizeof(vi->vertexAttributeDescriptionCount), 0);
+
+  for(uint32_t i = 0; i < vi->vertexAttributeDescriptionCount; i++)
+  {
+    const VkVertexInputAttributeDescription &attr = vi->pVertexAttributeDescriptions[i];
+    uint32_t attrKey[] = {attr.location, attr.binding, (uint32_t)attr.format};
+    hash = XXH64(attrKey, sizeof(attrKey), hash);
+  }
+
+  for(uint32_t i = 0; i < vi->vertexBindingDescriptionCount; i++)
+  {
+    const VkVertexInputBindingDescription &bind = vi->pVertexBindingDescriptions[i];
+    uint32_t bindKey[] = {bind.binding, bind.stride, (uint32_t)bind.inputRate,
+                          bind.binding < pipeInfo.vertexBindings.size()
+                              ? pipeInfo.vertexBindings[bind.binding].instanceDivisor
+                              : 1U};
+    hash = XXH64(bindKey, sizeof(bindKey), hash);
+  }
+
+  return hash;
+}
+
 void VulkanReplay::ClearPostVSCache()
 {
   VkDevice dev = m_Device;
 
+  // the patched shaders and pipelines are keyed by the shader contents, so they are still valid
+  // after a shader is replaced and are kept until shutdown.
   for(auto it = m_PostVS.Data.begin(); it != m_PostVS.Data.end(); ++it)
   {
     if(it->second.vsout.idxbuf != VK_NULL_HANDLE)
@@ -1166,8 +1302,8 @@ void VulkanReplay::ClearPostVSCache()
       m_pDriver->vkDestroyBuffer(dev, it->second.vsout.idxbuf, NULL);
       m_pDriver->vkFreeMemory(dev, it->second.vsout.idxbufmem, NULL);
     }
-    m_pDriver->vkDestroyBuffer(dev, it->second.vsout.buf, NULL);
-    m_pDriver->vkFreeMemory(dev, it->second.vsout.bufmem, NULL);
+
+    // the vertex output is in one of the arenas freed below
 
     if(it->second.gsout.buf != VK_NULL_HANDLE)
     {
@@ -1177,6 +1313,66 @@ void VulkanReplay::ClearPostVSCache()
   }
 
   m_PostVS.Data.clear();
+
+  for(const PostVS::Arena &arena : m_PostVS.OutputArenas)
+  {
+    m_pDriver->vkDestroyBuffer(dev, arena.buf, NULL);
+    m_pDriver->vkFreeMemory(dev, arena.mem, NULL);
+  }
+
+  m_PostVS.OutputArenas.clear();
+
+  m_pDriver->vkDestroyBuffer(dev, m_PostVS.Readback.buf, NULL);
+  m_pDriver->vkFreeMemory(dev, m_PostVS.Readback.mem, NULL);
+
+  m_PostVS.Readback = PostVS::Arena();
+}
+
+bool VulkanReplay::CreatePostVSArena(VkDeviceSize size, bool readback, VkBuffer &buf,
+                                     VkDeviceMemory &mem)
+{
+  VkDevice dev = m_Device;
+
+  VkBufferCreateInfo bufInfo = {VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+  bufInfo.size = size;
+
+  if(readback)
+    bufInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+  else
+    bufInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+
+  VkResult vkr = m_pDriver->vkCreateBuffer(dev, &bufInfo, NULL, &buf);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  VkMemoryRequirements mrq = {0};
+  m_pDriver->vkGetBufferMemoryRequirements(dev, buf, &mrq);
+
+  VkMemoryAllocateInfo allocInfo = {
+      VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, mrq.size,
+      readback ? m_pDriver->GetReadbackMemoryIndex(mrq.memoryTypeBits)
+               : m_pDriver->GetGPULocalMemoryIndex(mrq.memoryTypeBits),
+  };
+
+  vkr = m_pDriver->vkAllocateMemory(dev, &allocInfo, NULL, &mem);
+
+  if(vkr == VK_ERROR_OUT_OF_DEVICE_MEMORY || vkr == VK_ERROR_OUT_OF_HOST_MEMORY)
+  {
+    RDCWARN("Failed to allocate %llu bytes for %s", mrq.size,
+            readback ? "readback memory" : "output vertex SSBO");
+
+    m_pDriver->vkDestroyBuffer(dev, buf, NULL);
+    buf = VK_NULL_HANDLE;
+    mem = VK_NULL_HANDLE;
+    return false;
+  }
+
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  vkr = m_pDriver->vkBindBufferMemory(dev, buf, mem, 0);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  return true;
 }
 
 void VulkanReplay::PatchReservedDescriptors(const VulkanStatePipeline &pipe,
@@ -1185,7 +1381,7 @@ void VulkanReplay::PatchReservedDescriptors(const VulkanStatePipeline &pipe,
                                             rdcarray<VkDescriptorSet> &descSets,
                                             VkShaderStageFlagBits patchedBindingStage,
                                             const VkDescriptorSetLayoutBinding *newBindings,
-                                            size_t newBindingsCount)
+                                            size_t newBindingsCount, uint64_t *layoutHash)
 {
   VkDevice dev = m_Device;
   VulkanCreationInfo &creationInfo = m_pDriver->m_CreationInfo;
@@ -1237,6 +1433,9 @@ void VulkanReplay::PatchReservedDescriptors(const VulkanStatePipeline &pipe,
     if(setLayouts.empty())
       setLayouts.resize(1);
 
+    if(layoutHash)
+      *layoutHash = XXH64(&boundDescs, sizeof(boundDescs), setLayouts.size());
+
     for(size_t i = 0; i < setLayouts.size(); i++)
     {
       bool hasImmutableSamplers = false;
@@ -1309,6 +1508,22 @@ void VulkanReplay::PatchReservedDescriptors(const VulkanStatePipeline &pipe,
         }
       }
 
+      // identically defined layouts are compatible, so callers can use the hash to reuse pipelines
+      // created with an earlier set of layouts
+      if(layoutHash)
+      {
+        for(const VkDescriptorSetLayoutBinding &bind : bindings)
+        {
+          uint32_t bindKey[] = {(uint32_t)i, bind.binding, (uint32_t)bind.descriptorType,
+                                bind.descriptorCount, (uint32_t)bind.stageFlags};
+          *layoutHash = XXH64(bindKey, sizeof(bindKey), *layoutHash);
+
+          if(bind.pImmutableSamplers)
+            *layoutHash = XXH64(bind.pImmutableSamplers, sizeof(VkSampler) * bind.descriptorCount,
+                                *layoutHash);
+        }
+      }
+
       VkDescriptorSetLayoutCreateInfo descsetLayoutInfo = {
           VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
           NULL,
@@ -1548,7 +1763,7 @@ void VulkanReplay::FetchVSOut(uint32_t eventId)
   rdcarray<VkDescriptorSetLayout> setLayouts;
   rdcarray<VkDescriptorSet> descSets;
 
-  VkPipelineLayout pipeLayout;
+  VkPipelineLayout pipeLayout = VK_NULL_HANDLE;
 
   VkGraphicsPipelineCreateInfo pipeCreateInfo;
 
@@ -1574,6 +1789,9 @@ void VulkanReplay::FetchVSOut(uint32_t eventId)
       {
           4, VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, MeshOutputTBufferArraySize,
           VK_SHADER_STAGE_COMPUTE_BIT, NULL,
+      },    // draw parameters
+      {
+          5, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, NULL,
       },
   };
   RDCCOMPILE_ASSERT(ARRAY_COUNT(newBindings) == MeshOutputReservedBindings,
@@ -1581,33 +1799,33 @@ void VulkanReplay::FetchVSOut(uint32_t eventId)
 
   // create a duplicate set of descriptor sets, all visible to compute, with bindings shifted to
   // account for new ones we need. This also copies the existing bindings into the new sets
+  uint64_t layoutHash = 0;
   PatchReservedDescriptors(m_pDriver->m_RenderState.graphics, descpool, setLayouts, descSets,
-                           VK_SHADER_STAGE_COMPUTE_BIT, newBindings, ARRAY_COUNT(newBindings));
+                           VK_SHADER_STAGE_COMPUTE_BIT, newBindings, ARRAY_COUNT(newBindings),
+                           &layoutHash);
 
-  // create pipeline layout with new descriptor set layouts
-  {
-    rdcarray<VkPushConstantRange> push = creationInfo.m_PipelineLayout[pipeInfo.layout].pushRanges;
-
-    // ensure the push range is visible to the compute shader
-    for(VkPushConstantRange &range : push)
-      range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+  // delete descriptors. Technically we don't have to free the descriptor sets, but our tracking on
+  // replay doesn't handle destroying children of pooled objects so we do it explicitly anyway.
+  // The set layouts are only still here if they weren't handed to a newly cached pipeline.
+  auto releaseDescriptors = [this, dev, &descpool, &descSets, &setLayouts]() {
+    m_pDriver->vkFreeDescriptorSets(dev, descpool, (uint32_t)descSets.size(), descSets.data());
+    m_pDriver->vkDestroyDescriptorPool(dev, descpool, NULL);
+    for(VkDescriptorSetLayout layout : setLayouts)
+      m_pDriver->vkDestroyDescriptorSetLayout(dev, layout, NULL);
+  };
 
-    VkPipelineLayoutCreateInfo pipeLayoutInfo = {
-        VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-        NULL,
-        0,
-        (uint32_t)setLayouts.size(),
-        setLayouts.data(),
-        (uint32_t)push.size(),
-        push.data(),
-    };
+  rdcarray<VkPushConstantRange> push = creationInfo.m_PipelineLayout[pipeInfo.layout].pushRanges;
 
-    vkr = m_pDriver->vkCreatePipelineLayout(dev, &pipeLayoutInfo, NULL, &pipeLayout);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  // ensure the push range is visible to the compute shader
+  for(VkPushConstantRange &range : push)
+  {
+    range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    layoutHash = XXH64(&range, sizeof(range), layoutHash);
   }
 
   VkBuffer meshBuffer = VK_NULL_HANDLE, readbackBuffer = VK_NULL_HANDLE;
-  VkDeviceMemory meshMem = VK_NULL_HANDLE, readbackMem = VK_NULL_HANDLE;
+  VkDeviceMemory readbackMem = VK_NULL_HANDLE;
+  VkDeviceSize meshOffset = 0;
 
   VkBuffer uniqIdxBuf = VK_NULL_HANDLE;
   VkDeviceMemory uniqIdxBufMem = VK_NULL_HANDLE;
@@ -1903,7 +2121,6 @@ void VulkanReplay::FetchVSOut(uint32_t eventId)
   }
 
   uint32_t bufStride = 0;
-  rdcarray<uint32_t> modSpirv = moduleInfo.spirv.GetSPIRV();
 
   struct CompactedAttrBuffer
   {
@@ -2271,48 +2488,142 @@ void VulkanReplay::FetchVSOut(uint32_t eventId)
     m_pDriver->vkUpdateDescriptorSets(dev, numWrites, descWrites, 0, NULL);
   }
 
-  ConvertToMeshOutputCompute(*refl, *pipeInfo.shaders[0].patchData,
-                             pipeInfo.shaders[0].entryPoint.c_str(), attrInstDivisor, drawcall,
-                             numVerts, numViews, modSpirv, bufStride);
+  // find the original specialization info, the patched pipeline is specialised the same way
+  const VkSpecializationInfo *origSpecInfo = NULL;
+  for(uint32_t s = 0; s < pipeCreateInfo.stageCount; s++)
+  {
+    if(pipeCreateInfo.pStages[s].stage == VK_SHADER_STAGE_VERTEX_BIT)
+    {
+      origSpecInfo = pipeCreateInfo.pStages[s].pSpecializationInfo;
+      break;
+    }
+  }
 
-  VkComputePipelineCreateInfo compPipeInfo = {VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+  PostVS::ShaderKey shadKey;
+  shadKey.shaderHash = HashShader(pipeInfo.shaders[0]);
+  shadKey.vertexLayoutHash = HashVertexLayout(pipeInfo, pipeCreateInfo.pVertexInputState);
+  shadKey.indexed = bool(drawcall->flags & DrawFlags::Indexed);
 
-  // repoint pipeline layout
-  compPipeInfo.layout = pipeLayout;
+  auto shadIt = m_PostVS.MeshOutputShaders.find(shadKey);
+  if(shadIt == m_PostVS.MeshOutputShaders.end())
+  {
+    PostVS::PatchedShader patched;
 
-  // create vertex shader with modified code
-  VkShaderModuleCreateInfo moduleCreateInfo = {
-      VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, NULL,         0,
-      modSpirv.size() * sizeof(uint32_t),          &modSpirv[0],
-  };
+    rdcarray<uint32_t> modSpirv = moduleInfo.spirv.GetSPIRV();
 
-  VkShaderModule module;
-  vkr = m_pDriver->vkCreateShaderModule(dev, &moduleCreateInfo, NULL, &module);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+    ConvertToMeshOutputCompute(*refl, *pipeInfo.shaders[0].patchData,
+                               pipeInfo.shaders[0].entryPoint.c_str(), attrInstDivisor,
+                               shadKey.indexed, modSpirv, patched.stride);
 
-  compPipeInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-  compPipeInfo.stage.module = module;
-  compPipeInfo.stage.pName = PatchedMeshOutputEntryPoint;
-  compPipeInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    // create vertex shader with modified code
+    VkShaderModuleCreateInfo moduleCreateInfo = {
+        VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, NULL,         0,
+        modSpirv.size() * sizeof(uint32_t),          &modSpirv[0],
+    };
 
-  // copy over specialization info
-  for(uint32_t s = 0; s < pipeCreateInfo.stageCount; s++)
+    vkr = m_pDriver->vkCreateShaderModule(dev, &moduleCreateInfo, NULL, &patched.module);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    GetResourceManager()->SetInternalResource(GetResID(patched.module));
+
+    shadIt = m_PostVS.MeshOutputShaders.insert(std::make_pair(shadKey, patched)).first;
+  }
+
+  bufStride = shadIt->second.stride;
+
+  auto pipeIt = shadIt->second.pipes.find(layoutHash);
+  if(pipeIt == shadIt->second.pipes.end())
   {
-    if(pipeCreateInfo.pStages[s].stage == VK_SHADER_STAGE_VERTEX_BIT)
+    PostVS::PatchedShader::Pipeline patchedPipe;
+
+    // create pipeline layout with new descriptor set layouts
+    VkPipelineLayoutCreateInfo pipeLayoutInfo = {
+        VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        NULL,
+        0,
+        (uint32_t)setLayouts.size(),
+        setLayouts.data(),
+        (uint32_t)push.size(),
+        push.data(),
+    };
+
+    vkr = m_pDriver->vkCreatePipelineLayout(dev, &pipeLayoutInfo, NULL, &patchedPipe.layout);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    VkComputePipelineCreateInfo compPipeInfo = {VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+
+    // repoint pipeline layout
+    compPipeInfo.layout = patchedPipe.layout;
+
+    compPipeInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    compPipeInfo.stage.module = shadIt->second.module;
+    compPipeInfo.stage.pName = PatchedMeshOutputEntryPoint;
+    compPipeInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    compPipeInfo.stage.pSpecializationInfo = origSpecInfo;
+
+    // create new pipeline
+    vkr = m_pDriver->vkCreateComputePipelines(m_Device, VK_NULL_HANDLE, 1, &compPipeInfo, NULL,
+                                              &patchedPipe.pipe);
+
+    if(vkr != VK_SUCCESS)
     {
-      compPipeInfo.stage.pSpecializationInfo = pipeCreateInfo.pStages[s].pSpecializationInfo;
-      break;
+      RDCERR("Failed to create patched compute pipeline: %s", ToStr(vkr).c_str());
+
+      m_pDriver->vkDestroyPipelineLayout(dev, patchedPipe.layout, NULL);
+      releaseDescriptors();
+      return;
     }
+
+    // the pipeline layout refers to these set layouts, so the cache takes ownership of them
+    patchedPipe.setLayouts.swap(setLayouts);
+
+    pipeIt = shadIt->second.pipes.insert(std::make_pair(layoutHash, patchedPipe)).first;
   }
 
-  // create new pipeline
-  VkPipeline pipe;
-  vkr = m_pDriver->vkCreateComputePipelines(m_Device, VK_NULL_HANDLE, 1, &compPipeInfo, NULL, &pipe);
+  pipeLayout = pipeIt->second.layout;
+  VkPipeline pipe = pipeIt->second.pipe;
 
-  if(vkr != VK_SUCCESS)
+  // fill out the draw parameters and bind them
   {
-    RDCERR("Failed to create patched compute pipeline: %s", ToStr(vkr).c_str());
-    return;
+    if(m_PostVS.DrawParamsUBO.buf == VK_NULL_HANDLE)
+      m_PostVS.DrawParamsUBO.Create(m_pDriver, dev, sizeof(MeshOutputDrawParams), 128, 0);
+
+    uint32_t paramsOffset = 0;
+    MeshOutputDrawParams *params =
+        (MeshOutputDrawParams *)m_PostVS.DrawParamsUBO.Map(&paramsOffset);
+    if(!params)
+    {
+      releaseDescriptors();
+      return;
+    }
+
+    params->numVerts = numVerts;
+    params->numInsts = drawcall->numInstances;
+    params->numViews = numViews;
+    params->vertexOffset = drawcall->vertexOffset;
+    params->baseVertex = drawcall->baseVertex;
+    params->instanceOffset = drawcall->instanceOffset;
+    params->drawIndex = drawcall->drawIndex;
+
+    m_PostVS.DrawParamsUBO.Unmap();
+
+    VkDescriptorBufferInfo paramsInfo = {m_PostVS.DrawParamsUBO.buf, paramsOffset,
+                                         sizeof(MeshOutputDrawParams)};
+
+    VkWriteDescriptorSet paramsWrite = {
+        VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        NULL,
+        descSets[0],
+        5,
+        0,
+        1,
+        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+        NULL,
+        &paramsInfo,
+        NULL,
+    };
+
+    m_pDriver->vkUpdateDescriptorSets(dev, 1, &paramsWrite, 0, NULL);
   }
 
   // make copy of state to draw from
@@ -2341,62 +2652,53 @@ void VulkanReplay::FetchVSOut(uint32_t eventId)
     // have a compact 0-based index to index into the buffer. We must use
     // index-minIndex which is 0-based but potentially sparse, so this buffer may
     // be more or less wasteful
-    VkBufferCreateInfo bufInfo = {VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
-
-    // set bufSize
-    bufSize = bufInfo.size = uint64_t(numVerts) * uint64_t(drawcall->numInstances) *
-                             uint64_t(bufStride) * uint64_t(numViews);
-
-    bufInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-    bufInfo.usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-    bufInfo.usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-    bufInfo.usage |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-
-    vkr = m_pDriver->vkCreateBuffer(dev, &bufInfo, NULL, &meshBuffer);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-    bufInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-
-    vkr = m_pDriver->vkCreateBuffer(dev, &bufInfo, NULL, &readbackBuffer);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-    VkMemoryRequirements mrq = {0};
-    m_pDriver->vkGetBufferMemoryRequirements(dev, meshBuffer, &mrq);
+    bufSize = uint64_t(numVerts) * uint64_t(drawcall->numInstances) * uint64_t(bufStride) *
+              uint64_t(numViews);
 
-    VkMemoryAllocateInfo allocInfo = {
-        VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, mrq.size,
-        m_pDriver->GetGPULocalMemoryIndex(mrq.memoryTypeBits),
-    };
+    // sub-allocate the output from the current arena, or start a new one if it doesn't fit
+    VkDeviceSize align = RDCMAX(
+        (VkDeviceSize)m_pDriver->GetDeviceProps().limits.minStorageBufferOffsetAlignment,
+        (VkDeviceSize)4);
 
-    vkr = m_pDriver->vkAllocateMemory(dev, &allocInfo, NULL, &meshMem);
+    PostVS::Arena *arena = m_PostVS.OutputArenas.empty() ? NULL : &m_PostVS.OutputArenas.back();
 
-    if(vkr == VK_ERROR_OUT_OF_DEVICE_MEMORY || vkr == VK_ERROR_OUT_OF_HOST_MEMORY)
+    if(arena == NULL || AlignUp(arena->used, align) + bufSize > arena->size)
     {
-      RDCWARN("Failed to allocate %llu bytes for output vertex SSBO", mrq.size);
-      return;
-    }
+      PostVS::Arena newArena;
+      newArena.size = RDCMAX(bufSize, MeshOutputArenaSize);
 
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+      if(!CreatePostVSArena(newArena.size, false, newArena.buf, newArena.mem))
+      {
+        releaseDescriptors();
+        return;
+      }
 
-    vkr = m_pDriver->vkBindBufferMemory(dev, meshBuffer, meshMem, 0);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+      m_PostVS.OutputArenas.push_back(newArena);
+      arena = &m_PostVS.OutputArenas.back();
+    }
 
-    m_pDriver->vkGetBufferMemoryRequirements(dev, readbackBuffer, &mrq);
+    meshBuffer = arena->buf;
+    meshOffset = AlignUp(arena->used, align);
+    arena->used = meshOffset + bufSize;
 
-    allocInfo.memoryTypeIndex = m_pDriver->GetReadbackMemoryIndex(mrq.memoryTypeBits);
+    // the readback buffer is only needed until we've processed the data below
+    if(m_PostVS.Readback.size < bufSize)
+    {
+      m_pDriver->vkDestroyBuffer(dev, m_PostVS.Readback.buf, NULL);
+      m_pDriver->vkFreeMemory(dev, m_PostVS.Readback.mem, NULL);
+      m_PostVS.Readback = PostVS::Arena();
 
-    vkr = m_pDriver->vkAllocateMemory(dev, &allocInfo, NULL, &readbackMem);
+      if(!CreatePostVSArena(bufSize, true, m_PostVS.Readback.buf, m_PostVS.Readback.mem))
+      {
+        releaseDescriptors();
+        return;
+      }
 
-    if(vkr == VK_ERROR_OUT_OF_DEVICE_MEMORY || vkr == VK_ERROR_OUT_OF_HOST_MEMORY)
-    {
-      RDCWARN("Failed to allocate %llu bytes for readback memory", mrq.size);
-      return;
+      m_PostVS.Readback.size = bufSize;
     }
 
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-    vkr = m_pDriver->vkBindBufferMemory(dev, readbackBuffer, readbackMem, 0);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+    readbackBuffer = m_PostVS.Readback.buf;
+    readbackMem = m_PostVS.Readback.mem;
 
     VkCommandBuffer cmd = m_pDriver->GetNextCmd();
 
@@ -2407,7 +2709,7 @@ void VulkanReplay::FetchVSOut(uint32_t eventId)
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
     // fill destination buffer with 0s to ensure unwritten vertices have sane data
-    ObjDisp(dev)->CmdFillBuffer(Unwrap(cmd), Unwrap(meshBuffer), 0, bufInfo.size, 0);
+    ObjDisp(dev)->CmdFillBuffer(Unwrap(cmd), Unwrap(meshBuffer), meshOffset, bufSize, 0);
 
     VkBufferMemoryBarrier meshbufbarrier = {
         VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
@@ -2433,8 +2735,8 @@ void VulkanReplay::FetchVSOut(uint32_t eventId)
     // vkUpdateDescriptorSet desc set to point to buffer
     VkDescriptorBufferInfo fetchdesc = {0};
     fetchdesc.buffer = meshBuffer;
-    fetchdesc.offset = 0;
-    fetchdesc.range = bufInfo.size;
+    fetchdesc.offset = meshOffset;
+    fetchdesc.range = bufSize;
 
     VkWriteDescriptorSet write = {
         VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, descSets[0], 0,   0, 1,
@@ -2452,6 +2754,7 @@ void VulkanReplay::FetchVSOut(uint32_t eventId)
 
     // wait for mesh output writing to finish
     meshbufbarrier.buffer = Unwrap(meshBuffer);
+    meshbufbarrier.offset = meshOffset;
     meshbufbarrier.size = bufSize;
     meshbufbarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
     meshbufbarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
@@ -2459,7 +2762,7 @@ void VulkanReplay::FetchVSOut(uint32_t eventId)
     DoPipelineBarrier(cmd, 1, &meshbufbarrier);
 
     VkBufferCopy bufcopy = {
-        0, 0, bufInfo.size,
+        meshOffset, 0, bufSize,
     };
 
     // copy to readback buffer
@@ -2468,6 +2771,7 @@ void VulkanReplay::FetchVSOut(uint32_t eventId)
     meshbufbarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
     meshbufbarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
     meshbufbarrier.buffer = Unwrap(readbackBuffer);
+    meshbufbarrier.offset = 0;
 
     // wait for copy to finish
     DoPipelineBarrier(cmd, 1, &meshbufbarrier);
@@ -2569,9 +2873,6 @@ void VulkanReplay::FetchVSOut(uint32_t eventId)
   m_pDriver->vkUnmapMemory(m_Device, readbackMem);
 
   // clean up temporary memories
-  m_pDriver->vkDestroyBuffer(m_Device, readbackBuffer, NULL);
-  m_pDriver->vkFreeMemory(m_Device, readbackMem, NULL);
-
   if(uniqIdxBuf != VK_NULL_HANDLE)
   {
     m_pDriver->vkDestroyBuffer(m_Device, uniqIdxBuf, NULL);
@@ -2583,7 +2884,8 @@ void VulkanReplay::FetchVSOut(uint32_t eventId)
   m_PostVS.Data[eventId].vsin.topo = pipeCreateInfo.pInputAssemblyState->topology;
   m_PostVS.Data[eventId].vsout.topo = pipeCreateInfo.pInputAssemblyState->topology;
   m_PostVS.Data[eventId].vsout.buf = meshBuffer;
-  m_PostVS.Data[eventId].vsout.bufmem = meshMem;
+  m_PostVS.Data[eventId].vsout.bufmem = VK_NULL_HANDLE;
+  m_PostVS.Data[eventId].vsout.bufOffset = meshOffset;
 
   m_PostVS.Data[eventId].vsout.baseVertex = 0;
 
@@ -2617,23 +2919,8 @@ void VulkanReplay::FetchVSOut(uint32_t eventId)
   m_PostVS.Data[eventId].vsout.hasPosOut =
       refl->outputSignature[0].systemValue == ShaderBuiltin::Position;
 
-  // delete descriptors. Technically we don't have to free the descriptor sets, but our tracking on
-  // replay doesn't handle destroying children of pooled objects so we do it explicitly anyway.
-  m_pDriver->vkFreeDescriptorSets(dev, descpool, (uint32_t)descSets.size(), descSets.data());
-
-  // delete pipeline layout
-  m_pDriver->vkDestroyPipelineLayout(dev, pipeLayout, NULL);
-
-  m_pDriver->vkDestroyDescriptorPool(dev, descpool, NULL);
-
-  for(VkDescriptorSetLayout layout : setLayouts)
-    m_pDriver->vkDestroyDescriptorSetLayout(dev, layout, NULL);
-
-  // delete pipeline
-  m_pDriver->vkDestroyPipeline(dev, pipe, NULL);
-
-  // delete shader/shader module
-  m_pDriver->vkDestroyShaderModule(dev, module, NULL);
+  // the pipeline, its layout and the shader module are cached
+  releaseDescriptors();
 }
 
 void VulkanReplay::FetchTessGSOut(uint32_t eventId)
@@ -2734,26 +3021,39 @@ void VulkanReplay::FetchTessGSOut(uint32_t eventId)
   const VulkanCreationInfo::ShaderModule &moduleInfo =
       creationInfo.m_ShaderModule[pipeInfo.shaders[stageIndex].module];
 
-  rdcarray<uint32_t> modSpirv = moduleInfo.spirv.GetSPIRV();
+  VkResult vkr = VK_SUCCESS;
+  VkDevice dev = m_Device;
+
+  PostVS::ShaderKey shadKey;
+  shadKey.shaderHash = HashShader(pipeInfo.shaders[stageIndex]);
 
-  uint32_t xfbStride = 0;
+  auto shadIt = m_PostVS.XFBShaders.find(shadKey);
+  if(shadIt == m_PostVS.XFBShaders.end())
+  {
+    PostVS::PatchedShader patched;
 
-  // adds XFB annotations in order of the output signature (with the position first)
-  AddXFBAnnotations(*lastRefl, *pipeInfo.shaders[stageIndex].patchData,
-                    pipeInfo.shaders[stageIndex].entryPoint.c_str(), modSpirv, xfbStride);
+    rdcarray<uint32_t> modSpirv = moduleInfo.spirv.GetSPIRV();
 
-  // create vertex shader with modified code
-  VkShaderModuleCreateInfo moduleCreateInfo = {
-      VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, NULL,         0,
-      modSpirv.size() * sizeof(uint32_t),          &modSpirv[0],
-  };
+    // adds XFB annotations in order of the output signature (with the position first)
+    AddXFBAnnotations(*lastRefl, *pipeInfo.shaders[stageIndex].patchData,
+                      pipeInfo.shaders[stageIndex].entryPoint.c_str(), modSpirv, patched.stride);
 
-  VkResult vkr = VK_SUCCESS;
-  VkDevice dev = m_Device;
+    // create vertex shader with modified code
+    VkShaderModuleCreateInfo moduleCreateInfo = {
+        VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, NULL,         0,
+        modSpirv.size() * sizeof(uint32_t),          &modSpirv[0],
+    };
 
-  VkShaderModule module;
-  vkr = m_pDriver->vkCreateShaderModule(dev, &moduleCreateInfo, NULL, &module);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+    vkr = m_pDriver->vkCreateShaderModule(dev, &moduleCreateInfo, NULL, &patched.module);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    GetResourceManager()->SetInternalResource(GetResID(patched.module));
+
+    shadIt = m_PostVS.XFBShaders.insert(std::make_pair(shadKey, patched)).first;
+  }
+
+  VkShaderModule module = shadIt->second.module;
+  uint32_t xfbStride = shadIt->second.stride;
 
   VkGraphicsPipelineCreateInfo pipeCreateInfo;
 
@@ -2776,24 +3076,39 @@ void VulkanReplay::FetchTessGSOut(uint32_t eventId)
     }
   }
 
-  // create a empty renderpass and framebuffer so we can draw
-  VkFramebuffer fb = VK_NULL_HANDLE;
-  VkRenderPass rp = VK_NULL_HANDLE;
+  // create a empty renderpass and framebuffer so we can draw. These are shared by all fetches
+  if(m_PostVS.XFBRenderPass == VK_NULL_HANDLE)
+  {
+    VkSubpassDescription sub = {0, VK_PIPELINE_BIND_POINT_GRAPHICS};
+    VkRenderPassCreateInfo rpinfo = {
+        VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO, NULL, 0, 0, NULL, 1, &sub,
+    };
 
-  VkSubpassDescription sub = {0, VK_PIPELINE_BIND_POINT_GRAPHICS};
-  VkRenderPassCreateInfo rpinfo = {
-      VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO, NULL, 0, 0, NULL, 1, &sub,
-  };
+    vkr = m_pDriver->vkCreateRenderPass(m_Device, &rpinfo, NULL, &m_PostVS.XFBRenderPass);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
-  vkr = m_pDriver->vkCreateRenderPass(m_Device, &rpinfo, NULL, &rp);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+    GetResourceManager()->SetInternalResource(GetResID(m_PostVS.XFBRenderPass));
 
-  VkFramebufferCreateInfo fbinfo = {
-      VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO, NULL, 0, rp, 0, NULL, 16U, 16U, 1,
-  };
+    VkFramebufferCreateInfo fbinfo = {
+        VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+        NULL,
+        0,
+        m_PostVS.XFBRenderPass,
+        0,
+        NULL,
+        16U,
+        16U,
+        1,
+    };
 
-  vkr = m_pDriver->vkCreateFramebuffer(m_Device, &fbinfo, NULL, &fb);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+    vkr = m_pDriver->vkCreateFramebuffer(m_Device, &fbinfo, NULL, &m_PostVS.XFBFramebuffer);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    GetResourceManager()->SetInternalResource(GetResID(m_PostVS.XFBFramebuffer));
+  }
+
+  VkFramebuffer fb = m_PostVS.XFBFramebuffer;
+  VkRenderPass rp = m_PostVS.XFBRenderPass;
 
   pipeCreateInfo.renderPass = rp;
   pipeCreateInfo.subpass = 0;
@@ -2888,15 +3203,8 @@ void VulkanReplay::FetchTessGSOut(uint32_t eventId)
 
       m_pDriver->vkDestroyBuffer(dev, meshBuffer, NULL);
 
-      // delete framebuffer and renderpass
-      m_pDriver->vkDestroyFramebuffer(dev, fb, NULL);
-      m_pDriver->vkDestroyRenderPass(dev, rp, NULL);
-
-      // delete pipeline
+      // delete pipeline, the shader module, framebuffer and renderpass are cached
       m_pDriver->vkDestroyPipeline(dev, pipe, NULL);
-
-      // delete shader/shader module
-      m_pDriver->vkDestroyShaderModule(dev, module, NULL);
       return;
     }
 
@@ -3170,15 +3478,8 @@ void VulkanReplay::FetchTessGSOut(uint32_t eventId)
 
   m_PostVS.Data[eventId].gsout.hasPosOut = true;
 
-  // delete framebuffer and renderpass
-  m_pDriver->vkDestroyFramebuffer(dev, fb, NULL);
-  m_pDriver->vkDestroyRenderPass(dev, rp, NULL);
-
-  // delete pipeline
+  // delete pipeline, the shader module, framebuffer and renderpass are cached
   m_pDriver->vkDestroyPipeline(dev, pipe, NULL);
-
-  // delete shader/shader module
-  m_pDriver->vkDestroyShaderModule(dev, module, NULL);
 }
 
 void VulkanReplay::InitPostVSBuffers(uint32_t eventId)
@@ -3260,17 +3561,57 @@ struct VulkanInitPostVSCallback : public VulkanDrawcallCallback
 
 void VulkanReplay::InitPostVSBuffers(const rdcarray<uint32_t> &events)
 {
-  // first we must replay up to the first event without replaying it. This ensures any
-  // non-command buffer calls like memory unmaps etc all happen correctly before this
-  // command buffer
-  m_pDriver->ReplayLog(0, events.front(), eReplay_WithoutDraw);
+  // skip any events that are already fetched, if everything is then we don't need to replay at all
+  rdcarray<const DrawcallDescription *> draws;
+  for(uint32_t eid : events)
+  {
+    auto alias = m_PostVS.Alias.find(eid);
+    uint32_t dataEID = alias == m_PostVS.Alias.end() ? eid : alias->second;
+    if(m_PostVS.Data.find(dataEID) != m_PostVS.Data.end())
+      continue;
 
-  VulkanInitPostVSCallback cb(m_pDriver, events);
+    draws.push_back(m_pDriver->GetDrawcall(eid));
+  }
+
+  // the events could come from a whole frame, so split them up into runs that each lie within one
+  // renderpass. The outputs are fetched as each draw is replayed, so everything before the draw
+  // must have been executed. That's only true within a pass, since the commands before it in the
+  // same command buffer haven't been submitted yet.
+  rdcarray<rdcarray<uint32_t>> runs = SplitEventsByPass(draws);
+
+  uint32_t prevSubmission = 0;
+  uint32_t prevEvent = 0;
+
+  for(const rdcarray<uint32_t> &run : runs)
+  {
+    uint32_t submission = m_pDriver->GetSubmissionBaseEvent(run.front());
+
+    if(submission != 0 && submission == prevSubmission)
+    {
+      // we're still in the command buffer we replayed the previous run from, so continue the
+      // partial replay from where it stopped instead of replaying the frame again.
+      if(prevEvent + 1 < run.front())
+        m_pDriver->ReplayLog(prevEvent + 1, run.front(), eReplay_WithoutDraw);
+    }
+    else
+    {
+      // first we must replay up to the first event without replaying it. This ensures any
+      // non-command buffer calls like memory unmaps etc all happen correctly before this
+      // command buffer
+      m_pDriver->ReplayLog(0, run.front(), eReplay_WithoutDraw);
+    }
+
+    {
+      VulkanInitPostVSCallback cb(m_pDriver, run);
+
+      // now we replay the events, which are guaranteed to come from the same command buffer, so
+      // the event IDs are still locally continuous, even if we jump into replaying.
+      m_pDriver->ReplayLog(run.front(), run.back(), eReplay_Full);
+    }
 
-  // now we replay the events, which are guaranteed (because we generated them in
-  // GetPassEvents above) to come from the same command buffer, so the event IDs are
-  // still locally continuous, even if we jump into replaying.
-  m_pDriver->ReplayLog(events.front(), events.back(), eReplay_Full);
+    prevSubmission = submission;
+    prevEvent = run.back();
+  }
 }
 
 MeshFormat VulkanReplay::GetPostVSBuffers(uint32_t eventId, uint32_t instID, uint32_t viewID,
@@ -3325,7 +3666,7 @@ MeshFormat VulkanReplay::GetPostVSBuffers(uint32_t eventId, uint32_t instID, uin
   else
     ret.vertexResourceId = ResourceId();
 
-  ret.vertexByteOffset = s.instStride * (instID + viewID * numInstances);
+  ret.vertexByteOffset = s.bufOffset + s.instStride * (instID + viewID * numInstances);
   ret.vertexByteStride = s.vertStride;
 
   ret.format.compCount = 4;
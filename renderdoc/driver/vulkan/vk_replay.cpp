@@ -3995,6 +3995,9 @@ void VulkanReplay::ReplaceResource(ResourceId from, ResourceId to)
 
   ClearPostVSCache();
   ClearFeedbackCache();
+
+  // checkpoints hold results computed with the old resource
+  m_pDriver->FreeReplayCheckpoints();
 }
 
 void VulkanReplay::RemoveReplacement(ResourceId id)
@@ -4007,6 +4010,7 @@ void VulkanReplay::RemoveReplacement(ResourceId id)
 
     ClearPostVSCache();
     ClearFeedbackCache();
+    m_pDriver->FreeReplayCheckpoints();
   }
 }
 
@@ -162,6 +162,9 @@ struct VulkanPostVSData
 
     int32_t baseVertex;
 
+    // offset of this data in buf, which may be shared with other events
+    VkDeviceSize bufOffset;
+
     uint32_t numVerts;
     uint32_t vertStride;
     uint32_t instStride;
@@ -318,7 +321,8 @@ public:
 
   rdcarray<GPUCounter> EnumerateCounters();
   CounterDescription DescribeCounter(GPUCounter counterID);
-  rdcarray<CounterResult> FetchCounters(const rdcarray<GPUCounter> &counters);
+  rdcarray<CounterResult> FetchCounters(const rdcarray<GPUCounter> &counters, uint32_t firstEvent,
+                                        uint32_t lastEvent);
 
   void PickPixel(ResourceId texture, uint32_t x, uint32_t y, const Subresource &sub,
                  CompType typeCast, float pixel[4]);
@@ -424,9 +428,10 @@ private:
                                 rdcarray<VkDescriptorSet> &descSets,
                                 VkShaderStageFlagBits patchedBindingStage,
                                 const VkDescriptorSetLayoutBinding *newBindings,
-                                size_t newBindingsCount);
+                                size_t newBindingsCount, uint64_t *layoutHash = NULL);
 
   void FetchVSOut(uint32_t eventId);
+  bool CreatePostVSArena(VkDeviceSize size, bool readback, VkBuffer &buf, VkDeviceMemory &mem);
   void FetchTessGSOut(uint32_t eventId);
   void ClearPostVSCache();
 
@@ -683,6 +688,60 @@ private:
     VkQueryPool XFBQueryPool = VK_NULL_HANDLE;
     uint32_t XFBQueryPoolSize = 0;
 
+    // empty renderpass and framebuffer used for every transform feedback fetch
+    VkRenderPass XFBRenderPass = VK_NULL_HANDLE;
+    VkFramebuffer XFBFramebuffer = VK_NULL_HANDLE;
+
+    // patched shaders only depend on the original shader code and the vertex input layout, so
+    // they're cached on a hash of those and shared between all events and pipelines that use them.
+    // The cache is cleared whenever a resource is replaced.
+    struct ShaderKey
+    {
+      // hash of the shader module's ID, entry point and specialisation constants
+      uint64_t shaderHash = 0;
+      // hash of the vertex attributes and bindings. Only used for mesh output shaders
+      uint64_t vertexLayoutHash = 0;
+      bool indexed = false;
+
+      bool operator<(const ShaderKey &o) const;
+    };
+
+    struct PatchedShader
+    {
+      VkShaderModule module = VK_NULL_HANDLE;
+      uint32_t stride = 0;
+
+      // compute pipelines for mesh output, by hash of the pipeline layout they were created with.
+      // The draw parameters come from a uniform buffer so these don't depend on the draw. The set
+      // layouts are kept alive so that sets from identically defined layouts can be bound.
+      struct Pipeline
+      {
+        rdcarray<VkDescriptorSetLayout> setLayouts;
+        VkPipelineLayout layout = VK_NULL_HANDLE;
+        VkPipeline pipe = VK_NULL_HANDLE;
+      };
+      std::map<uint64_t, Pipeline> pipes;
+    };
+
+    std::map<ShaderKey, PatchedShader> MeshOutputShaders;
+    std::map<ShaderKey, PatchedShader> XFBShaders;
+
+    // ring of draw parameters for the mesh output shaders
+    GPUBuffer DrawParamsUBO;
+
+    // mesh output is sub-allocated from shared buffers, so fetching many events doesn't need
+    // allocations for each one. Readback is only used while fetching so it's reused, and grown if
+    // an event needs more space.
+    struct Arena
+    {
+      VkBuffer buf = VK_NULL_HANDLE;
+      VkDeviceMemory mem = VK_NULL_HANDLE;
+      VkDeviceSize size = 0;
+      VkDeviceSize used = 0;
+    };
+    rdcarray<Arena> OutputArenas;
+    Arena Readback;
+
     std::map<uint32_t, VulkanPostVSData> Data;
     std::map<uint32_t, uint32_t> Alias;
   } m_PostVS;
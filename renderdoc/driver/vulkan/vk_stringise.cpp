@@ -221,6 +221,7 @@ rdcstr DoStringise(const MemoryScope &el)
   {
     STRINGISE_ENUM_CLASS(InitialContents);
     STRINGISE_ENUM_CLASS(IndirectReadback);
+    STRINGISE_ENUM_CLASS(ReplayCheckpoint);
   }
   END_ENUM_STRINGISE()
 }
@@ -71,6 +71,35 @@ void WrappedVulkan::AddImplicitResolveResourceUsage(uint32_t subpass)
   }
 }
 
+void WrappedVulkan::AddImplicitLoadStoreContentWrites()
+{
+  ResourceId rp = m_BakedCmdBufferInfo[m_LastCmdBufferID].state.renderPass;
+  const VulkanCreationInfo::RenderPass &rpinfo = m_CreationInfo.m_RenderPass[rp];
+
+  const rdcarray<ResourceId> &fbattachments =
+      m_BakedCmdBufferInfo[m_LastCmdBufferID].state.fbattachments;
+
+  // Beginning a render pass instance can clear or discard attachments, and ending it can discard
+  // them. These happen without any drawcall, so mark them as content writes here.
+  for(size_t i = 0; i < rpinfo.attachments.size() && i < fbattachments.size(); i++)
+  {
+    const VulkanCreationInfo::RenderPass::Attachment &att = rpinfo.attachments[i];
+
+    if(att.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD &&
+       att.stencilLoadOp == VK_ATTACHMENT_LOAD_OP_LOAD &&
+       att.storeOp == VK_ATTACHMENT_STORE_OP_STORE &&
+       att.stencilStoreOp == VK_ATTACHMENT_STORE_OP_STORE &&
+       att.initialLayout != VK_IMAGE_LAYOUT_UNDEFINED)
+      continue;
+
+    auto view = m_CreationInfo.m_ImageView.find(fbattachments[i]);
+    if(view == m_CreationInfo.m_ImageView.end())
+      continue;
+
+    MarkCmdContentWrite(view->second.image);
+  }
+}
+
 rdcarray<VkImageMemoryBarrier> WrappedVulkan::GetImplicitRenderPassBarriers(uint32_t subpass)
 {
   ResourceId rp, fb;
@@ -860,6 +889,7 @@ bool WrappedVulkan::Serialise_vkBeginCommandBuffer(SerialiserType &ser, VkComman
 
         m_BakedCmdBufferInfo[BakedCommandBuffer].beginChunk =
             uint32_t(m_StructuredFile->chunks.size() - 1);
+        m_BakedCmdBufferInfo[BakedCommandBuffer].beginOffset = m_CurChunkOffset;
       }
 
       ObjDisp(device)->BeginCommandBuffer(Unwrap(cmd), &unwrappedBeginInfo);
@@ -1283,6 +1313,8 @@ bool WrappedVulkan::Serialise_vkCmdBeginRenderPass(SerialiserType &ser, VkComman
       GetResourceManager()->RecordBarriers(m_BakedCmdBufferInfo[cmd].imgbarriers, m_ImageLayouts,
                                            (uint32_t)imgBarriers.size(), imgBarriers.data());
 
+      AddImplicitLoadStoreContentWrites();
+
       AddEvent();
       DrawcallDescription draw;
       draw.name =
@@ -1700,6 +1732,8 @@ bool WrappedVulkan::Serialise_vkCmdBeginRenderPass2KHR(SerialiserType &ser,
       GetResourceManager()->RecordBarriers(m_BakedCmdBufferInfo[cmd].imgbarriers, m_ImageLayouts,
                                            (uint32_t)imgBarriers.size(), imgBarriers.data());
 
+      AddImplicitLoadStoreContentWrites();
+
       AddEvent();
       DrawcallDescription draw;
       draw.name =
@@ -2520,6 +2554,9 @@ bool WrappedVulkan::Serialise_vkCmdUpdateBuffer(SerialiserType &ser, VkCommandBu
   {
     m_LastCmdBufferID = GetResourceManager()->GetOriginalID(GetResID(commandBuffer));
 
+    if(IsLoading(m_State))
+      MarkCmdContentWrite(GetResID(destBuffer));
+
     if(IsActiveReplaying(m_State))
     {
       if(InRerecordRange(m_LastCmdBufferID))
@@ -2583,6 +2620,9 @@ bool WrappedVulkan::Serialise_vkCmdFillBuffer(SerialiserType &ser, VkCommandBuff
   {
     m_LastCmdBufferID = GetResourceManager()->GetOriginalID(GetResID(commandBuffer));
 
+    if(IsLoading(m_State))
+      MarkCmdContentWrite(GetResID(destBuffer));
+
     if(IsActiveReplaying(m_State))
     {
       if(InRerecordRange(m_LastCmdBufferID))
@@ -2950,6 +2990,9 @@ bool WrappedVulkan::Serialise_vkCmdCopyQueryPoolResults(
   {
     m_LastCmdBufferID = GetResourceManager()->GetOriginalID(GetResID(commandBuffer));
 
+    if(IsLoading(m_State))
+      MarkCmdContentWrite(GetResID(destBuffer));
+
     if(IsActiveReplaying(m_State))
     {
       if(InRerecordRange(m_LastCmdBufferID))
@@ -4341,6 +4384,9 @@ bool WrappedVulkan::Serialise_vkCmdWriteBufferMarkerAMD(SerialiserType &ser,
   {
     m_LastCmdBufferID = GetResourceManager()->GetOriginalID(GetResID(commandBuffer));
 
+    if(IsLoading(m_State))
+      MarkCmdContentWrite(GetResID(dstBuffer));
+
     if(IsActiveReplaying(m_State))
     {
       if(InRerecordRange(m_LastCmdBufferID))
@@ -4864,6 +4910,15 @@ bool WrappedVulkan::Serialise_vkCmdEndTransformFeedbackEXT(
   {
     m_LastCmdBufferID = GetResourceManager()->GetOriginalID(GetResID(commandBuffer));
 
+    if(IsLoading(m_State))
+    {
+      for(uint32_t i = 0; i < bufferCount; i++)
+      {
+        if(pCounterBuffers && pCounterBuffers[i] != VK_NULL_HANDLE)
+          MarkCmdContentWrite(GetResID(pCounterBuffers[i]));
+      }
+    }
+
     if(IsActiveReplaying(m_State))
     {
       if(InRerecordRange(m_LastCmdBufferID))
@@ -815,6 +815,17 @@ bool WrappedVulkan::Serialise_vkUpdateDescriptorSets(SerialiserType &ser, VkDevi
 
     for(uint32_t i = 0; i < copyCount; i++)
       ReplayDescriptorSetCopy(device, pDescriptorCopies[i]);
+
+    if(IsLoading(m_State))
+    {
+      for(uint32_t i = 0; i < writeCount; i++)
+        if(pDescriptorWrites[i].dstSet != VK_NULL_HANDLE)
+          MarkInitialContentsWrite(GetResID(pDescriptorWrites[i].dstSet), m_RootEventID);
+
+      for(uint32_t i = 0; i < copyCount; i++)
+        if(pDescriptorCopies[i].dstSet != VK_NULL_HANDLE)
+          MarkInitialContentsWrite(GetResID(pDescriptorCopies[i].dstSet), m_RootEventID);
+    }
   }
 
   return true;
@@ -1288,6 +1299,9 @@ bool WrappedVulkan::Serialise_vkUpdateDescriptorSetWithTemplate(
       writeDesc.dstSet = descriptorSet;
       ReplayDescriptorSetWrite(device, writeDesc);
     }
+
+    if(IsLoading(m_State) && descriptorSet != VK_NULL_HANDLE)
+      MarkInitialContentsWrite(GetResID(descriptorSet), m_RootEventID);
   }
 
   return true;
@@ -728,6 +728,9 @@ void WrappedVulkan::InsertDrawsAndRefreshIDs(BakedCmdBufferInfo &cmdBufInfo)
       m_EventFlags[u.eventId] |= PipeRWUsageEventFlags(u.usage);
     }
 
+    for(auto it = n.contentWrites.begin(); it != n.contentWrites.end(); ++it)
+      MarkInitialContentsWrite(it->first, it->second + m_RootEventID);
+
     GetDrawcallStack().back()->children.push_back(n);
 
     // if this is a push marker too, step down the drawcall stack
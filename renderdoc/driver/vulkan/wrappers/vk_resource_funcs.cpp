@@ -642,6 +642,9 @@ bool WrappedVulkan::Serialise_vkUnmapMemory(SerialiserType &ser, VkDevice device
 
   SERIALISE_CHECK_READ_ERRORS();
 
+  if(IsLoading(m_State) && memory != VK_NULL_HANDLE)
+    MarkInitialContentsWrite(GetResID(memory), m_RootEventID);
+
   return true;
 }
 
@@ -768,6 +771,9 @@ bool WrappedVulkan::Serialise_vkFlushMappedMemoryRanges(SerialiserType &ser, VkD
 
   SERIALISE_CHECK_READ_ERRORS();
 
+  if(IsLoading(m_State) && MemRange.memory != VK_NULL_HANDLE)
+    MarkInitialContentsWrite(GetResID(MemRange.memory), m_RootEventID);
+
   // if we need to save off this serialised buffer as reference for future comparison,
   // do so now. See the call to vkFlushMappedMemoryRanges in WrappedVulkan::vkQueueSubmit()
   if(ser.IsWriting() && state->needRefData)
@@ -653,6 +653,9 @@ bool WrappedVulkan::Serialise_vkCmdSetEvent(SerialiserType &ser, VkCommandBuffer
 
     // see top of this file for current event/fence handling
 
+    if(IsLoading(m_State))
+      m_ReplayCheckpointEvents.insert(GetResID(event));
+
     if(IsActiveReplaying(m_State))
     {
       if(InRerecordRange(m_LastCmdBufferID))
@@ -808,6 +811,9 @@ bool WrappedVulkan::Serialise_vkCmdWaitEvents(
 
         RemapQueueFamilyIndices(imgBarriers.back().srcQueueFamilyIndex,
                                 imgBarriers.back().dstQueueFamilyIndex);
+
+        if(IsLoading(m_State))
+          MarkCmdContentWrite(GetResID(pImageMemoryBarriers[i].image));
       }
     }
 
@@ -227,6 +227,253 @@ float ConvertLinearToSRGB(float linear)
   return 1.055f * powf(linear, 1.0f / 2.4f) - 0.055f;
 }
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+
+#define F16C_SUPPORTED OPTION_ON
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define F16C_TARGET
+#else
+#define F16C_TARGET __attribute__((target("f16c")))
+#endif
+
+static bool DetectF16C()
+{
+#if defined(_MSC_VER)
+  int info[4] = {};
+  __cpuid(info, 1);
+
+  const int f16c = (1 << 29);
+  const int osxsave = (1 << 27);
+  const int avx = (1 << 28);
+
+  if((info[2] & (f16c | osxsave | avx)) != (f16c | osxsave | avx))
+    return false;
+
+  // F16C is VEX encoded, so the OS must also be saving the AVX register state
+  return (_xgetbv(0) & 0x6) == 0x6;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+#endif
+}
+
+static bool HasF16C()
+{
+  static bool ret = DetectF16C();
+  return ret;
+}
+
+F16C_TARGET static void ConvertFromHalfF16C(const uint16_t *src, float *dst, size_t count)
+{
+  size_t i = 0;
+  for(; i + 4 <= count; i += 4)
+  {
+    __m128i h = _mm_loadl_epi64((const __m128i *)(src + i));
+    _mm_storeu_ps(dst + i, _mm_cvtph_ps(h));
+  }
+
+  for(; i < count; i++)
+    dst[i] = ConvertFromHalf(src[i]);
+}
+
+F16C_TARGET static void ConvertToHalfF16C(const float *src, uint16_t *dst, size_t count)
+{
+  size_t i = 0;
+  for(; i + 4 <= count; i += 4)
+  {
+    __m128i h = _mm_cvtps_ph(_mm_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storel_epi64((__m128i *)(dst + i), h);
+  }
+
+  for(; i < count; i++)
+    dst[i] = ConvertToHalf(src[i]);
+}
+
+#else
+
+#define F16C_SUPPORTED OPTION_OFF
+
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+
+#define NEON_HALF_SUPPORTED OPTION_ON
+
+#include <arm_neon.h>
+
+#else
+
+#define NEON_HALF_SUPPORTED OPTION_OFF
+
+#endif
+
+static inline float FloatFromBits(uint32_t bits)
+{
+  float ret;
+  memcpy(&ret, &bits, sizeof(ret));
+  return ret;
+}
+
+static inline uint32_t BitsFromFloat(float f)
+{
+  uint32_t ret;
+  memcpy(&ret, &f, sizeof(ret));
+  return ret;
+}
+
+// converts an unsigned small float with a 5-bit exponent (bias 15) and mantissaBits of mantissa
+// to a float. Shifting the exponent and mantissa into place and multiplying by 2^112 rebiases the
+// exponent, and handles subnormals exactly without any branching. Only infinity/NaN needs fixing.
+template <uint32_t mantissaBits>
+static inline float SmallFloatToFloat(uint32_t expMantissa)
+{
+  const uint32_t infExp = 0x1fU << mantissaBits;
+  const float rebias = FloatFromBits((127 + 112) << 23);
+
+  uint32_t shifted = expMantissa << (23 - mantissaBits);
+  float ret = FloatFromBits(shifted) * rebias;
+
+  return expMantissa >= infExp ? FloatFromBits(0x7f800000U | shifted) : ret;
+}
+
+void ConvertFromHalf(const uint16_t *src, float *dst, size_t count)
+{
+#if ENABLED(F16C_SUPPORTED)
+  if(HasF16C())
+  {
+    ConvertFromHalfF16C(src, dst, count);
+    return;
+  }
+#endif
+
+  size_t i = 0;
+
+#if ENABLED(NEON_HALF_SUPPORTED)
+  for(; i + 4 <= count; i += 4)
+    vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src + i))));
+#endif
+
+  for(; i < count; i++)
+  {
+    uint32_t h = src[i];
+    uint32_t sign = (h & 0x8000U) << 16;
+    dst[i] = FloatFromBits(BitsFromFloat(SmallFloatToFloat<10>(h & 0x7fffU)) | sign);
+  }
+}
+
+void ConvertToHalf(const float *src, uint16_t *dst, size_t count)
+{
+#if ENABLED(F16C_SUPPORTED)
+  if(HasF16C())
+  {
+    ConvertToHalfF16C(src, dst, count);
+    return;
+  }
+#endif
+
+  size_t i = 0;
+
+#if ENABLED(NEON_HALF_SUPPORTED)
+  for(; i + 4 <= count; i += 4)
+    vst1_u16(dst + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src + i))));
+#endif
+
+  for(; i < count; i++)
+    dst[i] = ConvertToHalf(src[i]);
+}
+
+void ConvertFromR11G11B10(const uint32_t *src, Vec3f *dst, size_t count)
+{
+  for(size_t i = 0; i < count; i++)
+  {
+    uint32_t data = src[i];
+    dst[i].x = SmallFloatToFloat<6>((data >> 0) & 0x7ff);
+    dst[i].y = SmallFloatToFloat<6>((data >> 11) & 0x7ff);
+    dst[i].z = SmallFloatToFloat<5>((data >> 22) & 0x3ff);
+  }
+}
+
+void ConvertFromSRGB8(const uint8_t *src, float *dst, size_t count)
+{
+  for(size_t i = 0; i < count; i++)
+    dst[i] = SRGB8_lookuptable[src[i]];
+}
+
+// lookup tables over [0, 1] for the curved part of the sRGB transfer functions, linearly
+// interpolated between entries. Values outside that range (including NaNs) or on the linear
+// segment near 0 are calculated exactly.
+struct SRGBTables
+{
+  static const uint32_t Size = 16384;
+
+  float toLinear[Size + 1];
+  float toSRGB[Size + 1];
+
+  SRGBTables()
+  {
+    for(uint32_t i = 0; i <= Size; i++)
+    {
+      float x = float(i) / float(Size);
+      toLinear[i] = ConvertSRGBToLinear(x);
+      toSRGB[i] = ConvertLinearToSRGB(x);
+    }
+  }
+
+  static const SRGBTables &Get()
+  {
+    static SRGBTables tables;
+    return tables;
+  }
+
+  static float Lookup(const float *table, float x)
+  {
+    float idx = x * float(Size);
+    uint32_t base = RDCMIN((uint32_t)idx, Size - 1);
+    float frac = idx - float(base);
+    return table[base] + (table[base + 1] - table[base]) * frac;
+  }
+};
+
+void ConvertSRGBToLinear(const float *src, float *dst, size_t count)
+{
+  const SRGBTables &tables = SRGBTables::Get();
+
+  for(size_t i = 0; i < count; i++)
+  {
+    float x = src[i];
+
+    if(x <= 0.04045f)
+      dst[i] = x / 12.92f;
+    else if(x < 1.0f)
+      dst[i] = SRGBTables::Lookup(tables.toLinear, x);
+    else
+      dst[i] = ConvertSRGBToLinear(x);
+  }
+}
+
+void ConvertLinearToSRGB(const float *src, float *dst, size_t count)
+{
+  const SRGBTables &tables = SRGBTables::Get();
+
+  for(size_t i = 0; i < count; i++)
+  {
+    float x = src[i];
+
+    // the curve is steep just above the linear segment, so use the exact function there to keep the
+    // interpolation error down.
+    if(x <= 0.0031308f)
+      dst[i] = 12.92f * x;
+    else if(x >= 0.01f && x < 1.0f)
+      dst[i] = SRGBTables::Lookup(tables.toSRGB, x);
+    else
+      dst[i] = ConvertLinearToSRGB(x);
+  }
+}
+
 float ConvertComponent(const ResourceFormat &fmt, const byte *data)
 {
   if(fmt.compByteWidth == 8)
@@ -351,11 +598,192 @@ float ConvertComponent(const ResourceFormat &fmt, const byte *data)
   return 0.0f;
 }
 
+template <typename T, typename ConvertFunc>
+static void DecodeRegularPixels(const byte *data, uint32_t pixelStride, uint32_t compCount,
+                                size_t numPixels, float *rgba, ConvertFunc convert)
+{
+  for(size_t i = 0; i < numPixels; i++)
+  {
+    const T *src = (const T *)data;
+    float *dst = rgba + i * 4;
+
+    dst[0] = dst[1] = dst[2] = 0.0f;
+    dst[3] = 1.0f;
+
+    for(uint32_t c = 0; c < compCount; c++)
+      dst[c] = convert(src[c]);
+
+    data += pixelStride;
+  }
+}
+
+bool DecodeFormattedPixels(const ResourceFormat &fmt, const byte *data, uint32_t pixelStride,
+                           size_t numPixels, float *rgba)
+{
+  if(fmt.type == ResourceFormatType::R10G10B10A2)
+  {
+    const bool snorm = (fmt.compType == CompType::SNorm);
+
+    for(size_t i = 0; i < numPixels; i++)
+    {
+      uint32_t packed;
+      memcpy(&packed, data, sizeof(packed));
+
+      Vec4f vec = snorm ? ConvertFromR10G10B10A2SNorm(packed) : ConvertFromR10G10B10A2(packed);
+      memcpy(rgba + i * 4, &vec, sizeof(vec));
+
+      data += pixelStride;
+    }
+  }
+  else if(fmt.type == ResourceFormatType::R11G11B10)
+  {
+    // convert in small batches with the array converter, then expand out to RGBA
+    uint32_t packed[64];
+    Vec3f vecs[64];
+
+    for(size_t base = 0; base < numPixels; base += ARRAY_COUNT(packed))
+    {
+      size_t num = RDCMIN(numPixels - base, ARRAY_COUNT(packed));
+
+      for(size_t i = 0; i < num; i++)
+        memcpy(&packed[i], data + (base + i) * pixelStride, sizeof(uint32_t));
+
+      ConvertFromR11G11B10(packed, vecs, num);
+
+      for(size_t i = 0; i < num; i++)
+      {
+        memcpy(rgba + (base + i) * 4, &vecs[i], sizeof(Vec3f));
+        rgba[(base + i) * 4 + 3] = 1.0f;
+      }
+    }
+  }
+  else if(fmt.type == ResourceFormatType::Regular)
+  {
+    const uint32_t compCount = RDCMIN((uint32_t)fmt.compCount, 4U);
+    const CompType type = fmt.compType;
+
+    bool supported = true;
+
+    if(fmt.compByteWidth == 8)
+    {
+      if(type == CompType::Double || type == CompType::Float)
+        DecodeRegularPixels<double>(data, pixelStride, compCount, numPixels, rgba,
+                                    [](double d) { return float(d); });
+      else if(type == CompType::UInt || type == CompType::UScaled)
+        DecodeRegularPixels<uint64_t>(data, pixelStride, compCount, numPixels, rgba,
+                                      [](uint64_t u) { return float(u); });
+      else if(type == CompType::SInt || type == CompType::SScaled)
+        DecodeRegularPixels<int64_t>(data, pixelStride, compCount, numPixels, rgba,
+                                     [](int64_t i) { return float(i); });
+      else
+        supported = false;
+    }
+    else if(fmt.compByteWidth == 4)
+    {
+      if(type == CompType::Float || type == CompType::Depth)
+        DecodeRegularPixels<float>(data, pixelStride, compCount, numPixels, rgba,
+                                   [](float f) { return f; });
+      else if(type == CompType::UInt || type == CompType::UScaled)
+        DecodeRegularPixels<uint32_t>(data, pixelStride, compCount, numPixels, rgba,
+                                      [](uint32_t u) { return float(u); });
+      else if(type == CompType::SInt || type == CompType::SScaled)
+        DecodeRegularPixels<int32_t>(data, pixelStride, compCount, numPixels, rgba,
+                                     [](int32_t i) { return float(i); });
+      else
+        supported = false;
+    }
+    else if(fmt.compByteWidth == 3 && type == CompType::Depth)
+    {
+      // 24-bit depth is assembled by hand, the same as in ConvertComponent
+      for(size_t i = 0; i < numPixels; i++)
+      {
+        uint32_t depth = uint32_t(data[1]) | uint32_t(data[2]) << 8 | uint32_t(data[3]) << 16;
+
+        float *dst = rgba + i * 4;
+        dst[0] = float(depth) / float(16777215.0f);
+        dst[1] = dst[2] = 0.0f;
+        dst[3] = 1.0f;
+
+        data += pixelStride;
+      }
+    }
+    else if(fmt.compByteWidth == 2)
+    {
+      if(type == CompType::Float && compCount == 4 && pixelStride == 8 &&
+         ((uintptr_t)data & 0x1) == 0)
+        ConvertFromHalf((const uint16_t *)data, rgba, numPixels * 4);
+      else if(type == CompType::Float)
+        DecodeRegularPixels<uint16_t>(data, pixelStride, compCount, numPixels, rgba,
+                                      [](uint16_t u) { return ConvertFromHalf(u); });
+      else if(type == CompType::UInt || type == CompType::UScaled)
+        DecodeRegularPixels<uint16_t>(data, pixelStride, compCount, numPixels, rgba,
+                                      [](uint16_t u) { return float(u); });
+      else if(type == CompType::SInt || type == CompType::SScaled)
+        DecodeRegularPixels<int16_t>(data, pixelStride, compCount, numPixels, rgba,
+                                     [](int16_t i) { return float(i); });
+      else if(type == CompType::UNorm || type == CompType::Depth)
+        DecodeRegularPixels<uint16_t>(data, pixelStride, compCount, numPixels, rgba,
+                                      [](uint16_t u) { return float(u) / 65535.0f; });
+      else if(type == CompType::SNorm)
+        DecodeRegularPixels<int16_t>(data, pixelStride, compCount, numPixels, rgba, [](int16_t i) {
+          return i == -32768 ? -1.0f : float(i) / 32767.0f;
+        });
+      else
+        supported = false;
+    }
+    else if(fmt.compByteWidth == 1)
+    {
+      if(type == CompType::UInt || type == CompType::UScaled)
+        DecodeRegularPixels<uint8_t>(data, pixelStride, compCount, numPixels, rgba,
+                                     [](uint8_t u) { return float(u); });
+      else if(type == CompType::SInt || type == CompType::SScaled)
+        DecodeRegularPixels<int8_t>(data, pixelStride, compCount, numPixels, rgba,
+                                    [](int8_t i) { return float(i); });
+      else if(type == CompType::UNormSRGB)
+        DecodeRegularPixels<uint8_t>(data, pixelStride, compCount, numPixels, rgba,
+                                     [](uint8_t u) { return SRGB8_lookuptable[u]; });
+      else if(type == CompType::UNorm)
+        DecodeRegularPixels<uint8_t>(data, pixelStride, compCount, numPixels, rgba,
+                                     [](uint8_t u) { return float(u) / 255.0f; });
+      else if(type == CompType::SNorm)
+        DecodeRegularPixels<int8_t>(data, pixelStride, compCount, numPixels, rgba, [](int8_t i) {
+          return i == -128 ? -1.0f : float(i) / 127.0f;
+        });
+      else
+        supported = false;
+    }
+    else
+    {
+      supported = false;
+    }
+
+    if(!supported)
+    {
+      RDCERR("Unexpected format to decode from %u %u", fmt.compByteWidth, fmt.compType);
+      return false;
+    }
+  }
+  else
+  {
+    RDCERR("Unexpected format type to decode from %u", fmt.type);
+    return false;
+  }
+
+  if(fmt.BGRAOrder())
+  {
+    for(size_t i = 0; i < numPixels; i++)
+      std::swap(rgba[i * 4 + 0], rgba[i * 4 + 2]);
+  }
+
+  return true;
+}
+
 #if ENABLED(ENABLE_UNIT_TESTS)
 
 #undef None
 
 #include "3rdparty/catch/catch.hpp"
+#include "common/formatting.h"
 
 TEST_CASE("Check format conversion", "[format]")
 {
@@ -663,6 +1091,273 @@ TEST_CASE("Check format conversion", "[format]")
       CHECK(conv == test.second);
     }
   };
+
+  SECTION("Check DecodeFormattedPixels matches per-component conversion")
+  {
+    rdcarray<ResourceFormat> formats;
+
+    const CompType types[] = {
+        CompType::Float, CompType::UNorm, CompType::SNorm, CompType::UInt,
+        CompType::SInt,  CompType::Depth, CompType::UNormSRGB,
+    };
+
+    for(uint8_t width : {1, 2, 4, 8})
+    {
+      for(CompType type : types)
+      {
+        for(uint8_t count = 1; count <= 4; count++)
+        {
+          ResourceFormat fmt;
+          fmt.type = ResourceFormatType::Regular;
+          fmt.compType = type;
+          fmt.compByteWidth = width;
+          fmt.compCount = count;
+          formats.push_back(fmt);
+        }
+      }
+    }
+
+    ResourceFormat bgra;
+    bgra.type = ResourceFormatType::Regular;
+    bgra.compType = CompType::UNorm;
+    bgra.compByteWidth = 1;
+    bgra.compCount = 4;
+    bgra.SetBGRAOrder(true);
+    formats.push_back(bgra);
+
+    ResourceFormat depth24;
+    depth24.type = ResourceFormatType::Regular;
+    depth24.compType = CompType::Depth;
+    depth24.compByteWidth = 3;
+    depth24.compCount = 1;
+    formats.push_back(depth24);
+
+    const size_t numPixels = 67;
+    bytebuf data;
+    data.resize(numPixels * 32);
+    for(byte &b : data)
+      b = byte(rand() & 0xff);
+
+    for(const ResourceFormat &fmt : formats)
+    {
+      // skip combinations that ConvertComponent doesn't support either
+      if((fmt.compByteWidth == 8 && (fmt.compType == CompType::UNorm ||
+                                     fmt.compType == CompType::SNorm ||
+                                     fmt.compType == CompType::Depth)) ||
+         (fmt.compByteWidth == 4 &&
+          (fmt.compType == CompType::UNorm || fmt.compType == CompType::SNorm)) ||
+         (fmt.compType == CompType::UNormSRGB && fmt.compByteWidth != 1) ||
+         (fmt.compByteWidth == 1 &&
+          (fmt.compType == CompType::Depth || fmt.compType == CompType::Float)))
+        continue;
+
+      uint32_t stride = fmt.compByteWidth * fmt.compCount;
+      if(fmt.compByteWidth == 3)
+        stride = 4;
+
+      rdcarray<float> decoded;
+      decoded.resize(numPixels * 4);
+
+      REQUIRE(DecodeFormattedPixels(fmt, data.data(), stride, numPixels, decoded.data()));
+
+      // RGBA16F goes through the array half converter, which differs from the single value
+      // converter in the sign of zero and NaN payloads. It's compared to the single value converter
+      // in its own test below.
+      const bool arrayHalfs =
+          fmt.compType == CompType::Float && fmt.compByteWidth == 2 && fmt.compCount == 4;
+
+      for(size_t p = 0; p < numPixels; p++)
+      {
+        float expected[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+        if(arrayHalfs)
+        {
+          ConvertFromHalf((const uint16_t *)(data.data() + p * stride), expected, 4);
+        }
+        else
+        {
+          for(uint32_t c = 0; c < fmt.compCount; c++)
+            expected[c] = ConvertComponent(fmt, data.data() + p * stride + c * fmt.compByteWidth);
+        }
+
+        if(fmt.BGRAOrder())
+          std::swap(expected[0], expected[2]);
+
+        // compare bitwise so that NaNs from random float data compare equal
+        CHECK(memcmp(expected, decoded.data() + p * 4, sizeof(expected)) == 0);
+      }
+    }
+
+    ResourceFormat packed;
+    packed.type = ResourceFormatType::R10G10B10A2;
+    packed.compType = CompType::UNorm;
+    packed.compByteWidth = 1;
+    packed.compCount = 4;
+
+    rdcarray<float> decoded;
+    decoded.resize(numPixels * 4);
+
+    REQUIRE(DecodeFormattedPixels(packed, data.data(), 4, numPixels, decoded.data()));
+
+    for(size_t p = 0; p < numPixels; p++)
+    {
+      uint32_t u32;
+      memcpy(&u32, data.data() + p * 4, 4);
+      Vec4f expected = ConvertFromR10G10B10A2(u32);
+      CHECK(memcmp(&expected, decoded.data() + p * 4, sizeof(expected)) == 0);
+    }
+
+    packed.type = ResourceFormatType::R11G11B10;
+    packed.compType = CompType::Float;
+    packed.compCount = 3;
+
+    REQUIRE(DecodeFormattedPixels(packed, data.data(), 4, numPixels, decoded.data()));
+
+    for(size_t p = 0; p < numPixels; p++)
+    {
+      uint32_t u32;
+      memcpy(&u32, data.data() + p * 4, 4);
+      Vec3f expected = ConvertFromR11G11B10(u32);
+      CHECK(memcmp(&expected, decoded.data() + p * 4, sizeof(expected)) == 0);
+      CHECK(decoded[p * 4 + 3] == 1.0f);
+    }
+  };
+
+  SECTION("Check array conversions match scalar conversions")
+  {
+    // every half value, with some misalignment so the SIMD tails get exercised
+    rdcarray<uint16_t> halfs;
+    halfs.resize(65536 + 3);
+    for(uint32_t i = 0; i < 65536; i++)
+      halfs[i + 3] = (uint16_t)i;
+
+    rdcarray<float> floats;
+    floats.resize(halfs.size());
+
+    ConvertFromHalf(halfs.data() + 3, floats.data() + 3, 65536);
+
+    for(uint32_t i = 0; i < 65536; i++)
+    {
+      float expected = ConvertFromHalf((uint16_t)i);
+      float actual = floats[i + 3];
+
+      // NaN payloads may differ, and the scalar converter flushes negative zero to positive while
+      // the array converter keeps the sign. Everything else must be bit-identical.
+      if(std::isnan(expected))
+      {
+        CHECK(std::isnan(actual));
+      }
+      else if(expected == 0.0f)
+      {
+        CHECK(actual == 0.0f);
+        CHECK(std::signbit(actual) == ((i & 0x8000) != 0));
+      }
+      else
+      {
+        CHECK(memcmp(&expected, &actual, sizeof(float)) == 0);
+      }
+    }
+
+    // sweep floats across the half range including denormals, rounding cases and overflow
+    floats.clear();
+    for(float f = 1.0e-8f; f < 1.0e6f; f *= 1.0013f)
+    {
+      floats.push_back(f);
+      floats.push_back(-f);
+    }
+    floats.push_back(0.0f);
+    floats.push_back(-0.0f);
+    floats.push_back(INFINITY);
+    floats.push_back(-INFINITY);
+    floats.push_back(NAN);
+
+    halfs.resize(floats.size());
+    ConvertToHalf(floats.data(), halfs.data(), floats.size());
+
+    for(size_t i = 0; i < floats.size(); i++)
+    {
+      if(std::isnan(floats[i]))
+        CHECK(std::isnan(ConvertFromHalf(halfs[i])));
+      else
+        CHECK(halfs[i] == ConvertToHalf(floats[i]));
+    }
+
+    rdcarray<uint32_t> packed;
+    uint32_t seed = 0x12345678;
+    for(uint32_t i = 0; i < 4096; i++)
+    {
+      seed = seed * 1664525U + 1013904223U;
+      packed.push_back(seed);
+    }
+    // explicit inf/nan in each channel
+    packed.push_back(0x7c0U);
+    packed.push_back(0x7c1U);
+    packed.push_back(0x7c0U << 11);
+    packed.push_back(0x7c1U << 11);
+    packed.push_back(0x3e0U << 22);
+    packed.push_back(0x3e1U << 22);
+
+    rdcarray<Vec3f> vecs;
+    vecs.resize(packed.size());
+    ConvertFromR11G11B10(packed.data(), vecs.data(), packed.size());
+
+    for(size_t i = 0; i < packed.size(); i++)
+    {
+      Vec3f expected = ConvertFromR11G11B10(packed[i]);
+      float *e = &expected.x;
+      float *a = &vecs[i].x;
+
+      for(int c = 0; c < 3; c++)
+      {
+        if(std::isnan(e[c]))
+          CHECK(std::isnan(a[c]));
+        else
+          CHECK(e[c] == a[c]);
+      }
+    }
+
+    uint8_t bytes[256];
+    float linear[256];
+    for(int i = 0; i < 256; i++)
+      bytes[i] = (uint8_t)i;
+
+    ConvertFromSRGB8(bytes, linear, 256);
+
+    for(int i = 0; i < 256; i++)
+      CHECK(linear[i] == ConvertFromSRGB8(bytes[i]));
+
+    floats.clear();
+    for(int i = -100; i <= 200000; i++)
+      floats.push_back(float(i) / 100000.0f);
+    floats.push_back(NAN);
+    floats.push_back(INFINITY);
+
+    rdcarray<float> converted;
+    converted.resize(floats.size());
+
+    ConvertSRGBToLinear(floats.data(), converted.data(), floats.size());
+    for(size_t i = 0; i < floats.size(); i++)
+    {
+      float expected = ConvertSRGBToLinear(floats[i]);
+      if(std::isnan(expected))
+        CHECK(std::isnan(converted[i]));
+      else if(std::isinf(expected))
+        CHECK(expected == converted[i]);
+      else
+        CHECK(fabsf(expected - converted[i]) <= 2.0e-6f);
+    }
+
+    ConvertLinearToSRGB(floats.data(), converted.data(), floats.size());
+    for(size_t i = 0; i < floats.size(); i++)
+    {
+      float expected = ConvertLinearToSRGB(floats[i]);
+      if(std::isnan(expected))
+        CHECK(std::isnan(converted[i]));
+      else if(std::isinf(expected))
+        CHECK(expected == converted[i]);
+      else
+        CHECK(fabsf(expected - converted[i]) <= 2.0e-6f);
+    }
+  };
 }
 
 #endif
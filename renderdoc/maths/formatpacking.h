@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 #include "half_convert.h"
 #include "vec.h"
@@ -100,7 +101,30 @@ float ConvertSRGBToLinear(float srgbF);
 Vec4f ConvertSRGBToLinear(Vec4f srgbF);
 float ConvertLinearToSRGB(float linear);
 
+// array versions of the conversions above, for converting many values at once. The half
+// conversions use the hardware instructions (F16C on x86, NEON on ARM64) when the CPU supports
+// them, and everything else is written as branch-free loops the compiler can vectorise. Results
+// are identical to the single value functions, except that NaN payloads may differ and
+// ConvertFromHalf keeps the sign of negative zero where the single value version returns +0.
+void ConvertFromHalf(const uint16_t *src, float *dst, size_t count);
+void ConvertToHalf(const float *src, uint16_t *dst, size_t count);
+void ConvertFromR11G11B10(const uint32_t *src, Vec3f *dst, size_t count);
+void ConvertFromSRGB8(const uint8_t *src, float *dst, size_t count);
+
+// these use an interpolated lookup table instead of powf, and are within 2e-6 of the single value
+// functions.
+void ConvertSRGBToLinear(const float *src, float *dst, size_t count);
+void ConvertLinearToSRGB(const float *src, float *dst, size_t count);
+
 typedef uint8_t byte;
 
 struct ResourceFormat;
 float ConvertComponent(const ResourceFormat &fmt, const byte *data);
+
+// decodes numPixels pixels of fmt, each pixelStride bytes apart, into RGBA floats with 4 floats per
+// pixel. BGRA ordered formats are swizzled to RGBA, and components the format doesn't have are set
+// to 0 (or 1 for alpha). This handles regular formats as well as R10G10B10A2 and R11G11B10, and
+// picks the conversion once up front rather than per component like ConvertComponent. Returns
+// false if the format isn't supported.
+bool DecodeFormattedPixels(const ResourceFormat &fmt, const byte *data, uint32_t pixelStride,
+                           size_t numPixels, float *rgba);
@@ -153,6 +153,9 @@ void DetachThread(ThreadHandle handle);
 void CloseThread(ThreadHandle handle);
 void Sleep(uint32_t milliseconds);
 
+// the number of logical CPU cores available, always at least 1
+uint32_t NumberOfCores();
+
 // kind of windows specific, to handle this case:
 // http://blogs.msdn.com/b/oldnewthing/archive/2013/11/05/10463645.aspx
 void KeepModuleAlive();
@@ -256,11 +259,23 @@ class StackResolver
 public:
   virtual ~StackResolver() {}
   virtual AddressDetails GetAddr(uint64_t addr) = 0;
+
+  // resolves a set of addresses at once, so implementations can batch up any expensive work
+  virtual rdcarray<AddressDetails> GetAddrs(const rdcarray<uint64_t> &addrs)
+  {
+    rdcarray<AddressDetails> ret;
+    ret.reserve(addrs.size());
+    for(uint64_t addr : addrs)
+      ret.push_back(GetAddr(addr));
+    return ret;
+  }
 };
 
 void Init();
 
-Stackwalk *Collect();
+// if fastUnwind is set, platforms that support it use a cheaper cached unwinder which may produce
+// truncated stacks. Others ignore it.
+Stackwalk *Collect(bool fastUnwind);
 Stackwalk *Create();
 
 StackResolver *MakeResolver(byte *moduleDB, size_t DBSize, RENDERDOC_ProgressCallback);
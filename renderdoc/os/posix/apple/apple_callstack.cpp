@@ -57,7 +57,7 @@ void Init()
 {
 }
 
-Stackwalk *Collect()
+Stackwalk *Collect(bool fastUnwind)
 {
   return new AndroidCallstack();
 }
@@ -105,7 +105,7 @@ void Init()
   }
 }
 
-Stackwalk *Collect()
+Stackwalk *Collect(bool fastUnwind)
 {
   return new GgpCallstack();
 }
@@ -25,10 +25,14 @@
 #include <execinfo.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 #include <map>
 #include "common/common.h"
 #include "common/formatting.h"
+#include "common/threading.h"
 #include "os/os_specific.h"
+#include "linux_elf.h"
+#include "linux_unwind.h"
 
 void *renderdocBase = NULL;
 void *renderdocEnd = NULL;
@@ -36,11 +40,11 @@ void *renderdocEnd = NULL;
 class LinuxCallstack : public Callstack::Stackwalk
 {
 public:
-  LinuxCallstack()
+  LinuxCallstack(bool fastUnwind)
   {
     RDCEraseEl(addrs);
     numLevels = 0;
-    Collect();
+    Collect(fastUnwind);
   }
   LinuxCallstack(uint64_t *calls, size_t num) { Set(calls, num); }
   ~LinuxCallstack() {}
@@ -56,11 +60,18 @@ public:
 private:
   LinuxCallstack(const Callstack::Stackwalk &other);
 
-  void Collect()
+  void Collect(bool fastUnwind)
   {
     void *addrs_ptr[ARRAY_COUNT(addrs)];
 
-    int ret = backtrace(addrs_ptr, ARRAY_COUNT(addrs));
+    int ret = -1;
+
+    if(fastUnwind)
+      ret = Unwind::FastBacktrace(addrs_ptr, ARRAY_COUNT(addrs));
+
+    // fall back if the fast unwind failed or couldn't get past the first frame
+    if(ret <= 0)
+      ret = backtrace(addrs_ptr, ARRAY_COUNT(addrs));
 
     numLevels = 0;
     if(ret > 0)
@@ -87,6 +98,8 @@ namespace Callstack
 {
 void Init()
 {
+  Unwind::Init();
+
   // look for our own line
   FILE *f = FileIO::fopen("/proc/self/maps", "r");
 
@@ -109,9 +122,9 @@ void Init()
   }
 }
 
-Stackwalk *Collect()
+Stackwalk *Collect(bool fastUnwind)
 {
-  return new LinuxCallstack();
+  return new LinuxCallstack(fastUnwind);
 }
 
 Stackwalk *Create()
@@ -156,81 +169,172 @@ struct LookupModule
 class LinuxResolver : public Callstack::StackResolver
 {
 public:
-  LinuxResolver(rdcarray<LookupModule> modules) { m_Modules = modules; }
-  Callstack::AddressDetails GetAddr(uint64_t addr)
+  LinuxResolver(rdcarray<LookupModule> modules)
+  {
+    m_Modules = modules;
+    m_Symbols.resize(m_Modules.size());
+    m_SymbolState.resize(m_Modules.size());
+  }
+  ~LinuxResolver()
+  {
+    for(ELF::ModuleSymbols *sym : m_Symbols)
+      delete sym;
+  }
+  Callstack::AddressDetails GetAddr(uint64_t addr) { return GetAddrs({addr})[0]; }
+  rdcarray<Callstack::AddressDetails> GetAddrs(const rdcarray<uint64_t> &addrs)
   {
-    EnsureCached(addr);
+    // find any modules we haven't loaded yet that these addresses need, and load them all at once
+    rdcarray<size_t> toLoad;
+    for(uint64_t addr : addrs)
+    {
+      size_t mod = FindModule(addr);
+      if(mod < m_Modules.size() && m_SymbolState[mod] == SymbolState::NotLoaded &&
+         !toLoad.contains(mod))
+        toLoad.push_back(mod);
+    }
+
+    if(!toLoad.empty())
+      LoadSymbols(toLoad);
+
+    rdcarray<Callstack::AddressDetails> ret;
+    ret.reserve(addrs.size());
+    for(uint64_t addr : addrs)
+    {
+      auto it = m_Cache.find(addr);
+      if(it == m_Cache.end())
+        it = m_Cache.insert(std::make_pair(addr, Resolve(addr))).first;
+      ret.push_back(it->second);
+    }
 
-    return m_Cache[addr];
+    return ret;
   }
 
 private:
-  void EnsureCached(uint64_t addr)
+  enum class SymbolState
   {
-    auto it = m_Cache.insert(
-        std::pair<uint64_t, Callstack::AddressDetails>(addr, Callstack::AddressDetails()));
-    if(!it.second)
-      return;
+    NotLoaded,
+    Loaded,
+    Failed,
+  };
+
+  size_t FindModule(uint64_t addr)
+  {
+    for(size_t i = 0; i < m_Modules.size(); i++)
+      if(addr >= m_Modules[i].base && addr < m_Modules[i].end)
+        return i;
 
-    Callstack::AddressDetails &ret = it.first->second;
+    return ~0U;
+  }
+
+  void LoadSymbols(const rdcarray<size_t> &modules)
+  {
+    // modules are parsed independently, and ones with full debug info can take a while, so spread
+    // them over a few threads.
+    auto load = [this, &modules](uint32_t i) {
+      size_t mod = modules[i];
+
+      ELF::ModuleSymbols *sym = new ELF::ModuleSymbols;
+      if(sym->Load(m_Modules[mod].path))
+      {
+        m_Symbols[mod] = sym;
+        m_SymbolState[mod] = SymbolState::Loaded;
+      }
+      else
+      {
+        delete sym;
+        m_SymbolState[mod] = SymbolState::Failed;
+      }
+    };
+
+    Threading::ParallelFor((uint32_t)modules.size(), RDCMIN(Threading::NumberOfCores(), 8U), load);
+  }
+
+  Callstack::AddressDetails Resolve(uint64_t addr)
+  {
+    Callstack::AddressDetails ret;
 
     ret.filename = "Unknown";
     ret.line = 0;
     ret.function = StringFormat::Fmt("0x%08llx", addr);
 
-    for(size_t i = 0; i < m_Modules.size(); i++)
+    size_t mod = FindModule(addr);
+    if(mod >= m_Modules.size())
+      return ret;
+
+    uint64_t relative = addr - m_Modules[mod].base + m_Modules[mod].offset;
+
+    if(m_SymbolState[mod] == SymbolState::Loaded)
     {
-      if(addr >= m_Modules[i].base && addr < m_Modules[i].end)
-      {
-        uint64_t relative = addr - m_Modules[i].base + m_Modules[i].offset;
-        rdcstr cmd = StringFormat::Fmt("addr2line -fCe \"%s\" 0x%llx", m_Modules[i].path, relative);
+      ELF::ModuleSymbols *sym = m_Symbols[mod];
 
-        FILE *f = ::popen(cmd.c_str(), "r");
+      uint64_t vaddr = sym->FileOffsetToAddress(relative);
 
-        char result[2048] = {0};
-        fread(result, 1, 2047, f);
+      rdcstr function = sym->LookupFunction(vaddr);
+      if(!function.empty())
+        ret.function = function;
 
-        fclose(f);
+      sym->LookupLine(vaddr, ret.filename, ret.line);
+    }
+    else
+    {
+      // fall back to addr2line if we couldn't parse the module ourselves
+      ResolveWithAddr2Line(m_Modules[mod].path, relative, ret);
+    }
 
-        char *line2 = strchr(result, '\n');
-        if(line2)
-        {
-          *line2 = 0;
-          line2++;
-        }
+    return ret;
+  }
 
-        ret.function = result;
+  void ResolveWithAddr2Line(const char *path, uint64_t relative, Callstack::AddressDetails &ret)
+  {
+    rdcstr cmd = StringFormat::Fmt("addr2line -fCe \"%s\" 0x%llx", path, relative);
 
-        if(line2)
-        {
-          char *linenum = line2 + strlen(line2) - 1;
-          while(linenum > line2 && *linenum != ':')
-            linenum--;
+    FILE *f = ::popen(cmd.c_str(), "r");
 
-          ret.line = 0;
+    if(!f)
+      return;
 
-          if(*linenum == ':')
-          {
-            *linenum = 0;
-            linenum++;
+    char result[2048] = {0};
+    fread(result, 1, 2047, f);
 
-            while(*linenum >= '0' && *linenum <= '9')
-            {
-              ret.line *= 10;
-              ret.line += (uint32_t(*linenum) - uint32_t('0'));
-              linenum++;
-            }
-          }
+    ::pclose(f);
 
-          ret.filename = line2;
-        }
+    char *line2 = strchr(result, '\n');
+    if(line2)
+    {
+      *line2 = 0;
+      line2++;
+    }
+
+    ret.function = result;
+
+    if(line2)
+    {
+      char *linenum = line2 + strlen(line2) - 1;
+      while(linenum > line2 && *linenum != ':')
+        linenum--;
+
+      ret.line = 0;
+
+      if(*linenum == ':')
+      {
+        *linenum = 0;
+        linenum++;
 
-        break;
+        while(*linenum >= '0' && *linenum <= '9')
+        {
+          ret.line *= 10;
+          ret.line += (uint32_t(*linenum) - uint32_t('0'));
+          linenum++;
+        }
       }
+
+      ret.filename = line2;
     }
   }
 
   rdcarray<LookupModule> m_Modules;
+  rdcarray<ELF::ModuleSymbols *> m_Symbols;
+  rdcarray<SymbolState> m_SymbolState;
   std::map<uint64_t, Callstack::AddressDetails> m_Cache;
 };
 
@@ -320,3 +424,97 @@ StackResolver *MakeResolver(byte *moduleDB, size_t DBSize, RENDERDOC_ProgressCal
   return new LinuxResolver(modules);
 }
 };
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "3rdparty/catch/catch.hpp"
+#include "common/timing.h"
+
+// recurse a few levels so the stacks have some frames of our own to compare, then walk the stack
+// both ways from the same frame.
+__attribute__((noinline)) static void CollectBothStacks(int depth, rdcarray<void *> &slow,
+                                                         rdcarray<void *> &fast)
+{
+  if(depth > 0)
+  {
+    CollectBothStacks(depth - 1, slow, fast);
+    // prevent this from becoming a tail call
+    asm volatile("");
+    return;
+  }
+
+  slow.resize(128);
+  slow.resize(backtrace(slow.data(), (int)slow.size()));
+
+  fast.resize(128);
+  int num = Unwind::FastBacktrace(fast.data(), (int)fast.size());
+  fast.resize(RDCMAX(num, 0));
+}
+
+TEST_CASE("Test fast callstack unwinding", "[osspecific][callstack]")
+{
+#if defined(__x86_64__)
+  // the innermost return address is different since the two calls are made from different places,
+  // but every frame after that should match exactly. The fast unwinder is allowed to stop early.
+  // The second pass hits the cached rules and must give the same result.
+  for(int pass = 0; pass < 2; pass++)
+  {
+    rdcarray<void *> slow, fast;
+    CollectBothStacks(5, slow, fast);
+
+    REQUIRE(fast.size() > 6);
+    REQUIRE(slow.size() >= fast.size());
+
+    for(size_t i = 1; i < fast.size(); i++)
+      CHECK(fast[i] == slow[i]);
+  }
+
+  // other threads get their own rule cache, which is freed when the thread exits
+  rdcarray<void *> threadSlow, threadFast;
+  Threading::ThreadHandle thread = Threading::CreateThread(
+      [&threadSlow, &threadFast]() { CollectBothStacks(2, threadSlow, threadFast); });
+  Threading::JoinThread(thread);
+  Threading::CloseThread(thread);
+
+  REQUIRE(threadFast.size() > 2);
+  REQUIRE(threadSlow.size() >= threadFast.size());
+
+  for(size_t i = 1; i < threadFast.size(); i++)
+    CHECK(threadFast[i] == threadSlow[i]);
+#else
+  rdcarray<void *> slow, fast;
+  CollectBothStacks(5, slow, fast);
+
+  CHECK(fast.empty());
+#endif
+};
+
+TEST_CASE("Benchmark callstack collection", "[.][benchmark][callstack]")
+{
+  const int numCalls = 20000;
+
+  for(bool fastUnwind : {false, true})
+  {
+    // warm up any caches first, for the fast unwinder this is where the rules are evaluated
+    delete Callstack::Collect(fastUnwind);
+
+    size_t numLevels = 0;
+
+    PerformanceTimer timer;
+    for(int i = 0; i < numCalls; i++)
+    {
+      Callstack::Stackwalk *stack = Callstack::Collect(fastUnwind);
+      numLevels += stack->NumLevels();
+      delete stack;
+    }
+    double micros = timer.GetMicroseconds();
+
+    WARN(StringFormat::Fmt("Callstack::Collect(%s): %.3f us per call, %.1f levels on average",
+                           fastUnwind ? "fast" : "default", micros / numCalls,
+                           double(numLevels) / numCalls));
+
+    CHECK(numLevels > 0);
+  }
+};
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -0,0 +1,1041 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "linux_elf.h"
+#include <cxxabi.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include "3rdparty/miniz/miniz.h"
+#include "common/common.h"
+#include "common/formatting.h"
+#include "os/os_specific.h"
+#include "strings/string_utils.h"
+
+// DWARF constants we need for .debug_line. We don't pull in a full DWARF header just for these
+enum
+{
+  DW_LNS_copy = 0x01,
+  DW_LNS_advance_pc = 0x02,
+  DW_LNS_advance_line = 0x03,
+  DW_LNS_set_file = 0x04,
+  DW_LNS_const_add_pc = 0x08,
+  DW_LNS_fixed_advance_pc = 0x09,
+
+  DW_LNE_end_sequence = 0x01,
+  DW_LNE_set_address = 0x02,
+  DW_LNE_define_file = 0x03,
+
+  DW_LNCT_path = 0x1,
+  DW_LNCT_directory_index = 0x2,
+
+  DW_FORM_block2 = 0x03,
+  DW_FORM_block4 = 0x04,
+  DW_FORM_data2 = 0x05,
+  DW_FORM_data4 = 0x06,
+  DW_FORM_data8 = 0x07,
+  DW_FORM_string = 0x08,
+  DW_FORM_block = 0x09,
+  DW_FORM_block1 = 0x0a,
+  DW_FORM_data1 = 0x0b,
+  DW_FORM_strp = 0x0e,
+  DW_FORM_udata = 0x0f,
+  DW_FORM_strx = 0x1a,
+  DW_FORM_data16 = 0x1e,
+  DW_FORM_line_strp = 0x1f,
+  DW_FORM_strx1 = 0x25,
+  DW_FORM_strx2 = 0x26,
+  DW_FORM_strx3 = 0x27,
+  DW_FORM_strx4 = 0x28,
+};
+
+namespace
+{
+// bounds-checked little-endian reader over a section. Reading past the end sets overflow and
+// returns zeroes, so parsing loops only need to check for it at convenient points.
+struct DWARFReader
+{
+  const byte *cur;
+  const byte *end;
+  bool overflow;
+
+  template <typename T>
+  T Read()
+  {
+    T ret = T();
+    if(size_t(end - cur) < sizeof(T))
+    {
+      overflow = true;
+      cur = end;
+      return ret;
+    }
+    memcpy(&ret, cur, sizeof(T));
+    cur += sizeof(T);
+    return ret;
+  }
+
+  uint64_t ReadULEB()
+  {
+    uint64_t ret = 0;
+    uint32_t shift = 0;
+    while(cur < end)
+    {
+      byte b = *cur++;
+      if(shift < 64)
+        ret |= uint64_t(b & 0x7f) << shift;
+      shift += 7;
+      if((b & 0x80) == 0)
+        return ret;
+    }
+    overflow = true;
+    return ret;
+  }
+
+  int64_t ReadSLEB()
+  {
+    int64_t ret = 0;
+    uint32_t shift = 0;
+    while(cur < end)
+    {
+      byte b = *cur++;
+      if(shift < 64)
+        ret |= int64_t(b & 0x7f) << shift;
+      shift += 7;
+      if((b & 0x80) == 0)
+      {
+        if(shift < 64 && (b & 0x40))
+          ret |= -(int64_t(1) << shift);
+        return ret;
+      }
+    }
+    overflow = true;
+    return ret;
+  }
+
+  uint64_t ReadOffset(bool dwarf64) { return dwarf64 ? Read<uint64_t>() : Read<uint32_t>(); }
+  uint64_t ReadAddress(uint64_t size)
+  {
+    switch(size)
+    {
+      case 1: return Read<uint8_t>();
+      case 2: return Read<uint16_t>();
+      case 4: return Read<uint32_t>();
+      case 8: return Read<uint64_t>();
+      default: Skip(size); return 0;
+    }
+  }
+
+  const char *ReadString()
+  {
+    const char *ret = (const char *)cur;
+    const byte *nul = (const byte *)memchr(cur, 0, size_t(end - cur));
+    if(nul == NULL)
+    {
+      overflow = true;
+      cur = end;
+      return "";
+    }
+    cur = nul + 1;
+    return ret;
+  }
+
+  void Skip(uint64_t bytes)
+  {
+    if(bytes > uint64_t(end - cur))
+    {
+      overflow = true;
+      cur = end;
+      return;
+    }
+    cur += bytes;
+  }
+};
+
+struct DWARFStrings
+{
+  const byte *lineStr;
+  size_t lineStrSize;
+  const byte *str;
+  size_t strSize;
+};
+
+const char *GetSectionString(const byte *section, size_t size, uint64_t offset)
+{
+  if(section == NULL || offset >= size || memchr(section + offset, 0, size - offset) == NULL)
+    return NULL;
+  return (const char *)section + offset;
+}
+
+// reads a single attribute from a DWARF 5 directory/filename entry. Strings are returned in str,
+// everything else in val. Returns false for forms we can't skip over, since then the rest of the
+// header can't be parsed.
+bool ReadEntryForm(DWARFReader &r, uint64_t form, bool dwarf64, const DWARFStrings &strings,
+                   const char *&str, uint64_t &val)
+{
+  str = NULL;
+  val = 0;
+  switch(form)
+  {
+    case DW_FORM_string: str = r.ReadString(); break;
+    case DW_FORM_line_strp:
+      str = GetSectionString(strings.lineStr, strings.lineStrSize, r.ReadOffset(dwarf64));
+      break;
+    case DW_FORM_strp:
+      str = GetSectionString(strings.str, strings.strSize, r.ReadOffset(dwarf64));
+      break;
+    case DW_FORM_udata: val = r.ReadULEB(); break;
+    case DW_FORM_data1: val = r.Read<uint8_t>(); break;
+    case DW_FORM_data2: val = r.Read<uint16_t>(); break;
+    case DW_FORM_data4: val = r.Read<uint32_t>(); break;
+    case DW_FORM_data8: val = r.Read<uint64_t>(); break;
+    case DW_FORM_data16: r.Skip(16); break;
+    case DW_FORM_block: r.Skip(r.ReadULEB()); break;
+    case DW_FORM_block1: r.Skip(r.Read<uint8_t>()); break;
+    case DW_FORM_block2: r.Skip(r.Read<uint16_t>()); break;
+    case DW_FORM_block4: r.Skip(r.Read<uint32_t>()); break;
+    // string indices need .debug_str_offsets and the CU's base, which we don't parse. Skip them
+    // and leave the string empty
+    case DW_FORM_strx: r.ReadULEB(); break;
+    case DW_FORM_strx1: r.Skip(1); break;
+    case DW_FORM_strx2: r.Skip(2); break;
+    case DW_FORM_strx3: r.Skip(3); break;
+    case DW_FORM_strx4: r.Skip(4); break;
+    default: return false;
+  }
+  return !r.overflow;
+}
+
+struct LineEntry
+{
+  const char *path;
+  uint64_t dir;
+};
+
+// reads a DWARF 5 directory or filename entry list, including its format description
+bool ReadEntryList(DWARFReader &r, bool dwarf64, const DWARFStrings &strings,
+                   rdcarray<LineEntry> &entries)
+{
+  uint8_t formatCount = r.Read<uint8_t>();
+  rdcarray<rdcpair<uint64_t, uint64_t>> format;
+  for(uint8_t i = 0; i < formatCount; i++)
+  {
+    uint64_t contentType = r.ReadULEB();
+    uint64_t form = r.ReadULEB();
+    format.push_back({contentType, form});
+  }
+
+  uint64_t count = r.ReadULEB();
+  for(uint64_t i = 0; i < count && !r.overflow; i++)
+  {
+    LineEntry entry = {NULL, 0};
+    for(const rdcpair<uint64_t, uint64_t> &f : format)
+    {
+      const char *str = NULL;
+      uint64_t val = 0;
+      if(!ReadEntryForm(r, f.second, dwarf64, strings, str, val))
+        return false;
+
+      if(f.first == DW_LNCT_path)
+        entry.path = str;
+      else if(f.first == DW_LNCT_directory_index)
+        entry.dir = val;
+    }
+    entries.push_back(entry);
+  }
+
+  return !r.overflow;
+}
+};
+
+namespace ELF
+{
+ModuleSymbols::~ModuleSymbols()
+{
+  for(MappedFile &f : m_Files)
+    munmap(f.base, f.size);
+  for(byte *b : m_Decompressed)
+    delete[] b;
+}
+
+bool ModuleSymbols::MapFile(const rdcstr &path, MappedFile &file)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+  if(fd < 0)
+    return false;
+
+  struct stat st = {};
+  if(fstat(fd, &st) != 0 || st.st_size <= 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if(base == MAP_FAILED)
+    return false;
+
+  file.base = base;
+  file.size = (size_t)st.st_size;
+
+  const byte *ident = (const byte *)base;
+  if(file.size < EI_NIDENT || memcmp(ident, ELFMAG, SELFMAG) != 0 ||
+     ident[EI_DATA] != ELFDATA2LSB ||
+     (ident[EI_CLASS] != ELFCLASS64 && ident[EI_CLASS] != ELFCLASS32) ||
+     file.size < (ident[EI_CLASS] == ELFCLASS64 ? sizeof(Elf64_Ehdr) : sizeof(Elf32_Ehdr)))
+  {
+    munmap(base, file.size);
+    return false;
+  }
+
+  m_Files.push_back(file);
+
+  return true;
+}
+
+bool ModuleSymbols::Load(const rdcstr &path)
+{
+  m_Path = path;
+
+  MappedFile file;
+  if(!MapFile(path, file))
+  {
+    RDCWARN("Couldn't load '%s' as an ELF file for symbol resolution", path.c_str());
+    return false;
+  }
+
+  bool success = false;
+  if(((const byte *)file.base)[EI_CLASS] == ELFCLASS64)
+    success = Parse<Elf64_Ehdr, Elf64_Shdr, Elf64_Phdr, Elf64_Sym, Elf64_Nhdr>(file, false);
+  else
+    success = Parse<Elf32_Ehdr, Elf32_Shdr, Elf32_Phdr, Elf32_Sym, Elf32_Nhdr>(file, false);
+
+  if(!success)
+    return false;
+
+  // stripped modules usually ship their debug info separately, look in the standard places gdb
+  // would look: by build ID first, then by the .gnu_debuglink name
+  if(m_Lines.empty())
+  {
+    rdcarray<rdcstr> candidates;
+
+    if(m_BuildID.size() > 2)
+      candidates.push_back("/usr/lib/debug/.build-id/" + m_BuildID.substr(0, 2) + "/" +
+                           m_BuildID.substr(2) + ".debug");
+
+    if(!m_DebugLink.empty())
+    {
+      rdcstr dir = get_dirname(path);
+      candidates.push_back(dir + "/" + m_DebugLink);
+      candidates.push_back(dir + "/.debug/" + m_DebugLink);
+      candidates.push_back("/usr/lib/debug" + dir + "/" + m_DebugLink);
+    }
+
+    for(const rdcstr &candidate : candidates)
+    {
+      if(candidate != path && FileIO::exists(candidate.c_str()) && LoadDebugFile(candidate))
+        break;
+    }
+  }
+
+  std::sort(m_Symbols.begin(), m_Symbols.end(), [](const Symbol &a, const Symbol &b) {
+    if(a.address != b.address)
+      return a.address < b.address;
+    // prefer symbols with a size, so that lookups can tell when they've run off the end
+    return a.size > b.size;
+  });
+  m_Symbols.resize(std::unique(m_Symbols.begin(), m_Symbols.end(),
+                               [](const Symbol &a, const Symbol &b) {
+                                 return a.address == b.address;
+                               }) -
+                   m_Symbols.begin());
+
+  // sequences are sorted by address individually but not relative to each other. Keep rows at the
+  // same address in program order, except that the end of one sequence sorts before the start of
+  // the next one at the same address.
+  std::stable_sort(m_Lines.begin(), m_Lines.end(), [](const LineRow &a, const LineRow &b) {
+    if(a.address != b.address)
+      return a.address < b.address;
+    return a.endSequence && !b.endSequence;
+  });
+
+  m_FilenameLookup.clear();
+
+  RDCDEBUG("Loaded %zu symbols and %zu line rows for '%s'", m_Symbols.size(), m_Lines.size(),
+           path.c_str());
+
+  return true;
+}
+
+bool ModuleSymbols::LoadDebugFile(const rdcstr &path)
+{
+  MappedFile file;
+  if(!MapFile(path, file))
+    return false;
+
+  bool success = false;
+  if(((const byte *)file.base)[EI_CLASS] == ELFCLASS64)
+    success = Parse<Elf64_Ehdr, Elf64_Shdr, Elf64_Phdr, Elf64_Sym, Elf64_Nhdr>(file, true);
+  else
+    success = Parse<Elf32_Ehdr, Elf32_Shdr, Elf32_Phdr, Elf32_Sym, Elf32_Nhdr>(file, true);
+
+  return success && !m_Lines.empty();
+}
+
+const byte *ModuleSymbols::GetSectionData(const byte *data, uint64_t size, uint64_t flags,
+                                          bool elf64, size_t &outSize)
+{
+  outSize = (size_t)size;
+
+  if((flags & SHF_COMPRESSED) == 0)
+    return data;
+
+  uint32_t type = 0;
+  uint64_t uncompressedSize = 0;
+  size_t headerSize = 0;
+
+  if(elf64 && size >= sizeof(Elf64_Chdr))
+  {
+    Elf64_Chdr chdr;
+    memcpy(&chdr, data, sizeof(chdr));
+    type = chdr.ch_type;
+    uncompressedSize = chdr.ch_size;
+    headerSize = sizeof(chdr);
+  }
+  else if(!elf64 && size >= sizeof(Elf32_Chdr))
+  {
+    Elf32_Chdr chdr;
+    memcpy(&chdr, data, sizeof(chdr));
+    type = chdr.ch_type;
+    uncompressedSize = chdr.ch_size;
+    headerSize = sizeof(chdr);
+  }
+
+  if(type != ELFCOMPRESS_ZLIB || uncompressedSize == 0)
+  {
+    RDCWARN("Unsupported compressed section in '%s'", m_Path.c_str());
+    return NULL;
+  }
+
+  byte *uncompressed = new byte[(size_t)uncompressedSize];
+  mz_ulong destSize = (mz_ulong)uncompressedSize;
+  int ret = mz_uncompress(uncompressed, &destSize, data + headerSize, mz_ulong(size - headerSize));
+
+  if(ret != MZ_OK)
+  {
+    RDCWARN("Failed to decompress section in '%s': %d", m_Path.c_str(), ret);
+    delete[] uncompressed;
+    return NULL;
+  }
+
+  m_Decompressed.push_back(uncompressed);
+  outSize = (size_t)destSize;
+  return uncompressed;
+}
+
+template <typename Ehdr, typename Shdr, typename Phdr, typename Sym, typename Nhdr>
+bool ModuleSymbols::Parse(const MappedFile &file, bool debugFile)
+{
+  const byte *base = (const byte *)file.base;
+  const Ehdr *ehdr = (const Ehdr *)base;
+  const bool elf64 = sizeof(Ehdr) == sizeof(Elf64_Ehdr);
+
+  // the debug file's program headers describe the same layout, only take them from the module
+  if(!debugFile && ehdr->e_phoff > 0 && ehdr->e_phentsize == sizeof(Phdr) &&
+     ehdr->e_phoff + uint64_t(ehdr->e_phnum) * sizeof(Phdr) <= file.size)
+  {
+    const Phdr *phdrs = (const Phdr *)(base + ehdr->e_phoff);
+    for(uint32_t i = 0; i < ehdr->e_phnum; i++)
+    {
+      if(phdrs[i].p_type == PT_LOAD)
+        m_Segments.push_back({phdrs[i].p_offset, phdrs[i].p_vaddr, phdrs[i].p_filesz});
+    }
+  }
+
+  // no section headers isn't an error, there's just nothing to resolve with
+  if(ehdr->e_shoff == 0 || ehdr->e_shentsize != sizeof(Shdr) ||
+     ehdr->e_shoff + sizeof(Shdr) > file.size)
+    return true;
+
+  const Shdr *sections = (const Shdr *)(base + ehdr->e_shoff);
+
+  // large section counts and string table indices are stored in the first section header
+  uint64_t numSections = ehdr->e_shnum ? ehdr->e_shnum : sections[0].sh_size;
+  uint64_t shstrndx = ehdr->e_shstrndx == SHN_XINDEX ? sections[0].sh_link : ehdr->e_shstrndx;
+
+  if(ehdr->e_shoff + numSections * sizeof(Shdr) > file.size || shstrndx >= numSections ||
+     sections[shstrndx].sh_offset + sections[shstrndx].sh_size > file.size)
+  {
+    RDCWARN("Corrupt section headers in '%s'", m_Path.c_str());
+    return false;
+  }
+
+  const byte *shstrtab = base + sections[shstrndx].sh_offset;
+  const size_t shstrtabSize = (size_t)sections[shstrndx].sh_size;
+
+  const Shdr *symtab = NULL;
+  const Shdr *dynsym = NULL;
+
+  const byte *debugLine = NULL, *debugLineStr = NULL, *debugStr = NULL;
+  size_t debugLineSize = 0, debugLineStrSize = 0, debugStrSize = 0;
+
+  for(uint64_t i = 0; i < numSections; i++)
+  {
+    const Shdr &sec = sections[i];
+
+    if(sec.sh_type == SHT_NOBITS || sec.sh_offset + sec.sh_size > file.size)
+      continue;
+
+    const char *name = GetSectionString(shstrtab, shstrtabSize, sec.sh_name);
+    if(name == NULL)
+      continue;
+
+    const byte *data = base + sec.sh_offset;
+
+    if(sec.sh_type == SHT_SYMTAB)
+    {
+      symtab = &sec;
+    }
+    else if(sec.sh_type == SHT_DYNSYM)
+    {
+      dynsym = &sec;
+    }
+    else if(!strcmp(name, ".debug_line"))
+    {
+      debugLine = GetSectionData(data, sec.sh_size, sec.sh_flags, elf64, debugLineSize);
+    }
+    else if(!strcmp(name, ".debug_line_str"))
+    {
+      debugLineStr = GetSectionData(data, sec.sh_size, sec.sh_flags, elf64, debugLineStrSize);
+    }
+    else if(!strcmp(name, ".debug_str"))
+    {
+      debugStr = GetSectionData(data, sec.sh_size, sec.sh_flags, elf64, debugStrSize);
+    }
+    else if(!debugFile && sec.sh_type == SHT_NOTE && !strcmp(name, ".note.gnu.build-id") &&
+            sec.sh_size >= sizeof(Nhdr))
+    {
+      const Nhdr *note = (const Nhdr *)data;
+      uint64_t descOffset = sizeof(Nhdr) + AlignUp4(uint64_t(note->n_namesz));
+      if(note->n_type == NT_GNU_BUILD_ID && descOffset + note->n_descsz <= sec.sh_size)
+      {
+        const byte *desc = data + descOffset;
+        for(uint32_t b = 0; b < note->n_descsz; b++)
+          m_BuildID += StringFormat::Fmt("%02x", desc[b]);
+      }
+    }
+    else if(!debugFile && !strcmp(name, ".gnu_debuglink"))
+    {
+      const char *link = GetSectionString(data, (size_t)sec.sh_size, 0);
+      if(link)
+        m_DebugLink = link;
+    }
+  }
+
+  // .symtab is a superset of .dynsym when present. Stripped modules only have .dynsym, in which
+  // case a separate debug file's .symtab is preferred if we find one.
+  const Shdr *symbols = symtab ? symtab : dynsym;
+  if(symbols && !m_FullSymtab && symbols->sh_link < numSections)
+  {
+    const Shdr &strtab = sections[symbols->sh_link];
+    if(strtab.sh_offset + strtab.sh_size <= file.size && symbols->sh_entsize == sizeof(Sym))
+    {
+      if(symtab)
+      {
+        m_FullSymtab = true;
+        m_Symbols.clear();
+      }
+
+      ParseSymbolTable(base + symbols->sh_offset, (size_t)symbols->sh_size, sizeof(Sym),
+                       base + strtab.sh_offset, (size_t)strtab.sh_size, elf64);
+    }
+  }
+
+  if(debugLine)
+  {
+    ParseLineTable(debugLine, debugLineSize, debugLineStr, debugLineStrSize, debugStr,
+                   debugStrSize);
+  }
+
+  return true;
+}
+
+void ModuleSymbols::ParseSymbolTable(const byte *data, size_t size, size_t entSize,
+                                     const byte *strtab, size_t strtabSize, bool elf64)
+{
+  for(size_t offs = 0; offs + entSize <= size; offs += entSize)
+  {
+    uint64_t value, symSize;
+    uint32_t nameOffs;
+    uint16_t shndx;
+    byte type;
+
+    if(elf64)
+    {
+      const Elf64_Sym *sym = (const Elf64_Sym *)(data + offs);
+      value = sym->st_value;
+      symSize = sym->st_size;
+      nameOffs = sym->st_name;
+      shndx = sym->st_shndx;
+      type = ELF64_ST_TYPE(sym->st_info);
+    }
+    else
+    {
+      const Elf32_Sym *sym = (const Elf32_Sym *)(data + offs);
+      value = sym->st_value;
+      symSize = sym->st_size;
+      nameOffs = sym->st_name;
+      shndx = sym->st_shndx;
+      type = ELF32_ST_TYPE(sym->st_info);
+    }
+
+    if((type != STT_FUNC && type != STT_GNU_IFUNC) || shndx == SHN_UNDEF || value == 0)
+      continue;
+
+    const char *name = GetSectionString(strtab, strtabSize, nameOffs);
+    if(name == NULL || name[0] == 0)
+      continue;
+
+    m_Symbols.push_back({value, symSize, name});
+  }
+}
+
+uint32_t ModuleSymbols::AddFilename(const rdcstr &dir, const char *name)
+{
+  if(name == NULL || name[0] == 0)
+    return ~0U;
+
+  rdcstr path = name;
+  if(name[0] != '/' && !dir.empty())
+    path = dir + "/" + path;
+
+  auto it = m_FilenameLookup.find(path);
+  if(it != m_FilenameLookup.end())
+    return it->second;
+
+  uint32_t idx = (uint32_t)m_Filenames.size();
+  m_Filenames.push_back(path);
+  m_FilenameLookup[path] = idx;
+  return idx;
+}
+
+void ModuleSymbols::ParseLineTable(const byte *data, size_t size, const byte *lineStr,
+                                   size_t lineStrSize, const byte *str, size_t strSize)
+{
+  DWARFStrings strings = {lineStr, lineStrSize, str, strSize};
+  DWARFReader units = {data, data + size, false};
+
+  while(units.cur < units.end && !units.overflow)
+  {
+    bool dwarf64 = false;
+    uint64_t length = units.Read<uint32_t>();
+    if(length == 0xffffffff)
+    {
+      dwarf64 = true;
+      length = units.Read<uint64_t>();
+    }
+    else if(length >= 0xfffffff0)
+    {
+      // reserved lengths, can't continue past this
+      break;
+    }
+
+    if(units.overflow || length > uint64_t(units.end - units.cur))
+      break;
+
+    DWARFReader r = {units.cur, units.cur + length, false};
+    units.cur += length;
+
+    uint16_t version = r.Read<uint16_t>();
+    if(version < 2 || version > 5)
+    {
+      RDCWARN("Unsupported DWARF line table version %u in '%s'", version, m_Path.c_str());
+      continue;
+    }
+
+    if(version >= 5)
+    {
+      // address size and segment selector size. The address size is implied by set_address
+      r.Skip(2);
+    }
+
+    uint64_t headerLength = r.ReadOffset(dwarf64);
+    if(r.overflow || headerLength > uint64_t(r.end - r.cur))
+      continue;
+
+    const byte *program = r.cur + headerLength;
+
+    uint8_t minInstLength = r.Read<uint8_t>();
+    // maximum operations per instruction, only relevant for VLIW
+    if(version >= 4)
+      r.Skip(1);
+    // default_is_stmt, we use all rows regardless
+    r.Skip(1);
+    int8_t lineBase = r.Read<int8_t>();
+    uint8_t lineRange = r.Read<uint8_t>();
+    uint8_t opcodeBase = r.Read<uint8_t>();
+
+    if(r.overflow || lineRange == 0 || opcodeBase == 0)
+      continue;
+
+    const byte *opcodeLengths = r.cur;
+    r.Skip(opcodeBase - 1);
+
+    // map from the unit's file indices to our global list of filenames
+    rdcarray<uint32_t> files;
+    rdcarray<rdcstr> dirs;
+
+    if(version >= 5)
+    {
+      rdcarray<LineEntry> dirEntries, fileEntries;
+      if(!ReadEntryList(r, dwarf64, strings, dirEntries) ||
+         !ReadEntryList(r, dwarf64, strings, fileEntries))
+        continue;
+
+      // directory 0 is the compilation directory, and other relative directories are relative to it
+      for(size_t i = 0; i < dirEntries.size(); i++)
+      {
+        rdcstr dir = dirEntries[i].path ? dirEntries[i].path : "";
+        if(i > 0 && !dir.empty() && dir[0] != '/' && !dirs[0].empty())
+          dir = dirs[0] + "/" + dir;
+        dirs.push_back(dir);
+      }
+
+      for(const LineEntry &f : fileEntries)
+        files.push_back(AddFilename(f.dir < dirs.size() ? dirs[(size_t)f.dir] : rdcstr(), f.path));
+    }
+    else
+    {
+      // directory 0 is the compilation directory, which is only in .debug_info for these versions.
+      // Relative paths are left relative rather than parsing all of that.
+      dirs.push_back(rdcstr());
+      for(;;)
+      {
+        const char *dir = r.ReadString();
+        if(r.overflow || dir[0] == 0)
+          break;
+        dirs.push_back(dir);
+      }
+
+      // file indices are 1-based
+      files.push_back(~0U);
+      for(;;)
+      {
+        const char *name = r.ReadString();
+        if(r.overflow || name[0] == 0)
+          break;
+        uint64_t dir = r.ReadULEB();
+        // modification time and length
+        r.ReadULEB();
+        r.ReadULEB();
+        files.push_back(AddFilename(dir < dirs.size() ? dirs[(size_t)dir] : rdcstr(), name));
+      }
+    }
+
+    if(r.overflow || program > r.end)
+      continue;
+
+    r.cur = program;
+
+    uint64_t address = 0;
+    uint64_t file = 1;
+    int64_t line = 1;
+    uint64_t addressSize = 8;
+
+    rdcarray<LineRow> sequence;
+
+    auto emitRow = [&](bool endSequence) {
+      sequence.push_back({address, file < files.size() ? files[(size_t)file] : ~0U,
+                          (uint32_t)RDCMAX(line, (int64_t)0), endSequence});
+    };
+
+    while(r.cur < r.end && !r.overflow)
+    {
+      uint8_t opcode = r.Read<uint8_t>();
+
+      if(opcode >= opcodeBase)
+      {
+        uint8_t adjusted = opcode - opcodeBase;
+        address += (adjusted / lineRange) * minInstLength;
+        line += lineBase + (adjusted % lineRange);
+        emitRow(false);
+      }
+      else if(opcode == 0)
+      {
+        uint64_t len = r.ReadULEB();
+        if(len == 0 || len > uint64_t(r.end - r.cur))
+          break;
+
+        const byte *next = r.cur + len;
+        uint8_t extOpcode = r.Read<uint8_t>();
+
+        if(extOpcode == DW_LNE_end_sequence)
+        {
+          emitRow(true);
+
+          // sequences for code removed by the linker are relocated to 0 or to a tombstone value,
+          // and would overlap real code
+          uint64_t tombstone = addressSize == 4 ? 0xffffffffULL : ~0ULL;
+          if(sequence[0].address != 0 && sequence[0].address < tombstone - 1)
+            m_Lines.append(sequence);
+
+          sequence.clear();
+          address = 0;
+          file = 1;
+          line = 1;
+        }
+        else if(extOpcode == DW_LNE_set_address)
+        {
+          addressSize = len - 1;
+          address = r.ReadAddress(addressSize);
+        }
+        else if(extOpcode == DW_LNE_define_file)
+        {
+          const char *name = r.ReadString();
+          uint64_t dir = r.ReadULEB();
+          files.push_back(AddFilename(dir < dirs.size() ? dirs[(size_t)dir] : rdcstr(), name));
+        }
+
+        r.cur = next;
+      }
+      else
+      {
+        switch(opcode)
+        {
+          case DW_LNS_copy: emitRow(false); break;
+          case DW_LNS_advance_pc: address += r.ReadULEB() * minInstLength; break;
+          case DW_LNS_advance_line: line += r.ReadSLEB(); break;
+          case DW_LNS_set_file: file = r.ReadULEB(); break;
+          case DW_LNS_const_add_pc:
+            address += ((255 - opcodeBase) / lineRange) * minInstLength;
+            break;
+          case DW_LNS_fixed_advance_pc: address += r.Read<uint16_t>(); break;
+          default:
+          {
+            // skip any other standard opcode's ULEB arguments, we don't need column, is_stmt, etc
+            for(uint8_t a = 0; a < opcodeLengths[opcode - 1]; a++)
+              r.ReadULEB();
+            break;
+          }
+        }
+      }
+    }
+  }
+}
+
+uint64_t ModuleSymbols::FileOffsetToAddress(uint64_t offset) const
+{
+  for(const Segment &seg : m_Segments)
+  {
+    if(offset >= seg.offset && offset < seg.offset + seg.size)
+      return offset - seg.offset + seg.address;
+  }
+
+  // shared libraries are normally linked with addresses matching file offsets
+  return offset;
+}
+
+rdcstr ModuleSymbols::LookupFunction(uint64_t addr) const
+{
+  const Symbol *it = std::upper_bound(
+      m_Symbols.begin(), m_Symbols.end(), addr,
+      [](uint64_t a, const Symbol &sym) { return a < sym.address; });
+
+  if(it == m_Symbols.begin())
+    return rdcstr();
+
+  it--;
+
+  if(it->size > 0 && addr >= it->address + it->size)
+    return rdcstr();
+
+  int status = 0;
+  char *demangled = abi::__cxa_demangle(it->name, NULL, NULL, &status);
+
+  rdcstr ret = (status == 0 && demangled) ? demangled : it->name;
+  free(demangled);
+
+  return ret;
+}
+
+bool ModuleSymbols::LookupLine(uint64_t addr, rdcstr &filename, uint32_t &line) const
+{
+  const LineRow *it = std::upper_bound(
+      m_Lines.begin(), m_Lines.end(), addr,
+      [](uint64_t a, const LineRow &row) { return a < row.address; });
+
+  if(it == m_Lines.begin())
+    return false;
+
+  it--;
+
+  if(it->endSequence || it->file >= m_Filenames.size())
+    return false;
+
+  filename = m_Filenames[it->file];
+  line = it->line;
+  return true;
+}
+};    // namespace ELF
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include <dlfcn.h>
+#include "3rdparty/catch/catch.hpp"
+
+static const uint32_t testFunctionLine = __LINE__ + 2;
+extern "C" __attribute__((noinline)) int ELFSymbolsTestFunction(int a)
+{
+  return a * 3 + 1;
+}
+
+static __attribute__((noinline)) void *ELFSymbolsReturnAddress()
+{
+  return __builtin_return_address(0);
+}
+
+// resolve an address with addr2line, for comparison. Returns false if addr2line isn't available or
+// couldn't resolve the address.
+static bool Addr2Line(const char *path, uint64_t addr, rdcstr &function, rdcstr &filename,
+                      uint32_t &line)
+{
+  rdcstr cmd = StringFormat::Fmt("addr2line -fCe \"%s\" 0x%llx 2>/dev/null", path, addr);
+
+  FILE *f = ::popen(cmd.c_str(), "r");
+
+  if(!f)
+    return false;
+
+  char result[2048] = {0};
+  fread(result, 1, 2047, f);
+
+  ::pclose(f);
+
+  rdcarray<rdcstr> lines;
+  split(rdcstr(result), lines, '\n');
+
+  if(lines.size() < 2)
+    return false;
+
+  function = lines[0];
+
+  // strip any " (discriminator N)" suffix
+  rdcstr location = lines[1];
+  int32_t discriminator = location.find(" (discriminator");
+  if(discriminator >= 0)
+    location.erase(discriminator, ~0U);
+
+  int32_t colon = location.find_last_of(":");
+  if(colon < 0)
+    return false;
+
+  filename = location.substr(0, colon);
+  line = (uint32_t)atoi(location.c_str() + colon + 1);
+
+  return filename != "??" && line != 0;
+}
+
+TEST_CASE("Test ELF symbol resolution", "[osspecific]")
+{
+  Dl_info info = {};
+  REQUIRE(dladdr((void *)&ELFSymbolsTestFunction, &info) != 0);
+  REQUIRE(info.dli_fname != NULL);
+
+  ELF::ModuleSymbols symbols;
+  REQUIRE(symbols.Load(info.dli_fname));
+
+  // we're in a shared library, so the load base maps directly to virtual address 0
+  uint64_t addr = uint64_t((byte *)&ELFSymbolsTestFunction - (byte *)info.dli_fbase);
+
+  SECTION("Function lookup")
+  {
+    CHECK(symbols.LookupFunction(addr) == "ELFSymbolsTestFunction");
+    CHECK(symbols.LookupFunction(addr + 1) == "ELFSymbolsTestFunction");
+    CHECK(symbols.LookupFunction(0) == "");
+  };
+
+  SECTION("Line lookup")
+  {
+    if(symbols.HasLineInfo())
+    {
+      rdcstr filename;
+      uint32_t line = 0;
+      CHECK(symbols.LookupLine(addr, filename, line));
+      CHECK(get_basename(filename) == "linux_elf.cpp");
+      CHECK(line >= testFunctionLine);
+      CHECK(line <= testFunctionLine + 2);
+    }
+  };
+
+  SECTION("Matches addr2line")
+  {
+    // functions in this module, and an address in the middle of this test
+    const void *funcs[] = {
+        (const void *)&ELFSymbolsTestFunction, (const void *)&GetSectionString,
+        (const void *)&ReadEntryList,
+    };
+
+    rdcarray<uint64_t> addrs;
+    for(const void *func : funcs)
+      addrs.push_back(uint64_t((const byte *)func - (const byte *)info.dli_fbase));
+
+    // the call instruction is just before the return address
+    addrs.push_back(uint64_t((byte *)ELFSymbolsReturnAddress() - (byte *)info.dli_fbase) - 1);
+
+    for(size_t i = 0; i < addrs.size(); i++)
+    {
+      rdcstr expectedFunction, expectedFile;
+      uint32_t expectedLine = 0;
+
+      if(!Addr2Line(info.dli_fname, addrs[i], expectedFunction, expectedFile, expectedLine))
+        continue;
+
+      INFO("Address 0x" << std::hex << addrs[i]);
+
+      // only whole functions are compared by name, addr2line reports inlined callers differently
+      if(i < ARRAY_COUNT(funcs))
+        CHECK(symbols.LookupFunction(addrs[i]) == expectedFunction);
+
+      rdcstr filename;
+      uint32_t line = 0;
+      CHECK(symbols.LookupLine(addrs[i], filename, line));
+      CHECK(get_basename(filename) == get_basename(expectedFile));
+      CHECK(line == expectedLine);
+    }
+  };
+
+  SECTION("Missing file")
+  {
+    ELF::ModuleSymbols missing;
+    CHECK_FALSE(missing.Load("/nonexistent/path/to/library.so"));
+  };
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
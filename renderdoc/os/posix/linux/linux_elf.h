@@ -0,0 +1,122 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <map>
+#include "api/replay/rdcarray.h"
+#include "api/replay/rdcstr.h"
+
+namespace ELF
+{
+// symbol and line information for a single ELF module, parsed in-process from the module's symbol
+// tables and DWARF .debug_line section (or those of its separate debug file, if one can be found).
+// Everything is parsed once up front into sorted tables so that each lookup is a binary search.
+class ModuleSymbols
+{
+public:
+  ModuleSymbols() = default;
+  ~ModuleSymbols();
+
+  ModuleSymbols(const ModuleSymbols &) = delete;
+  ModuleSymbols &operator=(const ModuleSymbols &) = delete;
+
+  // returns false if the file couldn't be opened or isn't a supported ELF file. A module without
+  // any symbols or line information still loads successfully, it just won't resolve anything.
+  bool Load(const rdcstr &path);
+
+  bool HasSymbols() const { return !m_Symbols.empty(); }
+  bool HasLineInfo() const { return !m_Lines.empty(); }
+  // converts an offset into the file (as seen in a /proc/<pid>/maps mapping) into the virtual
+  // address space that the symbol and line tables use.
+  uint64_t FileOffsetToAddress(uint64_t offset) const;
+
+  // look up the function containing addr. Returns an empty string if none is found. The name is
+  // demangled if possible.
+  rdcstr LookupFunction(uint64_t addr) const;
+
+  // look up the source location for addr. Returns false if there's no line information covering it
+  bool LookupLine(uint64_t addr, rdcstr &filename, uint32_t &line) const;
+
+private:
+  struct Symbol
+  {
+    uint64_t address;
+    uint64_t size;
+    const char *name;
+  };
+
+  struct LineRow
+  {
+    uint64_t address;
+    uint32_t file;
+    uint32_t line;
+    bool endSequence;
+  };
+
+  struct Segment
+  {
+    uint64_t offset;
+    uint64_t address;
+    uint64_t size;
+  };
+
+  struct MappedFile
+  {
+    void *base = NULL;
+    size_t size = 0;
+  };
+
+  template <typename Ehdr, typename Shdr, typename Phdr, typename Sym, typename Nhdr>
+  bool Parse(const MappedFile &file, bool debugFile);
+
+  void ParseLineTable(const byte *data, size_t size, const byte *lineStr, size_t lineStrSize,
+                      const byte *str, size_t strSize);
+  uint32_t AddFilename(const rdcstr &dir, const char *name);
+  void ParseSymbolTable(const byte *data, size_t size, size_t entSize, const byte *strtab,
+                        size_t strtabSize, bool elf64);
+
+  bool MapFile(const rdcstr &path, MappedFile &file);
+  const byte *GetSectionData(const byte *data, uint64_t size, uint64_t flags, bool elf64,
+                             size_t &outSize);
+  bool LoadDebugFile(const rdcstr &path);
+
+  rdcstr m_Path;
+  rdcstr m_BuildID;
+  rdcstr m_DebugLink;
+
+  rdcarray<MappedFile> m_Files;
+  // decompressed copies of any compressed debug sections, kept alive for the string pointers
+  rdcarray<byte *> m_Decompressed;
+
+  rdcarray<Segment> m_Segments;
+  rdcarray<Symbol> m_Symbols;
+  rdcarray<LineRow> m_Lines;
+  rdcarray<rdcstr> m_Filenames;
+
+  // only used while loading, to de-duplicate filenames shared between compilation units
+  std::map<rdcstr, uint32_t> m_FilenameLookup;
+  bool m_FullSymtab = false;
+};
+};    // namespace ELF
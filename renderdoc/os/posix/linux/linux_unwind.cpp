@@ -0,0 +1,736 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "linux_unwind.h"
+#include <pthread.h>
+#include <unordered_map>
+#include "common/common.h"
+#include "common/threading.h"
+
+#if defined(__x86_64__)
+
+// provided by libgcc. Finds the FDE covering pc in the same registered .eh_frame tables that the
+// regular unwinder uses, which handles modules being loaded and unloaded for us.
+struct dwarf_eh_bases
+{
+  void *tbase;
+  void *dbase;
+  void *func;
+};
+
+extern "C" const void *_Unwind_Find_FDE(void *pc, struct dwarf_eh_bases *bases);
+
+namespace
+{
+// DWARF register numbers on x86-64
+enum
+{
+  DWARF_RBP = 6,
+  DWARF_RSP = 7,
+};
+
+enum
+{
+  DW_EH_PE_absptr = 0x00,
+  DW_EH_PE_uleb128 = 0x01,
+  DW_EH_PE_udata2 = 0x02,
+  DW_EH_PE_udata4 = 0x03,
+  DW_EH_PE_udata8 = 0x04,
+  DW_EH_PE_sleb128 = 0x09,
+  DW_EH_PE_sdata2 = 0x0a,
+  DW_EH_PE_sdata4 = 0x0b,
+  DW_EH_PE_sdata8 = 0x0c,
+
+  DW_EH_PE_pcrel = 0x10,
+  DW_EH_PE_textrel = 0x20,
+  DW_EH_PE_datarel = 0x30,
+  DW_EH_PE_funcrel = 0x40,
+
+  DW_EH_PE_indirect = 0x80,
+  DW_EH_PE_omit = 0xff,
+};
+
+enum
+{
+  DW_CFA_nop = 0x00,
+  DW_CFA_set_loc = 0x01,
+  DW_CFA_advance_loc1 = 0x02,
+  DW_CFA_advance_loc2 = 0x03,
+  DW_CFA_advance_loc4 = 0x04,
+  DW_CFA_offset_extended = 0x05,
+  DW_CFA_restore_extended = 0x06,
+  DW_CFA_undefined = 0x07,
+  DW_CFA_same_value = 0x08,
+  DW_CFA_register = 0x09,
+  DW_CFA_remember_state = 0x0a,
+  DW_CFA_restore_state = 0x0b,
+  DW_CFA_def_cfa = 0x0c,
+  DW_CFA_def_cfa_register = 0x0d,
+  DW_CFA_def_cfa_offset = 0x0e,
+  DW_CFA_def_cfa_expression = 0x0f,
+  DW_CFA_expression = 0x10,
+  DW_CFA_offset_extended_sf = 0x11,
+  DW_CFA_def_cfa_sf = 0x12,
+  DW_CFA_def_cfa_offset_sf = 0x13,
+  DW_CFA_val_offset = 0x14,
+  DW_CFA_val_offset_sf = 0x15,
+  DW_CFA_val_expression = 0x16,
+  DW_CFA_GNU_args_size = 0x2e,
+  DW_CFA_GNU_negative_offset_extended = 0x2f,
+
+  // primary opcodes, in the top two bits
+  DW_CFA_advance_loc = 0x40,
+  DW_CFA_offset = 0x80,
+  DW_CFA_restore = 0xc0,
+};
+
+// reads from the in-memory unwind tables. Every read is bounds checked against the end of the
+// current CIE/FDE, and any malformed data just fails the lookup.
+struct CFIReader
+{
+  const byte *cur;
+  const byte *end;
+  bool ok;
+
+  template <typename T>
+  T Read()
+  {
+    if(cur + sizeof(T) > end)
+    {
+      ok = false;
+      cur = end;
+      return T();
+    }
+    T ret;
+    memcpy(&ret, cur, sizeof(T));
+    cur += sizeof(T);
+    return ret;
+  }
+
+  uint64_t ULEB()
+  {
+    uint64_t ret = 0;
+    uint32_t shift = 0;
+    byte b;
+    do
+    {
+      b = Read<byte>();
+      if(shift < 64)
+        ret |= uint64_t(b & 0x7f) << shift;
+      shift += 7;
+    } while(ok && (b & 0x80));
+    return ret;
+  }
+
+  int64_t SLEB()
+  {
+    int64_t ret = 0;
+    uint32_t shift = 0;
+    byte b;
+    do
+    {
+      b = Read<byte>();
+      if(shift < 64)
+        ret |= int64_t(b & 0x7f) << shift;
+      shift += 7;
+    } while(ok && (b & 0x80));
+    if(shift < 64 && (b & 0x40))
+      ret |= -(int64_t(1) << shift);
+    return ret;
+  }
+
+  void Skip(uint64_t bytes)
+  {
+    if(bytes > uint64_t(end - cur))
+    {
+      ok = false;
+      cur = end;
+      return;
+    }
+    cur += bytes;
+  }
+
+  uint64_t Encoded(uint8_t enc, const dwarf_eh_bases &bases, bool deref)
+  {
+    if(enc == DW_EH_PE_omit)
+      return 0;
+
+    const byte *field = cur;
+    uint64_t ret = 0;
+
+    switch(enc & 0x0f)
+    {
+      case DW_EH_PE_absptr: ret = Read<uint64_t>(); break;
+      case DW_EH_PE_uleb128: ret = ULEB(); break;
+      case DW_EH_PE_udata2: ret = Read<uint16_t>(); break;
+      case DW_EH_PE_udata4: ret = Read<uint32_t>(); break;
+      case DW_EH_PE_udata8: ret = Read<uint64_t>(); break;
+      case DW_EH_PE_sleb128: ret = (uint64_t)SLEB(); break;
+      case DW_EH_PE_sdata2: ret = (uint64_t)(int64_t)Read<int16_t>(); break;
+      case DW_EH_PE_sdata4: ret = (uint64_t)(int64_t)Read<int32_t>(); break;
+      case DW_EH_PE_sdata8: ret = (uint64_t)Read<int64_t>(); break;
+      default: ok = false; return 0;
+    }
+
+    switch(enc & 0x70)
+    {
+      case 0: break;
+      case DW_EH_PE_pcrel: ret += (uint64_t)field; break;
+      case DW_EH_PE_textrel: ret += (uint64_t)bases.tbase; break;
+      case DW_EH_PE_datarel: ret += (uint64_t)bases.dbase; break;
+      case DW_EH_PE_funcrel: ret += (uint64_t)bases.func; break;
+      default: ok = false; return 0;
+    }
+
+    if((enc & DW_EH_PE_indirect) && deref && ok && ret)
+      memcpy(&ret, (const void *)ret, sizeof(ret));
+
+    return ret;
+  }
+};
+
+struct CIEInfo
+{
+  uint64_t codeAlign = 1;
+  int64_t dataAlign = 1;
+  uint64_t raReg = 16;
+  uint8_t fdeEncoding = DW_EH_PE_absptr;
+  bool hasAugData = false;
+  bool signalFrame = false;
+  const byte *instructions = NULL;
+  const byte *end = NULL;
+};
+
+// reads the initial length of a CIE or FDE, returning the end of the entry and whether it uses the
+// 64-bit DWARF format.
+bool ReadLength(CFIReader &reader, bool &dwarf64)
+{
+  uint64_t length = reader.Read<uint32_t>();
+  dwarf64 = false;
+  if(length == 0xffffffff)
+  {
+    dwarf64 = true;
+    length = reader.Read<uint64_t>();
+  }
+
+  if(!reader.ok || length == 0)
+    return false;
+
+  reader.end = reader.cur + length;
+  return true;
+}
+
+bool ParseCIE(const byte *cie, CIEInfo &info)
+{
+  // lengths are validated as we go, so start out unbounded until we know the real size
+  CFIReader reader = {cie, cie + 12, true};
+
+  bool dwarf64 = false;
+  if(!ReadLength(reader, dwarf64))
+    return false;
+
+  uint64_t id = dwarf64 ? reader.Read<uint64_t>() : reader.Read<uint32_t>();
+  if(id != 0)
+    return false;
+
+  byte version = reader.Read<byte>();
+  if(version != 1 && version != 3)
+    return false;
+
+  const char *augmentation = (const char *)reader.cur;
+  while(reader.ok && reader.Read<byte>() != 0)
+    ;
+
+  if(augmentation[0] != 0 && augmentation[0] != 'z')
+  {
+    // only the old GCC "eh" augmentation precedes the alignment fields without the 'z' length, and
+    // nothing on x86-64 should still produce it
+    return false;
+  }
+
+  info.codeAlign = reader.ULEB();
+  info.dataAlign = reader.SLEB();
+  info.raReg = version == 1 ? reader.Read<byte>() : reader.ULEB();
+
+  if(augmentation[0] == 'z')
+  {
+    info.hasAugData = true;
+    uint64_t augLength = reader.ULEB();
+    const byte *augEnd = reader.cur + augLength;
+
+    dwarf_eh_bases bases = {};
+
+    for(const char *a = augmentation + 1; *a && reader.ok; a++)
+    {
+      if(*a == 'R')
+      {
+        info.fdeEncoding = reader.Read<byte>();
+      }
+      else if(*a == 'L')
+      {
+        reader.Read<byte>();
+      }
+      else if(*a == 'P')
+      {
+        byte enc = reader.Read<byte>();
+        reader.Encoded(enc, bases, false);
+      }
+      else if(*a == 'S')
+      {
+        info.signalFrame = true;
+      }
+      else
+      {
+        // unknown augmentation, the length lets us skip the rest safely
+        break;
+      }
+    }
+
+    reader.cur = augEnd;
+  }
+
+  info.instructions = reader.cur;
+  info.end = reader.end;
+
+  return reader.ok && info.instructions <= info.end;
+}
+
+enum class RegRule : uint8_t
+{
+  // the register has the same value in the caller
+  Same,
+  // the register is saved at CFA + offset
+  Offset,
+  // the register isn't recoverable - for the return address this marks the outermost frame
+  Undefined,
+  // any rule we don't evaluate, like a DWARF expression or a copy from another register
+  Unsupported,
+};
+
+struct CFARow
+{
+  int64_t cfaReg = -1;
+  int64_t cfaOffset = 0;
+
+  RegRule rbp = RegRule::Same;
+  int64_t rbpOffset = 0;
+
+  RegRule ra = RegRule::Undefined;
+  int64_t raOffset = 0;
+};
+
+void SetRule(CFARow &row, const CIEInfo &cie, uint64_t reg, RegRule rule, int64_t offset)
+{
+  if(reg == DWARF_RBP)
+  {
+    row.rbp = rule;
+    row.rbpOffset = offset;
+  }
+  else if(reg == cie.raReg)
+  {
+    row.ra = rule;
+    row.raOffset = offset;
+  }
+}
+
+void RestoreRule(CFARow &row, const CFARow &initial, const CIEInfo &cie, uint64_t reg)
+{
+  if(reg == DWARF_RBP)
+  {
+    row.rbp = initial.rbp;
+    row.rbpOffset = initial.rbpOffset;
+  }
+  else if(reg == cie.raReg)
+  {
+    row.ra = initial.ra;
+    row.raOffset = initial.raOffset;
+  }
+}
+
+// runs CFA instructions until the row covering target has been reached. The CIE's initial
+// instructions are run with target = ~0 since they never advance the location.
+bool Execute(CFIReader reader, const CIEInfo &cie, const dwarf_eh_bases &bases, uint64_t loc,
+             uint64_t target, const CFARow &initial, CFARow &row)
+{
+  CFARow stateStack[8];
+  int stackDepth = 0;
+
+  while(reader.ok && reader.cur < reader.end)
+  {
+    byte op = reader.Read<byte>();
+    byte primary = op & 0xc0;
+    byte operand = op & 0x3f;
+
+    uint64_t delta = 0;
+    bool advance = false;
+
+    if(primary == DW_CFA_advance_loc)
+    {
+      delta = operand * cie.codeAlign;
+      advance = true;
+    }
+    else if(primary == DW_CFA_offset)
+    {
+      SetRule(row, cie, operand, RegRule::Offset, int64_t(reader.ULEB()) * cie.dataAlign);
+    }
+    else if(primary == DW_CFA_restore)
+    {
+      RestoreRule(row, initial, cie, operand);
+    }
+    else
+    {
+      switch(op)
+      {
+        case DW_CFA_nop: break;
+        case DW_CFA_set_loc:
+        {
+          uint64_t newLoc = reader.Encoded(cie.fdeEncoding & 0x7f, bases, false);
+          if(newLoc > target)
+            return reader.ok;
+          loc = newLoc;
+          break;
+        }
+        case DW_CFA_advance_loc1:
+          delta = reader.Read<uint8_t>() * cie.codeAlign;
+          advance = true;
+          break;
+        case DW_CFA_advance_loc2:
+          delta = reader.Read<uint16_t>() * cie.codeAlign;
+          advance = true;
+          break;
+        case DW_CFA_advance_loc4:
+          delta = reader.Read<uint32_t>() * cie.codeAlign;
+          advance = true;
+          break;
+        case DW_CFA_offset_extended:
+        {
+          uint64_t reg = reader.ULEB();
+          SetRule(row, cie, reg, RegRule::Offset, int64_t(reader.ULEB()) * cie.dataAlign);
+          break;
+        }
+        case DW_CFA_offset_extended_sf:
+        {
+          uint64_t reg = reader.ULEB();
+          SetRule(row, cie, reg, RegRule::Offset, reader.SLEB() * cie.dataAlign);
+          break;
+        }
+        case DW_CFA_GNU_negative_offset_extended:
+        {
+          uint64_t reg = reader.ULEB();
+          SetRule(row, cie, reg, RegRule::Offset, -int64_t(reader.ULEB()) * cie.dataAlign);
+          break;
+        }
+        case DW_CFA_restore_extended: RestoreRule(row, initial, cie, reader.ULEB()); break;
+        case DW_CFA_undefined: SetRule(row, cie, reader.ULEB(), RegRule::Undefined, 0); break;
+        case DW_CFA_same_value: SetRule(row, cie, reader.ULEB(), RegRule::Same, 0); break;
+        case DW_CFA_register:
+        {
+          uint64_t reg = reader.ULEB();
+          reader.ULEB();
+          SetRule(row, cie, reg, RegRule::Unsupported, 0);
+          break;
+        }
+        case DW_CFA_val_offset:
+        {
+          uint64_t reg = reader.ULEB();
+          reader.ULEB();
+          SetRule(row, cie, reg, RegRule::Unsupported, 0);
+          break;
+        }
+        case DW_CFA_val_offset_sf:
+        {
+          uint64_t reg = reader.ULEB();
+          reader.SLEB();
+          SetRule(row, cie, reg, RegRule::Unsupported, 0);
+          break;
+        }
+        case DW_CFA_expression:
+        case DW_CFA_val_expression:
+        {
+          uint64_t reg = reader.ULEB();
+          reader.Skip(reader.ULEB());
+          SetRule(row, cie, reg, RegRule::Unsupported, 0);
+          break;
+        }
+        case DW_CFA_remember_state:
+          if(stackDepth >= (int)ARRAY_COUNT(stateStack))
+            return false;
+          stateStack[stackDepth++] = row;
+          break;
+        case DW_CFA_restore_state:
+        {
+          if(stackDepth == 0)
+            return false;
+          // the CFA itself isn't part of the remembered state
+          int64_t cfaReg = row.cfaReg;
+          int64_t cfaOffset = row.cfaOffset;
+          row = stateStack[--stackDepth];
+          row.cfaReg = cfaReg;
+          row.cfaOffset = cfaOffset;
+          break;
+        }
+        case DW_CFA_def_cfa:
+          row.cfaReg = (int64_t)reader.ULEB();
+          row.cfaOffset = (int64_t)reader.ULEB();
+          break;
+        case DW_CFA_def_cfa_sf:
+          row.cfaReg = (int64_t)reader.ULEB();
+          row.cfaOffset = reader.SLEB() * cie.dataAlign;
+          break;
+        case DW_CFA_def_cfa_register: row.cfaReg = (int64_t)reader.ULEB(); break;
+        case DW_CFA_def_cfa_offset: row.cfaOffset = (int64_t)reader.ULEB(); break;
+        case DW_CFA_def_cfa_offset_sf: row.cfaOffset = reader.SLEB() * cie.dataAlign; break;
+        case DW_CFA_def_cfa_expression:
+          reader.Skip(reader.ULEB());
+          row.cfaReg = -1;
+          break;
+        case DW_CFA_GNU_args_size: reader.ULEB(); break;
+        default:
+          // unknown opcode, we can't know how many operands to skip
+          return false;
+      }
+    }
+
+    if(advance)
+    {
+      if(loc + delta > target)
+        return reader.ok;
+      loc += delta;
+    }
+  }
+
+  return reader.ok;
+}
+
+// the evaluated unwind rule at a given address, in the only forms we need to step a frame.
+struct UnwindRule
+{
+  // false if we can't unwind past this address, either because there's no unwind info or because
+  // it uses rules we don't evaluate.
+  bool valid = false;
+  // the return address is undefined, so this is the outermost frame
+  bool outermost = false;
+  bool cfaFromRBP = false;
+  bool rbpSaved = false;
+  int32_t cfaOffset = 0;
+  int32_t rbpOffset = 0;
+  int32_t raOffset = 0;
+};
+
+UnwindRule ComputeRule(uint64_t pc)
+{
+  UnwindRule ret;
+
+  dwarf_eh_bases bases = {};
+  const byte *fde = (const byte *)_Unwind_Find_FDE((void *)pc, &bases);
+  if(!fde)
+    return ret;
+
+  CFIReader reader = {fde, fde + 12, true};
+
+  bool dwarf64 = false;
+  if(!ReadLength(reader, dwarf64))
+    return ret;
+
+  // the CIE pointer is relative to its own location
+  const byte *ciePointer = reader.cur;
+  uint64_t cieOffset = dwarf64 ? reader.Read<uint64_t>() : reader.Read<uint32_t>();
+  if(!reader.ok || cieOffset == 0)
+    return ret;
+
+  CIEInfo cie;
+  if(!ParseCIE(ciePointer - cieOffset, cie) || cie.signalFrame)
+    return ret;
+
+  uint64_t pcBegin = reader.Encoded(cie.fdeEncoding, bases, true);
+  reader.Encoded(cie.fdeEncoding & 0x0f, bases, false);
+
+  if(cie.hasAugData)
+    reader.Skip(reader.ULEB());
+
+  if(!reader.ok)
+    return ret;
+
+  CFARow initial;
+  if(!Execute({cie.instructions, cie.end, true}, cie, bases, pcBegin, ~0ULL, initial, initial))
+    return ret;
+
+  CFARow row = initial;
+  if(!Execute(reader, cie, bases, pcBegin, pc, initial, row))
+    return ret;
+
+  if(row.ra == RegRule::Undefined)
+  {
+    ret.valid = true;
+    ret.outermost = true;
+    return ret;
+  }
+
+  if(row.cfaReg != DWARF_RSP && row.cfaReg != DWARF_RBP)
+    return ret;
+
+  if(row.ra != RegRule::Offset || (row.rbp != RegRule::Same && row.rbp != RegRule::Offset))
+    return ret;
+
+  ret.valid = true;
+  ret.cfaFromRBP = (row.cfaReg == DWARF_RBP);
+  ret.cfaOffset = (int32_t)row.cfaOffset;
+  ret.raOffset = (int32_t)row.raOffset;
+  ret.rbpSaved = (row.rbp == RegRule::Offset);
+  ret.rbpOffset = (int32_t)row.rbpOffset;
+
+  return ret;
+}
+
+// rules are keyed by the address they were evaluated for. Code addresses only ever get reused if
+// a module is unloaded and another loaded in its place, which we don't try to detect.
+Threading::RWLock ruleLock;
+std::unordered_map<uint64_t, UnwindRule> ruleCache;
+
+UnwindRule GetSharedRule(uint64_t pc)
+{
+  {
+    SCOPED_READLOCK(ruleLock);
+    auto it = ruleCache.find(pc);
+    if(it != ruleCache.end())
+      return it->second;
+  }
+
+  UnwindRule rule = ComputeRule(pc);
+
+  {
+    SCOPED_WRITELOCK(ruleLock);
+    ruleCache[pc] = rule;
+  }
+
+  return rule;
+}
+
+// a small per-thread direct-mapped cache in front of the shared one, so that the common case of
+// walking through the same frames again doesn't touch the lock at all. Our own TLS slots have no
+// destructors, so these use a pthread key directly to be freed when their thread exits.
+struct ThreadRuleCache
+{
+  static const size_t Size = 256;
+  uint64_t pcs[Size] = {};
+  UnwindRule rules[Size];
+};
+
+pthread_key_t threadCacheKey;
+
+void FreeThreadRuleCache(void *cache)
+{
+  delete(ThreadRuleCache *)cache;
+}
+
+UnwindRule GetRule(uint64_t pc)
+{
+  ThreadRuleCache *cache = (ThreadRuleCache *)pthread_getspecific(threadCacheKey);
+  if(!cache)
+  {
+    cache = new ThreadRuleCache;
+    pthread_setspecific(threadCacheKey, cache);
+  }
+
+  // pc zero never has a rule, so it's safe to use to mark unused entries.
+  size_t slot = (pc ^ (pc >> 8)) & (ThreadRuleCache::Size - 1);
+  if(cache->pcs[slot] == pc)
+    return cache->rules[slot];
+
+  UnwindRule rule = GetSharedRule(pc);
+  cache->pcs[slot] = pc;
+  cache->rules[slot] = rule;
+  return rule;
+}
+};
+
+namespace Unwind
+{
+void Init()
+{
+  int err = pthread_key_create(&threadCacheKey, &FreeThreadRuleCache);
+  if(err != 0)
+    RDCFATAL("Can't allocate TLS key for unwind caches");
+}
+
+__attribute__((noinline)) int FastBacktrace(void **addrs, int maxLevels)
+{
+  uint64_t pc, sp, fp;
+  asm volatile(
+      "lea 0(%%rip), %0\n"
+      "mov %%rsp, %1\n"
+      "mov %%rbp, %2\n"
+      : "=r"(pc), "=r"(sp), "=r"(fp));
+
+  int numLevels = 0;
+
+  // the first lookup is for the exact pc we captured above, after that we look up return addresses
+  // minus one so that we land inside the call instruction, in case the call was the last
+  // instruction in the function.
+  uint64_t lookup = pc;
+
+  while(numLevels < maxLevels)
+  {
+    UnwindRule rule = GetRule(lookup);
+    if(!rule.valid || rule.outermost)
+      break;
+
+    uint64_t cfa = (rule.cfaFromRBP ? fp : sp) + (int64_t)rule.cfaOffset;
+
+    // the stack must strictly unwind towards higher addresses, anything else means the rule or the
+    // registers we've recovered are bogus.
+    if(cfa <= sp || (cfa & 0x7) != 0)
+      break;
+
+    uint64_t ra = *(const uint64_t *)(cfa + (int64_t)rule.raOffset);
+    if(rule.rbpSaved)
+      fp = *(const uint64_t *)(cfa + (int64_t)rule.rbpOffset);
+    sp = cfa;
+
+    if(ra == 0)
+      break;
+
+    addrs[numLevels++] = (void *)ra;
+    lookup = ra - 1;
+  }
+
+  return numLevels;
+}
+};
+
+#else
+
+namespace Unwind
+{
+void Init()
+{
+}
+
+int FastBacktrace(void **addrs, int maxLevels)
+{
+  return -1;
+}
+};
+
+#endif    // defined(__x86_64__)
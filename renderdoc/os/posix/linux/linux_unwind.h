@@ -0,0 +1,43 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+namespace Unwind
+{
+// must be called once before FastBacktrace is used.
+void Init();
+
+// walks the calling thread's stack using the .eh_frame unwind tables, the same as backtrace() but
+// without going through the generic _Unwind_Backtrace machinery. The unwind rule for each return
+// address is evaluated once and cached, so repeated walks through the same code only cost a hash
+// lookup and a couple of loads per frame.
+//
+// Frames whose unwind rules can't be represented simply (signal frames, DWARF expressions, a CFA
+// not based on rsp/rbp) end the walk, so the stack may be truncated compared to backtrace().
+//
+// Returns the number of return addresses written to addrs, innermost first, or -1 if fast
+// unwinding isn't supported on this platform and backtrace() should be used instead.
+int FastBacktrace(void **addrs, int maxLevels);
+};
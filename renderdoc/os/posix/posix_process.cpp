@@ -24,7 +24,9 @@
 
 #include <dlfcn.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <limits.h>
+#include <poll.h>
 #include <pwd.h>
 #include <signal.h>
 #include <stdlib.h>
@@ -491,11 +493,11 @@ static pid_t RunProcess(const char *app, const char *workingDir, const char *cmd
 
         a = "";
       }
-      else if(!dquot && *c == '"')
+      else if(!dquot && !squot && *c == '"')
       {
         dquot = true;
       }
-      else if(!squot && *c == '\'')
+      else if(!squot && !dquot && *c == '\'')
       {
         squot = true;
       }
@@ -593,9 +595,10 @@ static pid_t RunProcess(const char *app, const char *workingDir, const char *cmd
       fprintf(stderr, "exec failed\n");
       _exit(1);
     }
-    else
+    else if(stdoutPipe == NULL)
     {
-      // remember this PID so we can wait on it later
+      // remember this PID so we can wait on it later. When the output is being captured the caller
+      // waits on the child itself to get its exit status, so it mustn't be reaped here.
       SCOPED_SPINLOCK(zombieLock);
 
       PIDNode *node = NULL;
@@ -631,6 +634,22 @@ rdcpair<ReplayStatus, uint32_t> Process::InjectIntoProcess(
   return {ReplayStatus::InjectionFailed, 0};
 }
 
+// the pipe handles are close-on-exec so that processes launched concurrently from other threads
+// don't inherit them, which would stop us seeing the end of the output until they also exit.
+static bool CreatePipe(int fds[2])
+{
+#if ENABLED(RDOC_APPLE)
+  if(pipe(fds) == -1)
+    return false;
+
+  fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+  fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+  return true;
+#else
+  return pipe2(fds, O_CLOEXEC) == 0;
+#endif
+}
+
 uint32_t Process::LaunchProcess(const char *app, const char *workingDir, const char *cmdLine,
                                 bool internal, ProcessResult *result)
 {
@@ -643,9 +662,9 @@ uint32_t Process::LaunchProcess(const char *app, const char *workingDir, const c
   int stdoutPipe[2], stderrPipe[2];
   if(result)
   {
-    if(pipe(stdoutPipe) == -1)
+    if(!CreatePipe(stdoutPipe))
       RDCERR("Could not create stdout pipe");
-    if(pipe(stderrPipe) == -1)
+    if(!CreatePipe(stderrPipe))
       RDCERR("Could not create stderr pipe");
   }
 
@@ -657,25 +676,47 @@ uint32_t Process::LaunchProcess(const char *app, const char *workingDir, const c
   {
     result->strStdout = "";
     result->strStderror = "";
+    result->retCode = -1;
 
     if(ret)
     {
-      ssize_t stdoutRead, stderrRead;
+      // read both pipes as data arrives, so a child that fills one while we're blocked on the other
+      // can't stall
+      pollfd fds[2] = {{stdoutPipe[0], POLLIN, 0}, {stderrPipe[0], POLLIN, 0}};
+      rdcstr *outputs[2] = {&result->strStdout, &result->strStderror};
       char chBuf[4096];
-      do
+
+      while(fds[0].fd >= 0 || fds[1].fd >= 0)
       {
-        stdoutRead = read(stdoutPipe[0], chBuf, sizeof(chBuf));
-        if(stdoutRead > 0)
-          result->strStdout += rdcstr(chBuf, stdoutRead);
-      } while(stdoutRead > 0);
+        if(poll(fds, 2, -1) < 0)
+        {
+          if(errno == EINTR)
+            continue;
+          break;
+        }
+
+        for(int i = 0; i < 2; i++)
+        {
+          if(fds[i].revents == 0)
+            continue;
+
+          ssize_t numRead = read(fds[i].fd, chBuf, sizeof(chBuf));
+          if(numRead > 0)
+            *outputs[i] += rdcstr(chBuf, numRead);
+          else if(numRead == 0 || errno != EINTR)
+            fds[i].fd = -1;
+        }
+      }
 
+      int status = 0;
+      pid_t waited;
       do
       {
-        stderrRead = read(stderrPipe[0], chBuf, sizeof(chBuf));
-        if(stderrRead > 0)
-          result->strStderror += rdcstr(chBuf, stderrRead);
+        waited = waitpid((pid_t)ret, &status, 0);
+      } while(waited < 0 && errno == EINTR);
 
-      } while(stderrRead > 0);
+      if(waited == (pid_t)ret && WIFEXITED(status))
+        result->retCode = WEXITSTATUS(status);
     }
 
     // Close read ends.
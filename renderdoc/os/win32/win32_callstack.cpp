@@ -1070,7 +1070,7 @@ void Init()
     ::InitDbgHelp();
 }
 
-Stackwalk *Collect()
+Stackwalk *Collect(bool fastUnwind)
 {
   return new Win32Callstack();
 }
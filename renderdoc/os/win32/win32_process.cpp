@@ -1017,8 +1017,23 @@ uint32_t Process::LaunchProcess(const char *app, const char *workingDir, const c
     result->strStdout = "";
     result->strStderror = "";
 
+    // drain stderr on another thread, otherwise a child that fills the stderr pipe blocks forever
+    // while we're still waiting for stdout to close.
+    Threading::ThreadHandle errThread = Threading::CreateThread([hChildStdError_Rd, result]() {
+      char chBuf[4096];
+      DWORD dwErrorRead;
+      for(;;)
+      {
+        BOOL success = ReadFile(hChildStdError_Rd, chBuf, sizeof(chBuf), &dwErrorRead, NULL);
+        result->strStderror += rdcstr(chBuf, dwErrorRead);
+
+        if(!success && !dwErrorRead)
+          break;
+      }
+    });
+
     char chBuf[4096];
-    DWORD dwOutputRead, dwErrorRead;
+    DWORD dwOutputRead;
     BOOL success = FALSE;
     rdcstr s;
     for(;;)
@@ -1031,15 +1046,8 @@ uint32_t Process::LaunchProcess(const char *app, const char *workingDir, const c
         break;
     }
 
-    for(;;)
-    {
-      success = ReadFile(hChildStdError_Rd, chBuf, sizeof(chBuf), &dwErrorRead, NULL);
-      s = rdcstr(chBuf, dwErrorRead);
-      result->strStderror += s;
-
-      if(!success && !dwErrorRead)
-        break;
-    }
+    Threading::JoinThread(errThread);
+    Threading::CloseThread(errThread);
 
     CloseHandle(hChildStdOutput_Rd);
     CloseHandle(hChildStdError_Rd);
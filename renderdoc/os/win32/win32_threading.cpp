@@ -306,4 +306,11 @@ void Sleep(uint32_t milliseconds)
 {
   ::Sleep((DWORD)milliseconds);
 }
+
+uint32_t NumberOfCores()
+{
+  SYSTEM_INFO info = {};
+  GetSystemInfo(&info);
+  return RDCMAX((uint32_t)info.dwNumberOfProcessors, 1U);
+}
 };
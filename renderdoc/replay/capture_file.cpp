@@ -22,15 +22,19 @@
  * THE SOFTWARE.
  ******************************************************************************/
 
+#include <algorithm>
+#include "common/threading.h"
 #include "core/core.h"
 #include "jpeg-compressor/jpgd.h"
 #include "jpeg-compressor/jpge.h"
 #include "replay/replay_controller.h"
 #include "serialise/rdcfile.h"
 #include "serialise/serialiser.h"
+#include "serialise/zstdio.h"
 #include "stb/stb_image.h"
 #include "stb/stb_image_resize.h"
 #include "stb/stb_image_write.h"
+#include "strings/string_utils.h"
 
 static void writeToByteVector(void *context, void *data, int size)
 {
@@ -127,6 +131,8 @@ public:
 
   ReplayStatus Convert(const char *filename, const char *filetype, const SDFile *file,
                        RENDERDOC_ProgressCallback progress);
+  ReplayStatus Recompress(const char *filename, int compressionLevel, uint32_t numThreads,
+                          bool useDictionary, RENDERDOC_ProgressCallback progress);
 
   rdcarray<CaptureFileFormat> GetCaptureFileFormats()
   {
@@ -176,6 +182,9 @@ private:
   ReplayStatus Init();
 
   void InitStructuredData(RENDERDOC_ProgressCallback progress = RENDERDOC_ProgressCallback());
+  ReplayStatus WriteRDC(const char *filename, const SDFile *file, int zstdLevel,
+                        uint32_t numThreads, bool useDictionary,
+                        RENDERDOC_ProgressCallback progress);
 
   RDCFile *m_RDC = NULL;
   Callstack::StackResolver *m_Resolver = NULL;
@@ -441,8 +450,39 @@ ReplayStatus CaptureFile::Convert(const char *filename, const char *filetype, co
   if(filetype != NULL && strcmp(filetype, "") && strcmp(filetype, "rdc"))
     RDCWARN("Converting file to unrecognised filetype '%s' - treating as 'rdc'", filetype);
 
+  return WriteRDC(filename, file, 0, 1, false, progress);
+}
+
+ReplayStatus CaptureFile::Recompress(const char *filename, int compressionLevel,
+                                     uint32_t numThreads, bool useDictionary,
+                                     RENDERDOC_ProgressCallback progress)
+{
+  if(!m_RDC)
+  {
+    RDCERR("Data missing for creation of file, set metadata first.");
+    return ReplayStatus::FileCorrupted;
+  }
+
+  if(!progress)
+    progress = [](float) {};
+
+  if(numThreads == 0)
+    numThreads = Threading::NumberOfCores();
+
+  return WriteRDC(filename, NULL, compressionLevel, numThreads, useDictionary, progress);
+}
+
+ReplayStatus CaptureFile::WriteRDC(const char *filename, const SDFile *file, int zstdLevel,
+                                   uint32_t numThreads, bool useDictionary,
+                                   RENDERDOC_ProgressCallback progress)
+{
+  RENDERDOC_ProgressCallback fetchProgress = [progress](float p) { progress(p * 0.5f); };
+  RENDERDOC_ProgressCallback exportProgress = [progress](float p) { progress(0.5f + p * 0.5f); };
+
   RDCFile output;
 
+  output.SetZstdCompression(zstdLevel, numThreads);
+
   output.SetData(m_RDC->GetDriver(), m_RDC->GetDriverName().c_str(), m_RDC->GetMachineIdent(),
                  &m_RDC->GetThumbnail());
 
@@ -496,6 +536,19 @@ ReplayStatus CaptureFile::Convert(const char *filename, const char *filetype, co
     SectionProperties props = m_RDC->GetSectionProperties(frameCaptureIndex);
     props.flags = SectionFlags::ZstdCompressed;
 
+    if(useDictionary)
+    {
+      StreamReader *reader = m_RDC->ReadSection(frameCaptureIndex);
+      bytebuf dictionary = BuildZSTDDictionary(*reader);
+      delete reader;
+
+      if(!dictionary.empty())
+      {
+        output.SetZstdDictionary(dictionary);
+        props.flags |= SectionFlags::ZstdDictionary;
+      }
+    }
+
     StreamWriter *writer = output.WriteSection(props);
     StreamReader *reader = m_RDC->ReadSection(frameCaptureIndex);
 
@@ -507,6 +560,26 @@ ReplayStatus CaptureFile::Convert(const char *filename, const char *filetype, co
 
     delete reader;
     delete writer;
+
+    // the frame capture must always be the first section, so the dictionary it was compressed
+    // with is written immediately after it. The dictionary flag is dropped when writing if the
+    // dictionary couldn't be used, so check what was actually written.
+    if(success && (output.GetSectionProperties(0).flags & SectionFlags::ZstdDictionary))
+    {
+      SectionProperties dictProps;
+      dictProps.type = SectionType::ZstdDictionary;
+      dictProps.flags = SectionFlags::ZstdCompressed;
+
+      writer = output.WriteSection(dictProps);
+
+      const bytebuf &dictionary = output.GetZstdDictionary();
+      writer->Write(dictionary.data(), dictionary.size());
+      writer->Finish();
+
+      success = !writer->IsErrored();
+
+      delete writer;
+    }
   }
 
   if(!success)
@@ -517,7 +590,9 @@ ReplayStatus CaptureFile::Convert(const char *filename, const char *filetype, co
   {
     const SectionProperties &props = m_RDC->GetSectionProperties(i);
 
-    if(props.type == SectionType::FrameCapture)
+    // any dictionary in the source has already been applied when reading, and we write our own
+    // dictionary above if we want one.
+    if(props.type == SectionType::FrameCapture || props.type == SectionType::ZstdDictionary)
       continue;
 
     StreamWriter *writer = output.WriteSection(props);
@@ -539,16 +614,11 @@ ReplayStatus CaptureFile::Convert(const char *filename, const char *filetype, co
   return ReplayStatus::Succeeded;
 }
 
-Thumbnail CaptureFile::GetThumbnail(FileType type, uint32_t maxsize)
+static Thumbnail convertThumbnail(const RDCThumb &thumb, FileType type, uint32_t maxsize)
 {
   Thumbnail ret;
   ret.type = type;
 
-  if(m_RDC == NULL)
-    return ret;
-
-  const RDCThumb &thumb = m_RDC->GetThumbnail();
-
   const byte *thumbbuf = thumb.pixels;
   size_t thumblen = thumb.len;
   uint32_t thumbwidth = thumb.width, thumbheight = thumb.height;
@@ -684,6 +754,18 @@ Thumbnail CaptureFile::GetThumbnail(FileType type, uint32_t maxsize)
   return ret;
 }
 
+Thumbnail CaptureFile::GetThumbnail(FileType type, uint32_t maxsize)
+{
+  if(m_RDC == NULL)
+  {
+    Thumbnail ret;
+    ret.type = type;
+    return ret;
+  }
+
+  return convertThumbnail(m_RDC->GetThumbnail(), type, maxsize);
+}
+
 int CaptureFile::GetSectionCount()
 {
   if(!m_RDC)
@@ -813,12 +895,11 @@ rdcarray<rdcstr> CaptureFile::GetResolve(const rdcarray<uint64_t> &callstack)
     return ret;
   }
 
-  ret.reserve(callstack.size());
-  for(uint64_t frame : callstack)
-  {
-    Callstack::AddressDetails info = m_Resolver->GetAddr(frame);
+  rdcarray<Callstack::AddressDetails> details = m_Resolver->GetAddrs(callstack);
+
+  ret.reserve(details.size());
+  for(Callstack::AddressDetails &info : details)
     ret.push_back(info.formattedString());
-  }
 
   return ret;
 }
@@ -827,3 +908,318 @@ extern "C" RENDERDOC_API ICaptureFile *RENDERDOC_CC RENDERDOC_OpenCaptureFile()
 {
   return new CaptureFile();
 }
+
+extern "C" RENDERDOC_API void RENDERDOC_CC
+RENDERDOC_GetCaptureThumbnails(const rdcstr &path, FileType type, uint32_t maxsize,
+                               rdcarray<rdcpair<rdcstr, Thumbnail>> *thumbnails)
+{
+  if(thumbnails == NULL)
+    return;
+
+  thumbnails->clear();
+
+  rdcarray<PathEntry> files;
+  FileIO::GetFilesInDirectory(path.c_str(), files);
+
+  if(files.size() == 1 && (files[0].flags & (PathProperty::ErrorAccessDenied |
+                                             PathProperty::ErrorInvalidPath |
+                                             PathProperty::ErrorUnknown)))
+  {
+    RDCERR("Couldn't list captures in '%s'", path.c_str());
+    return;
+  }
+
+  std::sort(files.begin(), files.end());
+
+  for(const PathEntry &f : files)
+  {
+    if(f.flags & PathProperty::Directory)
+      continue;
+
+    const rdcstr &fn = f.filename;
+    if(fn.size() < 4 || strlower(fn.substr(fn.size() - 4)) != ".rdc")
+      continue;
+
+    rdcpair<rdcstr, Thumbnail> entry;
+    entry.first = path + "/" + fn;
+    entry.second.type = type;
+    thumbnails->push_back(entry);
+  }
+
+  // each capture only needs its header and thumbnail read, so the work is dominated by the
+  // thumbnail decode and re-encode. Spread whole captures over the available cores.
+  auto extract = [thumbnails, type, maxsize](uint32_t i) {
+    rdcpair<rdcstr, Thumbnail> &entry = (*thumbnails)[i];
+
+    RDCFile rdc;
+    rdc.OpenHeader(entry.first.c_str());
+
+    if(rdc.ErrorCode() != ContainerError::NoError)
+    {
+      RDCWARN("Couldn't read thumbnail from '%s': %s", entry.first.c_str(),
+              rdc.ErrorString().c_str());
+      return;
+    }
+
+    entry.second = convertThumbnail(rdc.GetThumbnail(), type, maxsize);
+  };
+
+  Threading::ParallelFor((uint32_t)thumbnails->size(), Threading::NumberOfCores(), extract);
+}
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "3rdparty/catch/catch.hpp"
+
+TEST_CASE("Extract thumbnails from a directory of captures", "[capturefile]")
+{
+  rdcstr dir = FileIO::GetTempFolderFilename() + "/renderdoc_thumbnail_test";
+
+  const uint16_t width = 64, height = 32;
+
+  bytebuf pixels;
+  pixels.resize(width * height * 3);
+  for(size_t i = 0; i < pixels.size(); i++)
+    pixels[i] = byte(i & 0xff);
+
+  bytebuf extPixels;
+  extPixels.resize(width * height * 4 * 3);
+  for(size_t i = 0; i < extPixels.size(); i++)
+    extPixels[i] = byte((i * 7) & 0xff);
+
+  RDCThumb thumb;
+  thumb.pixels = pixels.data();
+  thumb.len = (uint32_t)pixels.size();
+  thumb.width = width;
+  thumb.height = height;
+  thumb.format = FileType::Raw;
+
+  rdcarray<rdcstr> files = {dir + "/a.rdc", dir + "/b.rdc", dir + "/c.rdc"};
+
+  FileIO::CreateParentDirectory(files[0]);
+
+  for(const rdcstr &f : files)
+  {
+    RDCFile rdc;
+    rdc.SetData(RDCDriver::Vulkan, "Vulkan", 0, &thumb);
+    rdc.Create(f.c_str());
+    REQUIRE(rdc.ErrorString().empty());
+
+    // an empty frame capture section, so the file can be opened normally for comparison
+    SectionProperties props;
+    props.type = SectionType::FrameCapture;
+    StreamWriter *w = rdc.WriteSection(props);
+    w->Finish();
+    delete w;
+
+    // the last capture also has a larger extended thumbnail, which replaces the one in the header
+    if(f == files.back())
+    {
+      props = SectionProperties();
+      props.type = SectionType::ExtendedThumbnail;
+      props.version = 1;
+      w = rdc.WriteSection(props);
+
+      ExtThumbnailHeader header;
+      header.width = width * 2;
+      header.height = height * 2;
+      header.len = (uint32_t)extPixels.size();
+      header.format = FileType::Raw;
+      w->Write(header);
+      w->Write(extPixels.data(), extPixels.size());
+
+      w->Finish();
+      delete w;
+    }
+  }
+
+  // a corrupt capture and a file that isn't a capture at all
+  files.push_back(dir + "/bad.rdc");
+  files.push_back(dir + "/notes.txt");
+
+  for(size_t i = 3; i < files.size(); i++)
+  {
+    FILE *f = FileIO::fopen(files[i].c_str(), "wb");
+    REQUIRE(f);
+    FileIO::fwrite("not a capture", 1, 13, f);
+    FileIO::fclose(f);
+  }
+
+  SECTION("Full size raw thumbnails")
+  {
+    rdcarray<rdcpair<rdcstr, Thumbnail>> thumbnails;
+    RENDERDOC_GetCaptureThumbnails(dir, FileType::Raw, 0, &thumbnails);
+
+    REQUIRE(thumbnails.size() == 4);
+
+    CHECK(thumbnails[0].first == dir + "/a.rdc");
+    CHECK(thumbnails[1].first == dir + "/b.rdc");
+    CHECK(thumbnails[2].first == dir + "/bad.rdc");
+    CHECK(thumbnails[3].first == dir + "/c.rdc");
+
+    for(size_t i : {0, 1})
+    {
+      CHECK(thumbnails[i].second.type == FileType::Raw);
+      CHECK(thumbnails[i].second.width == width);
+      CHECK(thumbnails[i].second.height == height);
+      CHECK(thumbnails[i].second.data.size() == pixels.size());
+    }
+
+    CHECK(thumbnails[3].second.type == FileType::Raw);
+    CHECK(thumbnails[3].second.width == width * 2);
+    CHECK(thumbnails[3].second.height == height * 2);
+    CHECK(thumbnails[3].second.data == extPixels);
+
+    CHECK(thumbnails[2].second.data.empty());
+  };
+
+  SECTION("Resized thumbnails match a single capture fetch")
+  {
+    rdcarray<rdcpair<rdcstr, Thumbnail>> thumbnails;
+    RENDERDOC_GetCaptureThumbnails(dir, FileType::PNG, 16, &thumbnails);
+
+    REQUIRE(thumbnails.size() == 4);
+
+    ICaptureFile *file = RENDERDOC_OpenCaptureFile();
+    REQUIRE(file->OpenFile(files[0].c_str(), "rdc", NULL) == ReplayStatus::Succeeded);
+    Thumbnail expected = file->GetThumbnail(FileType::PNG, 16);
+    file->Shutdown();
+
+    CHECK(expected.width == 16);
+    CHECK(expected.height == 8);
+
+    CHECK(thumbnails[0].second.width == expected.width);
+    CHECK(thumbnails[0].second.height == expected.height);
+    CHECK(thumbnails[0].second.data == expected.data);
+  };
+
+  for(const rdcstr &f : files)
+    FileIO::Delete(f.c_str());
+};
+
+TEST_CASE("Recompress a capture", "[capturefile]")
+{
+  rdcstr dir = FileIO::GetTempFolderFilename() + "/renderdoc_recompress_test";
+  rdcstr source = dir + "/source.rdc";
+
+  FileIO::CreateParentDirectory(source);
+
+  // imitate a chunk stream - lots of small structures of a few different kinds with varying
+  // contents, which compress well against each other but poorly within a single block.
+  bytebuf frameData;
+  {
+    const char *names[] = {"vkCmdDrawIndexed", "vkCmdBindDescriptorSets", "vkCmdPipelineBarrier",
+                           "vkUpdateDescriptorSets"};
+    uint32_t seed = 1234;
+    for(uint32_t i = 0; frameData.size() < 3 * 1024 * 1024; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      uint32_t kind = (seed >> 16) % 4;
+      uint32_t header[4] = {kind + 1000, i, seed & 0xffff, 0xcafe0000 | kind};
+      frameData.append((const byte *)header, sizeof(header));
+      frameData.append((const byte *)names[kind], strlen(names[kind]) + 1);
+      for(uint32_t v = 0; v < 8 + kind * 4; v++)
+      {
+        uint64_t val = (uint64_t(kind) << 40) | ((seed >> v) & 0x3f);
+        frameData.append((const byte *)&val, sizeof(val));
+      }
+    }
+  }
+
+  const char notes[] = "{\"comments\": \"recompressed\"}";
+
+  {
+    RDCFile rdc;
+    rdc.SetData(RDCDriver::Vulkan, "Vulkan", 0, NULL);
+    rdc.Create(source.c_str());
+    REQUIRE(rdc.ErrorString().empty());
+
+    SectionProperties props;
+    props.type = SectionType::FrameCapture;
+    props.flags = SectionFlags::LZ4Compressed;
+    StreamWriter *w = rdc.WriteSection(props);
+    w->Write(frameData.data(), frameData.size());
+    w->Finish();
+    delete w;
+
+    props.type = SectionType::Notes;
+    props.flags = SectionFlags::ZstdCompressed | SectionFlags::ZstdDictionary;
+    w = rdc.WriteSection(props);
+    w->Write(notes, sizeof(notes) - 1);
+    w->Finish();
+    delete w;
+  }
+
+  ICaptureFile *file = RENDERDOC_OpenCaptureFile();
+  REQUIRE(file->OpenFile(source.c_str(), "rdc", NULL) == ReplayStatus::Succeeded);
+
+  auto readSection = [](const RDCFile &rdc, SectionType type) {
+    bytebuf ret;
+    StreamReader *reader = rdc.ReadSection(rdc.SectionIndex(type));
+    ret.resize((size_t)reader->GetSize());
+    reader->Read(ret.data(), ret.size());
+    CHECK_FALSE(reader->IsErrored());
+    delete reader;
+    return ret;
+  };
+
+  uint64_t sizes[2] = {};
+
+  for(bool useDictionary : {false, true})
+  {
+    rdcstr dest = dir + (useDictionary ? "/dict.rdc" : "/nodict.rdc");
+
+    REQUIRE(file->Recompress(dest.c_str(), 0, 4, useDictionary, NULL) == ReplayStatus::Succeeded);
+
+    RDCFile rdc;
+    rdc.Open(dest.c_str());
+    REQUIRE(rdc.ErrorString().empty());
+
+    const SectionProperties &props =
+        rdc.GetSectionProperties(rdc.SectionIndex(SectionType::FrameCapture));
+    CHECK(bool(props.flags & SectionFlags::ZstdCompressed));
+    CHECK(bool(props.flags & SectionFlags::ZstdDictionary) == useDictionary);
+    CHECK((rdc.SectionIndex(SectionType::ZstdDictionary) >= 0) == useDictionary);
+
+    // count the dictionary against the frame capture, since it's only needed for it
+    sizes[useDictionary] = props.compressedSize;
+    if(useDictionary)
+      sizes[useDictionary] +=
+          rdc.GetSectionProperties(rdc.SectionIndex(SectionType::ZstdDictionary)).compressedSize;
+
+    // the notes never had a dictionary to use, so the flag was dropped when writing
+    CHECK_FALSE(bool(rdc.GetSectionProperties(rdc.SectionIndex(SectionType::Notes)).flags &
+                     SectionFlags::ZstdDictionary));
+
+    CHECK(readSection(rdc, SectionType::FrameCapture) == frameData);
+    CHECK(readSection(rdc, SectionType::Notes) == bytebuf((const byte *)notes, sizeof(notes) - 1));
+
+    // recompressing a capture that has a dictionary must work too
+    if(useDictionary)
+    {
+      ICaptureFile *dictFile = RENDERDOC_OpenCaptureFile();
+      REQUIRE(dictFile->OpenFile(dest.c_str(), "rdc", NULL) == ReplayStatus::Succeeded);
+
+      rdcstr dest2 = dir + "/dict2.rdc";
+      REQUIRE(dictFile->Recompress(dest2.c_str(), 0, 1, false, NULL) == ReplayStatus::Succeeded);
+      dictFile->Shutdown();
+
+      RDCFile rdc2;
+      rdc2.Open(dest2.c_str());
+      REQUIRE(rdc2.ErrorString().empty());
+      CHECK(rdc2.SectionIndex(SectionType::ZstdDictionary) == -1);
+      CHECK(readSection(rdc2, SectionType::FrameCapture) == frameData);
+
+      FileIO::Delete(dest2.c_str());
+    }
+
+    FileIO::Delete(dest.c_str());
+  }
+
+  file->Shutdown();
+  FileIO::Delete(source.c_str());
+
+  CHECK(sizes[1] < sizes[0]);
+};
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -178,6 +178,7 @@ CaptureOptions::CaptureOptions()
   apiValidation = false;
   captureCallstacks = false;
   captureCallstacksOnlyDraws = false;
+  captureCallstacksFastUnwind = false;
   delayForDebugger = 0;
   verifyBufferAccess = false;
   hookIntoChildren = false;
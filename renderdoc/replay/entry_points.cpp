@@ -28,6 +28,7 @@
 #include "api/replay/version.h"
 #include "common/common.h"
 #include "common/formatting.h"
+#include "common/threading.h"
 #include "core/core.h"
 #include "maths/camera.h"
 #include "maths/formatpacking.h"
@@ -257,7 +258,10 @@ extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_LogMessage(LogType type, co
 #endif
 
   if(type == LogType::Fatal)
+  {
+    rdclog_flush();
     RDCDUMP();
+  }
 }
 
 extern "C" RENDERDOC_API const char *RENDERDOC_CC RENDERDOC_GetLogFile()
@@ -395,6 +399,80 @@ RENDERDOC_InjectIntoProcess(uint32_t pid, const rdcarray<EnvironmentModification
   return ret;
 }
 
+static rdcstr QuoteCaptureArgument(const rdcstr &capture)
+{
+  rdcstr ret = "\"";
+  for(char c : capture)
+  {
+#if ENABLED(RDOC_WIN32)
+    // quotes aren't valid in windows paths, and backslashes are path separators
+    if(c == '"')
+      continue;
+#else
+    // the command line is split like bash would, so escape anything special inside double quotes
+    if(c == '"' || c == '\\')
+      ret.push_back('\\');
+#endif
+    ret.push_back(c);
+  }
+  ret.push_back('"');
+  return ret;
+}
+
+extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_RunCaptureJobs(
+    const rdcstr &app, const rdcstr &workingDir, const rdcstr &cmdLine,
+    const rdcarray<rdcstr> &captures, uint32_t maxWorkers, rdcarray<CaptureJobResult> *results)
+{
+  const rdcstr placeholder = "{capture}";
+
+  results->clear();
+  results->resize(captures.size());
+
+  if(maxWorkers == 0)
+    maxWorkers = Threading::NumberOfCores();
+
+  RDCLOG("Running %zu capture jobs with '%s' on up to %u workers", captures.size(), app.c_str(),
+         maxWorkers);
+
+  // each job writes only to its own result, so no locking is needed
+  Threading::ParallelFor((uint32_t)captures.size(), maxWorkers, [&](uint32_t i) {
+    CaptureJobResult &res = results->at(i);
+    res.capture = captures[i];
+
+    rdcstr quoted = QuoteCaptureArgument(captures[i]);
+
+    rdcstr args;
+    int32_t offs = 0;
+    for(;;)
+    {
+      int32_t idx = cmdLine.find(placeholder, offs);
+      if(idx < 0)
+      {
+        args += cmdLine.substr(offs);
+        break;
+      }
+
+      args += cmdLine.substr(offs, idx - offs);
+      args += quoted;
+      offs = idx + placeholder.count();
+    }
+
+    Process::ProcessResult procResult = {};
+    procResult.retCode = -1;
+
+    uint32_t pid = Process::LaunchProcess(app.c_str(), workingDir.c_str(), args.c_str(), true,
+                                          &procResult);
+
+    res.launched = (pid != 0);
+    res.exitCode = res.launched ? procResult.retCode : -1;
+    res.output = procResult.strStdout;
+    res.errors = procResult.strStderror;
+
+    if(!res.launched)
+      RDCWARN("Couldn't launch '%s' for capture '%s'", app.c_str(), captures[i].c_str());
+  });
+}
+
 extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_FreeArrayMem(void *mem)
 {
   free(mem);
@@ -972,3 +1050,50 @@ extern "C" RENDERDOC_API int RENDERDOC_CC RENDERDOC_RunFunctionalTests(int pytho
 
   return mainFunc((int)wideArgStrings.size(), wideArgStrings.data());
 }
+
+#if ENABLED(ENABLE_UNIT_TESTS) && ENABLED(RDOC_LINUX)
+
+#include "3rdparty/catch/catch.hpp"
+
+TEST_CASE("Run jobs over captures in a worker pool", "[entrypoints]")
+{
+  // each job echoes the capture it was given, floods stderr to make sure neither pipe can block the
+  // other, and exits with the length of the capture path so we can check exit codes are per-job.
+  const rdcstr cmdLine =
+      "-c 'printf \"job %s\\n\" \"$0\"; yes x | head -c 200000 >&2; exit ${#0}' {capture}";
+
+  const rdcarray<rdcstr> captures = {
+      "a", "bb", "c c c", "d\"\\e", "eeeee", "ffffff", "ggggggg", "hhhhhhhh",
+  };
+
+  rdcarray<CaptureJobResult> results;
+
+  SECTION("Results are returned in capture order")
+  {
+    RENDERDOC_RunCaptureJobs("sh", "", cmdLine, captures, 3, &results);
+
+    REQUIRE(results.size() == captures.size());
+
+    for(size_t i = 0; i < captures.size(); i++)
+    {
+      CHECK(results[i].capture == captures[i]);
+      CHECK(results[i].launched);
+      CHECK(results[i].exitCode == captures[i].count());
+      CHECK(results[i].output == "job " + captures[i] + "\n");
+      CHECK(results[i].errors.size() == 200000);
+    }
+  };
+
+  SECTION("A missing worker application is reported per-job")
+  {
+    RENDERDOC_RunCaptureJobs("renderdoc_no_such_worker", "", "{capture}", {"a", "b"}, 0, &results);
+
+    REQUIRE(results.size() == 2);
+    CHECK(results[0].capture == "a");
+    CHECK(results[1].capture == "b");
+    CHECK(results[0].exitCode != 0);
+    CHECK(results[1].exitCode != 0);
+  };
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS) && ENABLED(RDOC_LINUX)
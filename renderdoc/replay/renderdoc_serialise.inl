@@ -62,6 +62,18 @@ void DoSerialise(SerialiserType &ser, ExecuteResult &el)
   SIZE_CHECK(8);
 }
 
+template <class SerialiserType>
+void DoSerialise(SerialiserType &ser, CaptureJobResult &el)
+{
+  SERIALISE_MEMBER(capture);
+  SERIALISE_MEMBER(launched);
+  SERIALISE_MEMBER(exitCode);
+  SERIALISE_MEMBER(output);
+  SERIALISE_MEMBER(errors);
+
+  SIZE_CHECK(80);
+}
+
 template <class SerialiserType>
 void DoSerialise(SerialiserType &ser, PathEntry &el)
 {
@@ -105,6 +117,7 @@ void DoSerialise(SerialiserType &ser, CaptureOptions &el)
   SERIALISE_MEMBER(apiValidation);
   SERIALISE_MEMBER(captureCallstacks);
   SERIALISE_MEMBER(captureCallstacksOnlyDraws);
+  SERIALISE_MEMBER(captureCallstacksFastUnwind);
   SERIALISE_MEMBER(delayForDebugger);
   SERIALISE_MEMBER(verifyBufferAccess);
   SERIALISE_MEMBER(hookIntoChildren);
@@ -731,6 +744,28 @@ void DoSerialise(SerialiserType &ser, FrameStatistics &el)
   SIZE_CHECK(1432);
 }
 
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, ChunkLoadStatistics &el)
+{
+  SERIALISE_MEMBER(name);
+  SERIALISE_MEMBER(chunkID);
+  SERIALISE_MEMBER(count);
+  SERIALISE_MEMBER(byteSize);
+  SERIALISE_MEMBER(durationMS);
+
+  SIZE_CHECK(48);
+}
+
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, LoadPhaseStatistics &el)
+{
+  SERIALISE_MEMBER(name);
+  SERIALISE_MEMBER(durationMS);
+  SERIALISE_MEMBER(memoryUsage);
+
+  SIZE_CHECK(40);
+}
+
 template <typename SerialiserType>
 void DoSerialise(SerialiserType &ser, FrameDescription &el)
 {
@@ -743,8 +778,9 @@ void DoSerialise(SerialiserType &ser, FrameDescription &el)
   SERIALISE_MEMBER(captureTime);
   SERIALISE_MEMBER(stats);
   SERIALISE_MEMBER(debugMessages);
+  SERIALISE_MEMBER(chunkLoadStatistics);
 
-  SIZE_CHECK(1512);
+  SIZE_CHECK(1536);
 }
 
 template <typename SerialiserType>
@@ -753,7 +789,7 @@ void DoSerialise(SerialiserType &ser, FrameRecord &el)
   SERIALISE_MEMBER(frameInfo);
   SERIALISE_MEMBER(drawcallList);
 
-  SIZE_CHECK(1536);
+  SIZE_CHECK(1560);
 }
 
 template <typename SerialiserType>
@@ -918,6 +954,7 @@ void DoSerialise(SerialiserType &ser, ReplayOptions &el)
   SERIALISE_MEMBER(forceGPUDeviceID);
   SERIALISE_MEMBER(forceGPUDriverName);
   SERIALISE_MEMBER(optimisation);
+  SERIALISE_MEMBER(checkpointMemoryBudgetMB);
 
   SIZE_CHECK(48);
 }
@@ -2233,6 +2270,7 @@ void DoSerialise(SerialiserType &ser, VKPipe::State &el)
 #pragma endregion Vulkan pipeline state
 
 INSTANTIATE_SERIALISE_TYPE(ExecuteResult)
+INSTANTIATE_SERIALISE_TYPE(CaptureJobResult)
 INSTANTIATE_SERIALISE_TYPE(PathEntry)
 INSTANTIATE_SERIALISE_TYPE(SectionProperties)
 INSTANTIATE_SERIALISE_TYPE(EnvironmentModification)
@@ -2277,6 +2315,8 @@ INSTANTIATE_SERIALISE_TYPE(DepthStencilStats)
 INSTANTIATE_SERIALISE_TYPE(RasterizationStats)
 INSTANTIATE_SERIALISE_TYPE(OutputTargetStats)
 INSTANTIATE_SERIALISE_TYPE(FrameStatistics)
+INSTANTIATE_SERIALISE_TYPE(ChunkLoadStatistics)
+INSTANTIATE_SERIALISE_TYPE(LoadPhaseStatistics)
 INSTANTIATE_SERIALISE_TYPE(FrameDescription)
 INSTANTIATE_SERIALISE_TYPE(FrameRecord)
 INSTANTIATE_SERIALISE_TYPE(MeshFormat)
@@ -24,9 +24,12 @@
  ******************************************************************************/
 
 #include "replay_controller.h"
+#include <algorithm>
 #include <string.h>
 #include <time.h>
 #include "common/dds_readwrite.h"
+#include "common/instrumentation.h"
+#include "common/threading.h"
 #include "driver/ihv/amd/amd_isa.h"
 #include "driver/ihv/amd/amd_rgp.h"
 #include "jpeg-compressor/jpgd.h"
@@ -45,6 +48,20 @@ static void fileWriteFunc(void *context, void *data, int size)
   FileIO::fwrite(data, 1, size, (FILE *)context);
 }
 
+// split an image's rows into blocks of roughly equal numbers of pixels and process them across up
+// to maxThreads threads. Small images end up as a single block and are processed inline.
+static void ForEachRowBlock(uint32_t width, uint32_t height, uint32_t maxThreads,
+                            std::function<void(uint32_t rowBegin, uint32_t rowEnd)> func)
+{
+  const uint32_t pixelsPerBlock = 64 * 1024;
+  const uint32_t rowsPerBlock = RDCMAX(1U, pixelsPerBlock / RDCMAX(1U, width));
+  const uint32_t numBlocks = (height + rowsPerBlock - 1) / rowsPerBlock;
+
+  Threading::ParallelFor(numBlocks, maxThreads, [&](uint32_t block) {
+    func(block * rowsPerBlock, RDCMIN(height, (block + 1) * rowsPerBlock));
+  });
+}
+
 ReplayController::ReplayController()
 {
   m_ThreadID = Threading::GetCurrentID();
@@ -90,6 +107,8 @@ ReplayController::~ReplayController()
 
 void ReplayController::SetFrameEvent(uint32_t eventId, bool force)
 {
+  SCOPED_INSTRUMENT("ReplayController::SetFrameEvent");
+
   CHECK_REPLAY_THREAD();
 
   if(eventId != m_EventID || force)
@@ -179,6 +198,13 @@ FrameDescription ReplayController::GetFrameInfo()
   return m_FrameRecord.frameInfo;
 }
 
+rdcarray<LoadPhaseStatistics> ReplayController::GetLoadPhaseStatistics()
+{
+  CHECK_REPLAY_THREAD();
+
+  return m_LoadPhases;
+}
+
 const SDFile &ReplayController::GetStructuredFile()
 {
   CHECK_REPLAY_THREAD();
@@ -415,7 +441,75 @@ rdcarray<CounterResult> ReplayController::FetchCounters(const rdcarray<GPUCounte
 {
   CHECK_REPLAY_THREAD();
 
-  return m_pDevice->FetchCounters(counters);
+  return m_pDevice->FetchCounters(counters, 0, ~0U);
+}
+
+bool ReplayController::FetchCountersStreamed(const rdcarray<GPUCounter> &counters,
+                                             RENDERDOC_CounterBatchCallback callback)
+{
+  CHECK_REPLAY_THREAD();
+
+  rdcarray<GPUCounter> genericCounters, vendorCounters;
+  for(GPUCounter c : counters)
+  {
+    if(IsGenericCounter(c))
+      genericCounters.push_back(c);
+    else
+      vendorCounters.push_back(c);
+  }
+
+  if(counters.empty())
+    return true;
+
+  if(!genericCounters.empty())
+  {
+    rdcarray<uint32_t> drawEvents;
+    for(const DrawcallDescription *draw : m_Drawcalls)
+      if(draw)
+        drawEvents.push_back(draw->eventId);
+
+    // every batch replays the frame from the start, so double the batch size each time. That keeps
+    // the total replay cost within about twice a single fetch while the first results come back
+    // after only a handful of drawcalls.
+    size_t batchSize = 64;
+    for(size_t first = 0; first < drawEvents.size(); first += batchSize, batchSize *= 2)
+    {
+      size_t last = RDCMIN(first + batchSize, drawEvents.size()) - 1;
+
+      // cover the events between batches too, so no result can fall outside every range
+      uint32_t firstEvent = first == 0 ? 0 : drawEvents[first - 1] + 1;
+      uint32_t lastEvent = last + 1 == drawEvents.size() ? ~0U : drawEvents[last];
+
+      rdcarray<CounterResult> measured =
+          m_pDevice->FetchCounters(genericCounters, firstEvent, lastEvent);
+
+      // drivers may measure the events before the range while replaying up to it
+      rdcarray<CounterResult> batch;
+      batch.reserve(measured.size());
+      for(const CounterResult &r : measured)
+        if(r.eventId >= firstEvent && r.eventId <= lastEvent)
+          batch.push_back(r);
+
+      std::sort(batch.begin(), batch.end());
+
+      if(!callback(batch))
+      {
+        SetFrameEvent(m_EventID, true);
+        return false;
+      }
+    }
+  }
+
+  bool ret = true;
+
+  if(!vendorCounters.empty())
+    ret = callback(m_pDevice->FetchCounters(vendorCounters, 0, ~0U));
+
+  // the replay is only put back at the current event once at the end. A callback that does other
+  // work in between batches is responsible for restoring it first
+  SetFrameEvent(m_EventID, true);
+
+  return ret;
 }
 
 rdcarray<GPUCounter> ReplayController::EnumerateCounters()
@@ -504,6 +598,34 @@ MeshFormat ReplayController::GetPostVSData(uint32_t instID, uint32_t viewID, Mes
   return m_pDevice->GetPostVSBuffers(draw->eventId, instID, viewID, stage);
 }
 
+void ReplayController::FetchPostVSData(const rdcarray<uint32_t> &eventIds)
+{
+  CHECK_REPLAY_THREAD();
+
+  rdcarray<uint32_t> events;
+  events.reserve(eventIds.size());
+
+  for(uint32_t eid : eventIds)
+  {
+    DrawcallDescription *draw = GetDrawcallByEID(eid);
+
+    if(draw && (draw->flags & DrawFlags::Drawcall))
+      events.push_back(draw->eventId);
+  }
+
+  if(events.empty())
+    return;
+
+  std::sort(events.begin(), events.end());
+  events.resize(std::unique(events.begin(), events.end()) - events.begin());
+
+  // the driver fetches as many events as it can together in each replay
+  m_pDevice->InitPostVSBuffers(events);
+
+  // restore the replay to the current event
+  m_pDevice->ReplayLog(m_EventID, eReplay_WithoutDraw);
+}
+
 bytebuf ReplayController::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len)
 {
   CHECK_REPLAY_THREAD();
@@ -545,7 +667,7 @@ bytebuf ReplayController::GetTextureData(ResourceId tex, const Subresource &sub)
   return ret;
 }
 
-bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path)
+bool ReplayController::FetchTextureForSave(const TextureSave &saveData, FetchedTexture &fetched)
 {
   CHECK_REPLAY_THREAD();
 
@@ -560,8 +682,6 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
 
   TextureDescription td = m_pDevice->GetTexture(liveid);
 
-  bool success = false;
-
   // clamp sample/mip/slice indices
   if(td.msSamp == 1)
   {
@@ -711,7 +831,7 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
     // otherwise take all mips, as by default
   }
 
-  rdcarray<byte *> subdata;
+  rdcarray<byte *> &subdata = fetched.subdata;
 
   bool downcast = false;
 
@@ -846,10 +966,6 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
       if(data.empty())
       {
         RDCERR("Couldn't get bytes for mip %u, slice %u", mip, slice);
-
-        for(size_t i = 0; i < subdata.size(); i++)
-          delete[] subdata[i];
-
         return false;
       }
 
@@ -908,6 +1024,29 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
     }
   }
 
+  fetched.sd = sd;
+  fetched.td = td;
+  fetched.rowPitch = rowPitch;
+  fetched.numMips = numMips;
+  fetched.numSlices = numSlices;
+  fetched.singleSlice = singleSlice;
+
+  return true;
+}
+
+bool ReplayController::EncodeTextureSave(FetchedTexture &fetched, const char *path,
+                                         uint32_t maxThreads)
+{
+  const TextureSave &sd = fetched.sd;
+  TextureDescription &td = fetched.td;
+  rdcarray<byte *> &subdata = fetched.subdata;
+  uint32_t &rowPitch = fetched.rowPitch;
+  const uint32_t numMips = fetched.numMips;
+  const uint32_t numSlices = fetched.numSlices;
+  const bool singleSlice = fetched.singleSlice;
+
+  bool success = false;
+
   // should have been handled above, but verify incoming data is RGBA8 or RGBA32
   if(sd.slice.slicesAsGrid && (td.format.compByteWidth == 1 || td.format.compByteWidth == 4) &&
      td.format.compCount == 4 && !td.format.Special())
@@ -937,16 +1076,8 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
       uint32_t xoffs = gridx * sliceWidth;
 
       for(uint32_t y = 0; y < sliceHeight; y++)
-      {
-        for(uint32_t x = 0; x < sliceWidth; x++)
-        {
-          uint32_t *srcpix = (uint32_t *)&subdata[i][(y * sliceWidth + x) * pixelStride + 0];
-          uint32_t *dstpix =
-              (uint32_t *)&combinedData[((y + yoffs) * td.width + x + xoffs) * pixelStride + 0];
-
-          memcpy(dstpix, srcpix, pixelStride);
-        }
-      }
+        memcpy(&combinedData[((y + yoffs) * td.width + xoffs) * pixelStride],
+               &subdata[i][y * sliceWidth * pixelStride], sliceWidth * pixelStride);
 
       delete[] subdata[i];
     }
@@ -996,16 +1127,8 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
       uint32_t xoffs = gridx[i] * sliceWidth;
 
       for(uint32_t y = 0; y < sliceHeight; y++)
-      {
-        for(uint32_t x = 0; x < sliceWidth; x++)
-        {
-          uint32_t *srcpix = (uint32_t *)&subdata[i][(y * sliceWidth + x) * pixelStride + 0];
-          uint32_t *dstpix =
-              (uint32_t *)&combinedData[((y + yoffs) * td.width + x + xoffs) * pixelStride + 0];
-
-          memcpy(dstpix, srcpix, pixelStride);
-        }
-      }
+        memcpy(&combinedData[((y + yoffs) * td.width + xoffs) * pixelStride],
+               &subdata[i][y * sliceWidth * pixelStride], sliceWidth * pixelStride);
 
       delete[] subdata[i];
     }
@@ -1027,37 +1150,40 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
     uint32_t compWidth = td.format.compByteWidth;
     uint32_t compCount = td.format.compCount;
 
-    uint32_t val = 0;
-    uint32_t max = ~0U;
+    ForEachRowBlock(td.width, td.height, maxThreads, [&](uint32_t rowBegin, uint32_t rowEnd) {
+      uint32_t val = 0;
+      uint32_t max = ~0U;
 
-    for(uint32_t y = 0; y < td.height; y++)
-    {
-      for(uint32_t x = 0; x < td.width; x++)
+      for(uint32_t y = rowBegin; y < rowEnd; y++)
       {
-        memcpy(&val, &subdata[0][(y * td.width + x) * pixelStride + sd.channelExtract * compWidth],
-               td.format.compByteWidth);
-
-        switch(compCount)
+        for(uint32_t x = 0; x < td.width; x++)
         {
-          case 4:
-            memcpy(&subdata[0][(y * td.width + x) * pixelStride + 3 * compWidth], &max,
-                   td.format.compByteWidth);
-            DELIBERATE_FALLTHROUGH();
-          case 3:
-            memcpy(&subdata[0][(y * td.width + x) * pixelStride + 2 * compWidth], &val,
-                   td.format.compByteWidth);
-            DELIBERATE_FALLTHROUGH();
-          case 2:
-            memcpy(&subdata[0][(y * td.width + x) * pixelStride + 1 * compWidth], &val,
-                   td.format.compByteWidth);
-            DELIBERATE_FALLTHROUGH();
-          case 1:
-            memcpy(&subdata[0][(y * td.width + x) * pixelStride + 0 * compWidth], &val,
-                   td.format.compByteWidth);
-            break;
+          memcpy(&val,
+                 &subdata[0][(y * td.width + x) * pixelStride + sd.channelExtract * compWidth],
+                 td.format.compByteWidth);
+
+          switch(compCount)
+          {
+            case 4:
+              memcpy(&subdata[0][(y * td.width + x) * pixelStride + 3 * compWidth], &max,
+                     td.format.compByteWidth);
+              DELIBERATE_FALLTHROUGH();
+            case 3:
+              memcpy(&subdata[0][(y * td.width + x) * pixelStride + 2 * compWidth], &val,
+                     td.format.compByteWidth);
+              DELIBERATE_FALLTHROUGH();
+            case 2:
+              memcpy(&subdata[0][(y * td.width + x) * pixelStride + 1 * compWidth], &val,
+                     td.format.compByteWidth);
+              DELIBERATE_FALLTHROUGH();
+            case 1:
+              memcpy(&subdata[0][(y * td.width + x) * pixelStride + 0 * compWidth], &val,
+                     td.format.compByteWidth);
+              break;
+          }
         }
       }
-    }
+    });
   }
 
   // handle formats that don't support alpha
@@ -1065,46 +1191,59 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
   {
     byte *nonalpha = new byte[td.width * td.height * 3];
 
-    for(uint32_t y = 0; y < td.height; y++)
+    // the colours we blend against only depend on the checkerboard square, so convert them once
+    // up front instead of per pixel.
+    Vec4f blendCol[2] = {
+        Vec4f(sd.alphaCol.x, sd.alphaCol.y, sd.alphaCol.z),
+        Vec4f(sd.alphaCol.x, sd.alphaCol.y, sd.alphaCol.z),
+    };
+
+    if(sd.alpha == AlphaMapping::BlendToCheckerboard)
     {
-      for(uint32_t x = 0; x < td.width; x++)
-      {
-        byte r = subdata[0][(y * td.width + x) * 4 + 0];
-        byte g = subdata[0][(y * td.width + x) * 4 + 1];
-        byte b = subdata[0][(y * td.width + x) * 4 + 2];
-        byte a = subdata[0][(y * td.width + x) * 4 + 3];
+      blendCol[0] = RenderDoc::Inst().DarkCheckerboardColor();
+      blendCol[1] = RenderDoc::Inst().LightCheckerboardColor();
+    }
 
-        if(sd.alpha != AlphaMapping::Discard)
+    for(Vec4f &col : blendCol)
+    {
+      col.x = ConvertLinearToSRGB(col.x);
+      col.y = ConvertLinearToSRGB(col.y);
+      col.z = ConvertLinearToSRGB(col.z);
+    }
+
+    ForEachRowBlock(td.width, td.height, maxThreads, [&](uint32_t rowBegin, uint32_t rowEnd) {
+      for(uint32_t y = rowBegin; y < rowEnd; y++)
+      {
+        for(uint32_t x = 0; x < td.width; x++)
         {
-          Vec4f col = Vec4f(sd.alphaCol.x, sd.alphaCol.y, sd.alphaCol.z);
-          if(sd.alpha == AlphaMapping::BlendToCheckerboard)
+          byte r = subdata[0][(y * td.width + x) * 4 + 0];
+          byte g = subdata[0][(y * td.width + x) * 4 + 1];
+          byte b = subdata[0][(y * td.width + x) * 4 + 2];
+          byte a = subdata[0][(y * td.width + x) * 4 + 3];
+
+          if(sd.alpha != AlphaMapping::Discard)
           {
             bool lightSquare = ((x / 64) % 2) == ((y / 64) % 2);
-            col = lightSquare ? RenderDoc::Inst().LightCheckerboardColor()
-                              : RenderDoc::Inst().DarkCheckerboardColor();
-          }
+            const Vec4f &col = blendCol[lightSquare ? 1 : 0];
 
-          col.x = ConvertLinearToSRGB(col.x);
-          col.y = ConvertLinearToSRGB(col.y);
-          col.z = ConvertLinearToSRGB(col.z);
+            FloatVector pixel = FloatVector(float(r) / 255.0f, float(g) / 255.0f,
+                                            float(b) / 255.0f, float(a) / 255.0f);
 
-          FloatVector pixel = FloatVector(float(r) / 255.0f, float(g) / 255.0f, float(b) / 255.0f,
-                                          float(a) / 255.0f);
+            pixel.x = pixel.x * pixel.w + col.x * (1.0f - pixel.w);
+            pixel.y = pixel.y * pixel.w + col.y * (1.0f - pixel.w);
+            pixel.z = pixel.z * pixel.w + col.z * (1.0f - pixel.w);
 
-          pixel.x = pixel.x * pixel.w + col.x * (1.0f - pixel.w);
-          pixel.y = pixel.y * pixel.w + col.y * (1.0f - pixel.w);
-          pixel.z = pixel.z * pixel.w + col.z * (1.0f - pixel.w);
+            r = byte(pixel.x * 255.0f);
+            g = byte(pixel.y * 255.0f);
+            b = byte(pixel.z * 255.0f);
+          }
 
-          r = byte(pixel.x * 255.0f);
-          g = byte(pixel.y * 255.0f);
-          b = byte(pixel.z * 255.0f);
+          nonalpha[(y * td.width + x) * 3 + 0] = r;
+          nonalpha[(y * td.width + x) * 3 + 1] = g;
+          nonalpha[(y * td.width + x) * 3 + 2] = b;
         }
-
-        nonalpha[(y * td.width + x) * 3 + 0] = r;
-        nonalpha[(y * td.width + x) * 3 + 1] = g;
-        nonalpha[(y * td.width + x) * 3 + 2] = b;
       }
-    }
+    });
 
     delete[] subdata[0];
 
@@ -1120,22 +1259,24 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
   {
     byte *rg0 = new byte[td.width * td.height * 3];
 
-    for(uint32_t y = 0; y < td.height; y++)
-    {
-      for(uint32_t x = 0; x < td.width; x++)
+    ForEachRowBlock(td.width, td.height, maxThreads, [&](uint32_t rowBegin, uint32_t rowEnd) {
+      for(uint32_t y = rowBegin; y < rowEnd; y++)
       {
-        byte r = subdata[0][(y * td.width + x) * 2 + 0];
-        byte g = subdata[0][(y * td.width + x) * 2 + 1];
+        for(uint32_t x = 0; x < td.width; x++)
+        {
+          byte r = subdata[0][(y * td.width + x) * 2 + 0];
+          byte g = subdata[0][(y * td.width + x) * 2 + 1];
 
-        rg0[(y * td.width + x) * 3 + 0] = r;
-        rg0[(y * td.width + x) * 3 + 1] = g;
-        rg0[(y * td.width + x) * 3 + 2] = 0;
+          rg0[(y * td.width + x) * 3 + 0] = r;
+          rg0[(y * td.width + x) * 3 + 1] = g;
+          rg0[(y * td.width + x) * 3 + 2] = 0;
 
-        // if we're greyscaling the image, then keep the greyscale here.
-        if(sd.channelExtract >= 0)
-          rg0[(y * td.width + x) * 3 + 2] = r;
+          // if we're greyscaling the image, then keep the greyscale here.
+          if(sd.channelExtract >= 0)
+            rg0[(y * td.width + x) * 3 + 2] = r;
+        }
       }
-    }
+    });
 
     delete[] subdata[0];
 
@@ -1244,8 +1385,6 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
         abgr[3] = new float[td.width * td.height];
       }
 
-      byte *srcData = subdata[0];
-
       ResourceFormat saveFmt = td.format;
       if(saveFmt.compType == CompType::Typeless)
         saveFmt.compType = sd.typeCast;
@@ -1258,106 +1397,88 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
       if(saveFmt.compType == CompType::Depth && pixStride == 3)
         pixStride = 4;
 
-      for(uint32_t y = 0; y < td.height; y++)
-      {
-        for(uint32_t x = 0; x < td.width; x++)
-        {
-          float r = 0.0f;
-          float g = 0.0f;
-          float b = 0.0f;
-          float a = 1.0f;
-
-          if(saveFmt.type == ResourceFormatType::R10G10B10A2)
-          {
-            uint32_t *u32 = (uint32_t *)srcData;
-
-            Vec4f vec = ConvertFromR10G10B10A2(*u32);
-
-            r = vec.x;
-            g = vec.y;
-            b = vec.z;
-            a = vec.w;
-
-            srcData += 4;
-          }
-          else if(saveFmt.type == ResourceFormatType::R11G11B10)
-          {
-            uint32_t *u32 = (uint32_t *)srcData;
+      if(saveFmt.type == ResourceFormatType::R10G10B10A2 ||
+         saveFmt.type == ResourceFormatType::R11G11B10)
+        pixStride = 4;
 
-            Vec3f vec = ConvertFromR11G11B10(*u32);
+      // decode a row at a time into RGBA floats, then apply the per-pixel transforms and write out
+      // in the layout the file format needs. Blocks of rows are independent so run in parallel.
+      int32_t decodeFailed = 0;
 
-            r = vec.x;
-            g = vec.y;
-            b = vec.z;
-            a = 1.0f;
+      ForEachRowBlock(td.width, td.height, maxThreads, [&](uint32_t rowBegin, uint32_t rowEnd) {
+        rdcarray<float> row;
+        row.resize(td.width * 4);
 
-            srcData += 4;
-          }
-          else
-          {
-            if(saveFmt.compCount >= 1)
-              r = ConvertComponent(saveFmt, srcData + saveFmt.compByteWidth * 0);
-            if(saveFmt.compCount >= 2)
-              g = ConvertComponent(saveFmt, srcData + saveFmt.compByteWidth * 1);
-            if(saveFmt.compCount >= 3)
-              b = ConvertComponent(saveFmt, srcData + saveFmt.compByteWidth * 2);
-            if(saveFmt.compCount >= 4)
-              a = ConvertComponent(saveFmt, srcData + saveFmt.compByteWidth * 3);
-
-            srcData += pixStride;
-          }
-
-          if(saveFmt.BGRAOrder())
-            std::swap(r, b);
-
-          // HDR can't represent negative values
-          if(sd.destType == FileType::HDR)
-          {
-            r = RDCMAX(r, 0.0f);
-            g = RDCMAX(g, 0.0f);
-            b = RDCMAX(b, 0.0f);
-            a = RDCMAX(a, 0.0f);
-          }
+        for(uint32_t y = rowBegin; y < rowEnd; y++)
+        {
+          const byte *srcData = subdata[0] + size_t(y) * td.width * pixStride;
 
-          if(sd.channelExtract == 0)
-          {
-            g = b = r;
-            a = 1.0f;
-          }
-          if(sd.channelExtract == 1)
-          {
-            r = b = g;
-            a = 1.0f;
-          }
-          if(sd.channelExtract == 2)
-          {
-            r = g = b;
-            a = 1.0f;
-          }
-          if(sd.channelExtract == 3)
+          if(!DecodeFormattedPixels(saveFmt, srcData, pixStride, td.width, row.data()))
           {
-            r = g = b = a;
-            a = 1.0f;
+            Atomic::Inc32(&decodeFailed);
+            return;
           }
 
-          if(fldata)
+          for(uint32_t x = 0; x < td.width; x++)
           {
-            fldata[(y * td.width + x) * 4 + 0] = r;
-            fldata[(y * td.width + x) * 4 + 1] = g;
-            fldata[(y * td.width + x) * 4 + 2] = b;
-            fldata[(y * td.width + x) * 4 + 3] = a;
-          }
-          else
-          {
-            abgr[0][(y * td.width + x)] = a;
-            abgr[1][(y * td.width + x)] = b;
-            abgr[2][(y * td.width + x)] = g;
-            abgr[3][(y * td.width + x)] = r;
+            float r = row[x * 4 + 0];
+            float g = row[x * 4 + 1];
+            float b = row[x * 4 + 2];
+            float a = row[x * 4 + 3];
+
+            // HDR can't represent negative values
+            if(sd.destType == FileType::HDR)
+            {
+              r = RDCMAX(r, 0.0f);
+              g = RDCMAX(g, 0.0f);
+              b = RDCMAX(b, 0.0f);
+              a = RDCMAX(a, 0.0f);
+            }
+
+            if(sd.channelExtract == 0)
+            {
+              g = b = r;
+              a = 1.0f;
+            }
+            if(sd.channelExtract == 1)
+            {
+              r = b = g;
+              a = 1.0f;
+            }
+            if(sd.channelExtract == 2)
+            {
+              r = g = b;
+              a = 1.0f;
+            }
+            if(sd.channelExtract == 3)
+            {
+              r = g = b = a;
+              a = 1.0f;
+            }
+
+            if(fldata)
+            {
+              fldata[(y * td.width + x) * 4 + 0] = r;
+              fldata[(y * td.width + x) * 4 + 1] = g;
+              fldata[(y * td.width + x) * 4 + 2] = b;
+              fldata[(y * td.width + x) * 4 + 3] = a;
+            }
+            else
+            {
+              abgr[0][(y * td.width + x)] = a;
+              abgr[1][(y * td.width + x)] = b;
+              abgr[2][(y * td.width + x)] = g;
+              abgr[3][(y * td.width + x)] = r;
+            }
           }
         }
-      }
+      });
 
-      if(sd.destType == FileType::HDR)
+      if(decodeFailed)
+      {
+        RDCERR("Unsupported format for saving to HDR/EXR");
+      }
+      else if(sd.destType == FileType::HDR)
       {
         int ret = stbi_write_hdr_to_func(fileWriteFunc, (void *)f, td.width, td.height, 4, fldata);
         success = (ret != 0);
@@ -1431,12 +1552,96 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
     FileIO::fclose(f);
   }
 
-  for(size_t i = 0; i < subdata.size(); i++)
-    delete[] subdata[i];
-
   return success;
 }
 
+bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path)
+{
+  CHECK_REPLAY_THREAD();
+
+  FetchedTexture fetched;
+  if(!FetchTextureForSave(saveData, fetched))
+    return false;
+
+  return EncodeTextureSave(fetched, path, Threading::NumberOfCores());
+}
+
+rdcarray<bool> ReplayController::SaveTextures(const rdcarray<TextureSave> &saveData,
+                                              const rdcarray<rdcstr> &paths)
+{
+  CHECK_REPLAY_THREAD();
+
+  rdcarray<bool> ret;
+  ret.resize(saveData.size());
+  for(bool &r : ret)
+    r = false;
+
+  if(saveData.size() != paths.size())
+  {
+    RDCERR("Mismatched number of textures (%zu) and paths (%zu) to save", saveData.size(),
+           paths.size());
+    return ret;
+  }
+
+  // fetching needs the replay so has to happen here, but converting and encoding the files doesn't.
+  // Fetch textures in batches of one per core, and encode each batch (one texture per thread) on a
+  // background thread while the next batch is fetched. This bounds the amount of fetched data in
+  // flight to two batches.
+  const size_t batchSize = Threading::NumberOfCores();
+
+  rdcarray<FetchedTexture *> encoding;
+  size_t encodingBase = 0;
+  Threading::ThreadHandle encodeThread = 0;
+
+  auto finishEncoding = [&]() {
+    if(encodeThread)
+    {
+      Threading::JoinThread(encodeThread);
+      Threading::CloseThread(encodeThread);
+      encodeThread = 0;
+    }
+
+    for(FetchedTexture *fetched : encoding)
+      delete fetched;
+    encoding.clear();
+  };
+
+  for(size_t base = 0; base < saveData.size(); base += batchSize)
+  {
+    size_t count = RDCMIN(batchSize, saveData.size() - base);
+
+    rdcarray<FetchedTexture *> batch;
+    batch.resize(count);
+
+    for(size_t i = 0; i < count; i++)
+    {
+      batch[i] = new FetchedTexture;
+      if(!FetchTextureForSave(saveData[base + i], *batch[i]))
+        SAFE_DELETE(batch[i]);
+    }
+
+    finishEncoding();
+
+    encoding.swap(batch);
+    encodingBase = base;
+
+    encodeThread = Threading::CreateThread([&ret, &paths, encoding, encodingBase]() {
+      // each texture is encoded on a single thread, the parallelism comes from the batch
+      auto encode = [&](uint32_t i) {
+        if(encoding[i])
+          ret[encodingBase + i] =
+              EncodeTextureSave(*encoding[i], paths[encodingBase + i].c_str(), 1);
+      };
+
+      Threading::ParallelFor((uint32_t)encoding.size(), (uint32_t)encoding.size(), encode);
+    });
+  }
+
+  finishEncoding();
+
+  return ret;
+}
+
 rdcarray<PixelModification> ReplayController::PixelHistory(ResourceId target, uint32_t x, uint32_t y,
                                                            const Subresource &sub, CompType typeCast)
 {
@@ -1978,11 +2183,19 @@ void ReplayController::RemoveReplacement(ResourceId id)
 
 ReplayStatus ReplayController::CreateDevice(RDCFile *rdc, const ReplayOptions &opts)
 {
+  SCOPED_INSTRUMENT("ReplayController::CreateDevice");
+
   CHECK_REPLAY_THREAD();
 
+  m_LoadPhases.clear();
+
+  PerformanceTimer timer;
+
   IReplayDriver *driver = NULL;
   ReplayStatus status = RenderDoc::Inst().CreateReplayDriver(rdc, opts, &driver);
 
+  AddLoadPhase("Create replay driver", timer);
+
   if(driver && status == ReplayStatus::Succeeded)
   {
     RDCLOG("Created replay driver.");
@@ -1997,6 +2210,8 @@ ReplayStatus ReplayController::SetDevice(IReplayDriver *device)
 {
   CHECK_REPLAY_THREAD();
 
+  m_LoadPhases.clear();
+
   if(device)
   {
     RDCLOG("Got replay driver.");
@@ -2013,8 +2228,12 @@ ReplayStatus ReplayController::PostCreateInit(IReplayDriver *device, RDCFile *rd
 
   m_pDevice = device;
 
+  PerformanceTimer timer;
+
   ReplayStatus status = m_pDevice->ReadLogInitialisation(rdc, false);
 
+  AddLoadPhase("Read capture and create resources", timer);
+
   if(status != ReplayStatus::Succeeded)
     return status;
 
@@ -2051,11 +2270,26 @@ ReplayStatus ReplayController::PostCreateInit(IReplayDriver *device, RDCFile *rd
   m_Drawcalls.clear();
   SetupDrawcallPointers(m_Drawcalls, m_FrameRecord.drawcallList);
 
+  AddLoadPhase("Fetch resource and frame information", timer);
+
   FetchPipelineState(m_Drawcalls.back()->eventId);
 
+  AddLoadPhase("Fetch initial pipeline state", timer);
+
   return ReplayStatus::Succeeded;
 }
 
+void ReplayController::AddLoadPhase(const char *name, PerformanceTimer &timer)
+{
+  LoadPhaseStatistics phase;
+  phase.name = name;
+  phase.durationMS = timer.GetMilliseconds();
+  phase.memoryUsage = Process::GetMemoryUsage();
+  m_LoadPhases.push_back(phase);
+
+  timer.Restart();
+}
+
 void ReplayController::FileChanged()
 {
   CHECK_REPLAY_THREAD();
@@ -28,6 +28,7 @@
 #include <set>
 #include "api/replay/renderdoc_replay.h"
 #include "common/common.h"
+#include "common/timing.h"
 #include "core/core.h"
 #include "replay/replay_driver.h"
 
@@ -163,10 +164,13 @@ public:
   void FreeTargetResource(ResourceId id);
 
   FrameDescription GetFrameInfo();
+  rdcarray<LoadPhaseStatistics> GetLoadPhaseStatistics();
   const SDFile &GetStructuredFile();
   const rdcarray<DrawcallDescription> &GetDrawcalls();
   void AddFakeMarkers();
   rdcarray<CounterResult> FetchCounters(const rdcarray<GPUCounter> &counters);
+  bool FetchCountersStreamed(const rdcarray<GPUCounter> &counters,
+                             RENDERDOC_CounterBatchCallback callback);
   rdcarray<GPUCounter> EnumerateCounters();
   CounterDescription DescribeCounter(GPUCounter counterID);
   const rdcarray<TextureDescription> &GetTextures();
@@ -192,6 +196,7 @@ public:
   void FreeTrace(ShaderDebugTrace *trace);
 
   MeshFormat GetPostVSData(uint32_t instID, uint32_t viewID, MeshDataStage stage);
+  void FetchPostVSData(const rdcarray<uint32_t> &eventIds);
 
   rdcarray<EventUsage> GetUsage(ResourceId id);
 
@@ -199,6 +204,7 @@ public:
   bytebuf GetTextureData(ResourceId buff, const Subresource &sub);
 
   bool SaveTexture(const TextureSave &saveData, const char *path);
+  rdcarray<bool> SaveTextures(const rdcarray<TextureSave> &saveData, const rdcarray<rdcstr> &paths);
 
   rdcarray<ShaderVariable> GetCBufferVariableContents(ResourceId pipeline, ResourceId shader,
                                                       const char *entryPoint, uint32_t cbufslot,
@@ -217,7 +223,33 @@ public:
   void Shutdown();
 
 private:
+  // a texture that's been fetched from the replay for saving, and only needs to be converted and
+  // encoded. That doesn't touch the replay so it can be done on any thread.
+  struct FetchedTexture
+  {
+    FetchedTexture() = default;
+    FetchedTexture(const FetchedTexture &) = delete;
+    FetchedTexture &operator=(const FetchedTexture &) = delete;
+    ~FetchedTexture()
+    {
+      for(byte *b : subdata)
+        delete[] b;
+    }
+
+    TextureSave sd;
+    TextureDescription td;
+    rdcarray<byte *> subdata;
+    uint32_t rowPitch = 0;
+    uint32_t numMips = 0;
+    uint32_t numSlices = 0;
+    bool singleSlice = false;
+  };
+
+  bool FetchTextureForSave(const TextureSave &saveData, FetchedTexture &fetched);
+  static bool EncodeTextureSave(FetchedTexture &fetched, const char *path, uint32_t maxThreads);
+
   ReplayStatus PostCreateInit(IReplayDriver *device, RDCFile *rdc);
+  void AddLoadPhase(const char *name, PerformanceTimer &timer);
 
   void FetchPipelineState(uint32_t eventId);
 
@@ -227,6 +259,7 @@ private:
 
   IReplayDriver *GetDevice() { return m_pDevice; }
   FrameRecord m_FrameRecord;
+  rdcarray<LoadPhaseStatistics> m_LoadPhases;
   rdcarray<DrawcallDescription *> m_Drawcalls;
 
   uint64_t m_ThreadID;
@@ -561,6 +561,63 @@ uint64_t CalcMeshOutputSize(uint64_t curSize, uint64_t requiredOutput)
   return curSize;
 }
 
+rdcarray<rdcarray<uint32_t>> SplitEventsByPass(const rdcarray<const DrawcallDescription *> &draws)
+{
+  rdcarray<rdcarray<uint32_t>> ret;
+
+  const DrawcallDescription *prev = NULL;
+  bool prevInPass = false;
+
+  for(const DrawcallDescription *draw : draws)
+  {
+    if(draw == NULL)
+      continue;
+
+    bool sameRun = false;
+
+    // walk forward from the previous draw, it's in the same run if we get here without crossing a
+    // pass boundary. Since the list is sorted this visits each drawcall at most once overall.
+    if(prev && prevInPass)
+    {
+      for(const DrawcallDescription *d = prev->next; d; d = d->next)
+      {
+        if(d->flags & (DrawFlags::BeginPass | DrawFlags::EndPass))
+          break;
+
+        if(d == draw)
+        {
+          sameRun = true;
+          break;
+        }
+      }
+    }
+
+    if(!sameRun)
+    {
+      // find out if this draw is inside a pass by walking backwards to the nearest boundary
+      prevInPass = false;
+      for(const DrawcallDescription *d = draw; d; d = d->previous)
+      {
+        if(d->flags & DrawFlags::BeginPass)
+        {
+          prevInPass = true;
+          break;
+        }
+
+        if(d->flags & DrawFlags::EndPass)
+          break;
+      }
+
+      ret.push_back({});
+    }
+
+    ret.back().push_back(draw->eventId);
+    prev = draw;
+  }
+
+  return ret;
+}
+
 FloatVector HighlightCache::InterpretVertex(const byte *data, uint32_t vert, const MeshDisplay &cfg,
                                             const byte *end, bool useidx, bool &valid)
 {
@@ -1161,3 +1218,76 @@ const Vec4f colorRamp[22] = {
     Vec4f(1.000000f, 0.376471f, 0.752941f, 1.0f), Vec4f(1.000000f, 0.627451f, 1.000000f, 1.0f),
     Vec4f(1.000000f, 0.878431f, 1.000000f, 1.0f), Vec4f(1.000000f, 1.000000f, 1.000000f, 1.0f),
 };
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "3rdparty/catch/catch.hpp"
+
+TEST_CASE("Test splitting events by pass", "[replay]")
+{
+  rdcarray<DrawcallDescription> draws;
+
+  auto addDraw = [&draws](uint32_t eventId, DrawFlags flags) {
+    DrawcallDescription draw;
+    draw.eventId = eventId;
+    draw.flags = flags;
+    draws.push_back(draw);
+  };
+
+  // 1: draw outside of a pass
+  // 2-6: first pass, with draws at 3, 4, 5
+  // 7-9: second pass, with a draw at 8
+  // 10: draw outside of a pass
+  addDraw(1, DrawFlags::Drawcall);
+  addDraw(2, DrawFlags::PassBoundary | DrawFlags::BeginPass);
+  addDraw(3, DrawFlags::Drawcall);
+  addDraw(4, DrawFlags::Drawcall);
+  addDraw(5, DrawFlags::Drawcall);
+  addDraw(6, DrawFlags::PassBoundary | DrawFlags::EndPass);
+  addDraw(7, DrawFlags::PassBoundary | DrawFlags::BeginPass);
+  addDraw(8, DrawFlags::Drawcall);
+  addDraw(9, DrawFlags::PassBoundary | DrawFlags::EndPass);
+  addDraw(10, DrawFlags::Drawcall);
+  addDraw(11, DrawFlags::Drawcall);
+
+  rdcarray<DrawcallDescription *> drawcallTable;
+  SetupDrawcallPointers(drawcallTable, draws);
+
+  auto split = [&drawcallTable](const rdcarray<uint32_t> &events) {
+    rdcarray<const DrawcallDescription *> list;
+    for(uint32_t eid : events)
+      list.push_back(drawcallTable[eid]);
+    return SplitEventsByPass(list);
+  };
+
+  SECTION("Events within one pass stay together")
+  {
+    rdcarray<rdcarray<uint32_t>> runs = split({2, 3, 5});
+
+    REQUIRE(runs.size() == 1);
+    CHECK(runs[0] == rdcarray<uint32_t>({2, 3, 5}));
+  };
+
+  SECTION("Events are split at pass boundaries")
+  {
+    rdcarray<rdcarray<uint32_t>> runs = split({1, 3, 4, 8, 10, 11});
+
+    REQUIRE(runs.size() == 5);
+    CHECK(runs[0] == rdcarray<uint32_t>({1}));
+    CHECK(runs[1] == rdcarray<uint32_t>({3, 4}));
+    CHECK(runs[2] == rdcarray<uint32_t>({8}));
+    CHECK(runs[3] == rdcarray<uint32_t>({10}));
+    CHECK(runs[4] == rdcarray<uint32_t>({11}));
+  };
+
+  SECTION("Missing drawcalls are skipped")
+  {
+    rdcarray<const DrawcallDescription *> list = {drawcallTable[3], NULL, drawcallTable[4]};
+    rdcarray<rdcarray<uint32_t>> runs = SplitEventsByPass(list);
+
+    REQUIRE(runs.size() == 1);
+    CHECK(runs[0] == rdcarray<uint32_t>({3, 4}));
+  };
+};
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -170,7 +170,10 @@ public:
 
   virtual rdcarray<GPUCounter> EnumerateCounters() = 0;
   virtual CounterDescription DescribeCounter(GPUCounter counterID) = 0;
-  virtual rdcarray<CounterResult> FetchCounters(const rdcarray<GPUCounter> &counterID) = 0;
+  // generic counters are only measured for events in [firstEvent, lastEvent], and the replay stops
+  // after lastEvent. Vendor counters may still be measured over the whole frame.
+  virtual rdcarray<CounterResult> FetchCounters(const rdcarray<GPUCounter> &counterID,
+                                                uint32_t firstEvent, uint32_t lastEvent) = 0;
 
   virtual void FillCBufferVariables(ResourceId pipeline, ResourceId shader, rdcstr entryPoint,
                                     uint32_t cbufSlot, rdcarray<ShaderVariable> &outvars,
@@ -288,6 +291,11 @@ void PatchTriangleFanRestartIndexBufer(rdcarray<uint32_t> &patchedIndices, uint3
 
 uint64_t CalcMeshOutputSize(uint64_t curSize, uint64_t requiredOutput);
 
+// splits a sorted list of drawcalls into runs that each lie within a single pass, as delimited by
+// BeginPass/EndPass, so that each run can be processed with one partial replay. Drawcalls outside
+// of any pass are put in a run of their own.
+rdcarray<rdcarray<uint32_t>> SplitEventsByPass(const rdcarray<const DrawcallDescription *> &draws);
+
 void StandardFillCBufferVariable(ResourceId shader, const ShaderVariableDescriptor &desc,
                                  uint32_t dataOffset, const bytebuf &data, ShaderVariable &outvar,
                                  uint32_t matStride);
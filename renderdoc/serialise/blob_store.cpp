@@ -0,0 +1,208 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "blob_store.h"
+#include "common/formatting.h"
+#include "zstd/xxhash.h"
+#include "lz4io.h"
+#include "rdcfile.h"
+#include "streamio.h"
+
+// each blob's entry in the table: hash, size, offset and compressed size
+static const uint64_t blobEntrySize = sizeof(uint64_t) * 5;
+
+BlobStore::~BlobStore()
+{
+  if(m_Spill)
+  {
+    FileIO::fclose(m_Spill);
+    FileIO::Delete(m_SpillFilename.c_str());
+  }
+}
+
+BlobHash BlobStore::Add(const byte *data, uint64_t size)
+{
+  // two independently seeded hashes, so that collisions are not a practical concern
+  BlobHash hash;
+  hash.a = XXH64(data, (size_t)size, 0);
+  hash.b = XXH64(data, (size_t)size, 0x9E3779B97F4A7C15ULL) ^ size;
+
+  SCOPED_LOCK(m_Lock);
+
+  auto it = m_Blobs.find(hash);
+  if(it != m_Blobs.end())
+  {
+    m_DeduplicatedBytes += size;
+    return hash;
+  }
+
+  if(m_Spill == NULL)
+  {
+    m_SpillFilename = StringFormat::Fmt("%s/renderdoc_blobs_%u_%p.tmp",
+                                        FileIO::GetTempFolderFilename().c_str(),
+                                        Process::GetCurrentPID(), this);
+    m_Spill = FileIO::fopen(m_SpillFilename.c_str(), "w+b");
+
+    if(m_Spill == NULL)
+      RDCERR("Couldn't open temporary file '%s' for blob storage", m_SpillFilename.c_str());
+  }
+
+  // compress with LZ4 so that it's fast, since this happens while capturing
+  StreamWriter compressed(StreamWriter::DefaultScratchSize);
+  {
+    StreamWriter writer(new LZ4Compressor(&compressed, Ownership::Nothing), Ownership::Stream);
+    writer.Write(data, size);
+    writer.Finish();
+  }
+
+  Blob blob;
+  blob.size = size;
+  blob.offset = m_SpillSize;
+  blob.compressedSize = compressed.GetOffset();
+
+  if(m_Spill)
+    FileIO::fwrite(compressed.GetData(), 1, (size_t)blob.compressedSize, m_Spill);
+
+  m_SpillSize += blob.compressedSize;
+
+  m_Blobs[hash] = blob;
+  m_Order.push_back(hash);
+
+  return hash;
+}
+
+size_t BlobStore::NumBlobs()
+{
+  SCOPED_LOCK(m_Lock);
+  return m_Order.size();
+}
+
+uint64_t BlobStore::DeduplicatedBytes()
+{
+  SCOPED_LOCK(m_Lock);
+  return m_DeduplicatedBytes;
+}
+
+void BlobStore::Write(StreamWriter *writer)
+{
+  SCOPED_LOCK(m_Lock);
+
+  writer->Write((uint64_t)m_Order.size());
+
+  for(const BlobHash &hash : m_Order)
+  {
+    const Blob &blob = m_Blobs[hash];
+    writer->Write(hash.a);
+    writer->Write(hash.b);
+    writer->Write(blob.size);
+    writer->Write(blob.offset);
+    writer->Write(blob.compressedSize);
+  }
+
+  if(m_Spill)
+  {
+    FileIO::fflush(m_Spill);
+    FileIO::fseek64(m_Spill, 0, SEEK_SET);
+
+    StreamReader spillReader(m_Spill, m_SpillSize, Ownership::Nothing);
+    StreamTransfer(writer, &spillReader, NULL);
+
+    FileIO::fseek64(m_Spill, 0, SEEK_END);
+  }
+}
+
+bool BlobStore::Read(const RDCFile *rdc, int sectionIndex)
+{
+  SCOPED_LOCK(m_Lock);
+
+  StreamReader *reader = rdc->ReadSection(sectionIndex);
+
+  uint64_t count = 0;
+  reader->Read(count);
+
+  if(count * blobEntrySize > reader->GetSize())
+  {
+    RDCERR("Blob table has invalid count %llu", count);
+    delete reader;
+    return false;
+  }
+
+  m_Blobs.reserve((size_t)count);
+  m_Order.reserve((size_t)count);
+
+  for(uint64_t i = 0; i < count; i++)
+  {
+    BlobHash hash;
+    Blob blob;
+    reader->Read(hash.a);
+    reader->Read(hash.b);
+    reader->Read(blob.size);
+    reader->Read(blob.offset);
+    reader->Read(blob.compressedSize);
+
+    m_Blobs[hash] = blob;
+    m_Order.push_back(hash);
+  }
+
+  bool success = !reader->IsErrored();
+
+  delete reader;
+
+  m_RDC = rdc;
+  m_Section = sectionIndex;
+  m_DataOffset = sizeof(uint64_t) + count * blobEntrySize;
+
+  return success;
+}
+
+bool BlobStore::Contains(const BlobHash &hash, uint64_t size)
+{
+  SCOPED_LOCK(m_Lock);
+
+  auto it = m_Blobs.find(hash);
+  return it != m_Blobs.end() && it->second.size == size;
+}
+
+bool BlobStore::Get(const BlobHash &hash, byte *data, uint64_t size)
+{
+  SCOPED_LOCK(m_Lock);
+
+  auto it = m_Blobs.find(hash);
+  if(it == m_Blobs.end() || it->second.size != size || m_RDC == NULL)
+    return false;
+
+  const Blob &blob = it->second;
+
+  bytebuf compressed;
+  if(!m_RDC->ReadSectionRange(m_Section, m_DataOffset + blob.offset, blob.compressedSize,
+                              compressed))
+    return false;
+
+  StreamReader reader(new LZ4Decompressor(new StreamReader(compressed), Ownership::Stream), size,
+                      Ownership::Stream);
+
+  reader.Read(data, size);
+
+  return !reader.IsErrored();
+}
@@ -0,0 +1,104 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <unordered_map>
+#include "common/common.h"
+#include "common/threading.h"
+
+class RDCFile;
+class StreamWriter;
+
+struct BlobHash
+{
+  uint64_t a, b;
+  bool operator==(const BlobHash &o) const { return a == o.a && b == o.b; }
+};
+
+// Stores large blobs of data such as resource initial contents once each, keyed by a hash of their
+// contents. When capturing, identical blobs (cleared targets, duplicate uploads, constant mip
+// chains) are only written once to a shared section and the frame capture references them by hash.
+// Each blob is compressed independently so that it can be read on its own when loading.
+class BlobStore
+{
+public:
+  // blobs smaller than this are cheaper to store inline than to reference
+  static const uint64_t MinimumSize = 1024;
+
+  BlobStore() = default;
+  ~BlobStore();
+
+  // adds a blob when writing and returns its hash. Safe to call from multiple threads.
+  BlobHash Add(const byte *data, uint64_t size);
+
+  // number of unique blobs stored
+  size_t NumBlobs();
+  // number of bytes that didn't need to be stored again because an identical blob already was
+  uint64_t DeduplicatedBytes();
+
+  void Write(StreamWriter *writer);
+
+  // reads the table of blobs from the given section, the blobs themselves are read on demand
+  bool Read(const RDCFile *rdc, int sectionIndex);
+
+  // returns true if the blob is present with the given size
+  bool Contains(const BlobHash &hash, uint64_t size);
+
+  // fetches a blob's contents into data, which must be size bytes. Returns false if the blob isn't
+  // present or is a different size.
+  bool Get(const BlobHash &hash, byte *data, uint64_t size);
+
+private:
+  struct BlobHashHasher
+  {
+    size_t operator()(const BlobHash &h) const { return size_t(h.a); }
+  };
+
+  struct Blob
+  {
+    uint64_t size;
+    // offset of the compressed blob, relative to the end of the table
+    uint64_t offset;
+    uint64_t compressedSize;
+  };
+
+  Threading::CriticalSection m_Lock;
+
+  std::unordered_map<BlobHash, Blob, BlobHashHasher> m_Blobs;
+
+  // the order blobs were added in, which is the order they're stored in
+  rdcarray<BlobHash> m_Order;
+
+  // when writing, compressed blobs are stored in a temporary file until the section is written
+  rdcstr m_SpillFilename;
+  FILE *m_Spill = NULL;
+  uint64_t m_SpillSize = 0;
+  uint64_t m_DeduplicatedBytes = 0;
+
+  // when reading, where to fetch the blobs from
+  const RDCFile *m_RDC = NULL;
+  int m_Section = -1;
+  uint64_t m_DataOffset = 0;
+};
@@ -0,0 +1,142 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "callstack_table.h"
+#include "streamio.h"
+
+const uint32_t CallstackTable::EmptyStack;
+
+CallstackTable::CallstackTable()
+{
+  // the root node's parent and address are never used
+  m_Parents.push_back(EmptyStack);
+  m_Addrs.push_back(0);
+}
+
+uint32_t CallstackTable::Add(const uint64_t *addrs, size_t numLevels)
+{
+  SCOPED_LOCK(m_Lock);
+
+  uint32_t node = EmptyStack;
+
+  // walk from the outermost frame inwards, so that stacks from the same call site share a path
+  for(size_t i = numLevels; i > 0; i--)
+  {
+    NodeKey key = {node, addrs[i - 1]};
+
+    auto it = m_Children.find(key);
+    if(it != m_Children.end())
+    {
+      node = it->second;
+      continue;
+    }
+
+    uint32_t child = (uint32_t)m_Parents.size();
+    m_Parents.push_back(node);
+    m_Addrs.push_back(key.addr);
+    m_Children[key] = child;
+
+    node = child;
+  }
+
+  return node;
+}
+
+bool CallstackTable::Get(uint32_t index, rdcarray<uint64_t> &addrs)
+{
+  SCOPED_LOCK(m_Lock);
+
+  addrs.clear();
+
+  if(index >= m_Parents.size())
+    return false;
+
+  // parents always have lower indices, so this terminates at the root
+  for(uint32_t node = index; node != EmptyStack; node = m_Parents[node])
+    addrs.push_back(m_Addrs[node]);
+
+  return true;
+}
+
+size_t CallstackTable::NumNodes()
+{
+  SCOPED_LOCK(m_Lock);
+
+  return m_Parents.size() - 1;
+}
+
+void CallstackTable::Write(StreamWriter *writer)
+{
+  SCOPED_LOCK(m_Lock);
+
+  uint32_t numNodes = uint32_t(m_Parents.size() - 1);
+  writer->Write(numNodes);
+  writer->Write(m_Parents.data() + 1, numNodes * sizeof(uint32_t));
+  writer->Write(m_Addrs.data() + 1, numNodes * sizeof(uint64_t));
+}
+
+bool CallstackTable::Read(StreamReader *reader)
+{
+  SCOPED_LOCK(m_Lock);
+
+  uint32_t numNodes = 0;
+  reader->Read(numNodes);
+
+  // sanity check the size against what's actually there before allocating
+  if(reader->IsErrored() ||
+     uint64_t(numNodes) * (sizeof(uint32_t) + sizeof(uint64_t)) > reader->GetSize())
+  {
+    RDCERR("Invalid callstack table with %u nodes", numNodes);
+    return false;
+  }
+
+  m_Parents.resize(numNodes + 1);
+  m_Addrs.resize(numNodes + 1);
+
+  reader->Read(m_Parents.data() + 1, numNodes * sizeof(uint32_t));
+  reader->Read(m_Addrs.data() + 1, numNodes * sizeof(uint64_t));
+
+  m_Children.clear();
+
+  bool valid = !reader->IsErrored();
+
+  for(uint32_t i = 1; valid && i <= numNodes; i++)
+  {
+    if(m_Parents[i] >= i)
+      valid = false;
+    else
+      m_Children[{m_Parents[i], m_Addrs[i]}] = i;
+  }
+
+  if(!valid)
+  {
+    RDCERR("Corrupt callstack table");
+    m_Parents.resize(1);
+    m_Addrs.resize(1);
+    m_Children.clear();
+    return false;
+  }
+
+  return true;
+}
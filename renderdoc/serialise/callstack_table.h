@@ -0,0 +1,81 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <unordered_map>
+#include "common/common.h"
+#include "common/threading.h"
+
+class StreamReader;
+class StreamWriter;
+
+// Stores each unique callstack once, as a trie of frames running from the outermost caller inwards
+// so that stacks with a common prefix share nodes. Chunks then reference their stack by the index
+// of its innermost node rather than storing every address.
+class CallstackTable
+{
+public:
+  // the root node, which is an empty callstack
+  static const uint32_t EmptyStack = 0;
+
+  CallstackTable();
+
+  // adds a callstack (innermost frame first, as returned by Callstack::Stackwalk) and returns its
+  // index. Safe to call from multiple threads.
+  uint32_t Add(const uint64_t *addrs, size_t numLevels);
+
+  // fetches the callstack for an index, innermost frame first. Returns false if it's invalid
+  bool Get(uint32_t index, rdcarray<uint64_t> &addrs);
+
+  // number of unique frames stored, not including the root
+  size_t NumNodes();
+
+  void Write(StreamWriter *writer);
+  bool Read(StreamReader *reader);
+
+private:
+  struct NodeKey
+  {
+    uint32_t parent;
+    uint64_t addr;
+    bool operator==(const NodeKey &o) const { return parent == o.parent && addr == o.addr; }
+  };
+
+  struct NodeKeyHash
+  {
+    size_t operator()(const NodeKey &k) const
+    {
+      return std::hash<uint64_t>()(k.addr ^ (uint64_t(k.parent) * 0x9E3779B97F4A7C15ULL));
+    }
+  };
+
+  Threading::CriticalSection m_Lock;
+
+  // nodes are stored as parallel arrays, parents always come before their children
+  rdcarray<uint32_t> m_Parents;
+  rdcarray<uint64_t> m_Addrs;
+
+  std::unordered_map<NodeKey, uint32_t, NodeKeyHash> m_Children;
+};
@@ -22,14 +22,15 @@
  * THE SOFTWARE.
  ******************************************************************************/
 
+#include "chrome_json_codec.h"
 #include <utility>
 #include "api/replay/structured_data.h"
 #include "common/common.h"
 #include "common/formatting.h"
 #include "serialise/rdcfile.h"
 
-ReplayStatus exportChrome(const char *filename, const RDCFile &rdc, const SDFile &structData,
-                          RENDERDOC_ProgressCallback progress)
+ReplayStatus WriteChromeTrace(const char *filename, const rdcarray<ChromeTraceEvent> &events,
+                              bool completeEvents, RENDERDOC_ProgressCallback progress)
 {
   FILE *f = FileIO::fopen(filename, "w");
 
@@ -43,40 +44,50 @@ ReplayStatus exportChrome(const char *filename, const RDCFile &rdc, const SDFile
   "displayTimeUnit": "ns",
   "traceEvents": [)";
 
-  const char *category = "Initialisation";
-
   // stupid JSON not allowing trailing ,s :(
   bool first = true;
 
   int i = 0;
-  int numChunks = structData.chunks.count();
+  int numEvents = events.count();
 
-  for(const SDChunk *chunk : structData.chunks)
+  for(const ChromeTraceEvent &ev : events)
   {
-    if(chunk->metadata.chunkID == (uint32_t)SystemChunk::FirstDriverChunk + 1)
-      category = "Frame Capture";
-
     if(!first)
       str += ",";
 
     first = false;
 
-    const char *fmt = R"(
+    if(ev.durationMicro == 0)
+    {
+      str += StringFormat::Fmt(R"(
+    { "name": "%s", "cat": "%s", "ph": "i", "ts": %llu, "pid": 5, "tid": %u })",
+                               ev.name, ev.category, ev.timestampMicro, ev.threadID);
+    }
+    else if(completeEvents)
+    {
+      str += StringFormat::Fmt(R"(
+    { "name": "%s", "cat": "%s", "ph": "X", "ts": %llu, "dur": %lld, "pid": 5, "tid": %u })",
+                               ev.name, ev.category, ev.timestampMicro, ev.durationMicro,
+                               ev.threadID);
+    }
+    else
+    {
+      str += StringFormat::Fmt(R"(
     { "name": "%s", "cat": "%s", "ph": "B", "ts": %llu, "pid": 5, "tid": %u },
-    { "ph": "E", "ts": %llu, "pid": 5, "tid": %u })";
+    { "ph": "E", "ts": %llu, "pid": 5, "tid": %u })",
+                               ev.name, ev.category, ev.timestampMicro, ev.threadID,
+                               ev.timestampMicro + ev.durationMicro, ev.threadID);
+    }
 
-    if(chunk->metadata.durationMicro == 0)
+    // flush periodically so that large traces don't need to be held in memory all at once
+    if(str.size() > 1024 * 1024)
     {
-      fmt = R"(
-    { "name": "%s", "cat": "%s", "ph": "i", "ts": %llu, "pid": 5, "tid": %u })";
+      FileIO::fwrite(str.data(), 1, str.size(), f);
+      str.clear();
     }
 
-    str += StringFormat::Fmt(
-        fmt, chunk->name.c_str(), category, chunk->metadata.timestampMicro, chunk->metadata.threadID,
-        chunk->metadata.timestampMicro + chunk->metadata.durationMicro, chunk->metadata.threadID);
-
     if(progress)
-      progress(float(i) / float(numChunks));
+      progress(float(i) / float(numEvents));
 
     i++;
   }
@@ -94,6 +105,31 @@ ReplayStatus exportChrome(const char *filename, const RDCFile &rdc, const SDFile
   return ReplayStatus::Succeeded;
 }
 
+ReplayStatus exportChrome(const char *filename, const RDCFile &rdc, const SDFile &structData,
+                          RENDERDOC_ProgressCallback progress)
+{
+  rdcarray<ChromeTraceEvent> events;
+  events.reserve(structData.chunks.size());
+
+  const char *category = "Initialisation";
+
+  for(const SDChunk *chunk : structData.chunks)
+  {
+    if(chunk->metadata.chunkID == (uint32_t)SystemChunk::FirstDriverChunk + 1)
+      category = "Frame Capture";
+
+    ChromeTraceEvent ev;
+    ev.name = chunk->name.c_str();
+    ev.category = category;
+    ev.timestampMicro = chunk->metadata.timestampMicro;
+    ev.durationMicro = chunk->metadata.durationMicro;
+    ev.threadID = (uint32_t)chunk->metadata.threadID;
+    events.push_back(ev);
+  }
+
+  return WriteChromeTrace(filename, events, false, progress);
+}
+
 static ConversionRegistration XMLConversionRegistration(
     &exportChrome,
     {
@@ -59,15 +59,209 @@ inline float StructuredProgress(float progress)
   return 0.2f + 0.8f * progress;
 }
 
-struct xml_file_writer : pugi::xml_writer
+// Writes XML straight to a file as it's generated, in the same layout as pugixml's default save, so
+// that exporting never needs the whole document in memory. Output is gathered into a small buffer
+// and written out whenever that fills up.
+class XMLStreamWriter
 {
-  StreamWriter stream;
+public:
+  XMLStreamWriter(const char *filename) : m_Stream(FileIO::fopen(filename, "wb"), Ownership::Stream)
+  {
+    m_Buffer.reserve(FlushSize + 1024);
+    Raw("<?xml version=\"1.0\"?>\n");
+  }
+
+  void BeginElement(const char *name)
+  {
+    if(m_TagOpen)
+      Raw('>');
+
+    if(!m_Elements.empty())
+      NewLine(m_Elements.size());
+
+    Raw('<');
+    Raw(name);
+
+    m_Elements.push_back(name);
+    m_TagOpen = true;
+  }
+
+  void Attribute(const char *name, const char *value)
+  {
+    Raw(' ');
+    Raw(name);
+    Raw("=\"");
+    Escaped(value, true);
+    Raw('"');
+  }
+
+  void Attribute(const char *name, uint64_t value)
+  {
+    char str[32];
+    Attribute(name, FormatUInt(value, str));
+  }
+
+  // a text-only element, closed immediately
+  void TextElement(const char *name, const char *text)
+  {
+    BeginElement(name);
+    BeginText();
+    Escaped(text, false);
+    EndText();
+  }
 
-  xml_file_writer(const char *filename) : stream(FileIO::fopen(filename, "wb"), Ownership::Stream)
+  void TextElement(const char *name, uint64_t value)
   {
+    char str[32];
+    TextElement(name, FormatUInt(value, str));
+  }
+
+  // begins the text contents of the current element, which is then closed by EndText(). Anything
+  // written in between with Raw() must already be escaped.
+  void BeginText()
+  {
+    Raw('>');
+    m_TagOpen = false;
+  }
+
+  void EndText()
+  {
+    Raw("</");
+    Raw(m_Elements.back());
+    Raw('>');
+
+    m_Elements.pop_back();
+  }
+
+  void EndElement()
+  {
+    if(m_TagOpen)
+    {
+      Raw(" />");
+    }
+    else
+    {
+      NewLine(m_Elements.size() - 1);
+      Raw("</");
+      Raw(m_Elements.back());
+      Raw('>');
+    }
+
+    m_Elements.pop_back();
+    m_TagOpen = false;
   }
 
-  void write(const void *data, size_t size) { stream.Write(data, size); }
+  bool Finish()
+  {
+    Raw('\n');
+    Flush();
+    return !m_Stream.IsErrored();
+  }
+
+  void Raw(char c)
+  {
+    m_Buffer.push_back(c);
+    if(m_Buffer.size() >= FlushSize)
+      Flush();
+  }
+
+  void Raw(const char *str) { Raw(str, strlen(str)); }
+  void Raw(const char *str, size_t len)
+  {
+    m_Buffer.append(str, len);
+    if(m_Buffer.size() >= FlushSize)
+      Flush();
+  }
+
+  // escapes the same characters as pugixml, so the output is identical
+  void Escaped(const char *str, bool attribute) { Escaped(str, strlen(str), attribute); }
+  void Escaped(const char *str, size_t len, bool attribute)
+  {
+    const char *end = str + len;
+
+    while(str < end)
+    {
+      const char *run = str;
+
+      while(str < end && !NeedsEscape(*str, attribute))
+        str++;
+
+      Raw(run, str - run);
+
+      if(str == end)
+        break;
+
+      switch(*str)
+      {
+        case '&': Raw("&amp;"); break;
+        case '<': Raw("&lt;"); break;
+        case '>': Raw("&gt;"); break;
+        case '"': Raw("&quot;"); break;
+        default:
+        {
+          unsigned char ch = (unsigned char)*str;
+          char code[] = {'&', '#', char('0' + ch / 10), char('0' + ch % 10), ';', 0};
+          Raw(code);
+          break;
+        }
+      }
+
+      str++;
+    }
+  }
+
+  static const char *FormatUInt(uint64_t value, char *str)
+  {
+    char *c = str + 31;
+    *c = 0;
+    do
+    {
+      *(--c) = char('0' + (value % 10));
+      value /= 10;
+    } while(value);
+    return c;
+  }
+
+  static const char *FormatInt(int64_t value, char *str)
+  {
+    if(value >= 0)
+      return FormatUInt(uint64_t(value), str);
+
+    // negate in unsigned space so INT64_MIN is handled
+    char *c = (char *)FormatUInt(0 - uint64_t(value), str);
+    *(--c) = '-';
+    return c;
+  }
+
+private:
+  static const size_t FlushSize = 1024 * 1024;
+
+  static bool NeedsEscape(char c, bool attribute)
+  {
+    if(c == '&' || c == '<' || c == '>')
+      return true;
+    if(attribute)
+      return c == '"' || ((unsigned char)c < 32 && c != '\t');
+    return (unsigned char)c < 32 && c != '\t' && c != '\n' && c != '\r';
+  }
+
+  void NewLine(size_t depth)
+  {
+    Raw('\n');
+    for(size_t i = 0; i < depth; i++)
+      Raw('\t');
+  }
+
+  void Flush()
+  {
+    m_Stream.Write(m_Buffer.data(), m_Buffer.size());
+    m_Buffer.clear();
+  }
+
+  StreamWriter m_Stream;
+  rdcstr m_Buffer;
+  rdcarray<const char *> m_Elements;
+  bool m_TagOpen = false;
 };
 
 // avoid &, <, and > since they throw off the ascii alignment
@@ -89,68 +283,161 @@ static constexpr byte FromHex(const char c)
                                      : (c >= 'a' && c <= 'f' ? byte(c - 'a') + 10 : 0));
 }
 
-static void HexEncode(const bytebuf &in, rdcstr &out)
-{
-  const size_t bytesPerLine = 32;
-  const size_t bytesPerGroup = 4;
+#if defined(__x86_64__) || defined(_M_X64)
 
-  const char digit[] = "0123456789ABCDEF";
-  // Reserve rough required size:
-  // - 3 characters per byte (two for hex, 1 for ascii),
-  // - 4 characters per line (3x space between hex and ascii, newline)
-  // - 1 character per group (space)
-  // - 2 characters for leading/trailing newline
-  out.reserve(in.size() * 3 + (in.size() / bytesPerLine) * 4 + (in.size() / bytesPerGroup) + 2);
+#define HEX_SSE2 OPTION_ON
+
+#include <emmintrin.h>
 
-  // leading newline
-  out = "\n";
+#else
 
-  // accumulate ascii representation for each line
-  rdcstr ascii;
+#define HEX_SSE2 OPTION_OFF
 
-  size_t i = 0;
-  for(byte c : in)
+#endif
+
+// Sections are hex encoded in lines of 32 bytes, with the bytes in groups of 4 and followed by
+// their ASCII representation:
+// 00070E15 1C232A31 383F464D 545B6269 70777E85 8C939AA1 A8AFB6BD C4CBD2D9   .....#*18?FMT[bipw~...
+static const size_t hexBytesPerLine = 32;
+static const size_t hexBytesPerGroup = 4;
+
+// enough for one full line including its newline
+static const size_t hexLineLength = 108;
+
+// encodes up to one line of bytes, returning the end of the written characters
+static char *HexEncodeLine(const byte *in, size_t len, char *out)
+{
+  const char digit[] = "0123456789ABCDEF";
+
+#if ENABLED(HEX_SSE2)
+  if(len == hexBytesPerLine)
   {
-    out.push_back(digit[(c & 0xf0) >> 4]);
-    out.push_back(digit[(c & 0x0f) >> 0]);
+    const __m128i nibbleMask = _mm_set1_epi8(0xf);
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i zeroChar = _mm_set1_epi8('0');
+    const __m128i alphaOffset = _mm_set1_epi8('A' - '0' - 10);
 
-    if(IsXMLPrintable((char)c))
-      ascii.push_back((char)c);
-    else
-      ascii.push_back('.');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tilde = _mm_set1_epi8('~');
+    const __m128i amp = _mm_set1_epi8('&');
+    const __m128i lt = _mm_set1_epi8('<');
+    const __m128i gt = _mm_set1_epi8('>');
+    const __m128i dot = _mm_set1_epi8('.');
+
+    char hex[hexBytesPerLine * 2];
 
-    i++;
-    if((i % bytesPerLine) == 0)
+    for(int half = 0; half < 2; half++)
     {
-      out += StringFormat::Fmt("   %s\n", ascii.c_str());
-      ascii.clear();
+      __m128i v = _mm_loadu_si128((const __m128i *)(in + half * 16));
+
+      __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), nibbleMask);
+      __m128i lo = _mm_and_si128(v, nibbleMask);
+
+      // nibble to '0'-'9' or 'A'-'F'
+      hi = _mm_add_epi8(_mm_add_epi8(hi, zeroChar),
+                        _mm_and_si128(_mm_cmpgt_epi8(hi, nine), alphaOffset));
+      lo = _mm_add_epi8(_mm_add_epi8(lo, zeroChar),
+                        _mm_and_si128(_mm_cmpgt_epi8(lo, nine), alphaOffset));
+
+      _mm_storeu_si128((__m128i *)(hex + half * 32), _mm_unpacklo_epi8(hi, lo));
+      _mm_storeu_si128((__m128i *)(hex + half * 32 + 16), _mm_unpackhi_epi8(hi, lo));
+
+      // bytes above 0x7f compare as negative, so they fail the lower bound
+      __m128i printable = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_sub_epi8(space, _mm_set1_epi8(1))),
+                                        _mm_cmplt_epi8(v, _mm_add_epi8(tilde, _mm_set1_epi8(1))));
+      __m128i special = _mm_or_si128(_mm_cmpeq_epi8(v, amp),
+                                     _mm_or_si128(_mm_cmpeq_epi8(v, lt), _mm_cmpeq_epi8(v, gt)));
+      printable = _mm_andnot_si128(special, printable);
+
+      __m128i ascii = _mm_or_si128(_mm_and_si128(printable, v), _mm_andnot_si128(printable, dot));
+
+      // 8 groups of 8 characters plus separating spaces, then 3 spaces before the ASCII
+      _mm_storeu_si128((__m128i *)(out + 8 * 9 + 2 + half * 16), ascii);
     }
-    else if((i % bytesPerGroup) == 0)
+
+    for(size_t g = 0; g < hexBytesPerLine / hexBytesPerGroup; g++)
     {
-      out.push_back(' ');
+      memcpy(out + g * 9, hex + g * 8, 8);
+      out[g * 9 + 8] = ' ';
     }
+
+    out[8 * 9 + 0] = ' ';
+    out[8 * 9 + 1] = ' ';
+    out[8 * 9 + 2 + hexBytesPerLine] = '\n';
+
+    return out + 8 * 9 + 2 + hexBytesPerLine + 1;
   }
+#endif
+
+  char *ascii = out + (hexBytesPerLine / hexBytesPerGroup) * 9 + 2;
 
-  // add remaining part of a line, if we didn't end by completing one
-  size_t lastLineLength = i % bytesPerLine;
-  if(lastLineLength > 0)
+  for(size_t i = 0; i < len; i++)
   {
-    for(i = lastLineLength; i < bytesPerLine; i++)
-    {
-      // print 2 spaces where there would be characters
-      out.push_back(' ');
-      out.push_back(' ');
+    byte c = in[i];
 
-      // don't print the group space the first time, since it was already printed, but after that
-      // print the group space
-      if((i % bytesPerGroup) == 0 && i > lastLineLength)
-        out.push_back(' ');
-    }
+    *(out++) = digit[(c & 0xf0) >> 4];
+    *(out++) = digit[(c & 0x0f) >> 0];
+
+    *(ascii++) = IsXMLPrintable((char)c) ? (char)c : '.';
+
+    // bytes are separated into groups, except at the end of the line
+    if(((i + 1) % hexBytesPerGroup) == 0 && i + 1 < hexBytesPerLine)
+      *(out++) = ' ';
+  }
+
+  // pad a partial line out so that its ASCII lines up. After the first group boundary each one is
+  // padded with a space as well
+  for(size_t i = len; i < hexBytesPerLine; i++)
+  {
+    *(out++) = ' ';
+    *(out++) = ' ';
 
-    // add ascii and final newline
-    out += StringFormat::Fmt("   %s\n", ascii.c_str());
+    if((i % hexBytesPerGroup) == 0 && i > len)
+      *(out++) = ' ';
   }
+
+  *(out++) = ' ';
+  *(out++) = ' ';
+  *(out++) = ' ';
+
+  RDCASSERT(out + len == ascii);
+
+  *(ascii++) = '\n';
+
+  return ascii;
+}
+
+#if ENABLED(HEX_SSE2)
+// decodes a group of 8 hex characters to 4 bytes, if they're all valid hex
+static bool HexDecodeGroup(const char *str, byte *out)
+{
+  __m128i c = _mm_loadl_epi64((const __m128i *)str);
+
+  // fold to lower case so letters are only checked once. Digits aren't affected
+  __m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+
+  __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+                                _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+  __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+
+  if((_mm_movemask_epi8(_mm_or_si128(digit, alpha)) & 0xff) != 0xff)
+    return false;
+
+  __m128i nibbles =
+      _mm_or_si128(_mm_and_si128(digit, _mm_sub_epi8(c, _mm_set1_epi8('0'))),
+                   _mm_andnot_si128(digit, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+
+  // each 16-bit lane now holds the high nibble in its low byte and the low nibble in its high byte
+  __m128i bytes = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0xf)), 4),
+                               _mm_srli_epi16(nibbles, 8));
+
+  int packed = _mm_cvtsi128_si32(_mm_packus_epi16(bytes, bytes));
+  memcpy(out, &packed, sizeof(packed));
+
+  return true;
 }
+#endif
 
 static void HexDecode(const char *str, const char *end, bytebuf &out)
 {
@@ -161,6 +448,22 @@ static void HexDecode(const char *str, const char *end, bytebuf &out)
 
   while(str + 1 < end)
   {
+#if ENABLED(HEX_SSE2)
+    // decode whole groups at once where possible
+    byte group[hexBytesPerGroup];
+    if(str + hexBytesPerGroup * 2 <= end && HexDecodeGroup(str, group))
+    {
+      out.append(group, hexBytesPerGroup);
+
+      str += hexBytesPerGroup * 2;
+
+      if(str < end && str[0] == ' ')
+        str++;
+
+      continue;
+    }
+#endif
+
     if(IsHex(str[0]) && IsHex(str[1]))
     {
       out.push_back(byte((FromHex(str[0]) << 4) | FromHex(str[1])));
@@ -189,36 +492,41 @@ static void HexDecode(const char *str, const char *end, bytebuf &out)
   }
 }
 
-static void Obj2XML(pugi::xml_node &parent, SDObject &child)
+static void Obj2XML(XMLStreamWriter &writer, const SDObject &child, bool arrayElement)
 {
-  pugi::xml_node obj = parent.append_child(typeNames[(uint32_t)child.type.basetype]);
+  writer.BeginElement(typeNames[(uint32_t)child.type.basetype]);
+
+  if(!arrayElement)
+    writer.Attribute("name", child.name.c_str());
 
-  obj.append_attribute("name") = child.name.c_str();
+  // arrays with elements take their type name from them
+  bool omitTypeName = child.type.basetype == SDBasic::Array && !child.data.children.empty();
 
-  if(!child.type.name.empty())
-    obj.append_attribute("typename") = child.type.name.c_str();
+  if(!child.type.name.empty() && !omitTypeName)
+    writer.Attribute("typename", child.type.name.c_str());
 
   if(child.type.basetype == SDBasic::UnsignedInteger ||
      child.type.basetype == SDBasic::SignedInteger || child.type.basetype == SDBasic::Float ||
      child.type.basetype == SDBasic::Resource)
   {
-    obj.append_attribute("width") = child.type.byteSize;
+    writer.Attribute("width", child.type.byteSize);
   }
 
   if(child.type.flags & SDTypeFlags::Hidden)
-    obj.append_attribute("hidden") = true;
+    writer.Attribute("hidden", "true");
 
-  if(child.type.flags & SDTypeFlags::Nullable)
-    obj.append_attribute("nullable") = true;
+  // redundant for null objects
+  if((child.type.flags & SDTypeFlags::Nullable) && child.type.basetype != SDBasic::Null)
+    writer.Attribute("nullable", "true");
 
   if(child.type.flags & SDTypeFlags::NullString)
-    obj.append_attribute("nullstring") = true;
+    writer.Attribute("nullstring", "true");
 
   if(child.type.flags & SDTypeFlags::FixedArray)
-    obj.append_attribute("fixedarray") = true;
+    writer.Attribute("fixedarray", "true");
 
   if(child.type.flags & SDTypeFlags::Union)
-    obj.append_attribute("union") = true;
+    writer.Attribute("union", "true");
 
   if(child.type.basetype == SDBasic::Chunk)
   {
@@ -226,90 +534,116 @@ static void Obj2XML(pugi::xml_node &parent, SDObject &child)
   }
   else if(child.type.basetype == SDBasic::Null)
   {
-    // redundant
-    obj.remove_attribute("nullable");
+    writer.EndElement();
+    return;
   }
   else if(child.type.basetype == SDBasic::Struct || child.type.basetype == SDBasic::Array)
   {
-    if(child.type.basetype == SDBasic::Array && !child.data.children.empty())
-      obj.remove_attribute("typename");
-
     for(size_t o = 0; o < child.data.children.size(); o++)
-    {
-      Obj2XML(obj, *child.data.children[o]);
+      Obj2XML(writer, *child.data.children[o], child.type.basetype == SDBasic::Array);
 
-      if(child.type.basetype == SDBasic::Array)
-        obj.last_child().remove_attribute("name");
-    }
+    writer.EndElement();
+    return;
   }
   else if(child.type.basetype == SDBasic::Buffer)
   {
-    obj.append_attribute("byteLength") = child.type.byteSize;
-    obj.text() = child.data.basic.u;
+    writer.Attribute("byteLength", child.type.byteSize);
   }
-  else
+  else if(child.type.flags & SDTypeFlags::HasCustomString)
   {
-    if(child.type.flags & SDTypeFlags::HasCustomString)
-    {
-      obj.append_attribute("string") = child.data.str.c_str();
-    }
+    writer.Attribute("string", child.data.str.c_str());
+  }
 
-    switch(child.type.basetype)
-    {
-      case SDBasic::Resource:
-      case SDBasic::Enum:
-      case SDBasic::UnsignedInteger: obj.text() = child.data.basic.u; break;
-      case SDBasic::SignedInteger: obj.text() = child.data.basic.i; break;
-      case SDBasic::String: obj.text() = child.data.str.c_str(); break;
-      case SDBasic::Float: obj.text() = child.data.basic.d; break;
-      case SDBasic::Boolean: obj.text() = child.data.basic.b; break;
-      case SDBasic::Character:
-      {
-        char str[2] = {child.data.basic.c, '\0'};
-        obj.text().set(str);
-        break;
-      }
-      default: RDCERR("Unexpected case");
-    }
+  char str[64];
+  const char *text = "";
+
+  switch(child.type.basetype)
+  {
+    case SDBasic::Buffer:
+    case SDBasic::Resource:
+    case SDBasic::Enum:
+    case SDBasic::UnsignedInteger:
+      text = XMLStreamWriter::FormatUInt(child.data.basic.u, str);
+      break;
+    case SDBasic::SignedInteger: text = XMLStreamWriter::FormatInt(child.data.basic.i, str); break;
+    case SDBasic::String: text = child.data.str.c_str(); break;
+    case SDBasic::Float:
+      // the same formatting pugixml uses, so the value round-trips exactly
+      snprintf(str, sizeof(str), "%.17g", child.data.basic.d);
+      text = str;
+      break;
+    case SDBasic::Boolean: text = child.data.basic.b ? "true" : "false"; break;
+    case SDBasic::Character:
+      str[0] = child.data.basic.c;
+      str[1] = 0;
+      text = str;
+      break;
+    default:
+      RDCERR("Unexpected case");
+      writer.EndElement();
+      return;
   }
+
+  writer.BeginText();
+  writer.Escaped(text, false);
+  writer.EndText();
 }
 
 static ReplayStatus Structured2XML(const char *filename, const RDCFile &file, uint64_t version,
                                    const StructuredChunkList &chunks,
                                    RENDERDOC_ProgressCallback progress)
 {
-  pugi::xml_document doc;
+  XMLStreamWriter writer(filename);
 
-  pugi::xml_node xRoot = doc.append_child("rdc");
+  writer.BeginElement("rdc");
 
   {
-    pugi::xml_node xHeader = xRoot.append_child("header");
+    writer.BeginElement("header");
 
-    pugi::xml_node xDriver = xHeader.append_child("driver");
-    xDriver.append_attribute("id") = (uint32_t)file.GetDriver();
-    xDriver.text() = file.GetDriverName().c_str();
+    writer.BeginElement("driver");
+    writer.Attribute("id", (uint32_t)file.GetDriver());
+    writer.BeginText();
+    writer.Escaped(file.GetDriverName().c_str(), false);
+    writer.EndText();
 
-    pugi::xml_node xIdent = xHeader.append_child("machineIdent");
+    writer.TextElement("machineIdent", file.GetMachineIdent());
 
-    xIdent.text().set(file.GetMachineIdent());
-
-    pugi::xml_node xThumbnail = xHeader.append_child("thumbnail");
+    writer.BeginElement("thumbnail");
 
     const RDCThumb &th = file.GetThumbnail();
     if(th.pixels && th.len > 0 && th.width > 0 && th.height > 0)
     {
-      xThumbnail.append_attribute("width") = th.width;
-      xThumbnail.append_attribute("height") = th.height;
+      writer.Attribute("width", th.width);
+      writer.Attribute("height", th.height);
+
+      const char *thumbName = NULL;
 
       if(th.format == FileType::JPG)
-        xThumbnail.text() = "thumb.jpg";
+        thumbName = "thumb.jpg";
       else if(th.format == FileType::PNG)
-        xThumbnail.text() = "thumb.png";
+        thumbName = "thumb.png";
       else if(th.format == FileType::Raw)
-        xThumbnail.text() = "thumb.raw";
+        thumbName = "thumb.raw";
       else
         RDCERR("Unexpected thumbnail format %s", ToStr(th.format).c_str());
+
+      if(thumbName)
+      {
+        writer.BeginText();
+        writer.Raw(thumbName);
+        writer.EndText();
+      }
+      else
+      {
+        writer.EndElement();
+      }
     }
+    else
+    {
+      writer.EndElement();
+    }
+
+    writer.EndElement();
   }
 
   if(progress)
@@ -334,20 +668,33 @@ static ReplayStatus Structured2XML(const char *filename, const RDCFile &file, ui
         bool succeeded = reader->SkipBytes(thumbHeader.len) && !reader->IsErrored();
         if(succeeded && (uint32_t)thumbHeader.format < (uint32_t)FileType::Count)
         {
-          pugi::xml_node xExtThumbnail = xRoot.append_child("extended_thumbnail");
+          writer.BeginElement("extended_thumbnail");
 
-          xExtThumbnail.append_attribute("width") = thumbHeader.width;
-          xExtThumbnail.append_attribute("height") = thumbHeader.height;
-          xExtThumbnail.append_attribute("length") = thumbHeader.len;
+          writer.Attribute("width", thumbHeader.width);
+          writer.Attribute("height", thumbHeader.height);
+          writer.Attribute("length", thumbHeader.len);
+
+          const char *thumbName = NULL;
 
           if(thumbHeader.format == FileType::JPG)
-            xExtThumbnail.text() = "ext_thumb.jpg";
+            thumbName = "ext_thumb.jpg";
           else if(thumbHeader.format == FileType::PNG)
-            xExtThumbnail.text() = "ext_thumb.png";
+            thumbName = "ext_thumb.png";
           else if(thumbHeader.format == FileType::Raw)
-            xExtThumbnail.text() = "ext_thumb.raw";
+            thumbName = "ext_thumb.raw";
           else
             RDCERR("Unexpected extended thumbnail format %s", ToStr(thumbHeader.format).c_str());
+
+          if(thumbName)
+          {
+            writer.BeginText();
+            writer.Raw(thumbName);
+            writer.EndText();
+          }
+          else
+          {
+            writer.EndElement();
+          }
         }
       }
 
@@ -355,101 +702,131 @@ static ReplayStatus Structured2XML(const char *filename, const RDCFile &file, ui
       continue;
     }
 
-    pugi::xml_node xSection = xRoot.append_child("section");
+    writer.BeginElement("section");
 
     if(props.flags & SectionFlags::ASCIIStored)
-      xSection.append_attribute("ascii");
+      writer.Attribute("ascii", "");
     if(props.flags & SectionFlags::LZ4Compressed)
-      xSection.append_attribute("lz4");
+      writer.Attribute("lz4", "");
     if(props.flags & SectionFlags::ZstdCompressed)
-      xSection.append_attribute("zstd");
+      writer.Attribute("zstd", "");
 
-    pugi::xml_node name = xSection.append_child("name");
-    name.text() = props.name.c_str();
+    writer.TextElement("name", props.name.c_str());
+    writer.TextElement("version", props.version);
+    writer.TextElement("type", (uint32_t)props.type);
 
-    pugi::xml_node secVer = xSection.append_child("version");
-    secVer.text() = props.version;
+    writer.BeginElement("data");
+    writer.BeginText();
 
-    pugi::xml_node type = xSection.append_child("type");
-    type.text() = (uint32_t)props.type;
+    // stream the contents through in blocks of whole lines, so large sections aren't held in memory
+    bytebuf block;
+    block.resize(hexBytesPerLine * 1024);
 
-    bytebuf contents;
-    contents.resize((size_t)reader->GetSize());
-    reader->Read(contents.data(), reader->GetSize());
+    if(!(props.flags & SectionFlags::ASCIIStored))
+      writer.Raw('\n');
 
-    pugi::xml_node data = xSection.append_child("data");
+    char line[hexLineLength];
 
-    if(props.flags & SectionFlags::ASCIIStored)
-    {
-      // insert the contents literally
-      data.text().set((char *)contents.data());
-    }
-    else
+    uint64_t remaining = reader->GetSize();
+    bool terminated = false;
+    while(remaining > 0 && !terminated && !reader->IsErrored())
     {
-      // encode to simple hex. Not efficient, but easy.
-      rdcstr hexdata;
-      hexdata.reserve(contents.size() * 2);
-      HexEncode(contents, hexdata);
-      data.text().set(hexdata.c_str());
+      size_t blockSize = (size_t)RDCMIN(remaining, (uint64_t)block.size());
+      reader->Read(block.data(), blockSize);
+      remaining -= blockSize;
+
+      if(props.flags & SectionFlags::ASCIIStored)
+      {
+        // insert the contents literally, up to any NULL terminator
+        const byte *nullTerminator = (const byte *)memchr(block.data(), 0, blockSize);
+        if(nullTerminator)
+        {
+          blockSize = nullTerminator - block.data();
+          terminated = true;
+        }
+
+        writer.Escaped((const char *)block.data(), blockSize, false);
+      }
+      else
+      {
+        // encode to simple hex. Not efficient, but easy.
+        for(size_t offs = 0; offs < blockSize; offs += hexBytesPerLine)
+        {
+          size_t lineBytes = RDCMIN(hexBytesPerLine, blockSize - offs);
+          char *lineEnd = HexEncodeLine(block.data() + offs, lineBytes, line);
+          writer.Raw(line, lineEnd - line);
+        }
+      }
     }
 
+    writer.EndText();
+
+    writer.EndElement();
+
     delete reader;
   }
 
   if(progress)
     progress(StructuredProgress(0.2f));
 
-  pugi::xml_node xChunks = xRoot.append_child("chunks");
+  writer.BeginElement("chunks");
 
-  xChunks.append_attribute("version") = version;
+  writer.Attribute("version", version);
 
   for(size_t c = 0; c < chunks.size(); c++)
   {
-    pugi::xml_node xChunk = xChunks.append_child("chunk");
+    writer.BeginElement("chunk");
     SDChunk *chunk = chunks[c];
 
-    xChunk.append_attribute("id") = chunk->metadata.chunkID;
-    xChunk.append_attribute("name") = chunk->name.c_str();
-    xChunk.append_attribute("length") = chunk->metadata.length;
+    writer.Attribute("id", chunk->metadata.chunkID);
+    writer.Attribute("name", chunk->name.c_str());
+    writer.Attribute("length", chunk->metadata.length);
     if(chunk->metadata.threadID)
-      xChunk.append_attribute("threadID") = chunk->metadata.threadID;
+      writer.Attribute("threadID", chunk->metadata.threadID);
     if(chunk->metadata.timestampMicro)
-      xChunk.append_attribute("timestamp") = chunk->metadata.timestampMicro;
+      writer.Attribute("timestamp", chunk->metadata.timestampMicro);
     if(chunk->metadata.durationMicro >= 0)
-      xChunk.append_attribute("duration") = chunk->metadata.durationMicro;
+      writer.Attribute("duration", (uint64_t)chunk->metadata.durationMicro);
+    if(chunk->metadata.flags & SDChunkFlags::OpaqueChunk)
+      writer.Attribute("opaque", "true");
+
     if(chunk->metadata.flags & SDChunkFlags::HasCallstack)
     {
-      pugi::xml_node stack = xChunk.append_child("callstack");
+      writer.BeginElement("callstack");
 
       for(size_t i = 0; i < chunk->metadata.callstack.size(); i++)
-      {
-        stack.append_child("address").text() = chunk->metadata.callstack[i];
-      }
+        writer.TextElement("address", chunk->metadata.callstack[i]);
+
+      writer.EndElement();
     }
 
     if(chunk->metadata.flags & SDChunkFlags::OpaqueChunk)
     {
-      xChunk.append_attribute("opaque") = true;
-
       RDCASSERT(!chunk->data.children.empty());
-      pugi::xml_node opaque = xChunk.append_child("buffer");
-      opaque.append_attribute("byteLength") = chunk->data.children[0]->type.byteSize;
-      opaque.text() = chunk->data.children[0]->data.basic.u;
+      writer.BeginElement("buffer");
+      writer.Attribute("byteLength", chunk->data.children[0]->type.byteSize);
+      writer.BeginText();
+      char str[32];
+      writer.Raw(XMLStreamWriter::FormatUInt(chunk->data.children[0]->data.basic.u, str));
+      writer.EndText();
     }
     else
     {
       for(size_t o = 0; o < chunk->data.children.size(); o++)
-        Obj2XML(xChunk, *chunk->data.children[o]);
+        Obj2XML(writer, *chunk->data.children[o], false);
     }
 
+    writer.EndElement();
+
     if(progress)
       progress(StructuredProgress(0.2f + 0.8f * (float(c) / float(chunks.size()))));
   }
 
-  xml_file_writer writer(filename);
-  doc.save(writer);
+  writer.EndElement();
 
-  return writer.stream.IsErrored() ? ReplayStatus::FileIOFailed : ReplayStatus::Succeeded;
+  writer.EndElement();
+
+  return writer.Finish() ? ReplayStatus::Succeeded : ReplayStatus::FileIOFailed;
 }
 
 static SDObject *XML2Obj(pugi::xml_node &obj)
@@ -997,3 +1374,270 @@ static ConversionRegistration XMLOnlyConversionRegistration(
 easier to work with but it cannot then be imported.)",
         false,
     });
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "3rdparty/catch/catch.hpp"
+
+static void MakeTestCapture(RDCFile &rdc, SDFile &sd, size_t numChunks, const bytebuf &thumbPixels)
+{
+  RDCThumb thumb;
+  thumb.pixels = thumbPixels.data();
+  thumb.len = (uint32_t)thumbPixels.size();
+  thumb.width = 4;
+  thumb.height = 2;
+  thumb.format = FileType::Raw;
+
+  rdc.SetData(RDCDriver::Vulkan, "Vulkan", 0x1234, &thumb);
+
+  {
+    SectionProperties props;
+    props.type = SectionType::ResolveDatabase;
+    props.name = ToStr(props.type);
+    props.version = 3;
+    props.flags = SectionFlags::ZstdCompressed;
+
+    // not a multiple of the 32 bytes per line, to check partial lines
+    bytebuf contents;
+    for(int i = 0; i < 100; i++)
+      contents.push_back(byte(i * 7));
+    contents.append((const byte *)"a&b<c>d", 7);
+
+    StreamWriter *w = rdc.WriteSection(props);
+    w->Write(contents.data(), contents.size());
+    w->Finish();
+    delete w;
+  }
+
+  {
+    SectionProperties props;
+    props.type = SectionType::Notes;
+    props.name = ToStr(props.type);
+    props.version = 1;
+    props.flags = SectionFlags::ASCIIStored;
+
+    const char notes[] = "{\"comments\": \"x < y & \\\"z\\\"\"}";
+
+    StreamWriter *w = rdc.WriteSection(props);
+    w->Write(notes, sizeof(notes) - 1);
+    w->Finish();
+    delete w;
+  }
+
+  sd.version = 0x10;
+
+  sd.buffers.push_back(new bytebuf);
+  sd.buffers.back()->resize(64);
+
+  for(size_t c = 0; c < numChunks; c++)
+  {
+    SDChunk *chunk = new SDChunk("vkTestChunk");
+    chunk->metadata.chunkID = uint32_t(1000 + c);
+    chunk->metadata.length = 123;
+    chunk->metadata.threadID = 77;
+    chunk->metadata.timestampMicro = 5000 + c;
+    chunk->metadata.durationMicro = 12;
+
+    SDObject *params = makeSDStruct("CreateInfo", "VkTestCreateInfo");
+    params->data.children.push_back(makeSDUInt32("flags", uint32_t(c)));
+    params->data.children.push_back(makeSDInt64("offset", -int64_t(c) - 5));
+    params->data.children.push_back(makeSDFloat("scale", 0.1f));
+    params->data.children.push_back(makeSDBool("enabled", (c % 2) == 0));
+    params->data.children.push_back(makeSDString("label", "tricky \"<label>\" & \x01 text\n"));
+    params->data.children.push_back(makeSDString("empty", ""));
+    params->data.children.push_back(makeSDResourceId("image", ResourceId()));
+    params->data.children.push_back(makeSDEnum("format", 37));
+    params->data.children.back()->SetCustomString("VK_FORMAT_R8G8B8A8_UNORM");
+    params->data.children.back()->SetTypeName("VkFormat");
+
+    SDObject *character = new SDObject("letter"_lit, "char"_lit);
+    character->type.basetype = SDBasic::Character;
+    character->type.byteSize = 1;
+    character->data.basic.c = 'q';
+    params->data.children.push_back(character);
+
+    SDObject *null = new SDObject("pNext"_lit, "VkBaseInStructure"_lit);
+    null->type.basetype = SDBasic::Null;
+    null->type.flags = SDTypeFlags::Nullable;
+    params->data.children.push_back(null);
+
+    SDObject *arr = makeSDArray("indices");
+    for(uint32_t i = 0; i < 3; i++)
+      arr->data.children.push_back(makeSDUInt32("$el", i));
+    params->data.children.push_back(arr);
+
+    params->data.children.push_back(makeSDArray("nothing"));
+
+    SDObject *buf = new SDObject("data"_lit, "Byte Buffer"_lit);
+    buf->type.basetype = SDBasic::Buffer;
+    buf->type.byteSize = 64;
+    buf->data.basic.u = 0;
+    params->data.children.push_back(buf);
+
+    SDObject *hidden = makeSDUInt64("internal", 99);
+    hidden->type.flags |= SDTypeFlags::Hidden;
+    params->data.children.push_back(hidden);
+
+    chunk->data.children.push_back(params);
+
+    sd.chunks.push_back(chunk);
+  }
+}
+
+static bytebuf ReadTestSection(const RDCFile &rdc, int index)
+{
+  bytebuf ret;
+  StreamReader *reader = rdc.ReadSection(index);
+  ret.resize((size_t)reader->GetSize());
+  reader->Read(ret.data(), ret.size());
+  delete reader;
+  return ret;
+}
+
+TEST_CASE("XML export and import", "[xml]")
+{
+  bytebuf thumbPixels;
+  for(int i = 0; i < 4 * 2 * 3; i++)
+    thumbPixels.push_back(byte(i));
+
+  RDCFile rdc;
+  SDFile sd;
+  MakeTestCapture(rdc, sd, 2, thumbPixels);
+
+  SECTION("Exported XML contents")
+  {
+    rdcstr path = FileIO::GetTempFolderFilename() + "/renderdoc_xml_export_test.xml";
+
+    REQUIRE(exportXMLOnly(path.c_str(), rdc, sd, RENDERDOC_ProgressCallback()) ==
+            ReplayStatus::Succeeded);
+
+    rdcstr xml;
+    FileIO::ReadAll(path.c_str(), xml);
+    FileIO::Delete(path.c_str());
+
+    CHECK(xml.beginsWith("<?xml version=\"1.0\"?>\n<rdc>\n\t<header>\n"));
+    CHECK(xml.endsWith("\t</chunks>\n</rdc>\n"));
+
+    const char *expected[] = {
+        "\t\t<driver id=\"8\">Vulkan</driver>\n",
+        "\t\t<thumbnail width=\"4\" height=\"2\">thumb.raw</thumbnail>\n",
+        "\t<section zstd=\"\">\n",
+        "00070E15 1C232A31 383F464D 545B6269 70777E85 8C939AA1 A8AFB6BD C4CBD2D9   "
+        ".....#*18?FMT[bipw~.............\n",
+        "A0A7AEB5 6126623C 633E64                                                  "
+        "....a.b.c.d\n</data>\n",
+        "<data>{\"comments\": \"x &lt; y &amp; \\\"z\\\"\"}</data>\n",
+        "\t<chunks version=\"16\">\n",
+        "<chunk id=\"1001\" name=\"vkTestChunk\" length=\"123\" threadID=\"77\" "
+        "timestamp=\"5001\" duration=\"12\">\n",
+        "<int name=\"offset\" typename=\"int64_t\" width=\"8\">-6</int>\n",
+        "<float name=\"scale\" typename=\"float\" width=\"4\">0.10000000149011612</float>\n",
+        "<string name=\"label\" typename=\"string\">tricky \"&lt;label&gt;\" &amp; &#01; "
+        "text\n</string>\n",
+        "<enum name=\"format\" typename=\"VkFormat\" "
+        "string=\"VK_FORMAT_R8G8B8A8_UNORM\">37</enum>\n",
+        "<null name=\"pNext\" typename=\"VkBaseInStructure\" />\n",
+        "\t\t\t\t\t<uint typename=\"uint32_t\" width=\"4\">2</uint>\n",
+        "<array name=\"nothing\" typename=\"array\" />\n",
+        "<buffer name=\"data\" typename=\"Byte Buffer\" byteLength=\"64\">0</buffer>\n",
+        "<uint name=\"internal\" typename=\"uint64_t\" width=\"8\" hidden=\"true\">99</uint>\n",
+    };
+
+    for(const char *e : expected)
+    {
+      INFO(e);
+      CHECK(xml.contains(e));
+    }
+  };
+
+  SECTION("Round trip through zip")
+  {
+    rdcstr path = FileIO::GetTempFolderFilename() + "/renderdoc_xml_roundtrip_test.zip.xml";
+
+    REQUIRE(exportXMLZ(path.c_str(), rdc, sd, RENDERDOC_ProgressCallback()) ==
+            ReplayStatus::Succeeded);
+
+    bytebuf xml;
+    FileIO::ReadAll(path.c_str(), xml);
+
+    RDCFile rdc2;
+    SDFile sd2;
+    StreamReader reader(xml);
+    REQUIRE(importXMLZ(path.c_str(), reader, &rdc2, sd2, RENDERDOC_ProgressCallback()) ==
+            ReplayStatus::Succeeded);
+
+    FileIO::Delete(path.c_str());
+    FileIO::Delete((path + ".zip").c_str());
+
+    CHECK(rdc2.GetDriverName() == "Vulkan");
+    CHECK(rdc2.GetMachineIdent() == 0x1234);
+    CHECK(rdc2.GetThumbnail().width == 4);
+    CHECK(rdc2.GetThumbnail().height == 2);
+
+    REQUIRE(rdc2.NumSections() == rdc.NumSections());
+    for(int i = 0; i < rdc.NumSections(); i++)
+    {
+      CHECK(rdc2.GetSectionProperties(i).name == rdc.GetSectionProperties(i).name);
+      CHECK(rdc2.GetSectionProperties(i).version == rdc.GetSectionProperties(i).version);
+      CHECK(ReadTestSection(rdc2, i) == ReadTestSection(rdc, i));
+    }
+
+    CHECK(sd2.version == sd.version);
+    // the buffer list is sized by the number of files in the zip, which includes the thumbnail
+    REQUIRE(sd2.buffers.size() >= sd.buffers.size());
+    CHECK(*sd2.buffers[0] == *sd.buffers[0]);
+
+    REQUIRE(sd2.chunks.size() == sd.chunks.size());
+    for(size_t c = 0; c < sd.chunks.size(); c++)
+    {
+      CHECK(sd2.chunks[c]->name == sd.chunks[c]->name);
+      CHECK(sd2.chunks[c]->metadata.chunkID == sd.chunks[c]->metadata.chunkID);
+      CHECK(sd2.chunks[c]->metadata.timestampMicro == sd.chunks[c]->metadata.timestampMicro);
+
+      const SDObject *params = sd.chunks[c]->GetChild(0);
+      const SDObject *params2 = sd2.chunks[c]->GetChild(0);
+      REQUIRE(params2->NumChildren() == params->NumChildren());
+      CHECK(params2->FindChild("offset")->AsInt64() == params->FindChild("offset")->AsInt64());
+      CHECK(params2->FindChild("label")->AsString() == params->FindChild("label")->AsString());
+      CHECK(params2->FindChild("indices")->NumChildren() == 3);
+    }
+  };
+};
+
+TEST_CASE("XML hex encoding", "[xml]")
+{
+  for(size_t len = 0; len <= 100; len++)
+  {
+    bytebuf data;
+    for(size_t i = 0; i < len; i++)
+      data.push_back(byte((i * 193 + len * 31) ^ (i >> 2)));
+
+    rdcstr encoded = "\n";
+    char line[hexLineLength];
+    for(size_t offs = 0; offs < len; offs += hexBytesPerLine)
+    {
+      char *lineEnd = HexEncodeLine(data.data() + offs, RDCMIN(hexBytesPerLine, len - offs), line);
+      encoded.append(line, lineEnd - line);
+    }
+
+    INFO("length " << len);
+
+    // every line has its ASCII column at the same position, including partial lines
+    rdcarray<rdcstr> lines;
+    split(encoded, lines, '\n');
+    for(const rdcstr &l : lines)
+    {
+      if(l.empty())
+        continue;
+      CHECK(l.size() <= hexLineLength - 1);
+      CHECK(l.size() > 74);
+      CHECK(l.substr(71, 3) == "   ");
+    }
+
+    bytebuf decoded;
+    HexDecode(encoded.c_str(), encoded.c_str() + encoded.size(), decoded);
+    CHECK(decoded == data);
+  }
+};
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
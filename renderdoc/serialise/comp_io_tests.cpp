@@ -190,4 +190,69 @@ TEST_CASE("Test ZSTD compression/decompression", "[streamio][zstd]")
   delete[] randomData;
 };
 
+TEST_CASE("Test parallel ZSTD compression", "[streamio][zstd]")
+{
+  // enough for several batches of blocks, and not a multiple of the block size
+  const uint64_t dataSize = 5 * 1024 * 1024 + 12345;
+
+  bytebuf data;
+  data.resize((size_t)dataSize);
+  for(size_t i = 0; i < data.size(); i++)
+    data[i] = (i / 4096) % 3 == 0 ? byte(rand() & 0xff) : byte(i & 0xf0);
+
+  auto compress = [&data](StreamWriter &buf, int level, uint32_t numThreads) {
+    StreamWriter writer(new ZSTDCompressor(&buf, Ownership::Nothing, level, numThreads),
+                        Ownership::Stream);
+
+    // write in uneven chunks so writes span block and batch boundaries
+    uint64_t offs = 0;
+    while(offs < data.size())
+    {
+      uint64_t len = RDCMIN(data.size() - offs, uint64_t(300 * 1024 + 17));
+      writer.Write(data.data() + offs, len);
+      offs += len;
+    }
+
+    writer.Finish();
+
+    CHECK_FALSE(writer.IsErrored());
+  };
+
+  StreamWriter single(StreamWriter::DefaultScratchSize);
+  compress(single, 0, 1);
+
+  SECTION("Output is identical regardless of thread count")
+  {
+    for(uint32_t numThreads : {2U, 3U, 8U})
+    {
+      StreamWriter parallel(StreamWriter::DefaultScratchSize);
+      compress(parallel, 0, numThreads);
+
+      REQUIRE(parallel.GetOffset() == single.GetOffset());
+      CHECK_FALSE(memcmp(parallel.GetData(), single.GetData(), (size_t)single.GetOffset()));
+    }
+  };
+
+  SECTION("Higher levels decompress correctly")
+  {
+    StreamWriter parallel(StreamWriter::DefaultScratchSize);
+    compress(parallel, 19, 4);
+
+    CHECK(parallel.GetOffset() <= single.GetOffset());
+
+    StreamReader reader(
+        new ZSTDDecompressor(new StreamReader(parallel.GetData(), parallel.GetOffset()),
+                             Ownership::Stream),
+        dataSize, Ownership::Stream);
+
+    bytebuf readData;
+    readData.resize((size_t)dataSize);
+    reader.Read(readData.data(), dataSize);
+
+    CHECK(readData == data);
+    CHECK_FALSE(reader.IsErrored());
+    CHECK(reader.AtEnd());
+  };
+};
+
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -29,6 +29,8 @@
 #include "api/replay/version.h"
 #include "common/dds_readwrite.h"
 #include "common/formatting.h"
+#include "blob_store.h"
+#include "callstack_table.h"
 #include "lz4io.h"
 #include "zstdio.h"
 
@@ -230,6 +232,9 @@ RDCFile::~RDCFile()
 
   if(m_Thumb.pixels)
     delete[] m_Thumb.pixels;
+
+  SAFE_DELETE(m_Callstacks);
+  SAFE_DELETE(m_Blobs);
 }
 
 void RDCFile::Open(const char *path)
@@ -286,7 +291,7 @@ void RDCFile::Open(const char *path)
 
   StreamReader reader(m_File, fileSize, Ownership::Nothing);
 
-  Init(reader);
+  Init(reader, false);
 }
 
 void RDCFile::Open(const bytebuf &buffer)
@@ -296,10 +301,35 @@ void RDCFile::Open(const bytebuf &buffer)
 
   StreamReader reader(m_Buffer);
 
-  Init(reader);
+  Init(reader, false);
 }
 
-void RDCFile::Init(StreamReader &reader)
+void RDCFile::OpenHeader(const char *path)
+{
+  if(path == NULL || path[0] == 0)
+  {
+    RETURNERROR(ContainerError::FileNotFound, "Invalid file path specified");
+  }
+
+  m_File = FileIO::fopen(path, "rb");
+  m_Filename = path;
+
+  if(!m_File)
+  {
+    RETURNERROR(ContainerError::FileNotFound, "Can't open capture file '%s' for read - errno %d",
+                path, errno);
+  }
+
+  FileIO::fseek64(m_File, 0, SEEK_END);
+  uint64_t fileSize = FileIO::ftell64(m_File);
+  FileIO::fseek64(m_File, 0, SEEK_SET);
+
+  StreamReader reader(m_File, fileSize, Ownership::Nothing);
+
+  Init(reader, true);
+}
+
+void RDCFile::Init(StreamReader &reader, bool headerOnly)
 {
   RDCDEBUG("Opened capture file for read");
 
@@ -585,7 +615,19 @@ void RDCFile::Init(StreamReader &reader)
     RETURNERROR(ContainerError::Corrupt, "Capture file doesn't have a frame capture");
   }
 
-  int index = SectionIndex(SectionType::ExtendedThumbnail);
+  // load the dictionary first, since other sections may need it to be read
+  int index = SectionIndex(SectionType::ZstdDictionary);
+  if(index >= 0)
+  {
+    StreamReader *dictReader = ReadSection(index);
+    m_ZstdDictionary.resize((size_t)dictReader->GetSize());
+    dictReader->Read(m_ZstdDictionary.data(), m_ZstdDictionary.size());
+    if(dictReader->IsErrored())
+      m_ZstdDictionary.clear();
+    delete dictReader;
+  }
+
+  index = SectionIndex(SectionType::ExtendedThumbnail);
   if(index >= 0)
   {
     StreamReader *thumbReader = ReadSection(index);
@@ -614,6 +656,38 @@ void RDCFile::Init(StreamReader &reader)
       delete thumbReader;
     }
   }
+
+  // the section table is only walked by seeking past each section's data, so reading it for the
+  // extended thumbnail is cheap. None of the other sections are loaded
+  if(headerOnly)
+    return;
+
+  index = SectionIndex(SectionType::CallstackTable);
+  if(index >= 0)
+  {
+    StreamReader *callstackReader = ReadSection(index);
+    if(callstackReader)
+    {
+      m_Callstacks = new CallstackTable();
+      if(!m_Callstacks->Read(callstackReader))
+        SAFE_DELETE(m_Callstacks);
+      delete callstackReader;
+    }
+  }
+
+  index = SectionIndex(SectionType::BlobStore);
+  if(index >= 0)
+  {
+    m_Blobs = new BlobStore();
+    if(!m_Blobs->Read(this, index))
+      SAFE_DELETE(m_Blobs);
+  }
+}
+
+void RDCFile::EnableBlobStore()
+{
+  if(m_Blobs == NULL)
+    m_Blobs = new BlobStore();
 }
 
 bool RDCFile::CopyFileTo(const char *filename)
@@ -815,7 +889,22 @@ StreamReader *RDCFile::ReadSection(int index) const
   }
   else if(props.flags & SectionFlags::ZstdCompressed)
   {
-    compReader = new StreamReader(new ZSTDDecompressor(fileReader, Ownership::Stream),
+    const bytebuf *dictionary = NULL;
+
+    if(props.flags & SectionFlags::ZstdDictionary)
+    {
+      if(m_ZstdDictionary.empty())
+      {
+        RDCERR("Section %d (%s) needs a zstd dictionary but the capture doesn't contain one.",
+               index, props.name.c_str());
+        delete fileReader;
+        return new StreamReader(StreamReader::InvalidStream);
+      }
+
+      dictionary = &m_ZstdDictionary;
+    }
+
+    compReader = new StreamReader(new ZSTDDecompressor(fileReader, Ownership::Stream, dictionary),
                                   props.uncompressedSize, Ownership::Stream);
   }
 
@@ -823,11 +912,68 @@ StreamReader *RDCFile::ReadSection(int index) const
   return compReader ? compReader : fileReader;
 }
 
-StreamWriter *RDCFile::WriteSection(const SectionProperties &props)
+bool RDCFile::ReadSectionRange(int index, uint64_t offset, uint64_t length, bytebuf &out) const
+{
+  if(m_Error != ContainerError::NoError || index < 0 || index >= NumSections())
+    return false;
+
+  const SectionProperties &props = m_Sections[index];
+
+  if(offset + length > props.uncompressedSize)
+  {
+    RDCERR("Range %llu-%llu is out of bounds in section %d (%s) of %llu bytes", offset,
+           offset + length, index, props.name.c_str(), props.uncompressedSize);
+    return false;
+  }
+
+  out.resize((size_t)length);
+
+  if(m_File == NULL)
+  {
+    if(index >= (int)m_MemorySections.size())
+      return false;
+
+    memcpy(out.data(), m_MemorySections[index].data() + offset, (size_t)length);
+    return true;
+  }
+
+  if(props.flags & (SectionFlags::LZ4Compressed | SectionFlags::ZstdCompressed))
+  {
+    // compressed sections have to be decompressed from the start
+    StreamReader *reader = ReadSection(index);
+    reader->SkipBytes(offset);
+    reader->Read(out.data(), length);
+    bool success = !reader->IsErrored();
+    delete reader;
+    return success;
+  }
+
+  // other readers such as the frame capture may be mid-way through the file, so restore the
+  // position afterwards
+  uint64_t prevPos = FileIO::ftell64(m_File);
+
+  FileIO::fseek64(m_File, m_SectionLocations[index].dataOffset + offset, SEEK_SET);
+  size_t numRead = FileIO::fread(out.data(), 1, (size_t)length, m_File);
+
+  FileIO::fseek64(m_File, prevPos, SEEK_SET);
+
+  return numRead == (size_t)length;
+}
+
+StreamWriter *RDCFile::WriteSection(const SectionProperties &sectionProps)
 {
   if(m_Error != ContainerError::NoError)
     return new StreamWriter(StreamWriter::InvalidStream);
 
+  SectionProperties props = sectionProps;
+
+  // a dictionary only applies to zstd compression, and we can only use one if we have it and zstd
+  // can load it. Otherwise the section is compressed without one, so mustn't be flagged as using it
+  if((props.flags & SectionFlags::ZstdDictionary) &&
+     (!(props.flags & SectionFlags::ZstdCompressed) ||
+      !ZSTDCompressor::CanUseDictionary(m_ZstdDictionary, m_ZstdLevel)))
+    props.flags &= ~SectionFlags::ZstdDictionary;
+
   RDCASSERT((size_t)props.type < (size_t)SectionType::Count);
 
   if(m_File == NULL)
@@ -1138,8 +1284,12 @@ StreamWriter *RDCFile::WriteSection(const SectionProperties &props)
   }
   else if(props.flags & SectionFlags::ZstdCompressed)
   {
-    compWriter =
-        new StreamWriter(new ZSTDCompressor(fileWriter, Ownership::Stream), Ownership::Stream);
+    const bytebuf *dictionary =
+        (props.flags & SectionFlags::ZstdDictionary) ? &m_ZstdDictionary : NULL;
+
+    compWriter = new StreamWriter(new ZSTDCompressor(fileWriter, Ownership::Stream, m_ZstdLevel,
+                                                     m_ZstdThreads, dictionary),
+                                  Ownership::Stream);
   }
 
   uint64_t dataOffset = FileIO::ftell64(m_File);
@@ -27,6 +27,9 @@
 #include "core/core.h"
 #include "streamio.h"
 
+class BlobStore;
+class CallstackTable;
+
 enum class ContainerError
 {
   NoError = 0,
@@ -74,6 +77,11 @@ public:
   void Open(const char *filename);
   void Open(const bytebuf &buffer);
 
+  // opens an existing file and reads only the file header - the driver, machine ident and
+  // thumbnail, including any extended thumbnail section. The section table is read but no other
+  // section contents are loaded, it's intended for quickly fetching thumbnails from many files.
+  void OpenHeader(const char *filename);
+
   bool CopyFileTo(const char *filename);
 
   // Sets the parameters of an RDCFile in memory.
@@ -94,14 +102,41 @@ public:
   int NumSections() const { return int(m_Sections.size()); }
   const SectionProperties &GetSectionProperties(int index) const { return m_Sections[index]; }
   StreamReader *ReadSection(int index) const;
+  // reads length bytes starting at offset within a section's uncompressed data. For uncompressed
+  // sections in a file this reads only the requested range, without disturbing other readers.
+  bool ReadSectionRange(int index, uint64_t offset, uint64_t length, bytebuf &out) const;
   StreamWriter *WriteSection(const SectionProperties &props);
 
+  // sets the compression level and number of threads used for zstd compressed sections written
+  // after this call. A level of 0 uses the default level.
+  void SetZstdCompression(int level, uint32_t numThreads)
+  {
+    m_ZstdLevel = level;
+    m_ZstdThreads = numThreads;
+  }
+
+  // sets the dictionary used for sections written with SectionFlags::ZstdDictionary. Readers need
+  // the same dictionary, so it must also be written to the SectionType::ZstdDictionary section.
+  void SetZstdDictionary(const bytebuf &dictionary) { m_ZstdDictionary = dictionary; }
+  const bytebuf &GetZstdDictionary() const { return m_ZstdDictionary; }
+
+  // the callstacks referenced by chunks in the frame capture, or NULL if there is no table
+  CallstackTable *GetCallstackTable() const { return m_Callstacks; }
+
+  // when writing, creates a blob store for large buffers to be deduplicated into while capturing.
+  // Without this, everything is written inline in the frame capture as before.
+  void EnableBlobStore();
+
+  // the deduplicated blobs referenced by chunks in the frame capture. When writing this is NULL
+  // unless EnableBlobStore() was called, when reading it's NULL if there are no blobs.
+  BlobStore *GetBlobStore() const { return m_Blobs; }
+
   // Only valid if GetDriver returns RDCDriver::Image, passes over the underlying FILE * for use
   // loading the image directly, since the RDC container isn't there to read from a section.
   FILE *StealImageFileHandle(rdcstr &filename);
 
 private:
-  void Init(StreamReader &reader);
+  void Init(StreamReader &reader, bool headerOnly);
 
   FILE *m_File = NULL;
   rdcstr m_Filename;
@@ -115,6 +150,12 @@ private:
   rdcstr m_DriverName;
   uint64_t m_MachineIdent = 0;
   RDCThumb m_Thumb;
+  CallstackTable *m_Callstacks = NULL;
+  BlobStore *m_Blobs = NULL;
+
+  int m_ZstdLevel = 0;
+  uint32_t m_ZstdThreads = 1;
+  bytebuf m_ZstdDictionary;
 
   ContainerError m_Error = ContainerError::NoError;
   rdcstr m_ErrorString;
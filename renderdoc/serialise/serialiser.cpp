@@ -27,6 +27,8 @@
 
 #include "serialiser.h"
 #include "core/core.h"
+#include "blob_store.h"
+#include "callstack_table.h"
 #include "strings/string_utils.h"
 
 #if ENABLED(RDOC_DEVEL)
@@ -147,6 +149,18 @@ uint32_t Serialiser<SerialiserMode::Reading>::BeginChunk(uint32_t, uint64_t)
         m_Read->Read(NULL, numFrames * sizeof(uint64_t));
       }
     }
+    else if(c & ChunkCallstackIndex)
+    {
+      uint32_t callstackIndex = 0;
+      m_Read->Read(callstackIndex);
+
+      m_ChunkMetadata.flags |= SDChunkFlags::HasCallstack;
+
+      // without a table (e.g. re-reading chunks to replay) the callstack is left empty
+      if(m_Callstacks && callstackIndex != CallstackTable::EmptyStack &&
+         !m_Callstacks->Get(callstackIndex, m_ChunkMetadata.callstack))
+        RDCERR("Read invalid callstack index: %u", callstackIndex);
+    }
 
     if(c & ChunkThreadID)
       m_Read->Read(m_ChunkMetadata.threadID);
@@ -349,31 +363,48 @@ uint32_t Serialiser<SerialiserMode::Writing>::BeginChunk(uint32_t chunkID, uint6
 
       m_ChunkMetadata.chunkID = chunkID;
 
-      /////////////////
+      uint32_t callstackIndex = CallstackTable::EmptyStack;
 
-      m_Write->Write(c);
-
-      if(c & ChunkCallstack)
+      // callstacks we collect ourselves during a frame capture go into the global table and the
+      // chunk only references them. Some of those chunks end up in resource records and are
+      // written again in later captures, so the table is never cleared and every capture writes
+      // all of it. Chunks written outside of a capture store their callstack inline so idle
+      // frames don't grow the table, as do chunks whose metadata already has a callstack (e.g.
+      // when writing out structured data).
+      if((c & ChunkCallstack) && m_ChunkMetadata.callstack.empty())
       {
-        if(m_ChunkMetadata.callstack.empty())
-        {
-          bool collect = RenderDoc::Inst().GetCaptureOptions().captureCallstacks;
+        const CaptureOptions &opts = RenderDoc::Inst().GetCaptureOptions();
 
-          if(RenderDoc::Inst().GetCaptureOptions().captureCallstacksOnlyDraws)
-            collect = collect && m_DrawChunk;
+        bool collect = opts.captureCallstacks;
+        bool useTable = RenderDoc::Inst().IsFrameCapturing();
 
-          if(collect)
-          {
-            Callstack::Stackwalk *stack = Callstack::Collect();
-            if(stack && stack->NumLevels() > 0)
-            {
-              m_ChunkMetadata.callstack.assign(stack->GetAddrs(), stack->NumLevels());
-            }
+        if(opts.captureCallstacksOnlyDraws)
+          collect = collect && m_DrawChunk;
 
-            SAFE_DELETE(stack);
+        if(collect)
+        {
+          Callstack::Stackwalk *stack = Callstack::Collect(opts.captureCallstacksFastUnwind);
+          if(stack && stack->NumLevels() > 0)
+          {
+            m_ChunkMetadata.callstack.assign(stack->GetAddrs(), stack->NumLevels());
+            if(useTable)
+              callstackIndex = RenderDoc::Inst().GetCallstackTable().Add(stack->GetAddrs(),
+                                                                         stack->NumLevels());
           }
+
+          SAFE_DELETE(stack);
         }
 
+        if(useTable)
+          c = (c & ~ChunkCallstack) | ChunkCallstackIndex;
+      }
+
+      /////////////////
+
+      m_Write->Write(c);
+
+      if(c & ChunkCallstack)
+      {
         m_ChunkMetadata.flags |= SDChunkFlags::HasCallstack;
 
         uint32_t numFrames = (uint32_t)m_ChunkMetadata.callstack.size();
@@ -381,6 +412,12 @@ uint32_t Serialiser<SerialiserMode::Writing>::BeginChunk(uint32_t chunkID, uint6
 
         m_Write->Write(m_ChunkMetadata.callstack.data(), m_ChunkMetadata.callstack.byteSize());
       }
+      else if(c & ChunkCallstackIndex)
+      {
+        m_ChunkMetadata.flags |= SDChunkFlags::HasCallstack;
+
+        m_Write->Write(callstackIndex);
+      }
 
       if(c & ChunkThreadID)
       {
@@ -621,6 +658,58 @@ void Serialiser<SerialiserMode::Writing>::WriteStructuredFile(const SDFile &file
   scratchWriter.m_StructuredFile = &scratchWriter.m_StructData;
 }
 
+/////////////////////////////////////////////////////////////
+// Blob store functions
+
+template <SerialiserMode sertype>
+bool Serialiser<sertype>::AddBlob(const byte *el, uint64_t byteSize, uint64_t *hash)
+{
+  if(m_Blobs == NULL || el == NULL || byteSize < BlobStore::MinimumSize)
+    return false;
+
+  BlobHash blobHash = m_Blobs->Add(el, byteSize);
+  hash[0] = blobHash.a;
+  hash[1] = blobHash.b;
+  return true;
+}
+
+template <SerialiserMode sertype>
+bool Serialiser<sertype>::HasBlob(const uint64_t *hash, uint64_t byteSize)
+{
+  return m_Blobs && m_Blobs->Contains({hash[0], hash[1]}, byteSize);
+}
+
+template <SerialiserMode sertype>
+void Serialiser<sertype>::FetchBlob(const uint64_t *hash, byte *el, uint64_t byteSize)
+{
+  if(el == NULL || byteSize == 0)
+    return;
+
+  if(m_Blobs == NULL)
+  {
+    RDCERR("Buffer references a blob of %llu bytes, but there is no blob store", byteSize);
+    memset(el, 0, (size_t)byteSize);
+    return;
+  }
+
+  if(!m_Blobs->Get({hash[0], hash[1]}, el, byteSize))
+  {
+    RDCERR("Couldn't fetch blob %016llx%016llx of %llu bytes", hash[0], hash[1], byteSize);
+    memset(el, 0, (size_t)byteSize);
+  }
+}
+
+template bool Serialiser<SerialiserMode::Writing>::AddBlob(const byte *el, uint64_t byteSize,
+                                                           uint64_t *hash);
+template bool Serialiser<SerialiserMode::Reading>::AddBlob(const byte *el, uint64_t byteSize,
+                                                           uint64_t *hash);
+template bool Serialiser<SerialiserMode::Writing>::HasBlob(const uint64_t *hash, uint64_t byteSize);
+template bool Serialiser<SerialiserMode::Reading>::HasBlob(const uint64_t *hash, uint64_t byteSize);
+template void Serialiser<SerialiserMode::Writing>::FetchBlob(const uint64_t *hash, byte *el,
+                                                             uint64_t byteSize);
+template void Serialiser<SerialiserMode::Reading>::FetchBlob(const uint64_t *hash, byte *el,
+                                                             uint64_t byteSize);
+
 template <>
 rdcstr DoStringise(const SDBasic &el)
 {
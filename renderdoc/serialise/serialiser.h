@@ -29,6 +29,9 @@
 #include "common/formatting.h"
 #include "streamio.h"
 
+class BlobStore;
+class CallstackTable;
+
 // function to deallocate anything from a serialise. Default impl
 // does no deallocation of anything.
 template <class T>
@@ -55,6 +58,8 @@ enum class SerialiserFlags
 {
   NoFlags = 0x0,
   AllocateMemory = 0x1,
+  // large buffers may be stored once in the blob store and referenced by hash, if there is one
+  Deduplicate = 0x2,
 };
 
 BITMASK_OPERATORS(SerialiserFlags);
@@ -105,6 +110,7 @@ public:
     ChunkDuration = 0x00040000,
     ChunkTimestamp = 0x00080000,
     Chunk64BitSize = 0x00100000,
+    ChunkCallstackIndex = 0x00200000,
   };
 
   //////////////////////////////////////////
@@ -134,6 +140,14 @@ public:
   void *GetUserData() { return m_pUserData; }
   void SetUserData(void *userData) { m_pUserData = userData; }
   void SetStringDatabase(std::set<rdcstr> *db) { m_ExtStringDB = db; }
+  // when reading, the table that chunks with a ChunkCallstackIndex reference their callstack from
+  void SetCallstackTable(CallstackTable *table) { m_Callstacks = table; }
+  // the store that buffers serialised with SerialiserFlags::Deduplicate are written to or read from
+  void SetBlobStore(BlobStore *blobs) { m_Blobs = blobs; }
+  BlobStore *GetBlobStore() const { return m_Blobs; }
+  // when reading, whether buffer sizes may be references into the blob store. This must only be
+  // enabled for capture versions that could have written references.
+  void SetBlobReferences(bool enabled) { m_BlobReferences = enabled; }
   // jumps to the byte after the current chunk, can be called any time after BeginChunk
   void SkipCurrentChunk();
 
@@ -246,15 +260,43 @@ public:
     if(IsWriting() && el == NULL)
       byteSize = 0;
 
+    // buffers stored in the blob store are written as their size with the top bit set, followed by
+    // the hash of their contents instead of the data itself.
+    uint64_t blobHash[2] = {};
+    bool blobRef = IsWriting() && (flags & SerialiserFlags::Deduplicate) &&
+                   AddBlob(el, byteSize, blobHash);
+
     {
       m_InternalElement = true;
-      DoSerialise(*this, byteSize);
+      if(blobRef)
+      {
+        uint64_t refSize = byteSize | BlobReferenceBit;
+        DoSerialise(*this, refSize);
+      }
+      else
+      {
+        DoSerialise(*this, byteSize);
+      }
+
+      if(IsReading() && m_BlobReferences && (byteSize & BlobReferenceBit))
+      {
+        blobRef = true;
+        byteSize &= ~BlobReferenceBit;
+      }
+
+      if(blobRef)
+      {
+        DoSerialise(*this, blobHash[0]);
+        DoSerialise(*this, blobHash[1]);
+      }
       m_InternalElement = false;
     }
 
     if(IsReading())
     {
-      VerifyArraySize(byteSize);
+      // the data for a blob isn't in the stream, so its size can only be verified by the store
+      if(!blobRef || !HasBlob(blobHash, byteSize))
+        VerifyArraySize(byteSize);
     }
 
     if(ExportStructure())
@@ -279,7 +321,11 @@ public:
     byte *tempAlloc = NULL;
 
     {
-      if(IsWriting())
+      if(blobRef && IsWriting())
+      {
+        // nothing to write, the data is in the blob store
+      }
+      else if(IsWriting())
       {
         // ensure byte alignment
         m_Write->AlignTo<ChunkAlignment>();
@@ -292,7 +338,8 @@ public:
       else if(IsReading())
       {
         // ensure byte alignment
-        m_Read->AlignTo<ChunkAlignment>();
+        if(!blobRef)
+          m_Read->AlignTo<ChunkAlignment>();
 
 // Coverity is unable to tie this allocation together with the automatic scoped deallocation in the
 // ScopedDeseralise* classes. We can verify with e.g. valgrind that there are no leaks, so to keep
@@ -318,7 +365,10 @@ public:
         }
 #endif
 
-        m_Read->Read(el, byteSize);
+        if(blobRef)
+          FetchBlob(blobHash, el, byteSize);
+        else
+          m_Read->Read(el, byteSize);
       }
     }
 
@@ -1320,6 +1370,20 @@ private:
   uint32_t m_ChunkFlags = 0;
   SDChunkMetaData m_ChunkMetadata;
 
+  CallstackTable *m_Callstacks = NULL;
+
+  static const uint64_t BlobReferenceBit = 1ULL << 63;
+
+  BlobStore *m_Blobs = NULL;
+  bool m_BlobReferences = false;
+
+  // when writing, stores the buffer in the blob store if it's large enough and returns its hash.
+  bool AddBlob(const byte *el, uint64_t byteSize, uint64_t *hash);
+  // when reading, checks the blob store contains the referenced blob with the expected size
+  bool HasBlob(const uint64_t *hash, uint64_t byteSize);
+  // when reading, fills el with the contents of the referenced blob
+  void FetchBlob(const uint64_t *hash, byte *el, uint64_t byteSize);
+
   // a database of strings read from the file, useful when serialised structures
   // expect a char* to return and point to static memory
   std::set<rdcstr> m_StringDB;
@@ -1703,6 +1767,15 @@ struct ScopedDeserialiseArray<SerialiserType, byte *>
       GET_SERIALISER, &obj, count);                                                               \
   GET_SERIALISER.Serialise(STRING_LITERAL(#obj), obj, count, SerialiserFlags::AllocateMemory)
 
+// as SERIALISE_ELEMENT_ARRAY, for large byte buffers that may be stored once in the blob store
+#define SERIALISE_ELEMENT_ARRAY_DEDUPLICATED(obj, count)                                          \
+  uint64_t CONCAT(dummy_array_count, __LINE__) = 0;                                               \
+  (void)CONCAT(dummy_array_count, __LINE__);                                                      \
+  ScopedDeserialiseArray<decltype(GET_SERIALISER), decltype(obj)> CONCAT(deserialise_, __LINE__)( \
+      GET_SERIALISER, &obj, count);                                                               \
+  GET_SERIALISER.Serialise(STRING_LITERAL(#obj), obj, count,                                      \
+                           SerialiserFlags::AllocateMemory | SerialiserFlags::Deduplicate)
+
 #define SERIALISE_ELEMENT_OPT(obj)                                           \
   ScopedDeserialiseNullable<decltype(GET_SERIALISER), decltype(obj)> CONCAT( \
       deserialise_, __LINE__)(GET_SERIALISER, &obj);                         \
@@ -23,6 +23,10 @@
  ******************************************************************************/
 
 #include "serialiser.h"
+#include "blob_store.h"
+#include "callstack_table.h"
+#include "core/core.h"
+#include "rdcfile.h"
 
 #if ENABLED(ENABLE_UNIT_TESTS)
 
@@ -562,6 +566,360 @@ TEST_CASE("Read/write chunk metadata", "[serialiser]")
   delete buf;
 };
 
+TEST_CASE("Read/write callstacks via callstack table", "[serialiser]")
+{
+  CallstackTable table;
+
+  // innermost frame first
+  uint64_t stackA[] = {0x1003, 0x1002, 0x1001};
+  uint64_t stackB[] = {0x2003, 0x1002, 0x1001};
+  uint64_t stackC[] = {0x1002, 0x1001};
+
+  uint32_t a = table.Add(stackA, ARRAY_COUNT(stackA));
+  uint32_t b = table.Add(stackB, ARRAY_COUNT(stackB));
+  uint32_t c = table.Add(stackC, ARRAY_COUNT(stackC));
+
+  SECTION("Stacks are de-duplicated")
+  {
+    CHECK(a != b);
+    CHECK(a != c);
+    CHECK(b != c);
+    CHECK(table.Add(stackA, ARRAY_COUNT(stackA)) == a);
+    CHECK(table.Add(NULL, 0) == CallstackTable::EmptyStack);
+
+    // the common outer frames are shared
+    CHECK(table.NumNodes() == 4);
+
+    rdcarray<uint64_t> addrs;
+    CHECK(table.Get(b, addrs));
+    CHECK(addrs == rdcarray<uint64_t>({0x2003, 0x1002, 0x1001}));
+
+    CHECK(table.Get(CallstackTable::EmptyStack, addrs));
+    CHECK(addrs.empty());
+
+    CHECK_FALSE(table.Get(100, addrs));
+  };
+
+  SECTION("Table and chunk references round-trip")
+  {
+    StreamWriter *buf = new StreamWriter(StreamWriter::DefaultScratchSize);
+
+    table.Write(buf);
+
+    // a chunk header referencing a callstack, with no contents
+    buf->Write(uint32_t(1 | WriteSerialiser::ChunkCallstackIndex));
+    buf->Write(c);
+    buf->Write(uint32_t(0));
+    // chunks are padded to the serialiser's chunk alignment
+    buf->AlignTo<64>();
+
+    StreamReader *reader = new StreamReader(buf->GetData(), buf->GetOffset());
+
+    CallstackTable readTable;
+    REQUIRE(readTable.Read(reader));
+    CHECK(readTable.NumNodes() == table.NumNodes());
+
+    ReadSerialiser ser(reader, Ownership::Stream);
+    ser.SetCallstackTable(&readTable);
+
+    ser.ReadChunk<uint32_t>();
+
+    bool hasCallstack = bool(ser.ChunkMetadata().flags & SDChunkFlags::HasCallstack);
+    CHECK(hasCallstack);
+    CHECK(ser.ChunkMetadata().callstack == rdcarray<uint64_t>({0x1002, 0x1001}));
+
+    ser.EndChunk();
+
+    REQUIRE_FALSE(ser.IsErrored());
+
+    delete buf;
+  };
+
+  SECTION("Frame chunks resolve through the capture's table")
+  {
+    rdcstr path = FileIO::GetTempFolderFilename() + "/renderdoc_callstack_table_test.rdc";
+
+    {
+      RDCFile rdc;
+      rdc.SetData(RDCDriver::Vulkan, "Vulkan", 0, NULL);
+      rdc.Create(path.c_str());
+
+      SectionProperties props;
+      props.type = SectionType::FrameCapture;
+
+      StreamWriter *w = rdc.WriteSection(props);
+      w->Write(uint32_t(1 | WriteSerialiser::ChunkCallstackIndex));
+      w->Write(b);
+      w->Write(uint32_t(0));
+      w->AlignTo<64>();
+      w->Finish();
+      delete w;
+
+      props.type = SectionType::CallstackTable;
+
+      w = rdc.WriteSection(props);
+      table.Write(w);
+      w->Finish();
+      delete w;
+    }
+
+    {
+      RDCFile rdc;
+      rdc.Open(path.c_str());
+
+      REQUIRE(bool(rdc.ErrorCode() == ContainerError::NoError));
+      REQUIRE(rdc.GetCallstackTable());
+
+      ReadSerialiser ser(rdc.ReadSection(rdc.SectionIndex(SectionType::FrameCapture)),
+                         Ownership::Stream);
+      ser.SetCallstackTable(rdc.GetCallstackTable());
+
+      ser.ReadChunk<uint32_t>();
+
+      CHECK(ser.ChunkMetadata().callstack == rdcarray<uint64_t>({0x2003, 0x1002, 0x1001}));
+
+      ser.EndChunk();
+
+      REQUIRE_FALSE(ser.IsErrored());
+    }
+
+    FileIO::Delete(path.c_str());
+  };
+};
+
+struct TestFrameCapturer : public IFrameCapturer
+{
+  RDCDriver GetFrameCaptureDriver() { return RDCDriver::Vulkan; }
+  void StartFrameCapture(void *dev, void *wnd) {}
+  bool EndFrameCapture(void *dev, void *wnd)
+  {
+    RenderDoc::Inst().FinishCaptureWriting(NULL, 0);
+    return true;
+  }
+  bool DiscardFrameCapture(void *dev, void *wnd) { return EndFrameCapture(dev, wnd); }
+};
+
+TEST_CASE("Callstacks recorded in one capture resolve in a later one", "[serialiser]")
+{
+  TestFrameCapturer capturer;
+  void *dev = &capturer;
+
+  CaptureOptions prevOpts = RenderDoc::Inst().GetCaptureOptions();
+  CaptureOptions opts = prevOpts;
+  opts.captureCallstacks = true;
+  opts.captureCallstacksOnlyDraws = false;
+  RenderDoc::Inst().SetCaptureOptions(opts);
+
+  RenderDoc::Inst().AddDeviceFrameCapturer(dev, &capturer);
+
+  // a chunk recorded during the first capture, e.g. a resource creation that's kept in its record
+  // and written again in every later capture
+  StreamWriter *record = new StreamWriter(StreamWriter::DefaultScratchSize);
+  rdcarray<uint64_t> callstack;
+
+  RenderDoc::Inst().StartFrameCapture(dev, NULL);
+  REQUIRE(RenderDoc::Inst().IsFrameCapturing());
+  {
+    WriteSerialiser ser(record, Ownership::Nothing);
+    ser.SetChunkMetadataRecording(WriteSerialiser::ChunkCallstack);
+
+    ser.WriteChunk(1);
+    callstack = ser.ChunkMetadata().callstack;
+    ser.EndChunk();
+
+    REQUIRE_FALSE(ser.IsErrored());
+  }
+  RenderDoc::Inst().EndFrameCapture(dev, NULL);
+
+  // the second capture writes out the table along with the recorded chunk
+  StreamWriter *table = new StreamWriter(StreamWriter::DefaultScratchSize);
+
+  RenderDoc::Inst().StartFrameCapture(dev, NULL);
+  RenderDoc::Inst().GetCallstackTable().Write(table);
+  RenderDoc::Inst().EndFrameCapture(dev, NULL);
+
+  RenderDoc::Inst().RemoveDeviceFrameCapturer(dev);
+  RenderDoc::Inst().SetCaptureOptions(prevOpts);
+
+  REQUIRE_FALSE(callstack.empty());
+
+  {
+    StreamReader tableReader(table->GetData(), table->GetOffset());
+
+    CallstackTable readTable;
+    REQUIRE(readTable.Read(&tableReader));
+
+    ReadSerialiser ser(new StreamReader(record->GetData(), record->GetOffset()),
+                       Ownership::Stream);
+    ser.SetCallstackTable(&readTable);
+
+    ser.ReadChunk<uint32_t>();
+
+    CHECK(ser.ChunkMetadata().callstack == callstack);
+
+    ser.EndChunk();
+
+    REQUIRE_FALSE(ser.IsErrored());
+  }
+
+  delete table;
+  delete record;
+};
+
+TEST_CASE("Read/write deduplicated buffers via blob store", "[serialiser]")
+{
+  bytebuf large, other, small;
+  for(int i = 0; i < 5000; i++)
+  {
+    large.push_back(byte(i * 13));
+    other.push_back(byte(i * 7));
+  }
+  small.resize(16);
+
+  rdcstr path = FileIO::GetTempFolderFilename() + "/renderdoc_blob_store_test.rdc";
+
+  {
+    RDCFile rdc;
+    rdc.SetData(RDCDriver::Vulkan, "Vulkan", 0, NULL);
+    rdc.Create(path.c_str());
+
+    // deduplication is opt-in
+    CHECK(rdc.GetBlobStore() == NULL);
+
+    rdc.EnableBlobStore();
+
+    REQUIRE(rdc.GetBlobStore());
+
+    SectionProperties props;
+    props.type = SectionType::FrameCapture;
+    props.flags = SectionFlags::LZ4Compressed;
+
+    {
+      WriteSerialiser ser(rdc.WriteSection(props), Ownership::Stream);
+      ser.SetBlobStore(rdc.GetBlobStore());
+
+      {
+        // file streams can't be seeked to fix up the length, so use an upper bound
+        SCOPED_SERIALISE_CHUNK(1, 16 * 1024);
+
+        byte *first = large.data(), *second = large.data(), *third = other.data();
+        byte *fourth = small.data(), *fifth = large.data();
+        uint32_t marker = 0xf00dcafe;
+
+        ser.Serialise("first"_lit, first, large.size(), SerialiserFlags::Deduplicate);
+        ser.Serialise("second"_lit, second, large.size(), SerialiserFlags::Deduplicate);
+        ser.Serialise("third"_lit, third, other.size(), SerialiserFlags::Deduplicate);
+        ser.Serialise("fourth"_lit, fourth, small.size(), SerialiserFlags::Deduplicate);
+        // without the flag it's always written inline
+        ser.Serialise("fifth"_lit, fifth, large.size());
+        SERIALISE_ELEMENT(marker);
+      }
+
+      ser.GetWriter()->Finish();
+    }
+
+    // the two large buffers are stored once, the small buffer is inline
+    CHECK(rdc.GetBlobStore()->NumBlobs() == 2);
+    CHECK(rdc.GetBlobStore()->DeduplicatedBytes() == large.size());
+
+    props.type = SectionType::BlobStore;
+    props.flags = SectionFlags::NoFlags;
+
+    StreamWriter *w = rdc.WriteSection(props);
+    rdc.GetBlobStore()->Write(w);
+    w->Finish();
+    delete w;
+  }
+
+  {
+    RDCFile rdc;
+    rdc.Open(path.c_str());
+
+    REQUIRE(bool(rdc.ErrorCode() == ContainerError::NoError));
+    REQUIRE(rdc.GetBlobStore());
+
+    ReadSerialiser ser(rdc.ReadSection(rdc.SectionIndex(SectionType::FrameCapture)),
+                       Ownership::Stream);
+
+    SECTION("Buffers are read from the blob store")
+    {
+      ser.SetBlobStore(rdc.GetBlobStore());
+      ser.SetBlobReferences(true);
+
+      ser.ReadChunk<uint32_t>();
+
+      byte *first = NULL, *second = NULL, *third = NULL, *fourth = NULL, *fifth = NULL;
+      uint32_t marker = 0;
+
+      // the sizes are read from the stream, these are only used on writing
+      ser.Serialise("first"_lit, first, 0, SerialiserFlags::AllocateMemory);
+      ser.Serialise("second"_lit, second, 0, SerialiserFlags::AllocateMemory);
+      ser.Serialise("third"_lit, third, 0, SerialiserFlags::AllocateMemory);
+      ser.Serialise("fourth"_lit, fourth, 0, SerialiserFlags::AllocateMemory);
+      ser.Serialise("fifth"_lit, fifth, 0, SerialiserFlags::AllocateMemory);
+      SERIALISE_ELEMENT(marker);
+
+      ser.EndChunk();
+
+      REQUIRE_FALSE(ser.IsErrored());
+
+      CHECK(bytebuf(first, large.size()) == large);
+      CHECK(bytebuf(second, large.size()) == large);
+      CHECK(bytebuf(third, other.size()) == other);
+      CHECK(bytebuf(fourth, small.size()) == small);
+      CHECK(bytebuf(fifth, large.size()) == large);
+      CHECK(marker == 0xf00dcafe);
+
+      FreeAlignedBuffer(first);
+      FreeAlignedBuffer(second);
+      FreeAlignedBuffer(third);
+      FreeAlignedBuffer(fourth);
+      FreeAlignedBuffer(fifth);
+    };
+
+    SECTION("Missing blob store")
+    {
+      ser.SetBlobReferences(true);
+
+      ser.ReadChunk<uint32_t>();
+
+      byte *first = NULL;
+
+      ser.Serialise("first"_lit, first, 0, SerialiserFlags::AllocateMemory);
+
+      REQUIRE_FALSE(ser.IsErrored());
+
+      // the size is still known but the data can't be fetched
+      bytebuf zeroes;
+      zeroes.resize(large.size());
+      CHECK(bytebuf(first, large.size()) == zeroes);
+
+      FreeAlignedBuffer(first);
+
+      ser.SkipCurrentChunk();
+    };
+
+    SECTION("References are only read when enabled for the capture version")
+    {
+      ser.SetBlobStore(rdc.GetBlobStore());
+
+      ser.ReadChunk<uint32_t>();
+
+      byte *first = NULL;
+
+      // without references the flagged size is taken literally, and is far too large
+      ser.Serialise("first"_lit, first, 0, SerialiserFlags::AllocateMemory);
+
+      CHECK(ser.IsErrored());
+      CHECK(first == NULL);
+
+      FreeAlignedBuffer(first);
+    };
+  }
+
+  FileIO::Delete(path.c_str());
+};
+
 TEST_CASE("Verify multiple chunks can be merged", "[serialiser][chunks]")
 {
   StreamWriter *buf = new StreamWriter(StreamWriter::DefaultScratchSize);
@@ -24,26 +24,87 @@
 
 #define ZSTD_STATIC_LINKING_ONLY
 #include "zstdio.h"
+#include "common/threading.h"
 
 static const uint64_t zstdBlockSize = 128 * 1024;
 static const uint64_t compressBlockSize = ZSTD_compressBound(zstdBlockSize);
 
-ZSTDCompressor::ZSTDCompressor(StreamWriter *write, Ownership own) : Compressor(write, own)
+// when compressing on multiple threads, how many blocks each thread gets per batch. Batching
+// several blocks per thread amortises the cost of starting up the threads.
+static const uint32_t zstdPagesPerThread = 4;
+
+// the size of raw-content dictionaries we build, and the size of each sampled fragment. This is
+// around the size that zstd's own dictionary trainer defaults to.
+static const uint64_t zstdDictionarySize = 112 * 1024;
+static const uint64_t zstdDictionaryFragmentSize = 1024;
+
+static int GetCompressionLevel(int level)
 {
-  m_Page = AllocAlignedBuffer(zstdBlockSize);
-  m_CompressBuffer = AllocAlignedBuffer(compressBlockSize);
+  return level <= 0 ? ZSTDCompressor::DefaultLevel : RDCMIN(level, ZSTD_maxCLevel());
+}
+
+static ZSTD_CDict *CreateCompressionDictionary(const bytebuf &dictionary, int level)
+{
+  return ZSTD_createCDict_advanced(dictionary.data(), dictionary.size(), ZSTD_dlm_byCopy,
+                                   ZSTD_dct_rawContent,
+                                   ZSTD_getCParams(level, zstdBlockSize, dictionary.size()),
+                                   ZSTD_defaultCMem);
+}
+
+bool ZSTDCompressor::CanUseDictionary(const bytebuf &dictionary, int level)
+{
+  if(dictionary.empty())
+    return false;
+
+  ZSTD_CDict *dict = CreateCompressionDictionary(dictionary, GetCompressionLevel(level));
+  ZSTD_freeCDict(dict);
+  return dict != NULL;
+}
+
+ZSTDCompressor::ZSTDCompressor(StreamWriter *write, Ownership own, int level, uint32_t numThreads,
+                               const bytebuf *dictionary)
+    : Compressor(write, own)
+{
+  m_Level = GetCompressionLevel(level);
+
+  if(dictionary && !dictionary->empty())
+  {
+    m_Dict = CreateCompressionDictionary(*dictionary, m_Level);
+
+    if(!m_Dict)
+      RDCERR("Couldn't create zstd compression dictionary");
+  }
+
+  numThreads = RDCMAX(numThreads, 1U);
+  m_NumPages = numThreads > 1 ? numThreads * zstdPagesPerThread : 1;
+
+  m_Page = AllocAlignedBuffer(zstdBlockSize * m_NumPages);
+  m_CompressBuffer = AllocAlignedBuffer(compressBlockSize * m_NumPages);
 
   m_PageOffset = 0;
 
-  m_Stream = ZSTD_createCStream();
+  m_CompressedSizes.resize(m_NumPages);
+
+  m_Streams.resize(numThreads);
+  for(uint32_t i = 0; i < numThreads; i++)
+    m_Streams[i] = ZSTD_createCStream();
 }
 
 ZSTDCompressor::~ZSTDCompressor()
 {
-  ZSTD_freeCStream(m_Stream);
+  for(ZSTD_CStream *stream : m_Streams)
+    ZSTD_freeCStream(stream);
+
+  ZSTD_freeCDict(m_Dict);
+
+  FreeBuffers();
+}
 
+void ZSTDCompressor::FreeBuffers()
+{
   FreeAlignedBuffer(m_Page);
   FreeAlignedBuffer(m_CompressBuffer);
+  m_Page = m_CompressBuffer = NULL;
 }
 
 bool ZSTDCompressor::Write(const void *data, uint64_t numBytes)
@@ -57,9 +118,11 @@ bool ZSTDCompressor::Write(const void *data, uint64_t numBytes)
 
   // this is largely similar to LZ4Compressor, so check the comments there for more details.
   // The only difference is that the lz4 streaming compression assumes a history of 64kb, where
-  // here we use a larger block size but no history must be maintained.
+  // here we use a larger block size but no history must be maintained. We treat all of our pages
+  // as one contiguous page here, and split them into blocks when flushing.
+  const uint64_t pageSize = zstdBlockSize * m_NumPages;
 
-  if(m_PageOffset + numBytes <= zstdBlockSize)
+  if(m_PageOffset + numBytes <= pageSize)
   {
     // simplest path, no page wrapping/spanning at all
     memcpy(m_Page + m_PageOffset, data, (size_t)numBytes);
@@ -73,7 +136,7 @@ bool ZSTDCompressor::Write(const void *data, uint64_t numBytes)
 
     // copy whatever will fit on this page
     {
-      uint64_t firstBytes = zstdBlockSize - m_PageOffset;
+      uint64_t firstBytes = pageSize - m_PageOffset;
       memcpy(m_Page + m_PageOffset, src, (size_t)firstBytes);
 
       m_PageOffset += firstBytes;
@@ -92,7 +155,7 @@ bool ZSTDCompressor::Write(const void *data, uint64_t numBytes)
         return success;
 
       // how many bytes can we copy in this page?
-      uint64_t partialBytes = RDCMIN(zstdBlockSize, numBytes);
+      uint64_t partialBytes = RDCMIN(pageSize, numBytes);
       memcpy(m_Page, src, (size_t)partialBytes);
 
       // advance the source pointer, dest offset, and remove the bytes we read
@@ -108,7 +171,7 @@ bool ZSTDCompressor::Write(const void *data, uint64_t numBytes)
 bool ZSTDCompressor::Finish()
 {
   // This function just writes the current page and closes zstd. Since we assume all blocks are
-  // precisely 64kb in size
+  // precisely 128kb in size
   // only the last one can be smaller, so we only write a partial page when finishing.
   // Calling Write() after Finish() is illegal
 
@@ -121,21 +184,49 @@ bool ZSTDCompressor::FlushPage()
   if(!m_CompressBuffer)
     return false;
 
-  ZSTD_inBuffer in = {m_Page, (size_t)m_PageOffset, 0};
-  ZSTD_outBuffer out = {m_CompressBuffer, ZSTD_CStreamOutSize(), 0};
+  // always write at least one block, even if it's empty
+  uint32_t numBlocks = RDCMAX(1U, uint32_t((m_PageOffset + zstdBlockSize - 1) / zstdBlockSize));
 
-  bool success = true;
+  const uint32_t numThreads = (uint32_t)m_Streams.size();
+
+  int32_t errors = 0;
+
+  // each thread compresses every numThreads'th block with its own stream. The blocks are all the
+  // same size so this balances well enough.
+  Threading::ParallelFor(RDCMIN(numThreads, numBlocks), numThreads, [&](uint32_t thread) {
+    for(uint32_t b = thread; b < numBlocks; b += numThreads)
+    {
+      uint64_t offs = b * zstdBlockSize;
+
+      ZSTD_inBuffer in = {m_Page + offs, (size_t)RDCMIN(zstdBlockSize, m_PageOffset - offs), 0};
+      ZSTD_outBuffer out = {m_CompressBuffer + b * compressBlockSize, (size_t)compressBlockSize, 0};
 
-  success &= CompressZSTDFrame(in, out);
+      if(!CompressZSTDFrame(m_Streams[thread], in, out))
+      {
+        Atomic::Inc32(&errors);
+        return;
+      }
+
+      m_CompressedSizes[b] = (uint32_t)out.pos;
+    }
+  });
 
   // if there was an error, bail
-  if(!m_CompressBuffer)
+  if(errors > 0)
+  {
+    FreeBuffers();
     return false;
+  }
+
+  bool success = true;
 
-  // a bit redundant to write this but it means we can read the entire frame without
-  // doing multiple reads
-  success &= m_Write->Write((uint32_t)out.pos);
-  success &= m_Write->Write(m_CompressBuffer, out.pos);
+  for(uint32_t b = 0; b < numBlocks; b++)
+  {
+    // a bit redundant to write this but it means we can read the entire frame without
+    // doing multiple reads
+    success &= m_Write->Write(m_CompressedSizes[b]);
+    success &= m_Write->Write(m_CompressBuffer + b * compressBlockSize, m_CompressedSizes[b]);
+  }
 
   // start writing to the start of the page again
   m_PageOffset = 0;
@@ -143,16 +234,14 @@ bool ZSTDCompressor::FlushPage()
   return success;
 }
 
-bool ZSTDCompressor::CompressZSTDFrame(ZSTD_inBuffer &in, ZSTD_outBuffer &out)
+bool ZSTDCompressor::CompressZSTDFrame(ZSTD_CStream *stream, ZSTD_inBuffer &in, ZSTD_outBuffer &out)
 {
-  size_t err = ZSTD_initCStream(m_Stream, 7);
+  size_t err = m_Dict ? ZSTD_initCStream_usingCDict(stream, m_Dict)
+                      : ZSTD_initCStream(stream, m_Level);
 
   if(ZSTD_isError(err))
   {
     RDCERR("Error compressing: %s", ZSTD_getErrorName(err));
-    FreeAlignedBuffer(m_Page);
-    FreeAlignedBuffer(m_CompressBuffer);
-    m_Page = m_CompressBuffer = NULL;
     return false;
   }
 
@@ -162,7 +251,7 @@ bool ZSTDCompressor::CompressZSTDFrame(ZSTD_inBuffer &in, ZSTD_outBuffer &out)
     size_t inpos = in.pos;
     size_t outpos = out.pos;
 
-    err = ZSTD_compressStream(m_Stream, &out, &in);
+    err = ZSTD_compressStream(stream, &out, &in);
 
     if(ZSTD_isError(err) || (inpos == in.pos && outpos == out.pos))
     {
@@ -170,14 +259,11 @@ bool ZSTDCompressor::CompressZSTDFrame(ZSTD_inBuffer &in, ZSTD_outBuffer &out)
         RDCERR("Error compressing: %s", ZSTD_getErrorName(err));
       else
         RDCERR("Error compressing, no progress made");
-      FreeAlignedBuffer(m_Page);
-      FreeAlignedBuffer(m_CompressBuffer);
-      m_Page = m_CompressBuffer = NULL;
       return false;
     }
   }
 
-  err = ZSTD_endStream(m_Stream, &out);
+  err = ZSTD_endStream(stream, &out);
 
   if(ZSTD_isError(err) || err != 0)
   {
@@ -185,17 +271,24 @@ bool ZSTDCompressor::CompressZSTDFrame(ZSTD_inBuffer &in, ZSTD_outBuffer &out)
       RDCERR("Error compressing: %s", ZSTD_getErrorName(err));
     else
       RDCERR("Error compressing, couldn't end stream");
-    FreeAlignedBuffer(m_Page);
-    FreeAlignedBuffer(m_CompressBuffer);
-    m_Page = m_CompressBuffer = NULL;
     return false;
   }
 
   return true;
 }
 
-ZSTDDecompressor::ZSTDDecompressor(StreamReader *read, Ownership own) : Decompressor(read, own)
+ZSTDDecompressor::ZSTDDecompressor(StreamReader *read, Ownership own, const bytebuf *dictionary)
+    : Decompressor(read, own)
 {
+  if(dictionary && !dictionary->empty())
+  {
+    m_Dict = ZSTD_createDDict_advanced(dictionary->data(), dictionary->size(), ZSTD_dlm_byCopy,
+                                       ZSTD_dct_rawContent, ZSTD_defaultCMem);
+
+    if(!m_Dict)
+      RDCERR("Couldn't create zstd decompression dictionary");
+  }
+
   m_Page = AllocAlignedBuffer(zstdBlockSize);
   m_CompressBuffer = AllocAlignedBuffer(compressBlockSize);
 
@@ -208,6 +301,7 @@ ZSTDDecompressor::ZSTDDecompressor(StreamReader *read, Ownership own) : Decompre
 ZSTDDecompressor::~ZSTDDecompressor()
 {
   ZSTD_freeDStream(m_Stream);
+  ZSTD_freeDDict(m_Dict);
   FreeAlignedBuffer(m_Page);
   FreeAlignedBuffer(m_CompressBuffer);
 }
@@ -303,7 +397,8 @@ bool ZSTDDecompressor::FillPage()
     return false;
   }
 
-  size_t err = ZSTD_initDStream(m_Stream);
+  size_t err =
+      m_Dict ? ZSTD_initDStream_usingDDict(m_Stream, m_Dict) : ZSTD_initDStream(m_Stream);
 
   if(ZSTD_isError(err))
   {
@@ -343,3 +438,30 @@ bool ZSTDDecompressor::FillPage()
 
   return success;
 }
+
+bytebuf BuildZSTDDictionary(StreamReader &reader)
+{
+  bytebuf ret;
+
+  const uint64_t size = reader.GetSize();
+
+  // if the whole stream fits in a couple of blocks, a dictionary would only add overhead
+  if(size < zstdBlockSize * 4)
+    return ret;
+
+  const uint64_t numFragments = zstdDictionarySize / zstdDictionaryFragmentSize;
+  const uint64_t stride = size / numFragments;
+
+  ret.resize((size_t)zstdDictionarySize);
+
+  for(uint64_t i = 0; i < numFragments; i++)
+  {
+    reader.Read(ret.data() + i * zstdDictionaryFragmentSize, zstdDictionaryFragmentSize);
+    reader.SkipBytes(stride - zstdDictionaryFragmentSize);
+  }
+
+  if(reader.IsErrored())
+    ret.clear();
+
+  return ret;
+}
@@ -30,28 +30,50 @@
 class ZSTDCompressor : public Compressor
 {
 public:
-  ZSTDCompressor(StreamWriter *write, Ownership own);
+  static const int DefaultLevel = 7;
+
+  // each block is compressed as an independent frame, so with more than one thread several blocks
+  // are batched up and compressed in parallel. The output is identical regardless of thread count.
+  // A level of 0 or below uses the default level. If a dictionary is given, every block is
+  // compressed against it and must be decompressed with the same dictionary.
+  ZSTDCompressor(StreamWriter *write, Ownership own, int level = DefaultLevel,
+                 uint32_t numThreads = 1, const bytebuf *dictionary = NULL);
   ~ZSTDCompressor();
 
+  // returns whether zstd can create a compression dictionary from this data at the given level. If
+  // it can't, the compressor would fall back to compressing without the dictionary.
+  static bool CanUseDictionary(const bytebuf &dictionary, int level = DefaultLevel);
+
   bool Write(const void *data, uint64_t numBytes);
   bool Finish();
 
 private:
   bool FlushPage();
+  void FreeBuffers();
+
+  bool CompressZSTDFrame(ZSTD_CStream *stream, ZSTD_inBuffer &in, ZSTD_outBuffer &out);
 
-  bool CompressZSTDFrame(ZSTD_inBuffer &in, ZSTD_outBuffer &out);
+  int m_Level;
+  uint32_t m_NumPages;
 
+  // m_NumPages blocks back to back, and the corresponding compressed output for each
   byte *m_Page;
   byte *m_CompressBuffer;
   uint64_t m_PageOffset;
 
-  ZSTD_CStream *m_Stream;
+  rdcarray<uint32_t> m_CompressedSizes;
+
+  // one stream per thread
+  rdcarray<ZSTD_CStream *> m_Streams;
+
+  // shared between all streams, since it's read-only once created
+  ZSTD_CDict *m_Dict = NULL;
 };
 
 class ZSTDDecompressor : public Decompressor
 {
 public:
-  ZSTDDecompressor(StreamReader *read, Ownership own);
+  ZSTDDecompressor(StreamReader *read, Ownership own, const bytebuf *dictionary = NULL);
   ~ZSTDDecompressor();
 
   bool Recompress(Compressor *comp);
@@ -66,4 +88,11 @@ private:
   uint64_t m_PageLength;
 
   ZSTD_DStream *m_Stream;
+  ZSTD_DDict *m_Dict = NULL;
 };
+
+// builds a raw-content dictionary from fragments sampled evenly through the given stream. Blocks
+// are compressed independently, so structures that recur in every block (such as common chunk
+// types) can instead be referenced from the dictionary. Returns an empty buffer if the stream is
+// too small to benefit.
+bytebuf BuildZSTDDictionary(StreamReader &reader);
@@ -25,6 +25,7 @@
 
 #include "renderdoccmd.h"
 #include <app/renderdoc_app.h>
+#include <chrono>
 #include <replay/version.h>
 #include <string>
 
@@ -233,15 +234,20 @@ struct ThumbCommand : public Command
   ThumbCommand(const GlobalEnvironment &env) : Command(env) {}
   virtual void AddOptions(cmdline::parser &parser)
   {
-    parser.set_footer("<filename.rdc>");
-    parser.add<std::string>("out", 'o', "The output filename to save the file to", true,
-                            "filename.jpg");
+    parser.set_footer("<filename.rdc | directory>");
+    parser.add<std::string>("out", 'o',
+                            "The output filename to save the file to, or the output directory with "
+                            "--batch",
+                            true, "filename.jpg");
     parser.add<std::string>("format", 'f',
                             "The format of the output file. If empty, detected from filename",
                             false, "", cmdline::oneof<std::string>("jpg", "png", "bmp", "tga"));
     parser.add<uint32_t>(
         "max-size", 's',
         "The maximum dimension of the thumbnail. Default is 0, which is unlimited.", false, 0);
+    parser.add("batch", 'b',
+               "Extract the thumbnails of every capture in the given directory concurrently, "
+               "saving each next to the others in the output directory.");
   }
   virtual const char *Description() { return "Saves a capture's embedded thumbnail to disk."; }
   virtual bool IsInternalOnly() { return false; }
@@ -269,6 +275,8 @@ struct ThumbCommand : public Command
 
     uint32_t maxsize = parser.get<uint32_t>("max-size");
 
+    bool batch = parser.exist("batch");
+
     FileType type = FileType::JPG;
 
     if(format == "png")
@@ -283,7 +291,9 @@ struct ThumbCommand : public Command
     {
       type = FileType::BMP;
     }
-    else
+    // in batch mode the output is a directory, so there's no extension to guess from and we stay
+    // with the jpg default
+    else if(!batch)
     {
       const char *dot = strrchr(outfile.c_str(), '.');
 
@@ -300,6 +310,9 @@ struct ThumbCommand : public Command
                   << std::endl;
     }
 
+    if(batch)
+      return ExecuteBatch(filename, outfile, type, maxsize);
+
     bytebuf buf;
 
     ICaptureFile *file = RENDERDOC_OpenCaptureFile();
@@ -337,6 +350,67 @@ struct ThumbCommand : public Command
 
     return 0;
   }
+
+  int ExecuteBatch(const std::string &dir, const std::string &outdir, FileType type,
+                   uint32_t maxsize)
+  {
+    const char *ext = "jpg";
+    if(type == FileType::PNG)
+      ext = "png";
+    else if(type == FileType::TGA)
+      ext = "tga";
+    else if(type == FileType::BMP)
+      ext = "bmp";
+
+    rdcarray<rdcpair<rdcstr, Thumbnail>> thumbnails;
+    RENDERDOC_GetCaptureThumbnails(dir.c_str(), type, maxsize, &thumbnails);
+
+    if(thumbnails.empty())
+    {
+      std::cerr << "Couldn't find any captures in '" << dir << "'" << std::endl;
+      return 1;
+    }
+
+    size_t written = 0;
+
+    for(const rdcpair<rdcstr, Thumbnail> &thumb : thumbnails)
+    {
+      std::string capture = thumb.first.c_str();
+
+      if(thumb.second.data.empty())
+      {
+        std::cerr << "Couldn't fetch the thumbnail in '" << capture << "'" << std::endl;
+        continue;
+      }
+
+      // strip the directory and the .rdc extension to get the base name
+      std::string base = capture;
+      size_t slash = base.find_last_of("/\\");
+      if(slash != std::string::npos)
+        base = base.substr(slash + 1);
+      base = base.substr(0, base.size() - 4);
+
+      std::string outfile = outdir + "/" + base + "." + ext;
+
+      FILE *f = fopen(outfile.c_str(), "wb");
+
+      if(!f)
+      {
+        std::cerr << "Couldn't open destination file '" << outfile << "'" << std::endl;
+        continue;
+      }
+
+      fwrite(thumb.second.data.data(), 1, thumb.second.data.size(), f);
+      fclose(f);
+
+      written++;
+    }
+
+    std::cout << "Wrote " << written << " of " << thumbnails.size() << " thumbnails from '" << dir
+              << "' to '" << outdir << "'." << std::endl;
+
+    return 0;
+  }
 };
 
 struct CaptureCommand : public Command
@@ -640,6 +714,133 @@ struct ReplayCommand : public Command
   }
 };
 
+struct LoadProfileCommand : public Command
+{
+  LoadProfileCommand(const GlobalEnvironment &env) : Command(env) {}
+  virtual void AddOptions(cmdline::parser &parser)
+  {
+    parser.set_footer("<capture.rdc>");
+    parser.add("csv", 0, "Print the report as comma-separated values, for processing by scripts.");
+  }
+  virtual const char *Description()
+  {
+    return "Open a capture for replay without displaying it, and report where the load time went.";
+  }
+  virtual bool IsInternalOnly() { return false; }
+  virtual bool IsCaptureCommand() { return false; }
+  virtual int Execute(cmdline::parser &parser, const CaptureOptions &)
+  {
+    std::vector<std::string> rest = parser.rest();
+    if(rest.empty())
+    {
+      std::cerr << "Error: loadprofile command requires a filename to load." << std::endl
+                << std::endl
+                << parser.usage();
+      return 0;
+    }
+
+    std::string filename = rest[0];
+
+    rest.erase(rest.begin());
+
+    RENDERDOC_InitGlobalEnv(m_Env, convertArgs(rest));
+
+    bool csv = parser.exist("csv");
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    ICaptureFile *file = RENDERDOC_OpenCaptureFile();
+
+    if(file->OpenFile(filename.c_str(), "rdc", NULL) != ReplayStatus::Succeeded)
+    {
+      std::cerr << "Couldn't load '" << filename << "'." << std::endl;
+      file->Shutdown();
+      return 1;
+    }
+
+    LoadPhaseStatistics openPhase;
+    openPhase.name = "Open capture file";
+    openPhase.durationMS = std::chrono::duration<double, std::milli>(
+                               std::chrono::high_resolution_clock::now() - start)
+                               .count();
+
+    IReplayController *renderer = NULL;
+    ReplayStatus status = ReplayStatus::InternalError;
+    rdctie(status, renderer) = file->OpenCapture(ReplayOptions(), NULL);
+
+    file->Shutdown();
+
+    if(status != ReplayStatus::Succeeded)
+    {
+      std::cerr << "Couldn't load and replay '" << filename << "': " << ToStr(status) << std::endl;
+      return 1;
+    }
+
+    rdcarray<LoadPhaseStatistics> phases = renderer->GetLoadPhaseStatistics();
+    phases.insert(0, openPhase);
+
+    FrameDescription frameInfo = renderer->GetFrameInfo();
+    rdcarray<ChunkLoadStatistics> chunks = frameInfo.chunkLoadStatistics;
+
+    renderer->Shutdown();
+
+    // slowest chunk types first
+    std::sort(chunks.begin(), chunks.end(),
+              [](const ChunkLoadStatistics &a, const ChunkLoadStatistics &b) {
+                return a.durationMS > b.durationMS;
+              });
+
+    double totalMS = 0.0;
+    for(const LoadPhaseStatistics &phase : phases)
+      totalMS += phase.durationMS;
+
+    const double MB = 1024.0 * 1024.0;
+
+    if(csv)
+    {
+      printf("phase,name,time_ms,memory_bytes\n");
+      for(const LoadPhaseStatistics &phase : phases)
+        printf("phase,\"%s\",%.3f,%llu\n", phase.name.c_str(), phase.durationMS,
+               (unsigned long long)phase.memoryUsage);
+
+      printf("chunk,name,id,count,size_bytes,time_ms\n");
+      for(const ChunkLoadStatistics &chunk : chunks)
+        printf("chunk,\"%s\",%u,%u,%llu,%.3f\n", chunk.name.c_str(), chunk.chunkID, chunk.count,
+               (unsigned long long)chunk.byteSize, chunk.durationMS);
+
+      return 0;
+    }
+
+    printf("Loaded '%s' in %.3f ms\n", filename.c_str(), totalMS);
+    printf("Capture data: %.3f MB compressed, %.3f MB uncompressed, %.3f MB initial contents\n\n",
+           double(frameInfo.compressedFileSize) / MB, double(frameInfo.uncompressedFileSize) / MB,
+           double(frameInfo.initDataSize) / MB);
+
+    printf("%-40s %12s %8s %14s\n", "Phase", "Time (ms)", "Time %", "Memory (MB)");
+    for(const LoadPhaseStatistics &phase : phases)
+    {
+      printf("%-40s %12.3f %7.1f%%", phase.name.c_str(), phase.durationMS,
+             totalMS > 0.0 ? phase.durationMS * 100.0 / totalMS : 0.0);
+
+      if(phase.memoryUsage > 0)
+        printf(" %14.3f\n", double(phase.memoryUsage) / MB);
+      else
+        printf(" %14s\n", "-");
+    }
+
+    printf("\n%-40s %8s %12s %12s %12s\n", "Chunk", "Count", "Size (MB)", "Time (ms)",
+           "Avg (ms)");
+    for(const ChunkLoadStatistics &chunk : chunks)
+    {
+      printf("%-40s %8u %12.3f %12.3f %12.3f\n", chunk.name.c_str(), chunk.count,
+             double(chunk.byteSize) / MB, chunk.durationMS,
+             chunk.count > 0 ? chunk.durationMS / double(chunk.count) : 0.0);
+    }
+
+    return 0;
+  }
+};
+
 struct formats_reader
 {
   formats_reader(bool input)
@@ -808,6 +1009,149 @@ struct ConvertCommand : public Command
   }
 };
 
+struct RecompressCommand : public Command
+{
+  RecompressCommand(const GlobalEnvironment &env) : Command(env) {}
+  virtual void AddOptions(cmdline::parser &parser)
+  {
+    parser.add<std::string>("filename", 'f', "The capture to recompress.", false);
+    parser.add<std::string>("output", 'o', "The file to write the recompressed capture to.", false);
+    parser.add<int>("level", 'l', "The zstd compression level, from 1 to 22. 0 uses the default.",
+                    false, 0);
+    parser.add<uint32_t>("threads", 't', "The number of threads to use. 0 uses all cores.", false,
+                         0);
+    parser.add("dictionary", 'd',
+               "Build a compression dictionary from the capture and store it alongside. This "
+               "compresses better but older versions of RenderDoc can't open the result.");
+  }
+  virtual const char *Description()
+  {
+    return "Recompress a capture with zstd, using multiple threads.";
+  }
+  virtual bool IsInternalOnly() { return false; }
+  virtual bool IsCaptureCommand() { return false; }
+  virtual int Execute(cmdline::parser &parser, const CaptureOptions &)
+  {
+    std::string infile = parser.get<std::string>("filename");
+    std::string outfile = parser.get<std::string>("output");
+
+    if(infile.empty())
+    {
+      std::cerr << "Need an input filename (-f)." << std::endl << std::endl;
+      std::cerr << parser.usage() << std::endl;
+      return 1;
+    }
+
+    if(outfile.empty())
+    {
+      std::cerr << "Need an output filename (-o)." << std::endl << std::endl;
+      std::cerr << parser.usage() << std::endl;
+      return 1;
+    }
+
+    ICaptureFile *file = RENDERDOC_OpenCaptureFile();
+
+    ReplayStatus st = file->OpenFile(infile.c_str(), "rdc", NULL);
+
+    if(st != ReplayStatus::Succeeded)
+    {
+      std::cerr << "Couldn't load '" << infile << "': " << ToStr(st) << std::endl;
+      file->Shutdown();
+      return 1;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    st = file->Recompress(outfile.c_str(), parser.get<int>("level"),
+                          parser.get<uint32_t>("threads"), parser.exist("dictionary"), NULL);
+
+    file->Shutdown();
+
+    if(st != ReplayStatus::Succeeded)
+    {
+      std::cerr << "Couldn't recompress '" << infile << "' to '" << outfile << "': " << ToStr(st)
+                << std::endl;
+      return 1;
+    }
+
+    std::chrono::duration<double> secs = std::chrono::high_resolution_clock::now() - start;
+
+    std::cout << "Recompressed '" << infile << "' to '" << outfile << "' in " << secs.count()
+              << "s" << std::endl;
+
+    return 0;
+  }
+};
+
+struct PoolCommand : public Command
+{
+  PoolCommand(const GlobalEnvironment &env) : Command(env) {}
+  virtual void AddOptions(cmdline::parser &parser)
+  {
+    parser.set_footer("<capture> [<capture> ...]");
+    parser.add<std::string>("app", 'a', "The worker program to run for each capture.", true);
+    parser.add<std::string>("cmdline", 'c',
+                            "The worker's command line. {capture} is replaced with the capture.",
+                            false, "{capture}");
+    parser.add<uint32_t>("workers", 'w', "The number of workers to run at once. 0 uses all cores.",
+                         false, 0);
+    parser.stop_at_rest(true);
+  }
+  virtual const char *Description()
+  {
+    return "Run a command over many captures across a pool of worker processes.";
+  }
+  virtual bool IsInternalOnly() { return false; }
+  virtual bool IsCaptureCommand() { return false; }
+  virtual int Execute(cmdline::parser &parser, const CaptureOptions &)
+  {
+    std::vector<std::string> rest = parser.rest();
+
+    if(rest.empty())
+    {
+      std::cerr << "Need at least one capture to run over." << std::endl << std::endl;
+      std::cerr << parser.usage() << std::endl;
+      return 1;
+    }
+
+    std::string app = parser.get<std::string>("app");
+    std::string cmdLine = parser.get<std::string>("cmdline");
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // run in the current directory so that relative capture paths still resolve
+    rdcarray<CaptureJobResult> results;
+    RENDERDOC_RunCaptureJobs(conv(app), ".", conv(cmdLine), convertArgs(rest),
+                             parser.get<uint32_t>("workers"), &results);
+
+    std::chrono::duration<double> secs = std::chrono::high_resolution_clock::now() - start;
+
+    size_t failed = 0;
+
+    for(const CaptureJobResult &res : results)
+    {
+      if(!res.launched)
+      {
+        std::cout << "== " << res.capture << " (failed to launch)" << std::endl;
+        failed++;
+        continue;
+      }
+
+      std::cout << "== " << res.capture << " (exit code " << res.exitCode << ")" << std::endl;
+      std::cout << res.output.c_str();
+      std::cerr << res.errors.c_str();
+
+      if(res.exitCode != 0)
+        failed++;
+    }
+
+    std::cout << "Ran " << results.size() << " jobs in " << secs.count() << "s, " << failed
+              << " failed." << std::endl;
+
+    return failed > 0 ? 1 : 0;
+  }
+};
+
 struct TestCommand : public Command
 {
   TestCommand(const GlobalEnvironment &env) : Command(env) {}
@@ -1219,9 +1563,12 @@ int renderdoccmd(GlobalEnvironment &env, std::vector<std::string> &argv)
     add_command("inject", new InjectCommand(env));
     add_command("remoteserver", new RemoteServerCommand(env));
     add_command("replay", new ReplayCommand(env));
+    add_command("loadprofile", new LoadProfileCommand(env));
     add_command("capaltbit", new CapAltBitCommand(env));
     add_command("test", new TestCommand(env));
     add_command("convert", new ConvertCommand(env));
+    add_command("recompress", new RecompressCommand(env));
+    add_command("pool", new PoolCommand(env));
     add_command("embed", new EmbeddedSectionCommand(env, false));
     add_command("extract", new EmbeddedSectionCommand(env, true));
 
@@ -1286,6 +1633,8 @@ int renderdoccmd(GlobalEnvironment &env, std::vector<std::string> &argv)
               "Capturing Option: Capture CPU callstacks for API events.");
       cmd.add("opt-capture-callstacks-only-draws", 0,
               "Capturing Option: When capturing CPU callstacks, only capture them from drawcalls.");
+      cmd.add("opt-capture-callstacks-fast-unwind", 0,
+              "Capturing Option: When capturing CPU callstacks, use the faster cached unwinder.");
       cmd.add<int>("opt-delay-for-debugger", 0,
                    "Capturing Option: Specify a delay in seconds to wait for a debugger to attach.",
                    false, 0, cmdline::range(0, 10000));
@@ -1319,6 +1668,8 @@ int renderdoccmd(GlobalEnvironment &env, std::vector<std::string> &argv)
         opts.captureCallstacks = true;
       if(cmd.exist("opt-capture-callstacks-only-draws"))
         opts.captureCallstacksOnlyDraws = true;
+      if(cmd.exist("opt-capture-callstacks-fast-unwind"))
+        opts.captureCallstacksFastUnwind = true;
       if(cmd.exist("opt-verify-buffer-access"))
         opts.verifyBufferAccess = true;
       if(cmd.exist("opt-hook-children"))